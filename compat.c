@@ -588,10 +588,12 @@ wsac0(char   *kname,
     y = s->y;
     s->x = xarray;
     s->y = yarray;
+    sac_mark_data_dirty(s);
     sac_be(s);
     sac_write(s, name, nerr);
     s->x = x;
     s->y = y;
+    sac_mark_data_dirty(s);
 }
 /**
  * @brief      Write a sac file
@@ -681,9 +683,11 @@ wsac1(char   *kname,
     sac_set_float(s, SAC_B, (double) *beg);
     s->h->npts  = *nlen;
     s->h->leven = TRUE;
+    sac_mark_data_dirty(s);
     sac_be(s);
     sac_write(s, name, nerr);
     s->y = y;
+    sac_mark_data_dirty(s);
 }
 
 /**
@@ -763,10 +767,12 @@ wsac2(char   *kname,
     s->x = xarray;
     s->h->npts  = *nlen;
     s->h->leven = FALSE;
+    sac_mark_data_dirty(s);
     sac_be(s);
     sac_write(s, name, nerr);
     s->y = y;
     s->x = x;
+    sac_mark_data_dirty(s);
 }
 
 /**
@@ -1916,6 +1922,7 @@ sac_compare_to_file(char *file, float *y, double tolerance, int byte_order, int
     }
     s1 = sac_copy(sc);
     s1->y = y;
+    sac_mark_data_dirty(s1);
 
     retval = sac_compare(s1, s2, tolerance, byte_order, verbose);
 
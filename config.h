@@ -0,0 +1,89 @@
+/* config.h.  Generated from config.h.in by configure.  */
+/* config.h.in.  Generated from configure.ac by autoheader.  */
+
+/* System Libraries define fallocate */
+#define HAVE_FUNC_FALLOCATE 1
+
+/* System Libraries define fmemopen */
+#define HAVE_FUNC_FMEMOPEN 1
+
+/* System Libraries define inotify_init1 */
+#define HAVE_FUNC_INOTIFY_INIT1 1
+
+/* System Libraries define posix_fadvise */
+#define HAVE_FUNC_POSIX_FADVISE 1
+
+/* System Libraries define pwritev */
+#define HAVE_FUNC_PWRITEV 1
+
+/* System Libraries define sync_file_range */
+#define HAVE_FUNC_SYNC_FILE_RANGE 1
+
+/* Define to 1 if you have the <inttypes.h> header file. */
+#define HAVE_INTTYPES_H 1
+
+/* System headers define io_uring with openat and statx */
+#define HAVE_IO_URING 1
+
+/* Define to 1 if you have the <memory.h> header file. */
+#define HAVE_MEMORY_H 1
+
+/* Define to 1 if you have the <stdint.h> header file. */
+#define HAVE_STDINT_H 1
+
+/* Define to 1 if you have the <stdlib.h> header file. */
+#define HAVE_STDLIB_H 1
+
+/* Define to 1 if you have the <strings.h> header file. */
+#define HAVE_STRINGS_H 1
+
+/* Define to 1 if you have the <string.h> header file. */
+#define HAVE_STRING_H 1
+
+/* Define to 1 if you have the <sys/stat.h> header file. */
+#define HAVE_SYS_STAT_H 1
+
+/* Define to 1 if you have the <sys/types.h> header file. */
+#define HAVE_SYS_TYPES_H 1
+
+/* Define to 1 if you have the <unistd.h> header file. */
+#define HAVE_UNISTD_H 1
+
+/* Read gzip compressed files with zlib */
+#define HAVE_ZLIB 1
+
+/* Read zstd compressed files with libzstd */
+/* #undef HAVE_ZSTD */
+
+/* System Libraries missing fmemopen */
+/* #undef MISSING_FUNC_FMEMOPEN */
+
+/* Name of package */
+#define PACKAGE "sacio"
+
+/* Define to the address where bug reports for this package should be sent. */
+#define PACKAGE_BUGREPORT "savage13@gmail.com"
+
+/* Define to the full name of this package. */
+#define PACKAGE_NAME "sacio"
+
+/* Define to the full name and version of this package. */
+#define PACKAGE_STRING "sacio 1.0.2"
+
+/* Define to the one symbol short name of this package. */
+#define PACKAGE_TARNAME "sacio"
+
+/* Define to the home page for this package. */
+#define PACKAGE_URL ""
+
+/* Define to the version of this package. */
+#define PACKAGE_VERSION "1.0.2"
+
+/* Define to 1 if you have the ANSI C header files. */
+#define STDC_HEADERS 1
+
+/* Use the geographiclib library for geodetic calcs */
+#define USE_GEOGRAPHICLIB 1
+
+/* Version number of package */
+#define VERSION "1.0.2"
@@ -16,4 +16,12 @@
 #define FALSE 0
 #define TRUE  1
 
+#define ERROR_NOT_A_SAC_FILE                1317 /**< @brief Not a sac file */
+#define ERROR_OVERWRITE_FLAG_IS_OFF         1303 /**< @brief Overwrite flag, lovrok is set to 0 */
+#define ERROR_WRITING_FILE                  115 /**< @brief Error writing sac file */
+#define ERROR_READING_FILE                  114 /**< @brief Error reading sac file */
+#define ERROR_FILE_DOES_NOT_EXIST           108 /**< @brief Error file does not exist */
+#define ERROR_OPENING_FILE                  101 /**< @brief Error opening sac file */
+#define SAC_OK                              0 /**< @brief Success, everything is ok */
+
 #endif /* _DEFS_H_ */
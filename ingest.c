@@ -0,0 +1,536 @@
+/**
+ * @file
+ * @brief Time rotating, multi-channel real-time ingest of sac files
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdatomic.h>
+
+#include "sacio.h"
+#include "timespec.h"
+
+#include "defs.h"
+
+/**
+ * @brief      Number of samples staged per channel before appending
+ * @private
+ */
+#define SAC_INGEST_BATCH 1024
+
+/**
+ * @brief      Number of names tried for a new file, see sac_channel_create()
+ * @private
+ */
+#define SAC_INGEST_UNIQUE 1000
+
+/**
+ * @defgroup ingest ingest
+ * @brief Time rotating, multi-channel real-time ingest
+ */
+
+/**
+ * @brief sac ingest channel
+ * @private
+ */
+struct sac_channel {
+    _Atomic(sac_packet *) head;   /**< @brief Most recently pushed packet */
+    sac *hdr;                     /**< @brief Header template */
+    char *pattern;                /**< @brief Filename pattern, see strftime64t() */
+    sac_writer *w;                /**< @brief Current file, NULL if none */
+    timespec64 start;             /**< @brief Time of the first sample of the current file */
+    timespec64 end;               /**< @brief Rotation boundary of the current file */
+    double delta;                 /**< @brief Sample interval */
+    size_t nbuf;                  /**< @brief Samples staged in buf */
+    float buf[SAC_INGEST_BATCH];  /**< @brief Staged samples */
+};
+
+/**
+ * @brief sac ingest
+ * @private
+ */
+struct sac_ingest {
+    duration rotate;     /**< @brief File rotation duration */
+    sac_channel **ch;    /**< @brief Channels */
+    size_t n;            /**< @brief Number of channels */
+    size_t alloc;        /**< @brief Allocated channels */
+};
+
+/**
+ * @brief      Create a new ingest
+ *
+ * @memberof   sac_ingest
+ * @ingroup    ingest
+ *
+ * @details    Create a new ingest where files are rotated on calendar aligned
+ *             boundaries of \p rotate, e.g. `1h` or `1day`, see
+ *             duration_parse() and timespec64_floor_duration().
+ *
+ *             Sample packets are pushed by any number of producer threads
+ *             with sac_ingest_push(), which is lock-free.  Packets are
+ *             written by a single consumer calling sac_ingest_flush(), which
+ *             batches contiguous packets for each channel into a single
+ *             append.  Samples written are published to concurrent readers
+ *             at the end of each flush, see sac_writer_publish().
+ *             Channels must be added before producers start.
+ *             A new file is started at each rotation boundary or whenever a
+ *             packet does not continue the current file, e.g. a gap, overlap
+ *             or change in order.  Existing files are never overwritten, see
+ *             sac_ingest_add_channel().
+ *
+ * @param      rotate   rotation duration, see duration_parse()
+ * @param      nerr     status code, 0 on success, non-zero on failure
+ *
+ * @return     new ingest, NULL on failure, free with sac_ingest_free()
+ *
+ * @code
+ * int nerr = 0;
+ * char out[64] = {0};
+ * float y[90];
+ * timespec64 t = {0,0}, tf = {0,0};
+ *
+ * remove("t/test_ingest_000030.sac.tmp");
+ * remove("t/test_ingest_000100.sac.tmp");
+ * sac_ingest *in = sac_ingest_new("1min", &nerr);
+ * assert_eq(nerr, 0);
+ *
+ * // Template header, 1 sample per second
+ * sac *hdr = sac_new();
+ * sac_set_float(hdr, SAC_DELTA, 1.0);
+ * sac_set_float(hdr, SAC_B, 0.0);
+ * hdr->h->iftype = ITIME;
+ * hdr->h->leven = 1;
+ * hdr->h->nvhdr = 6;
+ * sac_channel *c = sac_ingest_add_channel(in, hdr, "t/test_ingest_%H%M%S.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ *
+ * // 90 samples starting at 00:00:30 in 3 packets, crossing 00:01:00
+ * for(int i = 0; i < 90; i++) {
+ *     y[i] = (float) i;
+ * }
+ * timespec64_parse("2000/001T00:00:30", &t);
+ * for(int i = 0; i < 3; i++) {
+ *     timespec64 ti = t;
+ *     ti.tv_sec += i * 30;
+ *     sac_ingest_push(c, sac_packet_new(ti, y + i * 30, 30));
+ * }
+ * sac_ingest_flush(in, &nerr);
+ * assert_eq(nerr, 0);
+ * sac_ingest_free(in, &nerr);
+ * assert_eq(nerr, 0);
+ *
+ * sac *a = sac_read("t/test_ingest_000030.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(a->h->npts, 30);
+ * assert_eq(a->y[29], 29.0);
+ * sac_get_time_ref(a, &tf);
+ * strftime64t(out, sizeof out, "%FT%T", &tf);
+ * assert_eq(strcmp(out, "2000-01-01T00:00:30"), 0);
+ *
+ * sac *b = sac_read("t/test_ingest_000100.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(b->h->npts, 60);
+ * assert_eq(b->y[0], 30.0);
+ * assert_eq(b->h->_b, 0.0);
+ * assert_eq(b->h->depmax, 89.0);
+ * @endcode
+ */
+sac_ingest *
+sac_ingest_new(char *rotate, int *nerr) {
+    sac_ingest *in = NULL;
+    *nerr = SAC_OK;
+    in = calloc(1, sizeof(sac_ingest));
+    if(!rotate || !duration_parse(rotate, &in->rotate) || in->rotate.n <= 0) {
+        *nerr = ERROR_OPENING_FILE;
+        free(in);
+        return NULL;
+    }
+    return in;
+}
+
+/**
+ * @brief      Add a channel to an ingest
+ *
+ * @memberof   sac_ingest
+ * @ingroup    ingest
+ *
+ * @details    Add a channel with a header template and a filename pattern.
+ *             Each new file is named by formatting \p pattern with the time
+ *             of its first sample, see strftime64t().  If a file with that
+ *             name exists, e.g. after a gap within a rotation period or on a
+ *             restart, a number is added before the extension of the name,
+ *             `a.sac`, `a.1.sac`, `a.2.sac`, and so on; existing files are
+ *             never overwritten.  The template must be
+ *             an evenly spaced time series, data values and times in the
+ *             template are ignored.  Not safe to call concurrently with
+ *             sac_ingest_push() or sac_ingest_flush().
+ *
+ * @param      in       ingest
+ * @param      hdr      header template, copied
+ * @param      pattern  filename pattern, e.g. `IU.ANMO.BHZ.%Y.%j.%H.sac`
+ * @param      nerr     status code, 0 on success, non-zero on failure
+ *
+ * @return     channel to push packets to, NULL on failure
+ *
+ * @code
+ * int nerr = 0;
+ * float y[100] = {0};
+ * timespec64 t = {0,0};
+ * remove("t/test_ingest_00.sac.tmp");
+ * remove("t/test_ingest_00.sac.1.tmp");
+ *
+ * sac_ingest *in = sac_ingest_new("1h", &nerr);
+ * sac *hdr = sac_new();
+ * sac_set_float(hdr, SAC_DELTA, 1.0);
+ * hdr->h->iftype = ITIME;
+ * hdr->h->leven = 1;
+ * hdr->h->nvhdr = 6;
+ * sac_channel *c = sac_ingest_add_channel(in, hdr, "t/test_ingest_%H.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ *
+ * // A gap within the hour starts a second file with the same time pattern
+ * timespec64_parse("2000/001T00:00:00", &t);
+ * sac_ingest_push(c, sac_packet_new(t, y, 100));
+ * sac_ingest_flush(in, &nerr);
+ * assert_eq(nerr, 0);
+ * t.tv_sec += 700;
+ * sac_ingest_push(c, sac_packet_new(t, y, 10));
+ * sac_ingest_free(in, &nerr);
+ * assert_eq(nerr, 0);
+ *
+ * sac *a = sac_read("t/test_ingest_00.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(a->h->npts, 100);
+ * sac *b = sac_read("t/test_ingest_00.sac.1.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(b->h->npts, 10);
+ * @endcode
+ */
+sac_channel *
+sac_ingest_add_channel(sac_ingest *in, sac *hdr, char *pattern, int *nerr) {
+    double delta = 0.0;
+    sac_channel *c = NULL;
+    *nerr = SAC_OK;
+    if(!hdr || !pattern || !hdr->h->leven ||
+       !sac_get_float(hdr, SAC_DELTA, &delta) || delta <= 0.0) {
+        *nerr = ERROR_OPENING_FILE;
+        return NULL;
+    }
+    if(in->n == in->alloc) {
+        in->alloc = (in->alloc) ? 2 * in->alloc : 16;
+        in->ch = realloc(in->ch, in->alloc * sizeof(sac_channel *));
+    }
+    c = calloc(1, sizeof(sac_channel));
+    atomic_init(&c->head, NULL);
+    c->hdr = sac_new();
+    sac_header_copy(c->hdr, hdr);
+    c->pattern = strdup(pattern);
+    c->delta = delta;
+    in->ch[in->n++] = c;
+    return c;
+}
+
+/**
+ * @brief      Create a sample packet
+ *
+ * @memberof   sac_packet
+ * @ingroup    ingest
+ *
+ * @param      t     time of the first sample
+ * @param      y     samples, copied
+ * @param      n     number of samples
+ *
+ * @return     new packet, owned by the ingest once pushed
+ */
+sac_packet *
+sac_packet_new(timespec64 t, const float *y, size_t n) {
+    sac_packet *p = malloc(sizeof(sac_packet) + n * sizeof(float));
+    p->t = t;
+    p->n = n;
+    p->next = NULL;
+    memcpy(p->y, y, n * sizeof(float));
+    return p;
+}
+
+/**
+ * @brief      Push a packet onto a channel
+ *
+ * @memberof   sac_ingest
+ * @ingroup    ingest
+ *
+ * @details    Lock-free, may be called from any number of threads.  Packets
+ *             pushed from a single thread are written in the order pushed.
+ *
+ * @param      c     channel
+ * @param      p     packet, see sac_packet_new(), freed by the ingest
+ */
+void
+sac_ingest_push(sac_channel *c, sac_packet *p) {
+    sac_packet *head = atomic_load_explicit(&c->head, memory_order_relaxed);
+    do {
+        p->next = head;
+    } while(!atomic_compare_exchange_weak_explicit(&c->head, &head, p,
+                                                   memory_order_release,
+                                                   memory_order_relaxed));
+}
+
+/**
+ * @brief      Seconds from \p a to \p b
+ * @private
+ */
+static double
+timespec64_diff(timespec64 *a, timespec64 *b) {
+    return (double) (b->tv_sec - a->tv_sec) + (double) (b->tv_nsec - a->tv_nsec) / 1e9;
+}
+
+/**
+ * @brief      Append staged samples to the current file
+ * @private
+ */
+static int
+sac_channel_drain(sac_channel *c) {
+    int nerr = SAC_OK;
+    if(c->nbuf > 0 && c->w) {
+        sac_writer_append(c->w, c->buf, c->nbuf, &nerr);
+    }
+    c->nbuf = 0;
+    return nerr;
+}
+
+/**
+ * @brief      Close the current file of a channel
+ * @private
+ */
+static int
+sac_channel_close(sac_channel *c) {
+    int nerr = SAC_OK, err = SAC_OK;
+    if(!c->w) {
+        return SAC_OK;
+    }
+    nerr = sac_channel_drain(c);
+    sac_writer_close(c->w, &err);
+    c->w = NULL;
+    return (nerr != SAC_OK) ? nerr : err;
+}
+
+/**
+ * @brief      Create a new, empty file named \p file, adding a number before
+ *             the extension if the name is taken
+ *
+ * @private
+ *
+ * @param      file  name of the file, replaced with the name created
+ * @param      n     size of \p file
+ *
+ * @return     0 on success, ERROR_OPENING_FILE on failure
+ */
+static int
+sac_channel_create(char *file, size_t n) {
+    int i = 0, fd = -1;
+    char name[PATH_MAX];
+    char *base = strrchr(file, '/');
+    char *ext = NULL;
+
+    base = (base) ? base + 1 : file;
+    ext = strrchr(base, '.');
+    ext = (ext && ext != base) ? ext : file + strlen(file);
+    for(i = 0; i < SAC_INGEST_UNIQUE; i++) {
+        if(i == 0) {
+            snprintf(name, sizeof name, "%s", file);
+        } else if(snprintf(name, sizeof name, "%.*s.%d%s", (int) (ext - file), file, i, ext) >= (int) sizeof name) {
+            break;
+        }
+        if((fd = open(name, O_WRONLY | O_CREAT | O_EXCL, 0666)) >= 0) {
+            close(fd);
+            snprintf(file, n, "%s", name);
+            return SAC_OK;
+        }
+        if(errno != EEXIST) {
+            break;
+        }
+    }
+    return ERROR_OPENING_FILE;
+}
+
+/**
+ * @brief      Start a new file for a channel at time \p t
+ *
+ * @private
+ *
+ * @details    The reference time is set to \p t with sac_set_time() and
+ *             the begin value to the fraction of a millisecond not
+ *             representable in the reference time.  The file is created
+ *             with sac_channel_create(), so existing files are kept
+ */
+static int
+sac_channel_start(sac_ingest *in, sac_channel *c, timespec64 t) {
+    int nerr = SAC_OK;
+    char file[PATH_MAX];
+    sac *s = sac_new();
+
+    sac_header_copy(s, c->hdr);
+    s->h->nzyear = SAC_INT_UNDEFINED; // No prior reference time
+    sac_set_time(s, t);
+    s->h->iztype = IB;
+    sac_set_float(s, SAC_O, SAC_FLOAT_UNDEFINED);
+    sac_set_float(s, SAC_B, (double) (t.tv_nsec % 1000000) / 1e9);
+
+    strftime64t(file, sizeof file, c->pattern, &t);
+    if((nerr = sac_channel_create(file, sizeof file)) == SAC_OK &&
+       !(c->w = sac_writer_open(s, file, &nerr))) {
+        unlink(file);
+    }
+    sac_free(s);
+    if(!c->w) {
+        return nerr;
+    }
+    c->start = t;
+    c->end = timespec64_add_duration(timespec64_floor_duration(t, &in->rotate), &in->rotate);
+    return SAC_OK;
+}
+
+/**
+ * @brief      Write a single packet to a channel, rotating files as needed
+ * @private
+ */
+static int
+sac_channel_write(sac_ingest *in, sac_channel *c, sac_packet *p) {
+    int nerr = SAC_OK;
+    size_t i = 0, k = 0, m = 0;
+    double dt = 0.0;
+    timespec64 t = p->t;
+
+    while(i < p->n) {
+        if(c->w) {
+            // Continue the current file only if contiguous within half a sample
+            dt = timespec64_diff(&c->start, &t) - (double) (c->w->npts + c->nbuf) * c->delta;
+            if(fabs(dt) > c->delta / 2.0) {
+                if((nerr = sac_channel_close(c)) != SAC_OK) {
+                    return nerr;
+                }
+            }
+        }
+        if(c->w && timespec64_cmp(&t, &c->end) >= 0) {
+            if((nerr = sac_channel_close(c)) != SAC_OK) {
+                return nerr;
+            }
+        }
+        if(!c->w && (nerr = sac_channel_start(in, c, t)) != SAC_OK) {
+            return nerr;
+        }
+        // Samples before the rotation boundary
+        dt = timespec64_diff(&t, &c->end) / c->delta;
+        k = (dt > 1.0) ? (size_t) ceil(dt - 1e-6) : 1;
+        k = (k < p->n - i) ? k : p->n - i;
+        while(k > 0) {
+            if(c->nbuf == SAC_INGEST_BATCH && (nerr = sac_channel_drain(c)) != SAC_OK) {
+                return nerr;
+            }
+            m = (k < SAC_INGEST_BATCH - c->nbuf) ? k : SAC_INGEST_BATCH - c->nbuf;
+            memcpy(c->buf + c->nbuf, p->y + i, m * sizeof(float));
+            c->nbuf += m;
+            i += m;
+            k -= m;
+        }
+        // Time of the next sample, relative to the start of the file
+        dt = (double) (c->w->npts + c->nbuf) * c->delta;
+        t = c->start;
+        t.tv_sec += (int64_t) floor(dt);
+        t.tv_nsec += (int64_t) llround((dt - floor(dt)) * 1e9);
+        if(t.tv_nsec >= 1000000000) {
+            t.tv_sec += 1;
+            t.tv_nsec -= 1000000000;
+        }
+    }
+    return SAC_OK;
+}
+
+/**
+ * @brief      Write all pushed packets
+ *
+ * @memberof   sac_ingest
+ * @ingroup    ingest
+ *
+ * @details    Drain the queue of each channel and write packets in the order
+ *             pushed, with contiguous packets batched into a single append.
+ *             Only a single thread may flush at a time.  A failure on one
+ *             channel does not stop the remaining channels from being
+ *             written; the first error is returned.
+ *
+ * @param      in    ingest
+ * @param      nerr  status code, 0 on success, non-zero on failure
+ *
+ * @return     number of packets written
+ */
+size_t
+sac_ingest_flush(sac_ingest *in, int *nerr) {
+    int err = SAC_OK;
+    size_t i = 0, n = 0;
+    sac_packet *p = NULL, *next = NULL, *fifo = NULL;
+
+    *nerr = SAC_OK;
+    for(i = 0; i < in->n; i++) {
+        sac_channel *c = in->ch[i];
+        p = atomic_exchange_explicit(&c->head, NULL, memory_order_acquire);
+        // Packets are pushed newest first, reverse to write oldest first
+        for(fifo = NULL; p; p = next) {
+            next = p->next;
+            p->next = fifo;
+            fifo = p;
+        }
+        for(p = fifo; p; p = next) {
+            next = p->next;
+            if((err = sac_channel_write(in, c, p)) != SAC_OK && *nerr == SAC_OK) {
+                *nerr = err;
+            }
+            free(p);
+            n++;
+        }
+        if((err = sac_channel_drain(c)) != SAC_OK && *nerr == SAC_OK) {
+            *nerr = err;
+        }
+        if(fifo && c->w) {
+            sac_writer_publish(c->w, &err);
+            if(err != SAC_OK && *nerr == SAC_OK) {
+                *nerr = err;
+            }
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief      Flush, close all files and free an ingest
+ *
+ * @memberof   sac_ingest
+ * @ingroup    ingest
+ *
+ * @param      in    ingest, may be NULL
+ * @param      nerr  status code, 0 on success, non-zero on failure
+ */
+void
+sac_ingest_free(sac_ingest *in, int *nerr) {
+    int err = SAC_OK;
+    size_t i = 0;
+    *nerr = SAC_OK;
+    if(!in) {
+        return;
+    }
+    sac_ingest_flush(in, nerr);
+    for(i = 0; i < in->n; i++) {
+        sac_channel *c = in->ch[i];
+        if((err = sac_channel_close(c)) != SAC_OK && *nerr == SAC_OK) {
+            *nerr = err;
+        }
+        sac_free(c->hdr);
+        FREE(c->pattern);
+        free(c);
+    }
+    FREE(in->ch);
+    free(in);
+}
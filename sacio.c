@@ -2,6 +2,9 @@
  * @file
  * @brief sac I/O and manipulation
  */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /**< @private fallocate() and other system extensions */
+#endif
 #include <stdio.h>
 #include <string.h>
 #include <stdarg.h>
@@ -10,13 +13,40 @@
 #include <unistd.h>
 #include <math.h>
 #include <float.h>
+#include <stddef.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <poll.h>
 #include <errno.h>
+#include <stdatomic.h>
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
 
+#ifdef HAVE_FUNC_INOTIFY_INIT1
+#include <sys/inotify.h>
+#endif /* HAVE_FUNC_INOTIFY_INIT1 */
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif /* HAVE_ZLIB */
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif /* HAVE_ZSTD */
+
+#ifdef HAVE_IO_URING
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif /* HAVE_IO_URING */
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SAC_SWAP_X86 /**< @private Use x86 vector byteswap kernels */
+#include <immintrin.h>
+#endif
+
 /** @cond NO_DOCS */
 #define SAC_NULL_HEADER_REQUIRED /**< @private Define a fully NULL sac header */
 /** @endcond */
@@ -28,14 +58,6 @@
 
 #include "geodesic.h"
 
-#define ERROR_NOT_A_SAC_FILE                1317 /**< @brief Not a sac file */
-#define ERROR_OVERWRITE_FLAG_IS_OFF         1303 /**< @brief Overwrite flag, lovrok is set to 0 */
-#define ERROR_WRITING_FILE                  115 /**< @brief Error writing sac file */
-#define ERROR_READING_FILE                  114 /**< @brief Error reading sac file */
-#define ERROR_FILE_DOES_NOT_EXIST           108 /**< @brief Error file does not exist */
-#define ERROR_OPENING_FILE                  101 /**< @brief Error opening sac file */
-#define SAC_OK                              0 /**< @brief Success, everything is ok */
-
 #define SAC_HEADER_SIZEOF_NUMBER          (sizeof(float))  /**< @brief Size of header values in bytes */
 #define SAC_DATA_SIZE                     SAC_HEADER_SIZEOF_NUMBER /**< @brief Size of data values in bytes */
 #define SAC_HEADER_VERSION_6              6 /**< @brief Sac version no 6 */
@@ -43,6 +65,16 @@
 #define SAC_HEADER_MAJOR_VERSION          SAC_HEADER_VERSION_6 /**< @brief Current Major sac version number */
 #define SAC_HEADER_MAX_VERSION            SAC_HEADER_VERSION_7 /**< @brief Current Maximum sac version number */
 #define SAC_VERSION_LOCATION              76 /**< @brief Offset in 4-byte words of the header version */
+#define SAC_LIVE_MAGIC                    0x4c495645 /**< @brief Header marker, unused25, of a file being written, "LIVE" */
+#define SAC_LIVE_RETRY                    64 /**< @brief Attempts to read a consistent header of a file being written */
+#define SAC_LIVE_SPIN                     8 /**< @brief Attempts to read a header of a file being written before waiting between attempts */
+#define SAC_LIVE_BEGIN                    104 /**< @brief Offset in 4-byte words of unused26, the begin counter of a header being written */
+#define SAC_LIVE_END                      109 /**< @brief Offset in 4-byte words of unused27, the end counter of a header being written */
+#define SAC_PACK_MAGIC                    0x5041434b /**< @brief Header marker, unused24, of a file with packed data, "PACK" */
+#define SAC_PACK_CHUNK                    4096 /**< @brief Values per chunk of packed data */
+#define SAC_PACK_CHUNK_LIMIT              (1 << 20) /**< @brief Largest chunk of packed data accepted on read */
+#define SAC_PACK_GROUP                    32 /**< @brief Values per bit width in a chunk of packed data */
+#define SAC_PACK_QUANT_HEADER             18 /**< @brief Bytes before the values of a quantized chunk of packed data */
 
 /**
  * @defgroup sac sac
@@ -62,14 +94,37 @@
  */
 #define MAX(a,b) ((a > b) ? a : b )
 
+/**
+ * @brief Compression formats of sac files
+ * @private
+ */
+enum {
+    SAC_COMPRESS_NONE = 0, /**< @private not compressed */
+    SAC_COMPRESS_GZIP,     /**< @private gzip */
+    SAC_COMPRESS_ZSTD,     /**< @private zstd */
+};
+
 /** \cond NO_DOCS */
 sacmeta * sac_meta_new();
-sac * sac_read_internal(char *filename, int read_data, int *nerr);
+sac * sac_read_internal(char *filename, int read_data, int flags, int *nerr);
+static void sac_data_release(sac *s);
+static sac * sac_header_read_fd(int fd, char *filename, off_t *size, int *nerr);
+static int sac_errno_to_nerr(int err);
+static void sac_read_post(sac *s, int flags);
+static int sac_data_read_flags(sac *s, FILE *fp, int flags);
+static sac * sac_read_header_flags(char *filename, int flags, int *nerr);
+static sac * sac_read_compressed(char *filename, int read_data, int cut, char *c1, double t1, char *c2, double t2, enum CutAction cutact, int flags, int *nerr);
+static int sac_compression(const char *buf, size_t n);
+static int sac_data_load(sac *s);
+sac * sac_read_from_memory(const uint8_t *buf, size_t len);
 double calc_e_even(sac *s);
-void sac_write_internal(sac *s, char *filename, int write_data, int swap, int *nerr);
+void sac_write_internal(sac *s, char *filename, int write_data, int swap, int flags, int *nerr);
 static float array_max(float *y, int n);
 static float array_min(float *y, int n);
-static float array_mean(float *y, int n);
+static void check_value(float vmin, float vmax, size_t nonfinite);
+static void sac_swap32(void *dst, const void *src, size_t n);
+void sac_header_v7_encode(const sac *s, char *buf, int swap);
+void sac_copy_strings_strip_terminator(sac *s, char *dst);
 sac_hdr * sac_hdr_new();
 int sac_get_time_ref(sac *s, timespec64 *t);
 /** \endcond */
@@ -192,7 +247,10 @@ sac_int(sac *s, int id) {
  * @ingroup    sac
  * @memberof   sac
  *
- * @details    Read a sac file, data and header
+ * @details    Read a sac file, data and header.  gzip and zstd compressed
+ *             files are recognized by their contents and decompressed as
+ *             they are read, if the library was built with zlib or zstd.
+ *             Otherwise they fail with ERROR_COMPRESSED_FILE.
  *
  * @param      filename   file to read data and header from
  * @param      nerr       status code, 0 on success, non-zero on header
@@ -232,7 +290,111 @@ sac_int(sac *s, int id) {
 */
 sac *
 sac_read(char *filename, int *nerr) {
-    return sac_read_internal(filename, 1, nerr);
+    return sac_read_internal(filename, 1, 0, nerr);
+}
+
+/**
+ * @brief      Read a sac file with options
+ *
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Read a sac file as sac_read() with options
+ *
+ * @param      filename   file to read data and header from
+ * @param      flags      read flags
+ *                        - SAC_READ_LAZY - only read the header, data is read
+ *                          on first access with sac_data()
+ *                        - SAC_READ_NO_BE - do not update b and e
+ *                        - SAC_READ_NO_DISTAZ - do not update dist, az, baz
+ *                          and gcarc
+ *                        - SAC_READ_NO_EXTREMA - do not update depmin, depmax
+ *                          and depmen from the data
+ *                        - SAC_READ_NO_PRECISION - do not check the precision
+ *                          of time values
+ *                        - SAC_READ_NO_UPDATE - all of the above, header
+ *                          values are as stored in the file
+ *                        - SAC_READ_BULK - the file is read once, hint
+ *                          sequential access and drop the file from the
+ *                          page cache after reading, see sac_io_stats_get()
+ *
+ *             Skipped updates may be performed later with sac_be(),
+ *             update_distaz(), sac_extrema() and sac_check_time_precision().
+ * @param      nerr       status code, 0 on success, non-zero on failure
+ *
+ * @return     sac file structure, NULL on failure
+ *
+ * Lazy reading defers the data until requested
+ * @code
+ * int nerr = 0;
+ * sac *f = sac_read("t/test_io_big.sac", &nerr);
+ * sac *s = sac_read_with_flags("t/test_io_big.sac", SAC_READ_LAZY, &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(s->y, NULL);
+ * assert_eq(s->h->npts, f->h->npts);
+ * assert_eq(s->h->gcarc, f->h->gcarc);
+ *
+ * float *y = sac_data(s, 0);
+ * assert_ne(y, NULL);
+ * assert_eq(y, s->y);
+ * assert_eq(memcmp(y, f->y, sizeof(float) * f->h->npts), 0);
+ * assert_eq(sac_data(s, 0), y);
+ * assert_eq(sac_data(s, 1), NULL);
+ *
+ * // Data is loaded before writing or copying
+ * s = sac_read_with_flags("t/test_io_big.sac", SAC_READ_LAZY, &nerr);
+ * sac_write(s, "t/test_io_lazy.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ * sac *c = sac_read("t/test_io_lazy.sac.tmp", &nerr);
+ * assert_eq(memcmp(c->y, f->y, sizeof(float) * f->h->npts), 0);
+ * @endcode
+ *
+ * Header values are left as stored in the file when updates are skipped
+ * @code
+ * int nerr = 0;
+ * float y[5] = { 1e3, 2e3, 3e3, 4e3, 5e3 };
+ * sac *s = sac_read("t/test_io_big.sac", &nerr);
+ * sac_set_float(s, SAC_E, 1.0);
+ * sac_write_with_flags(s, "t/test_io_noupdate.sac.tmp", SAC_WRITE_NO_DISTAZ, &nerr);
+ * assert_eq(nerr, 0);
+ * sac_write_samples("t/test_io_noupdate.sac.tmp", 0, y, 5, &nerr);
+ *
+ * sac *c = sac_read_with_flags("t/test_io_noupdate.sac.tmp", SAC_READ_NO_UPDATE, &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(c->h->_e, 1.0);
+ * assert_eq(c->h->depmax, 5e3);
+ * assert_eq(memcmp(c->y, y, sizeof y), 0);
+ *
+ * // Extrema not updated when written
+ * c->h->depmax = 1.0;
+ * sac_write_with_flags(c, "t/test_io_noupdate.sac.tmp", SAC_WRITE_NO_EXTREMA, &nerr);
+ * c = sac_read_with_flags("t/test_io_noupdate.sac.tmp", SAC_READ_NO_EXTREMA, &nerr);
+ * assert_eq(c->h->depmax, 1.0);
+ * c = sac_read("t/test_io_noupdate.sac.tmp", &nerr);
+ * assert_eq(c->h->depmax, 5e3);
+ * assert_ne(c->h->_e, 1.0);
+ * @endcode
+ */
+sac *
+sac_read_with_flags(char *filename, int flags, int *nerr) {
+    sac *s = NULL;
+    if(!(flags & SAC_READ_LAZY)) {
+        return sac_read_internal(filename, 1, flags, nerr);
+    }
+    if(!(s = sac_read_header_flags(filename, flags, nerr))) {
+        return NULL;
+    }
+    if(s->y) {
+        return s;
+    }
+    s->m->data_read = FALSE;
+    s->m->flags  = flags;
+    s->m->nstart = 1;
+    s->m->nstop  = s->h->npts;
+    s->m->ntotal = s->h->npts;
+    s->m->nfillb = 0;
+    s->m->nfille = 0;
+    return s;
 }
 
 
@@ -242,7 +404,9 @@ sac_read(char *filename, int *nerr) {
  * @ingroup    sac
  * @memberof   sac
  *
- * @details    Read a sac file header
+ * @details    Read a sac file header.  The header is read with a single
+ *             fstat() and a positioned read, plus a positioned read of the
+ *             footer for v7 files; the data section is never touched.
  *
  * @param      filename    file to read sac header from
  * @param      nerr        status code, 0 on success, non-zero on failure
@@ -257,10 +421,62 @@ sac_read(char *filename, int *nerr) {
  * assert_eq(s->y, NULL);
  * assert_ne(s->h, NULL);
  * @endcode
+ *
+ * Errors match those from sac_read()
+ * @code
+ * int nerr = 0;
+ * sac *s = sac_read_header("non-existant-file", &nerr);
+ * assert_eq(s, NULL);
+ * assert_eq(nerr, 108);
+ * s = sac_read_header("sacio.c", &nerr);
+ * assert_eq(s, NULL);
+ * assert_eq(nerr, 1317);
+ * @endcode
  */
 sac *
 sac_read_header(char *filename, int *nerr) {
-    return sac_read_internal(filename, 0, nerr);
+    return sac_read_header_flags(filename, 0, nerr);
+}
+
+/**
+ * @brief      Read a sac file header with read flags
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @param      filename    file to read sac header from
+ * @param      flags       read flags, see sac_read_with_flags()
+ * @param      nerr        status code, 0 on success, non-zero on failure
+ *
+ * @return     sac file structure, NULL on failure
+ */
+static sac *
+sac_read_header_flags(char *filename, int flags, int *nerr) {
+    int fd = -1;
+    sac *s = NULL;
+
+    *nerr = SAC_OK;
+    if(!filename) {
+        *nerr = ERROR_FILE_DOES_NOT_EXIST;
+        return NULL;
+    }
+    if((fd = open(filename, O_RDONLY)) < 0) {
+        *nerr = sac_errno_to_nerr(errno);
+        return NULL;
+    }
+    s = sac_header_read_fd(fd, filename, NULL, nerr);
+    close(fd);
+    if(!s && *nerr == ERROR_COMPRESSED_FILE) {
+        // Lazy reads of compressed files read the data now
+        return sac_read_compressed(filename, (flags & SAC_READ_LAZY), FALSE,
+                                   NULL, 0.0, NULL, 0.0, CutNone, flags, nerr);
+    }
+    if(!s) {
+        return NULL;
+    }
+    sac_read_post(s, flags);
+    return s;
 }
 
 
@@ -285,10 +501,201 @@ sac_read_header(char *filename, int *nerr) {
  * sac_write(s, "t/test_io_small.sac.tmp", &nerr);
  * assert_eq(nerr, 0);
  * @endcode
+ *
+ * Data and header are converted to the file's byte order in a separate
+ * buffer, the sac file being written is not modified
+ * @code
+ * int nerr = 0;
+ * sac *s = sac_read("t/test_io_big.sac", &nerr);
+ * assert_eq(nerr, 0);
+ * sac *c = sac_copy(s);
+ * sac_write(s, "t/test_io_big.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(memcmp(s->y, c->y, sizeof(float) * s->h->npts), 0);
+ * assert_eq(memcmp(s->h, c->h, sizeof(sac_hdr)), 0);
+ * sac_free(c);
+ * c = sac_read("t/test_io_big.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(c->m->swap, s->m->swap);
+ * assert_eq(memcmp(s->y, c->y, sizeof(float) * s->h->npts), 0);
+ * @endcode
  */
 void
 sac_write(sac *s, char *filename, int *nerr) {
-    sac_write_internal(s, filename, SAC_WRITE_HEADER_AND_DATA, s->m->swap, nerr);
+    sac_write_internal(s, filename, SAC_WRITE_HEADER_AND_DATA, s->m->swap, 0, nerr);
+}
+
+/**
+ * @brief      write a sac file to disk with options
+ *
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    write a sac file to disk as sac_write() with options
+ *
+ * @param      s          sac file to write to disk
+ * @param      filename   filename to write the sac file to
+ * @param      flags      write flags
+ *                        - SAC_WRITE_PREALLOCATE - preallocate the file with
+ *                          fallocate(), if available
+ *                        - SAC_WRITE_NO_DISTAZ - do not update dist, az, baz
+ *                          and gcarc
+ *                        - SAC_WRITE_NO_EXTREMA - do not update depmin,
+ *                          depmax and depmen from the data
+ *                        - SAC_WRITE_NO_PRECISION - do not check the
+ *                          precision of time values
+ *                        - SAC_WRITE_NO_UPDATE - all of the above updates,
+ *                          header values are written as they are
+ *                        - SAC_WRITE_DIRTY_EXTREMA - only update depmin,
+ *                          depmax and depmen if the data was marked changed
+ *                          since they were computed, see sac_mark_data_dirty()
+ *                        - SAC_WRITE_ATOMIC - write to a temporary file in
+ *                          the same directory and rename it over \p filename,
+ *                          so a crash never leaves a partially written file;
+ *                          the permissions and, where permitted, the owner of
+ *                          an existing \p filename are kept
+ *                        - SAC_WRITE_FSYNC - flush the file and its directory
+ *                          to disk before returning
+ *                        - SAC_WRITE_FSYNC_GROUP - as SAC_WRITE_FSYNC, with
+ *                          files flushed together by sac_write_many()
+ *                        - SAC_WRITE_PACK - store the data losslessly
+ *                          compressed in chunks with an index, read back
+ *                          transparently by sac_read() and sac_read_with_cut().
+ *                          Files read with packed data are written packed
+ *                          unless \p s->m->pack is cleared.  Packed files are
+ *                          not readable by other sac readers.
+ * @param      nerr       status code, 0 on success, non-zero on failure
+ *
+ * Writing updates the header of \p s unless SAC_WRITE_NO_UPDATE is set.
+ * To write the same sac file from several threads at once, use
+ * SAC_WRITE_NO_UPDATE and load the data first, see sac_data(); the write
+ * then only reads \p s.
+ *
+ * @code
+ * int nerr = 0;
+ * sac *s = sac_read("t/test_io_small.sac", &nerr);
+ * sac_write_with_flags(s, "t/test_io_atomic.sac.tmp", SAC_WRITE_ATOMIC | SAC_WRITE_FSYNC, &nerr);
+ * assert_eq(nerr, 0);
+ * sac *c = sac_read("t/test_io_atomic.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(memcmp(c->y, s->y, sizeof(float) * s->h->npts), 0);
+ *
+ * // Permissions of the file replaced are kept
+ * struct stat st;
+ * chmod("t/test_io_atomic.sac.tmp", 0640);
+ * sac_write_with_flags(s, "t/test_io_atomic.sac.tmp", SAC_WRITE_ATOMIC, &nerr);
+ * assert_eq(nerr, 0);
+ * stat("t/test_io_atomic.sac.tmp", &st);
+ * assert_eq(st.st_mode & 0777, 0640);
+ * @endcode
+ *
+ * Packed data is smaller and reads back exactly, cut reads only unpack the
+ * chunks covering the window
+ * @code
+ * int nerr = 0;
+ * sac *s = sac_new();
+ * sac_set_int(s, SAC_NPTS, 20000);
+ * sac_set_float(s, SAC_DELTA, 0.01);
+ * sac_set_float(s, SAC_B, 0.0);
+ * sac_alloc(s);
+ * for(int i = 0; i < 20000; i++) {
+ *     s->y[i] = floorf(1000.0f * sinf(0.01f * i));
+ * }
+ * s->y[100] = -0.0f;
+ * sac_write_with_flags(s, "t/test_io_pack.sac.tmp", SAC_WRITE_PACK, &nerr);
+ * assert_eq(nerr, 0);
+ * FILE *fp = fopen("t/test_io_pack.sac.tmp", "rb");
+ * fseek(fp, 0, SEEK_END);
+ * assert_eq(ftell(fp) < sac_size(s) / 2, 1);
+ * fclose(fp);
+ * sac *c = sac_read("t/test_io_pack.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(c->m->pack, 1);
+ * assert_eq(memcmp(c->y, s->y, sizeof(float) * 20000), 0);
+ * assert_eq(c->h->depmax, s->h->depmax);
+ * c = sac_read_with_cut("t/test_io_pack.sac.tmp", "B", 50.0, "B", 52.0, CutUseBE, &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(c->h->npts, 201);
+ * assert_eq(memcmp(c->y, s->y + 5000, sizeof(float) * 201), 0);
+ *
+ * // Lazy, memory mapped and caller buffer reads unpack the data
+ * c = sac_read_with_flags("t/test_io_pack.sac.tmp", SAC_READ_LAZY, &nerr);
+ * assert_eq(memcmp(sac_data(c, 0), s->y, sizeof(float) * 20000), 0);
+ * c = sac_read_mmap("t/test_io_pack.sac.tmp", &nerr);
+ * assert_eq(memcmp(c->y, s->y, sizeof(float) * 20000), 0);
+ * float *y = malloc(sizeof(float) * 20000);
+ * sac_read_into_float("t/test_io_pack.sac.tmp", y, 20000, &nerr);
+ * assert_eq(memcmp(y, s->y, sizeof(float) * 20000), 0);
+ * free(y);
+ *
+ * // Files in memory are unpacked, but can not be viewed in place
+ * fp = fopen("t/test_io_pack.sac.tmp", "rb");
+ * fseek(fp, 0, SEEK_END);
+ * size_t len = (size_t) ftell(fp);
+ * char *buf = malloc(len);
+ * rewind(fp);
+ * assert_eq(fread(buf, 1, len, fp), len);
+ * fclose(fp);
+ * c = sac_read_buffer(buf, len, 0, &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(memcmp(c->y, s->y, sizeof(float) * 20000), 0);
+ * assert_eq(c->h->depmax, s->h->depmax);
+ * c = sac_read_buffer(buf, len - 1, 0, &nerr);
+ * assert_eq(c, NULL);
+ * assert_eq(nerr, 114);
+ * c = sac_view_buffer(buf, len, 0, &nerr);
+ * assert_eq(c, NULL);
+ * assert_eq(nerr, 1363);
+ * free(buf);
+ *
+ * // Noise is stored raw, never larger than the values plus the index
+ * sac_set_int(s, SAC_NPTS, 100000);
+ * sac_alloc(s);
+ * srand(1);
+ * for(int i = 0; i < 100000; i++) {
+ *     s->y[i] = (float) rand() / RAND_MAX - 0.5f;
+ * }
+ * sac_write_with_flags(s, "t/test_io_pack.sac.tmp", SAC_WRITE_PACK, &nerr);
+ * assert_eq(nerr, 0);
+ * fp = fopen("t/test_io_pack.sac.tmp", "rb");
+ * fseek(fp, 0, SEEK_END);
+ * assert_eq(ftell(fp) <= sac_size(s) + 16 + 25 * 24, 1);
+ * fclose(fp);
+ * c = sac_read("t/test_io_pack.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(memcmp(c->y, s->y, sizeof(float) * 100000), 0);
+ * c = sac_read_with_cut("t/test_io_pack.sac.tmp", "B", 500.0, "B", 502.0, CutUseBE, &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(memcmp(c->y, s->y + 50000, sizeof(float) * 201), 0);
+ *
+ * // Two component, byteswapped and v7 files
+ * s = sac_read("t/test_uneven_small.sac", &nerr);
+ * s->h->nvhdr = 7;
+ * s->m->swap = !s->m->swap;
+ * sac_write_with_flags(s, "t/test_io_pack.sac.tmp", SAC_WRITE_PACK, &nerr);
+ * c = sac_read("t/test_io_pack.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(memcmp(c->x, s->x, sizeof(float) * s->h->npts), 0);
+ * assert_eq(memcmp(c->y, s->y, sizeof(float) * s->h->npts), 0);
+ * assert_eq(c->h->_b, s->h->_b);
+ * fp = fopen("t/test_io_pack.sac.tmp", "rb");
+ * fseek(fp, 0, SEEK_END);
+ * len = (size_t) ftell(fp);
+ * buf = malloc(len);
+ * rewind(fp);
+ * assert_eq(fread(buf, 1, len, fp), len);
+ * fclose(fp);
+ * c = sac_read_buffer(buf, len, 0, &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(memcmp(c->x, s->x, sizeof(float) * s->h->npts), 0);
+ * assert_eq(memcmp(c->y, s->y, sizeof(float) * s->h->npts), 0);
+ * assert_eq(c->h->_b, s->h->_b);
+ * free(buf);
+ * @endcode
+ */
+void
+sac_write_with_flags(sac *s, char *filename, int flags, int *nerr) {
+    sac_write_internal(s, filename, SAC_WRITE_HEADER_AND_DATA, s->m->swap, flags, nerr);
 }
 
 /**
@@ -332,7 +739,87 @@ sac_write(sac *s, char *filename, int *nerr) {
  */
 void
 sac_write_header(sac *s, char *filename, int *nerr) {
-    sac_write_internal(s, filename, SAC_WRITE_HEADER, s->m->swap, nerr);
+    sac_write_internal(s, filename, SAC_WRITE_HEADER, s->m->swap, 0, nerr);
+}
+
+/**
+ * @brief      Check if the system is little endian
+ * @private
+ */
+static int
+host_is_little_endian(void) {
+    uint16_t word = 0x0001;
+    return *((char *) &word) == 1;
+}
+
+/**
+ * @brief      Determine if data should be byteswapped to get a byte order
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @param      s      sac file
+ * @param      order  requested byte order
+ *
+ * @return     1 if data should be swapped, 0 otherwise
+ */
+static int
+sac_byte_order_swap(sac *s, enum ByteOrder order) {
+    switch(order) {
+    case ByteOrderNative: return FALSE;
+    case ByteOrderLittle: return ! host_is_little_endian();
+    case ByteOrderBig:    return host_is_little_endian();
+    case ByteOrderInput:  break;
+    }
+    return s->m->swap;
+}
+
+/**
+ * @brief      write a sac file to disk in a specific byte order
+ *
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    write a sac file to disk, header and data, in a requested
+ *             byte order.  sac_write() uses the byte order of the file as
+ *             it was read.  The sac file in memory is not modified by the
+ *             conversion
+ *
+ * @param      s         sac file to write to disk
+ * @param      filename  file to write to
+ * @param      order     byte order of the output file
+ *                       - ByteOrderInput - Byte order of the file as read
+ *                       - ByteOrderNative - System byte order
+ *                       - ByteOrderLittle - Little endian
+ *                       - ByteOrderBig - Big endian
+ * @param      nerr      status code, 0 on success, non-zero on error
+ *
+ * @code
+ * int nerr = 0;
+ * int little = (byte_order() == ENDIAN_LITTLE);
+ * sac *s = sac_read("t/test_io_small.sac", &nerr);
+ * assert_eq(nerr, 0);
+ *
+ * sac_write_byte_order(s, "t/test_io_order_big.sac.tmp", ByteOrderBig, &nerr);
+ * assert_eq(nerr, 0);
+ * sac *b = sac_read("t/test_io_order_big.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(b->m->swap, little);
+ * assert_eq(memcmp(s->y, b->y, sizeof(float) * s->h->npts), 0);
+ *
+ * sac_write_byte_order(b, "t/test_io_order_native.sac.tmp", ByteOrderNative, &nerr);
+ * assert_eq(nerr, 0);
+ * sac *n = sac_read("t/test_io_order_native.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(n->m->swap, 0);
+ * assert_eq(memcmp(s->y, n->y, sizeof(float) * s->h->npts), 0);
+ * @endcode
+ */
+void
+sac_write_byte_order(sac *s, char *filename, enum ByteOrder order, int *nerr) {
+    sac_write_internal(s, filename, SAC_WRITE_HEADER_AND_DATA,
+                       sac_byte_order_swap(s, order), 0, nerr);
 }
 
 /**
@@ -716,6 +1203,75 @@ sac_set_v6(sac *s) {
     s->h->nvhdr = SAC_HEADER_VERSION_6;
 }
 
+/**
+ * @brief      Set the error allowed when writing the data
+ *
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Data written after this call is packed, see SAC_WRITE_PACK,
+ *             with chunks quantized to 8, 16 or 24 bit integers, using a
+ *             scale and offset per chunk.  Each value read back differs from
+ *             the value written by at most \p error.  Chunks holding inf or
+ *             nan values, or whose range needs more than 24 bits, are packed
+ *             losslessly.  Intended for derived data, e.g. envelopes,
+ *             synthetics or stacks, where the error is tolerable.
+ *
+ * @param      s         sac file
+ * @param      error     largest error of a value, 0 to write data losslessly
+ * @param      relative  if \p error is relative to the largest absolute
+ *                       value of each data component, otherwise it is
+ *                       absolute
+ *
+ * @code
+ * int nerr = 0;
+ * sac *s = sac_new();
+ * sac_set_int(s, SAC_NPTS, 20000);
+ * sac_set_float(s, SAC_DELTA, 0.01);
+ * sac_set_float(s, SAC_B, 0.0);
+ * sac_alloc(s);
+ * for(int i = 0; i < 20000; i++) {
+ *     s->y[i] = 3.7f * sinf(0.01f * i) * expf(-0.0001f * i) + 0.001f * (i % 7);
+ * }
+ * // Values within 1% of the largest amplitude
+ * sac_set_quantize(s, 0.01, 1);
+ * sac_write(s, "t/test_io_quant.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ * FILE *fp = fopen("t/test_io_quant.sac.tmp", "rb");
+ * fseek(fp, 0, SEEK_END);
+ * assert_eq(ftell(fp) < sac_size(s) / 3, 1);
+ * fclose(fp);
+ * sac *c = sac_read("t/test_io_quant.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(c->m->pack, 1);
+ * for(int i = 0; i < 20000; i++) {
+ *     assert_eq(fabsf(c->y[i] - s->y[i]) <= 0.01 * 3.7, 1);
+ * }
+ * c = sac_read_with_cut("t/test_io_quant.sac.tmp", "B", 50.0, "B", 52.0, CutUseBE, &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(c->h->npts, 201);
+ * assert_eq(fabsf(c->y[0] - s->y[5000]) <= 0.01 * 3.7, 1);
+ *
+ * // Absolute errors, chunks are stored exactly when that is smaller
+ * for(int i = 0; i < 20000; i++) {
+ *     s->y[i] = (i < 8192) ? floorf(s->y[i]) : s->y[i] * 1000.0f;
+ * }
+ * sac_set_quantize(s, 0.5, 0);
+ * sac_write(s, "t/test_io_quant.sac.tmp", &nerr);
+ * c = sac_read("t/test_io_quant.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(memcmp(c->y, s->y, sizeof(float) * 8192), 0);
+ * for(int i = 8192; i < 20000; i++) {
+ *     assert_eq(fabsf(c->y[i] - s->y[i]) <= 0.5, 1);
+ * }
+ * @endcode
+ */
+void
+sac_set_quantize(sac *s, double error, int relative) {
+    s->m->quantize = (error > 0.0) ? error : 0.0;
+    s->m->quantize_relative = (relative) ? TRUE : FALSE;
+}
+
 /**
  * @brief      create a new sac file structure
  *
@@ -806,9 +1362,8 @@ sac_new() {
 void
 sac_free(sac * s) {
     if (s) {
+        sac_data_release(s);
         FREE(s->h);
-        FREE(s->x);
-        FREE(s->y);
         FREE(s->z);
         if (s->m) {
             FREE(s->m->filename);
@@ -819,6 +1374,40 @@ sac_free(sac * s) {
     }
 }
 
+/**
+ * @brief      release the data components of a sac structure
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    release the data components of a sac structure.  Data
+ *             allocated with sac_alloc() is freed, data backed by a
+ *             memory mapped file, see sac_read_mmap(), is unmapped
+ *
+ * @param      s   sac file to release the data from
+ *
+ */
+static void
+sac_data_release(sac *s) {
+    if(s->m && s->m->borrowed) {
+        s->m->borrowed = FALSE;
+        s->y = NULL;
+        s->x = NULL;
+        return;
+    }
+    if(s->m && s->m->map) {
+        munmap(s->m->map, s->m->map_size);
+        s->m->map = NULL;
+        s->m->map_size = 0;
+        s->y = NULL;
+        s->x = NULL;
+        return;
+    }
+    FREE(s->y);
+    FREE(s->x);
+}
+
 /**
  * @brief      allocate the sac data portion of a sac strucutre
  *
@@ -854,11 +1443,11 @@ sac_alloc(sac * s) {
     if (!s) {
         return;
     }
-    FREE(s->y);
-    FREE(s->x);
+    sac_data_release(s);
     if(s->h->npts <= 0) {
         return;
     }
+    s->m->data_dirty = TRUE;
     n = sizeof(float) * (size_t) s->h->npts;
     s->y = (float *) malloc(n);
     memset(s->y, 0, n);
@@ -1371,22 +1960,72 @@ update_distaz(sac * s) {
 #endif
 
 /**
- * @brief      copy the sac header
- *
- * @details    copy the sac header from \p from to \p to
+ * @brief      Collect the header values used and set by update_distaz()
  *
+ * @private
  * @ingroup    sac
  * @memberof   sac
  *
- * @param      to     destination
- * @param      from   source
+ * @param      s    sac file
+ * @param      key  output values: evla, evlo, stla, stlo, dist, az, baz,
+ *                  gcarc, lcalda and ibody
+ */
+static void
+sac_distaz_key(sac *s, double key[SAC_DISTAZ_KEY]) {
+    size_t i = 0;
+    int id[] = { SAC_EVLA, SAC_EVLO, SAC_STLA, SAC_STLO,
+                 SAC_DIST, SAC_AZ, SAC_BAZ, SAC_GCARC };
+    for(i = 0; i < sizeof(id) / sizeof(id[0]); i++) {
+        sac_get_float(s, id[i], &key[i]);
+    }
+    key[i++] = (double) s->h->lcalda;
+    key[i++] = (double) s->h->ibody;
+}
+
+/**
+ * @brief      Update the dist, az, gcarc, baz header fields if needed
  *
- * @code
- * sac *new = NULL;
- * int n_old = 0, n_new = 0;
- * int nerr = 0;
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
  *
- * // Read in an existing file
+ * @details    Call update_distaz() only if the event or station location,
+ *             the distance fields, lcalda or ibody changed since the last
+ *             call of this function.  Changes are detected by comparing
+ *             header values, so both the sac_set_* setters and direct
+ *             access to the header are covered
+ *
+ * @param      s  sac file to update
+ */
+static void
+sac_update_distaz(sac *s) {
+    double key[SAC_DISTAZ_KEY];
+    sac_distaz_key(s, key);
+    if(s->m->distaz_valid && memcmp(key, s->m->distaz, sizeof key) == 0) {
+        return;
+    }
+    update_distaz(s);
+    sac_distaz_key(s, s->m->distaz);
+    s->m->distaz_valid = TRUE;
+}
+
+/**
+ * @brief      copy the sac header
+ *
+ * @details    copy the sac header from \p from to \p to
+ *
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @param      to     destination
+ * @param      from   source
+ *
+ * @code
+ * sac *new = NULL;
+ * int n_old = 0, n_new = 0;
+ * int nerr = 0;
+ *
+ * // Read in an existing file
  * sac *old = sac_read("t/test_io_small.sac", &nerr);
  * assert_eq(nerr, 0);
  *
@@ -1452,6 +2091,13 @@ sac_meta_copy(sac *to, sac *from) {
     to->m->swap      = from->m->swap;
     to->m->filename  = strdup(from->m->filename);
     to->m->data_read = from->m->data_read;
+    to->m->flags     = from->m->flags;
+    to->m->data_dirty   = from->m->data_dirty;
+    to->m->distaz_valid = from->m->distaz_valid;
+    to->m->pack         = from->m->pack;
+    to->m->quantize     = from->m->quantize;
+    to->m->quantize_relative = from->m->quantize_relative;
+    memcpy(to->m->distaz, from->m->distaz, sizeof(to->m->distaz));
     to->m->nstop     = from->m->nstop;
     to->m->nstart    = from->m->nstart;
     to->m->nfillb    = from->m->nfillb;
@@ -1565,6 +2211,9 @@ sac_data_copy(sac *to, sac *from) {
 sac *
 sac_copy(sac *s) {
     sac *new;
+    if(!s->m->data_read) {
+        sac_data_load(s);
+    }
     new = sac_new();
     sac_header_copy(new, s);
     sac_meta_copy(new, s);
@@ -1788,45 +2437,176 @@ array_max(float *y, int n) {
     return v;
 }
 /**
- * @brief      Get the mean value in an array
+ * @brief      Running minimum, maximum and sum of data values
  *
- * @details    Get the mean value in an array
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
  *
- * @param      y   array
+ * @details    Accumulated over one or more blocks of data with
+ *             extrema_update() so data can be scanned while it is
+ *             still in cache, e.g. directly after it is read
+ */
+typedef struct extrema extrema;
+struct extrema {
+    float min;        /**< @brief minimum value, nan values are ignored */
+    float max;        /**< @brief maximum value, nan values are ignored */
+    double sum;       /**< @brief sum of all values */
+    size_t n;         /**< @brief number of values */
+    size_t nonfinite; /**< @brief number of inf or nan values */
+};
+
+/**
+ * @brief      Number of data samples processed per block
+ * @private
+ */
+#define SAC_DATA_BLOCK 16384
+
+/**
+ * @brief      Initialize a running extrema
+ * @private
+ */
+static void
+extrema_init(extrema *e) {
+    e->min = NAN;
+    e->max = NAN;
+    e->sum = 0.0;
+    e->n = 0;
+    e->nonfinite = 0;
+}
+
+/**
+ * @brief      Update a running extrema with a block of data
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @param      e   running extrema
+ * @param      y   data values
  * @param      n   length of \p y
  *
- * @return     mean value in array
+ */
+static void
+extrema_update(extrema *e, const float *y, size_t n) {
+    float vmin = e->min;
+    float vmax = e->max;
+    double sum = e->sum;
+    size_t bad = 0;
+    for(size_t i = 0; i < n; i++) {
+        float v = y[i];
+        vmin = fminf(vmin, v);
+        vmax = fmaxf(vmax, v);
+        sum += v;
+        bad += ! isfinite(v);
+    }
+    e->min = vmin;
+    e->max = vmax;
+    e->sum = sum;
+    e->n += n;
+    e->nonfinite += bad;
+}
+
+/**
+ * @brief      Set depmin, depmax and depmen from a running extrema
  *
  * @private
  * @ingroup    sac
  * @memberof   sac
+ *
+ * @param      s   sac file
+ * @param      e   running extrema
+ *
  */
+static void
+extrema_set(sac *s, extrema *e) {
+    s->h->depmin = e->min;
+    s->h->depmax = e->max;
+    s->h->depmen = (float) (e->sum / (double) e->n);
+    s->m->data_dirty = FALSE;
+    check_value(e->min, e->max, e->nonfinite);
+}
 
-static float
-array_mean(float *y, int n) {
-    int i = 0;
-    double v = 0.0;
-    for(i = 0; i < n; i++) {
-        v += y[i];
+/**
+ * @brief      Byteswap a data array and update a running extrema
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Each block of data is swapped and scanned for extrema before
+ *             moving to the next block, so the data is brought into cache
+ *             only once
+ *
+ * @param      y     data to be swapped in place
+ * @param      n     length of \p y
+ * @param      swap  if the data should be byteswapped
+ * @param      e     running extrema to update, may be NULL
+ *
+ */
+static void
+sac_data_swap_extrema(float *y, size_t n, int swap, extrema *e) {
+    size_t i = 0, k = 0;
+    for(i = 0; i < n; i += k) {
+        k = MIN(n - i, (size_t) SAC_DATA_BLOCK);
+        if(swap) {
+            sac_swap32(y + i, y + i, k);
+        }
+        if(e) {
+            extrema_update(e, y + i, k);
+        }
+    }
+}
+
+/**
+ * @brief      Read, byteswap and scan a data array in a single pass
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Data is read in blocks, each block is swapped and scanned
+ *             for extrema while it is still in cache
+ *
+ * @param      fp    file pointer to read data from
+ * @param      y     output data array
+ * @param      n     number of values to read
+ * @param      swap  if the data should be byteswapped
+ * @param      e     running extrema to update, may be NULL
+ *
+ * @return     0 on success, ERROR_READING_FILE on read error
+ */
+static int
+sac_data_read_fused(FILE *fp, float *y, size_t n, int swap, extrema *e) {
+    size_t i = 0, k = 0;
+    for(i = 0; i < n; i += k) {
+        k = MIN(n - i, (size_t) SAC_DATA_BLOCK);
+        if(fread(y + i, sizeof(float), k, fp) != k) {
+            return ERROR_READING_FILE;
+        }
+        sac_data_swap_extrema(y + i, k, swap, e);
     }
-    return (float) (v / n);
+    return SAC_OK;
 }
 
 /**
  * @brief      check if min and max values are valid floating point numbers
  *
  * @details    check if min and max values are valid floating point numbers
+ *             and if any data values were not finite
  *
- * @param      vmin    miniumum value
- * @param      vmax    maxiumum value
+ * @param      vmin       miniumum value
+ * @param      vmax       maxiumum value
+ * @param      nonfinite  number of inf or nan data values
  *
  * @private
  * @ingroup    sac
  * @memberof   sac
  */
 static void
-check_value(float vmin, float vmax) {
-    if(! isfinite(vmin) || ! isfinite(vmax) || vmin < -3.40282e38 || vmax > 3.40282e38) {
+check_value(float vmin, float vmax, size_t nonfinite) {
+    if(nonfinite > 0 ||
+       ! isfinite(vmin) || ! isfinite(vmax) || vmin < -3.40282e38 || vmax > 3.40282e38) {
         printf(" WARNING: Data value outside system storage bounds\n");
         printf(" Maxvalue = %.5g ", vmax);
         printf(" Minvalue = %.5g\n", vmin);
@@ -1877,10 +2657,73 @@ check_value(float vmin, float vmax) {
  */
 void
 sac_extrema(sac * s) {
-    s->h->depmin = array_min(s->y, s->h->npts);
-    s->h->depmax = array_max(s->y, s->h->npts);
-    s->h->depmen = array_mean(s->y, s->h->npts);
-    check_value(s->h->depmin, s->h->depmax);
+    extrema e;
+    if(!s->m->data_read && sac_data_load(s) != SAC_OK) {
+        return;
+    }
+    // Header only reads have no data to scan
+    if(!s->y) {
+        return;
+    }
+    extrema_init(&e);
+    extrema_update(&e, s->y, (size_t) s->h->npts);
+    extrema_set(s, &e);
+}
+
+/**
+ * @brief      Mark the data as changed
+ *
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Mark the data as changed so depmin, depmax and depmen are
+ *             recomputed when the file is written with
+ *             SAC_WRITE_DIRTY_EXTREMA.  Writes always rescan the data
+ *             unless that flag is set; with it, the data is only rescanned
+ *             if it was changed since it was read or since the last call
+ *             to sac_extrema().  Callers setting the flag must mark data
+ *             changed through s->y, s->x or sac_data() with this function.
+ *
+ * @param      s   sac file
+ *
+ * @code
+ * int nerr = 0;
+ * sac *s = sac_read("t/test_io_big.sac", &nerr);
+ * float depmax = s->h->depmax;
+ * double gcarc = 0.0;
+ *
+ * // Writes rescan the data by default
+ * s->y[0] = depmax + 1.0;
+ * sac_write(s, "t/test_io_dirty.sac.tmp", &nerr);
+ * assert_eq(s->h->depmax, depmax + 1.0);
+ *
+ * // Header only changes do not rescan marked data
+ * sac_set_string(s, SAC_STA, "ABCD");
+ * s->y[0] = depmax + 2.0;
+ * sac_write_with_flags(s, "t/test_io_dirty.sac.tmp", SAC_WRITE_DIRTY_EXTREMA, &nerr);
+ * assert_eq(s->h->depmax, depmax + 1.0);
+ *
+ * sac_mark_data_dirty(s);
+ * sac_write_with_flags(s, "t/test_io_dirty.sac.tmp", SAC_WRITE_DIRTY_EXTREMA, &nerr);
+ * assert_eq(s->h->depmax, depmax + 2.0);
+ *
+ * // Location changes, from setters or directly, update the distance
+ * sac_set_float(s, SAC_EVLA, 0.0);
+ * sac_set_float(s, SAC_EVLO, 0.0);
+ * sac_set_float(s, SAC_STLA, 0.0);
+ * sac_set_float(s, SAC_STLO, 10.0);
+ * sac_write(s, "t/test_io_dirty.sac.tmp", &nerr);
+ * sac_get_float(s, SAC_GCARC, &gcarc);
+ * assert(fabs(gcarc - 10.0336) < 1e-3);
+ * s->h->_stlo = 20.0;
+ * sac_write(s, "t/test_io_dirty.sac.tmp", &nerr);
+ * sac_get_float(s, SAC_GCARC, &gcarc);
+ * assert(fabs(gcarc - 20.0) < 0.1);
+ * @endcode
+ */
+void
+sac_mark_data_dirty(sac *s) {
+    s->m->data_dirty = TRUE;
 }
 
 /**
@@ -2105,1005 +2948,5971 @@ byteswap_bsd(void *v, size_t n) {
 }
 
 /**
- * @brief Swap the Sac Header
- *
- * @details Swap all floating point and integer values of the sac header
- *
+ * @brief      byteswap a 32-bit word
  * @private
- * @memberof sac
- * @ingroup  sac
- *
- * @param hdr    Sac Header to Swap, packed
- *
- * @date July 01, 2007 Initial Version -- B. Savage
- *
  */
-void
-sac_header_swap(void *hdr) {
-    int i;
-    float *ptr;
-    for (i = 0, ptr = hdr; i < SAC_HEADER_NUMBERS; i++, ptr++) {
-        byteswap_bsd(ptr, SAC_HEADER_SIZEOF_NUMBER);
-    }
-}
+#if defined(__GNUC__)
+#define SAC_BSWAP32(x) __builtin_bswap32(x)
+#define SAC_BSWAP64(x) __builtin_bswap64(x)
+#else
+#define SAC_BSWAP32(x) ( (((x) & 0x000000ffU) << 24) | (((x) & 0x0000ff00U) <<  8) | \
+                         (((x) & 0x00ff0000U) >>  8) | (((x) & 0xff000000U) >> 24) )
+#define SAC_BSWAP64(x) ( ((uint64_t) SAC_BSWAP32((uint32_t) (x)) << 32) |     \
+                         (uint64_t) SAC_BSWAP32((uint32_t) ((x) >> 32)) )
+#endif
 
 /**
- * @brief      Swap an array of data in place
- *
- * @details    Swap an array of data in place,
- *             typically the data component of a sac file
- *
+ * @brief      byteswap kernel, swap \p n words from \p src into \p dst
  * @private
- * @memberof sac
- * @ingroup  sac
- *
- * @param      y   array to to be swapped in place
- * @param      n   length of \p y
- *
  */
-void
-sac_data_swap(float *y, int n) {
-    int i;
-    float *ptr;
-    for (i = 0, ptr = y; i < n; i++, ptr++) {
-        byteswap_bsd((void *) ptr, SAC_HEADER_SIZEOF_NUMBER);
-    }
-}
+typedef void (*swap_kernel)(void *dst, const void *src, size_t n);
 
 /**
- * @brief      Copy strings from a sac file to a sac structure in memory
+ * @brief      byteswap 32-bit words, portable version
  *
  * @private
  * @ingroup    sac
  * @memberof   sac
  *
- * @details    Copy character string from a sac file to a sac structure
- *             in memory, appending C-termination characters at the end
- *             This is the inverse of sac_copy_strings_strip_terminator().
- *             Input \p src data is assumed to be concatenated unterminated
- *             character strings as exists for a sac file saved to disk
- *
+ * @details    byteswap \p n 32-bit words from \p src into \p dst.  Buffers
+ *             may be unaligned and \p dst may equal \p src for an in place swap
  *
- * @param      s     Where to place the character strings with terminators
- * @param      src   Packed Input character strings without terminators
+ * @param      dst   output words
+ * @param      src   input words
+ * @param      n     number of words
  *
  */
-void
-sac_copy_strings_add_terminator(sac *s, char *src) {
-    int i = 0;
-    void *p = src;
-    for(i = SAC_STA; i <= SAC_INST; i++) {
-        if(i == SAC_EVENT2) {
-            continue;
-        }
-        char *dst = khdr(s, i-SAC_STA+1);
-        size_t n = (i == SAC_EVENT) ? 16 : 8;
-        memcpy(dst, p, n);
-        dst[n] = 0;
-        p += n;
+static void
+swap32_scalar(void *dst, const void *src, size_t n) {
+    uint32_t v = 0;
+    char *out = dst;
+    const char *in = src;
+    for(size_t i = 0; i < n; i++) {
+        memcpy(&v, in + 4 * i, 4);
+        v = SAC_BSWAP32(v);
+        memcpy(out + 4 * i, &v, 4);
     }
 }
 
 /**
- * @brief      Copy strings from a sac file to a packed string
+ * @brief      byteswap 64-bit words, portable version
  *
  * @private
  * @ingroup    sac
  * @memberof   sac
  *
- * @details    Copy character strings from a sac structure in memory
- *             to a concatenated character string as would exist in a sac
- *             file on disk.  Terminators are removed and strings are appended
- *             in order as they appear on disk.  This is the inverse operation
- *             of sac_copy_strings_add_terminator().  Order is important.
+ * @details    byteswap \p n 64-bit words from \p src into \p dst.  Buffers
+ *             may be unaligned and \p dst may equal \p src for an in place swap
  *
- * @param      s     sac file to take strings from
- * @param      dst   concatenated character string to place unterminated
- *                   character string into.  
+ * @param      dst   output words
+ * @param      src   input words
+ * @param      n     number of words
  *
  */
-void
-sac_copy_strings_strip_terminator(sac *s, char *dst) {
-    int i = 0;
-    void *p = dst;
-    for(i = SAC_STA; i <= SAC_INST; i++) {
-        if(i == SAC_EVENT2) {
-            continue;
-        }
-        size_t n = (i == SAC_EVENT) ? 16 : 8;
-        memcpy(p, khdr(s, i-SAC_STA+1), n);
-        p += n;
+static void
+swap64_scalar(void *dst, const void *src, size_t n) {
+    uint64_t v = 0;
+    char *out = dst;
+    const char *in = src;
+    for(size_t i = 0; i < n; i++) {
+        memcpy(&v, in + 8 * i, 8);
+        v = SAC_BSWAP64(v);
+        memcpy(out + 8 * i, &v, 8);
     }
 }
 
+#ifdef SAC_SWAP_X86
 /**
- * @brief Write a Sac Header
+ * @brief      byteswap 32-bit words, SSE2 version
  *
  * @private
  * @ingroup    sac
  * @memberof   sac
  *
- * @param sac   - Sac file structure
- * @param nerr  - File pointer in which to write header to
- *
- * @return 0 on success, Non-zero on error
- *     - ERROR_WRITING_FILE (115)
+ * @details    SSE2 has no byte shuffle, bytes are swapped within 16-bit
+ *             lanes and the lanes are then exchanged.  See swap32_scalar()
  *
- * @date March 12, 2020
  */
-int
-sac_header_write(sac *s, FILE *fp) {
-    char dst[SAC_HEADER_STRINGS * 8];
-    size_t n = SAC_HEADER_NUMBERS;
+__attribute__((target("sse2")))
+static void
+swap32_sse2(void *dst, const void *src, size_t n) {
+    size_t i = 0;
+    char *out = dst;
+    const char *in = src;
+    for(i = 0; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *) (in + 4 * i));
+        v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2,3,0,1));
+        v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2,3,0,1));
+        _mm_storeu_si128((__m128i *) (out + 4 * i), v);
+    }
+    swap32_scalar(out + 4 * i, in + 4 * i, n - i);
+}
 
-    if (s->m->swap) {
-        sac_header_swap((void *) s->h);
-    }
+/**
+ * @brief      byteswap 64-bit words, SSE2 version, see swap32_sse2()
+ * @private
+ */
+__attribute__((target("sse2")))
+static void
+swap64_sse2(void *dst, const void *src, size_t n) {
+    size_t i = 0;
+    char *out = dst;
+    const char *in = src;
+    for(i = 0; i + 2 <= n; i += 2) {
+        __m128i v = _mm_loadu_si128((const __m128i *) (in + 8 * i));
+        v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0,1,2,3));
+        v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0,1,2,3));
+        _mm_storeu_si128((__m128i *) (out + 8 * i), v);
+    }
+    swap64_scalar(out + 8 * i, in + 8 * i, n - i);
+}
 
-    if(fwrite((char *) s->h, sizeof(float), n, fp) != n) {
-        return ERROR_WRITING_FILE;
-    }
+/**
+ * @brief      byteswap 32-bit words, AVX2 version, see swap32_scalar()
+ * @private
+ */
+__attribute__((target("avx2")))
+static void
+swap32_avx2(void *dst, const void *src, size_t n) {
+    size_t i = 0;
+    char *out = dst;
+    const char *in = src;
+    const __m256i mask = _mm256_setr_epi8( 3, 2, 1, 0,  7, 6, 5, 4,
+                                          11,10, 9, 8, 15,14,13,12,
+                                           3, 2, 1, 0,  7, 6, 5, 4,
+                                          11,10, 9, 8, 15,14,13,12);
+    for(i = 0; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i *) (in + 4 * i));
+        _mm256_storeu_si256((__m256i *) (out + 4 * i), _mm256_shuffle_epi8(v, mask));
+    }
+    swap32_scalar(out + 4 * i, in + 4 * i, n - i);
+}
 
-    if (s->m->swap) {
-        sac_header_swap((void *) s->h);
-    }
+/**
+ * @brief      byteswap 64-bit words, AVX2 version, see swap64_scalar()
+ * @private
+ */
+__attribute__((target("avx2")))
+static void
+swap64_avx2(void *dst, const void *src, size_t n) {
+    size_t i = 0;
+    char *out = dst;
+    const char *in = src;
+    const __m256i mask = _mm256_setr_epi8( 7, 6, 5, 4, 3, 2, 1, 0,
+                                          15,14,13,12,11,10, 9, 8,
+                                           7, 6, 5, 4, 3, 2, 1, 0,
+                                          15,14,13,12,11,10, 9, 8);
+    for(i = 0; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i *) (in + 8 * i));
+        _mm256_storeu_si256((__m256i *) (out + 8 * i), _mm256_shuffle_epi8(v, mask));
+    }
+    swap64_scalar(out + 8 * i, in + 8 * i, n - i);
+}
+#endif /* SAC_SWAP_X86 */
 
-    sac_copy_strings_strip_terminator(s, dst);
-    if(fwrite(dst, 8, SAC_HEADER_STRINGS, fp) != SAC_HEADER_STRINGS) {
-        return ERROR_WRITING_FILE;
-    }
+static _Atomic(swap_kernel) swap32_kernel = NULL; /**< @private Selected 32-bit byteswap kernel */
+static _Atomic(swap_kernel) swap64_kernel = NULL; /**< @private Selected 64-bit byteswap kernel */
 
-    return SAC_OK;
+/**
+ * @brief      select the byteswap kernels
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    select the byteswap kernels for the running processor, so a
+ *             single library works on every host.  Kernels are selected on
+ *             first use.  Threads racing on first use select the same
+ *             kernels; the kernel pointers are atomic, so the race is benign.
+ *
+ */
+static void
+swap_kernel_select(void) {
+    swap_kernel k32 = swap32_scalar;
+    swap_kernel k64 = swap64_scalar;
+#ifdef SAC_SWAP_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")) {
+        k32 = swap32_avx2;
+        k64 = swap64_avx2;
+    } else if(__builtin_cpu_supports("sse2")) {
+        k32 = swap32_sse2;
+        k64 = swap64_sse2;
+    }
+#endif /* SAC_SWAP_X86 */
+    atomic_store_explicit(&swap64_kernel, k64, memory_order_release);
+    atomic_store_explicit(&swap32_kernel, k32, memory_order_release);
 }
 
-
 /**
- * @brief      Write data components to a file descriptor
+ * @brief      byteswap 32-bit words
  *
  * @private
  * @ingroup    sac
  * @memberof   sac
  *
- * @param      s    sac file structure to write to
- * @param      fp   file descriptor to write to
+ * @details    byteswap \p n 32-bit words from \p src into \p dst using the
+ *             fastest kernel available. \p dst may equal \p src
  *
- * @return     status code, 0 on success, non-zero on failure
+ * @param      dst   output words
+ * @param      src   input words
+ * @param      n     number of words
  *
  */
-int
-sac_data_write(sac *s, FILE *fp) {
-    size_t n = s->h->npts;
-    for(int i = 0; i < sac_comps(s); i++) {
-        float *p = (i == 0) ? s->y : s->x;
-        if (s->m->swap) {
-            sac_data_swap(p, s->h->npts);
-        }
-        if(fwrite(p, sizeof(float), n, fp) != n) {
-            return ERROR_WRITING_FILE;
-        }
-        if (s->m->swap) {
-            sac_data_swap(p, s->h->npts);
-        }
+static void
+sac_swap32(void *dst, const void *src, size_t n) {
+    swap_kernel k = atomic_load_explicit(&swap32_kernel, memory_order_acquire);
+    if(!k) {
+        swap_kernel_select();
+        k = atomic_load_explicit(&swap32_kernel, memory_order_acquire);
     }
-    return SAC_OK;
+    k(dst, src, n);
 }
 
-static int v7_keys[] = {
-#define X(name,key) SAC_##name ,
-    SAC_F64
-#undef X
-};
-static size_t v7_keys_length = sizeof(v7_keys) / sizeof(int);
 /**
- * @brief Write the sac header version 7
+ * @brief      byteswap 64-bit words
  *
  * @private
  * @ingroup    sac
  * @memberof   sac
  *
- * @details Write the sac header version 7 to the end of a file.
- *          file pointer must be positioned at the end of the data
- *          section for write to be done properly
- *
- * @param s     - sac file structure to write out
- * @param fp    - File descriptor to write to
- *
- * @return nerr  - Error reporting value
- *
- * V7 of the header is a additional set of data at the end of the file
- * following the data.  This routine only write the this "footer" of
- * metadata, the v6 header I/O routines are still required
- *
- * @code
- * int nerr = 0;
- * sac *s = NULL;
- * int host = byte_order();
- * int little = !(host == ENDIAN_LITTLE);
- * int big    = !(host == ENDIAN_BIG);
- *
- * s = sac_read("t/test_io_small.sac", &nerr);
- * assert_eq(nerr, 0);
- * assert_eq(s->m->swap, little);
- *
- * sac_set_v7(s);
- * sac_write(s, "t/test_io_small_v7.sac.tmp", &nerr);
- * assert_eq(nerr, 0);
- *
- * s = sac_read("t/test_io_big.sac", &nerr);
- * assert_eq(nerr, 0);
- * assert_eq(s->m->swap, big);
- *
- * sac_set_v7(s);
- * sac_write(s, "t/test_io_big_v7.sac.tmp", &nerr);
- * assert_eq(nerr, 0);
- *
- * s = sac_read("t/test_io_big_v7.sac.tmp", &nerr);
- * assert_eq(nerr, 0);
- * assert_eq(s->m->swap, big);
- * assert_eq(s->h->nvhdr, 7);
- *
- * FILE *fp = NULL;
- * double v = 0.0;
- * fprintf(stderr, "Checking raw data file\n");
- * fp = fopen("t/test_io_big_v7.sac.tmp", "r");
- * assert_ne(fp, NULL);
- * fseek(fp, -8, SEEK_END);
- * v = 0.0;
- * assert_eq(fread(&v, sizeof(double), 1, fp), 1);
- * if(s->m->swap) {
- *    assert_ne(v, -12345.0);
- *    swap_double((void *) &v);
- * }
- * assert_eq(v, -12345.0);
- * fclose(fp);
- *
- * s = sac_read("t/test_io_small_v7.sac.tmp", &nerr);
- * assert_eq(nerr, 0);
- * assert_eq(s->m->swap, little);
- * assert_eq(s->h->nvhdr, 7);
+ * @details    byteswap \p n 64-bit words from \p src into \p dst using the
+ *             fastest kernel available. \p dst may equal \p src
  *
- * fprintf(stderr, "Checking raw data file\n");
- * fp = fopen("t/test_io_small_v7.sac.tmp", "r");
- * assert_ne(fp, NULL);
- * fseek(fp, -8, SEEK_END);
- * v = 0.0;
- * assert_eq(fread(&v, sizeof(double), 1, fp), 1);
- * if(s->m->swap) {
- *    assert_ne(v, -12345.0);
- *    swap_double((void *) &v);
- * }
- * assert_eq(v, -12345.0);
- * fclose(fp);
+ * @param      dst   output words
+ * @param      src   input words
+ * @param      n     number of words
  *
- * @endcode
  */
-int
-sac_header_write_v7(sac *s, FILE *fp) {
-    double buffer[v7_keys_length];
-    for(size_t i = 0; i < v7_keys_length; i++) {
-        sac_get_f64(s, v7_keys[i], &buffer[i]);
-        if(s->m->swap) {
-            byteswap_bsd((void *) &buffer[i], sizeof(double));
-        }
-    }
-    if(fwrite(buffer, sizeof(buffer), 1, fp) != 1) {
-        return ERROR_WRITING_FILE;
+static void
+sac_swap64(void *dst, const void *src, size_t n) {
+    swap_kernel k = atomic_load_explicit(&swap64_kernel, memory_order_acquire);
+    if(!k) {
+        swap_kernel_select();
+        k = atomic_load_explicit(&swap64_kernel, memory_order_acquire);
     }
-    return SAC_OK;
+    k(dst, src, n);
 }
 
 /**
- * @brief     Read the sac header version 7
- *
- * @details   V7 of the header is a additional set of data at the end of the file
- *            following the data.  This routine only reads the this "footer" of
- *            metadata, the v6 header I/O routines are still required
- *
- *            Function places the file pointer at the beginning of the v7 header,
- *            completes the read and then places the file pointer at its previous
- *            position.  It is safe to call before reading data components.
- *
- * @ingroup    sac
- * @memberof   sac
+ * @brief      Map float bits to unsigned integers in the order of the floats
  * @private
- *
- * @param  fp    File Pointer to open sac file for reading
- * @param  s     sac file structure to fill
- * @param  nerr  Error reporting value
- *
  */
-void
-sac_header_read_v7(FILE *fp, sac *s, int *nerr) {
-    size_t i = 0;
-    long offset = 0;
-    size_t n = 0;
-    double buffer[v7_keys_length];
-    *nerr = SAC_OK;
+#define SAC_PACK_ORDER(u)   (((u) & 0x80000000U) ? ~(u) : ((u) | 0x80000000U))
+/**
+ * @brief      Map unsigned integers back to float bits, see SAC_PACK_ORDER()
+ * @private
+ */
+#define SAC_PACK_UNORDER(u) (((u) & 0x80000000U) ? ((u) & 0x7fffffffU) : ~(u))
 
-    offset = ftell(fp);
-    fseek(fp, -1 * (int)(sizeof(double) * v7_keys_length), SEEK_END);
+/**
+ * @brief      Convert a little endian 32 or 64-bit word to the system's byte order
+ * @private
+ */
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define SAC_LE32(x) SAC_BSWAP32(x)
+#define SAC_LE64(x) SAC_BSWAP64(x)
+#else
+#define SAC_LE32(x) (x)
+#define SAC_LE64(x) (x)
+#endif
 
-    n = fread(buffer, sizeof(double), v7_keys_length, fp);
-    if(n != v7_keys_length) {
-        *nerr = ERROR_READING_FILE;
-        return;
-    }
-    for(i = 0; i < v7_keys_length; i++) {
-        if(s->m->swap) {
-            byteswap_bsd((void *) &buffer[i], sizeof(double));
-        }
-        sac_set_f64(s, v7_keys[i], buffer[i]);
+/**
+ * @brief      Largest encoded size of a chunk of \p n samples
+ * @private
+ */
+#define SAC_PACK_CHUNK_MAX(n) (1 + (((n) + SAC_PACK_GROUP - 1) / SAC_PACK_GROUP) * (1 + SAC_PACK_GROUP * 4))
+/**
+ * @brief      Largest size of a quantized chunk of \p n samples, at most SAC_PACK_CHUNK_MAX(n)
+ * @private
+ */
+#define SAC_PACK_QUANT_MAX(n) (SAC_PACK_QUANT_HEADER + 3 * (n))
+
+/**
+ * @brief      Mapping of values to integers in a chunk of packed data
+ * @private
+ */
+enum {
+    SAC_PACK_FLOAT = 0, /**< @private float bits, in float order */
+    SAC_PACK_INT   = 1, /**< @private integer values */
+    SAC_PACK_QUANT = 2, /**< @private values quantized to a bounded error, see sac_pack_quantize() */
+};
+
+typedef struct sac_pack_hdr sac_pack_hdr;
+/**
+ * @brief      start of packed data, stored in the byte order of the file
+ * @private
+ */
+struct sac_pack_hdr {
+    uint32_t chunk;   /**< @private samples per chunk */
+    uint32_t nchunk;  /**< @private chunks per data component */
+    uint64_t bytes;   /**< @private size of the packed data, this header included */
+};
+
+typedef struct sac_pack_entry sac_pack_entry;
+/**
+ * @brief      index entry of a packed chunk, stored in the byte order of the file
+ * @private
+ */
+struct sac_pack_entry {
+    uint64_t off;     /**< @private offset of the chunk from the start of the packed data */
+    uint32_t len;     /**< @private encoded size of the chunk in bytes */
+    uint32_t n;       /**< @private samples in the chunk */
+    float min;        /**< @private minimum value in the chunk */
+    float max;        /**< @private maximum value in the chunk */
+};
+
+/**
+ * @brief      byteswap packed index entries in place
+ * @private
+ */
+static void
+sac_pack_entry_swap(sac_pack_entry *p, size_t n) {
+    size_t i = 0;
+    for(i = 0; i < n; i++) {
+        sac_swap64(&p[i].off, &p[i].off, 1);
+        sac_swap32(&p[i].len, &p[i].len, 4);
     }
-    fseek(fp, offset, SEEK_SET);
 }
 
 /**
- * @brief      Fill the v7 header
- *
- * @details    Fill the v7 header through either reading the v7 header
- *             or copying v6 header values to the v7 header.  Reading of
- *             the v7 header will only occur if the header version equals 7.
+ * @brief      Check and clear the marker of packed data
  *
+ * @private
  * @ingroup    sac
  * @memberof   sac
- * @private
  *
- * @param      s      sac file
- * @param      fp     file begin read from
- * @param      nerr   0 on success, non-zero on error
+ * @details    Files written with SAC_WRITE_PACK carry SAC_PACK_MAGIC in
+ *             the unused24 header word.  The marker is removed from the
+ *             header and recorded in the meta data.
  *
- * @return     return type
+ * @param      s     sac file with the header just read
  */
-void
-sac_header_v7_fill(sac *s, FILE *fp, int *nerr) {
-    switch(s->h->nvhdr) {
-    case SAC_HEADER_VERSION_7:
-        sac_header_read_v7(fp, s, nerr);
-        sac_copy_f64_to_f32(s);
-        break;
-    case SAC_HEADER_VERSION_6:
-        sac_copy_f32_to_f64(s);
-        break;
+static void
+sac_header_pack(sac *s) {
+    s->m->pack = (s->h->unused24 == SAC_PACK_MAGIC);
+    if(s->m->pack) {
+        s->h->unused24 = SAC_INT_UNDEFINED;
     }
+}
 
+/**
+ * @brief      Mark an encoded header as followed by packed data
+ *
+ * @private
+ * @ingroup    sac
+ *
+ * @param      hdr   header as stored on disk, see sac_header_encode()
+ * @param      swap  if the header is byteswapped
+ */
+static void
+sac_header_pack_mark(char *hdr, int swap) {
+    int32_t magic = SAC_PACK_MAGIC;
+    if(swap) {
+        byteswap_bsd(&magic, sizeof magic);
+    }
+    memcpy(hdr + offsetof(sac_hdr, unused24), &magic, sizeof magic);
 }
 
 /**
- * @brief      internal sac data writing function
+ * @brief      Check if a chunk of data holds only integer values
  *
  * @private
  * @ingroup    sac
- * @memberof   sac
  *
- * @details    internal sac data writing function.
- *             - Checks the number of points
- *             - checks if the overwrite flag is "ok"
- *             - updates the extra values (depmin, depmax, depmen)
- *             - updates the distance fields (dist, az, baz, gcarc)
- *             - checks and reports any time precison issues
- *             - create a new file if writing data or update the header of
- *               and existing file
- *             - write the header
- *             - write the data
+ * @details    Values must be exactly representable as 32-bit integers,
+ *             negative zero is not, as its sign would be lost
  *
- * @param      s           sac file to write
- * @param      filename    filename to write to
- * @param      write_data  whether to write data or just the header
- * @param      swap        whether to swap the data and header before writing
- * @param      nerr        status code, 0 on success, non-zero on failure
+ * @param      y     data
+ * @param      n     number of values in \p y
  *
+ * @return     1 if all values are integers, 0 otherwise
  */
-void
-sac_write_internal(sac *s, char *filename, int write_data, int swap, int *nerr) {
-    sac *old = NULL;
-    FILE *fp = NULL;
-
-    UNUSED(swap);
-
-    if(write_data && ((*nerr = sac_check_npts(s->h->npts)) != SAC_OK)) {
-        return;
-    }
-    if((*nerr = sac_check_lovrok(s->h->lovrok)) != SAC_OK) {
-        return;
-    }
-    if(write_data) {
-        sac_extrema(s);
-    }
-    update_distaz(s);
-
-    sac_check_time_precision(s);
-
-    if(!write_data) {
-        if(!(old = sac_read_header(filename, nerr))) {
-            return;
-        }
+static int
+sac_pack_integer(const float *y, size_t n) {
+    size_t i = 0;
+    int ok = 1;
+    for(i = 0; i < n; i++) {
+        ok &= (y[i] >= -2147483648.0f && y[i] < 2147483648.0f &&
+               y[i] == (float) (int32_t) y[i] && !(y[i] == 0.0f && signbit(y[i])));
     }
+    return ok;
+}
 
-    
-    if(write_data) {
-        fp = fopen(filename, "w"); // Truncate or create
-    } else {
-        fp = fopen(filename, "r+"); // Open for reading and writing
-        swap = s->m->swap;
-    }
-    if(! fp) {
-        if(!write_data) {
-            *nerr = ERROR_FILE_DOES_NOT_EXIST;
+/**
+ * @brief      Encode a chunk of data
+ *
+ * @private
+ * @ingroup    sac
+ *
+ * @details    Chunks begin with a byte giving the mapping of values to
+ *             integers.  Chunks holding only integer values, e.g. counts,
+ *             are mapped to those integers, SAC_PACK_INT, other chunks map
+ *             the bits of each float to an integer in float order,
+ *             SAC_PACK_FLOAT.  Each integer is predicted by the previous
+ *             one, starting from 0 in every chunk.  Prediction residuals are
+ *             zigzag coded and bit packed in groups of SAC_PACK_GROUP
+ *             values, each group preceeded by a byte holding its bit width.
+ *             The last group is padded with zeros.  Every float, including
+ *             NaN and infinities, is stored exactly.  Loops over groups have
+ *             a fixed trip count and no branches, so compilers can vectorize
+ *             them.
+ *
+ *             Chunks that do not shrink, e.g. of noise, are stored raw
+ *             instead, as \p n little endian floats without a mapping byte.
+ *             Raw chunks are recognised by their size, exactly 4 \p n
+ *             bytes, which other encodings never use, so packed data is at
+ *             most the size of the values plus the header and index.
+ *
+ * @param      y     data to encode
+ * @param      n     number of values in \p y
+ * @param      out   output, at least SAC_PACK_CHUNK_MAX(n) bytes
+ *
+ * @return     number of bytes written to \p out, 4 \p n for a raw chunk
+ */
+static size_t
+sac_pack_encode(const float *y, size_t n, unsigned char *out) {
+    size_t i = 0, j = 0, k = 0, len = 0;
+    uint32_t prev = 0, d = 0, all = 0;
+    uint32_t u[SAC_PACK_GROUP], z[SAC_PACK_GROUP];
+    uint64_t acc = 0;
+    int w = 0, nbits = 0;
+    int mode = sac_pack_integer(y, n) ? SAC_PACK_INT : SAC_PACK_FLOAT;
+
+    out[len++] = (unsigned char) mode;
+    for(i = 0; i < n; i += SAC_PACK_GROUP) {
+        k = MIN(n - i, (size_t) SAC_PACK_GROUP);
+        if(mode == SAC_PACK_INT) {
+            for(j = 0; j < SAC_PACK_GROUP; j++) {
+                u[j] = (uint32_t) (int32_t) y[i + MIN(j, k - 1)];
+            }
         } else {
-            *nerr = ERROR_OPENING_FILE;
+            for(j = 0; j < SAC_PACK_GROUP; j++) {
+                memcpy(&u[j], &y[i + MIN(j, k - 1)], sizeof u[j]);
+                u[j] = SAC_PACK_ORDER(u[j]);
+            }
         }
-        return;
-    }
-    switch(s->h->nvhdr) {
-    case SAC_HEADER_VERSION_7:  sac_copy_f64_to_f32(s); break;
-    case SAC_HEADER_VERSION_6: break;
-    }
-
-    if(!write_data) {
-        if(sac_int(s, SAC_NPTS) != sac_int(old, SAC_NPTS) ||
-           sac_int(s, SAC_HDR)  != sac_int(old, SAC_HDR)) {
-            *nerr = 115;
-            return;
+        all = 0;
+        for(j = 0; j < SAC_PACK_GROUP; j++) {
+            d = u[j] - prev;
+            z[j] = (j < k) ? ((d << 1) ^ (uint32_t) -(d >> 31)) : 0;
+            prev = (j < k) ? u[j] : prev;
+            all |= z[j];
         }
-        sac_free(old);
-        old = NULL;
-    }
-
-    *nerr = sac_header_write(s, fp);
-    if(*nerr != SAC_OK) {
-        return;
-    }
-    if(write_data) {
-        *nerr = sac_data_write(s, fp);
-        if(*nerr != SAC_OK) {
-            return;
+        for(w = 0; w < 32 && (all >> w); w++) { }
+        out[len++] = (unsigned char) w;
+        acc = 0;
+        nbits = 0;
+        for(j = 0; j < SAC_PACK_GROUP && w > 0; j++) {
+            acc |= (uint64_t) z[j] << nbits;
+            nbits += w;
+            while(nbits >= 8) {
+                out[len++] = (unsigned char) acc;
+                acc >>= 8;
+                nbits -= 8;
+            }
         }
-    } else {
-        fseek(fp, 
-              SAC_HEADER_SIZE +
-              4 * (off_t) s->h->npts * sac_comps(s),
-              SEEK_SET);
     }
-    if(s->h->nvhdr == SAC_HEADER_VERSION_7) {
-        *nerr = sac_header_write_v7(s, fp);
+    if(len >= 4 * n) {
+        for(i = 0; i < n; i++) {
+            memcpy(&d, &y[i], sizeof d);
+            d = SAC_LE32(d);
+            memcpy(out + 4 * i, &d, sizeof d);
+        }
+        len = 4 * n;
     }
+    return len;
+}
 
-    fclose(fp);
+/**
+ * @brief      Value of a quantization level, see sac_pack_quantize()
+ * @private
+ */
+static inline float
+sac_pack_level(double lo, double step, uint32_t q) {
+    return (float) (lo + step * (double) q);
 }
+
 /**
- * @brief      read sac data from a file pointer
+ * @brief      Encode a chunk of data quantized to a bounded error
  *
  * @private
  * @ingroup    sac
- * @memberof   sac
- *
- * @details    read sac data from a file pointer.  Memory should already
- *             be allocated and data will be swapped if the \p swap flag
- *             is defined in the meta data
  *
- * @param      s    sac data to read data into
- * @param      fp   file pointer to read data from
- *
- * @return     0 on success, -1 if npts < 0, ERROR_READING_FILE on read error
+ * @details    Quantized chunks begin with SAC_PACK_QUANT, the width of the
+ *             quantized values in bits, 8, 16 or 24, and the offset and step
+ *             of the quantization levels as little endian doubles.  The
+ *             levels span the range of the chunk, each value is stored as
+ *             the index of its nearest level in width bits, little endian.
+ *             The smallest width for which every decoded value is within
+ *             \p tol of the data is used.  The bound is checked on the
+ *             decoded floats, with a margin of one float rounding.
+ *
+ * @param      y     data to encode
+ * @param      n     number of values in \p y
+ * @param      tol   largest absolute error allowed
+ * @param      out   output, at least SAC_PACK_QUANT_MAX(n) bytes
+ * @param      e     extrema of the decoded values on return
+ *
+ * @return     number of bytes written to \p out, 0 if the chunk holds inf or
+ *             nan values or no width keeps the error within \p tol
  */
-int
-sac_data_read(sac *s, FILE *fp) {
-    float *p;
-    int i;
-    size_t n;
-    if(s->h->npts <= 0) {
-        return -1;
+static size_t
+sac_pack_quantize(const float *y, size_t n, double tol, unsigned char *out, extrema *e) {
+    size_t i = 0, len = 0;
+    unsigned int w = 0, b = 0, j = 0;
+    uint32_t q = 0, top = 0;
+    uint64_t u = 0;
+    double lo = 0.0, step = 0.0;
+    float v = 0.0f, vmin = 0.0f, vmax = 0.0f;
+    int bad = 0;
+
+    extrema_init(e);
+    extrema_update(e, y, n);
+    if(n == 0 || e->nonfinite > 0) {
+        return 0;
     }
-    n = (size_t) s->h->npts;
-    for(i = 0; i < sac_comps(s); i++) {
-        p = (i == 0) ? s->y : s->x ;
-        if(fread(p, sizeof(float), n, fp) != n) {
-            return ERROR_READING_FILE;
+    lo = e->min;
+    for(w = 8; w <= 24; w += 8) {
+        top = (1U << w) - 1;
+        step = ((double) e->max - lo) / top;
+        if(step > 2.0 * tol) {
+            continue;
         }
-        if(s->m->swap) {
-            sac_data_swap(p, s->h->npts);
+        // Constant chunks have a single level
+        step = (step > 0.0) ? step : 1.0;
+        b = w / 8;
+        len = 0;
+        out[len++] = SAC_PACK_QUANT;
+        out[len++] = (unsigned char) w;
+        memcpy(&u, &lo, sizeof u);
+        u = SAC_LE64(u);
+        memcpy(out + len, &u, sizeof u);
+        len += sizeof u;
+        memcpy(&u, &step, sizeof u);
+        u = SAC_LE64(u);
+        memcpy(out + len, &u, sizeof u);
+        len += sizeof u;
+        bad = 0;
+        vmin = vmax = sac_pack_level(lo, step, 0);
+        for(i = 0; i < n; i++) {
+            q = (uint32_t) MIN(lrint(((double) y[i] - lo) / step), (long) top);
+            v = sac_pack_level(lo, step, q);
+            bad |= (fabs((double) v - (double) y[i]) + fabs((double) y[i]) * FLT_EPSILON > tol);
+            vmin = fminf(vmin, v);
+            vmax = fmaxf(vmax, v);
+            for(j = 0; j < b; j++) {
+                out[len++] = (unsigned char) (q >> (8 * j));
+            }
+        }
+        if(!bad) {
+            e->min = vmin;
+            e->max = vmax;
+            return len;
         }
     }
     return 0;
 }
 
 /**
- * @brief Check the Sac Header Version
+ * @brief      Decode a quantized chunk of data, see sac_pack_quantize()
  *
  * @private
  * @ingroup    sac
- * @memberof   sac
- *
- * @details This routine checks the header version for a number between
- *          1 and \p SAC_HEADER_MAJOR_VERSION.  It check both the swapped
- *          and non-swapped version to determine the byte-order of the file
  *
- * @param hdr    Sac Header to Check
- * @param nerr   status code, 0 on success, non-zero on failure
- *
- * @return if header needs to be swapped or not or is not a sac file
- *    - 1 if file needs to be swapped
- *    - 0 if file does not need to be swapped
- *    - -1 if there was an error checking the header
+ * @param      in    encoded data, followed by at least 8 readable bytes
+ * @param      len   number of encoded bytes
+ * @param      n     number of values to decode
+ * @param      y     output data, \p n values
  *
+ * @return     0 on success, ERROR_READING_FILE if the data is malformed
  */
-int
-sac_check_header_version(float *hdr, int *nerr) {
-    int lswap;
-    int *ver;
-
-    lswap = FALSE;
-    *nerr = SAC_OK;
-    /* determine if the data needs to be swapped. */
-    ver = (int *) (hdr + SAC_VERSION_LOCATION);
-    if (*ver < 1 || *ver > SAC_HEADER_MAX_VERSION) {
-        byteswap_bsd((void *) ver, SAC_HEADER_SIZEOF_NUMBER);
+static int
+sac_pack_dequantize(const unsigned char *in, size_t len, size_t n, float *y) {
+    size_t i = 0, b = 0;
+    uint64_t u = 0, mask = 0;
+    double lo = 0.0, step = 0.0;
 
-        if (*ver < 1 || *ver > SAC_HEADER_MAX_VERSION) {
-            *nerr = ERROR_NOT_A_SAC_FILE;
-            printf("not in sac format, nor byteswapped sac format.");
-            return -1;
-        } else {
-            /* swap back, so it can be */
-            byteswap_bsd((void *) ver, SAC_HEADER_SIZEOF_NUMBER);
-            lswap = TRUE;
-        }
+    if(len < SAC_PACK_QUANT_HEADER || in[0] != SAC_PACK_QUANT ||
+       (in[1] != 8 && in[1] != 16 && in[1] != 24)) {
+        return ERROR_READING_FILE;
     }
-    return lswap;
+    b = in[1] / 8;
+    if(len != SAC_PACK_QUANT_HEADER + n * b) {
+        return ERROR_READING_FILE;
+    }
+    memcpy(&u, in + 2, sizeof u);
+    u = SAC_LE64(u);
+    memcpy(&lo, &u, sizeof lo);
+    memcpy(&u, in + 10, sizeof u);
+    u = SAC_LE64(u);
+    memcpy(&step, &u, sizeof step);
+    mask = ((uint64_t) 1 << in[1]) - 1;
+    in += SAC_PACK_QUANT_HEADER;
+    for(i = 0; i < n; i++) {
+        memcpy(&u, in + i * b, sizeof u);
+        y[i] = sac_pack_level(lo, step, (uint32_t) (SAC_LE64(u) & mask));
+    }
+    return SAC_OK;
 }
 
-
 /**
- * @brief      Read a sac header from a file pointer
+ * @brief      Decode a chunk of data, see sac_pack_encode() and sac_pack_quantize()
  *
  * @private
  * @ingroup    sac
- * @memberof   sac
- *
- * @details    Read a sac header from a file pointer
  *
- * @param      s   sac file to place header into
- * @param      fp  file pointer to read header from
+ * @param      in    encoded data, followed by at least 8 readable bytes
+ * @param      len   number of encoded bytes
+ * @param      n     number of values to decode
+ * @param      y     output data, \p n values
  *
- * @return     status code, 0 on success, non-zero on failure
+ * @return     0 on success, ERROR_READING_FILE if the data is malformed
  */
-int
-sac_header_read(sac *s, FILE *fp) {
-    int nerr;
-    size_t n;
-    char str[SAC_HEADER_STRINGS * 8];
-
-    n = SAC_HEADER_NUMBERS;
-    if(fread((char *) s->h, sizeof(float), n, fp) != n) {
-        return ERROR_NOT_A_SAC_FILE;
-    }
-    s->m->swap = sac_check_header_version((float *) s->h, &nerr);
-    if(nerr) {
-        return ERROR_NOT_A_SAC_FILE;
+static int
+sac_pack_decode(const unsigned char *in, size_t len, size_t n, float *y) {
+    size_t i = 0, j = 0, k = 0, pos = 0;
+    uint32_t prev = 0;
+    uint32_t u[SAC_PACK_GROUP], z[SAC_PACK_GROUP];
+    uint64_t v = 0, mask = 0;
+    unsigned int w = 0;
+    int mode = 0;
+
+    if(len == 4 * n) {
+        for(i = 0; i < n; i++) {
+            memcpy(&prev, in + 4 * i, sizeof prev);
+            prev = SAC_LE32(prev);
+            memcpy(&y[i], &prev, sizeof prev);
+        }
+        return SAC_OK;
     }
-    if(s->m->swap) {
-        sac_header_swap((float *) s->h);
+    if(len > 0 && in[0] == SAC_PACK_QUANT) {
+        return sac_pack_dequantize(in, len, n, y);
     }
-
-    if(fread(str, 8, SAC_HEADER_STRINGS, fp) != SAC_HEADER_STRINGS) {
+    if(len < 1 || ((mode = in[pos++]) != SAC_PACK_INT && mode != SAC_PACK_FLOAT)) {
         return ERROR_READING_FILE;
     }
-    sac_copy_strings_add_terminator(s, str);
-
-    return 0;
+    for(i = 0; i < n; i += SAC_PACK_GROUP) {
+        k = MIN(n - i, (size_t) SAC_PACK_GROUP);
+        if(pos >= len || (w = in[pos++]) > 32 || pos + 4 * (size_t) w > len) {
+            return ERROR_READING_FILE;
+        }
+        mask = ((uint64_t) 1 << w) - 1;
+        for(j = 0; j < SAC_PACK_GROUP; j++) {
+            memcpy(&v, in + pos + ((j * w) >> 3), sizeof v);
+            v = SAC_LE64(v);
+            z[j] = (uint32_t) ((v >> ((j * w) & 7)) & mask);
+        }
+        pos += 4 * (size_t) w;
+        for(j = 0; j < SAC_PACK_GROUP; j++) {
+            prev += (z[j] >> 1) ^ (uint32_t) -(z[j] & 1);
+            u[j] = prev;
+        }
+        if(mode == SAC_PACK_INT) {
+            for(j = 0; j < k; j++) {
+                y[i + j] = (float) (int32_t) u[j];
+            }
+        } else {
+            for(j = 0; j < k; j++) {
+                u[j] = SAC_PACK_UNORDER(u[j]);
+                memcpy(&y[i + j], &u[j], sizeof u[j]);
+            }
+        }
+    }
+    return (pos == len) ? SAC_OK : ERROR_READING_FILE;
 }
+
 /**
- * @brief Read the sac header
+ * @brief      Pack the data of a sac file
  *
  * @private
  * @ingroup    sac
  * @memberof   sac
  *
- * @details    Read a sac header from a file pointer
- *
- * @param      filename   file to read from
- * @param      nerr       status error code, non-zero on failure
- * @param      fp         returned file pointer
+ * @details    Pack all data components into chunks of SAC_PACK_CHUNK
+ *             values, see sac_pack_encode().  The packed data begins with a
+ *             sac_pack_hdr and an index of the chunks of each component,
+ *             with their offset, size, and minimum and maximum values,
+ *             followed by the chunks.  The header and index are stored in
+ *             the byte order of the file; chunks do not depend on it.
+ *             With a quantization error set, see sac_set_quantize(), chunks
+ *             are quantized, see sac_pack_quantize(), where that is smaller
+ *             than their lossless encoding.  The index then holds the
+ *             extrema of the quantized values.
  *
- * @return     sac file with only the header read, NULL on failure
+ * @param      s     sac file
+ * @param      swap  if the header and index should be byteswapped
+ * @param      len   size of the packed data on return
  *
+ * @return     packed data, free with free(), NULL on failure
  */
-static sac *
-sac_read_header_internal(char *filename, int *nerr, FILE **fp) {
-    off_t size = 0;
-    sac *s = NULL;
-    struct stat stbuf;
-
-    if(!filename) {
-        *nerr = ERROR_FILE_DOES_NOT_EXIST;
-        return NULL;
-    }
-
-    if(stat(filename, &stbuf) != 0) {
-        switch(errno) {
-        case EACCES:       /* Permission         */
-        case EIO:          /* I/O Error          */
-        case ELOOP:        /* Too many sym links */
-        case ENOTDIR:      /* Not a Directory    */
-        case ENAMETOOLONG: /* Name too long      */
-        case EFAULT:       /* Invalid Address    */
-            *nerr = ERROR_READING_FILE;
-            break;
-        case ENOENT:       /* File does not exit */
-            *nerr = ERROR_FILE_DOES_NOT_EXIST;
-        }
+static unsigned char *
+sac_pack(const sac *s, int swap, size_t *len) {
+    int j = 0;
+    size_t i = 0, c = 0, k = 0, off = 0, qlen = 0;
+    size_t n = (size_t) s->h->npts;
+    size_t nchunk = (n + SAC_PACK_CHUNK - 1) / SAC_PACK_CHUNK;
+    size_t ncomp = (size_t) sac_comps((sac *) s);
+    sac_pack_hdr ph;
+    sac_pack_entry *idx = NULL;
+    unsigned char *out = NULL, *quant = NULL;
+    double tol = 0.0;
+    extrema e, eq;
+
+    off = sizeof ph + ncomp * nchunk * sizeof(sac_pack_entry);
+    if(!(out = malloc(off + ncomp * nchunk * SAC_PACK_CHUNK_MAX(SAC_PACK_CHUNK)))) {
         return NULL;
     }
-
-    if(!(*fp = fopen(filename, "rb"))) {
-        *nerr = ERROR_FILE_DOES_NOT_EXIST;
+    if(s->m->quantize > 0.0 && !(quant = malloc(SAC_PACK_QUANT_MAX(SAC_PACK_CHUNK)))) {
+        FREE(out);
         return NULL;
     }
-
-    size = stbuf.st_size;
-
-    s = sac_new();
-
-    s->m->filename = strdup(filename);
-    *nerr = sac_header_read(s, *fp);
-    if(*nerr) {
-        goto error;
-    }
-
-    // Check actual size versus expected size of the file
-    if(sac_size(s) != size) {
-        printf("sacio: Actual file size %lld != expected file size: %lld [npts: %d]\n",
-               (long long int) size, (long long int) sac_size(s), s->h->npts);
-        *nerr = ERROR_NOT_A_SAC_FILE;
-        goto error;
-    }
-
-    return s;
- error:
-    if(s) {
-        sac_free(s);
-        s = NULL;
+    idx = (sac_pack_entry *) (out + sizeof ph);
+    for(j = 0; j < (int) ncomp; j++) {
+        const float *y = (j == 0) ? s->y : s->x;
+        tol = s->m->quantize;
+        if(tol > 0.0 && s->m->quantize_relative) {
+            extrema_init(&e);
+            extrema_update(&e, y, n);
+            tol *= fmax(fabs(e.min), fabs(e.max));
+        }
+        for(i = 0; i < n; i += k, c++) {
+            k = MIN(n - i, (size_t) SAC_PACK_CHUNK);
+            extrema_init(&e);
+            extrema_update(&e, y + i, k);
+            idx[c].off = off;
+            idx[c].n   = (uint32_t) k;
+            idx[c].min = e.min;
+            idx[c].max = e.max;
+            idx[c].len = (uint32_t) sac_pack_encode(y + i, k, out + off);
+            if(tol > 0.0 && isfinite(tol) &&
+               (qlen = sac_pack_quantize(y + i, k, tol, quant, &eq)) > 0 && qlen < idx[c].len) {
+                memcpy(out + off, quant, qlen);
+                idx[c].len = (uint32_t) qlen;
+                idx[c].min = eq.min;
+                idx[c].max = eq.max;
+            }
+            off += idx[c].len;
+        }
     }
-    return NULL;
+    FREE(quant);
+    ph.chunk  = SAC_PACK_CHUNK;
+    ph.nchunk = (uint32_t) nchunk;
+    ph.bytes  = off;
+    if(swap) {
+        sac_swap32(&ph.chunk, &ph.chunk, 2);
+        sac_swap64(&ph.bytes, &ph.bytes, 1);
+        sac_pack_entry_swap(idx, c);
+    }
+    memcpy(out, &ph, sizeof ph);
+    *len = off;
+    return out;
 }
 
 /**
- * @brief  Update meta data following (post) read
+ * @brief      Read and unpack data from a file with packed data
  *
  * @private
  * @ingroup    sac
  * @memberof   sac
  *
- * @details   Update the begin and end value, the distance, az, baz,
- *            and great circle distance, min, max, and mean of the data,
- *            check the precision of time picks relative to the delta
- *
- * @param     s          sac file to check
- * @param     read_data  if data was read
- *
+ * @details    Read values \p first to \p first + \p n of data component
+ *             \p comp.  Only the index entries and chunks covering the values
+ *             are read.  On success \p fp is positioned at the end of the
+ *             packed data, where a v7 footer begins.
+ *
+ * @param      s      sac file with the header read
+ * @param      fp     file to read from
+ * @param      npts   number of values per component in the file, npts in
+ *                    the header of the file
+ * @param      comp   data component, 0 for y, 1 for x
+ * @param      first  index of the first value to read
+ * @param      n      number of values to read
+ * @param      y      output data, \p n values
+ * @param      e      running extrema to update, may be NULL
+ * @param      bytes  number of bytes read is added, may be NULL
+ *
+ * @return     0 on success, ERROR_READING_FILE on failure
  */
-static void
-sac_read_post(sac *s, int read_data) {
-    sac_be(s);
-    update_distaz(s);
-    if(read_data) {
-        sac_extrema(s);
+static int
+sac_pack_read(sac *s, FILE *fp, size_t npts, int comp, size_t first, size_t n,
+              float *y, extrema *e, size_t *bytes) {
+    int nerr = ERROR_READING_FILE;
+    size_t c = 0, c0 = 0, c1 = 0, i = 0, k = 0, a = 0, b = 0, nread = 0;
+    sac_pack_hdr ph;
+    sac_pack_entry *idx = NULL;
+    unsigned char *buf = NULL;
+    float *tmp = NULL;
+
+    if(fseeko(fp, SAC_HEADER_SIZE, SEEK_SET) != 0 || fread(&ph, sizeof ph, 1, fp) != 1) {
+        return ERROR_READING_FILE;
     }
-    sac_check_time_precision(s);
+    if(s->m->swap) {
+        sac_swap32(&ph.chunk, &ph.chunk, 2);
+        sac_swap64(&ph.bytes, &ph.bytes, 1);
+    }
+    nread = sizeof ph;
+    if(ph.chunk == 0 || ph.chunk > SAC_PACK_CHUNK_LIMIT ||
+       ph.nchunk != (npts + ph.chunk - 1) / ph.chunk || first + n > npts) {
+        return ERROR_READING_FILE;
+    }
+    if(n > 0) {
+        c0 = first / ph.chunk;
+        c1 = (first + n - 1) / ph.chunk;
+        if(!(idx = malloc((c1 - c0 + 1) * sizeof(sac_pack_entry))) ||
+           !(buf = malloc(SAC_PACK_CHUNK_MAX(ph.chunk) + sizeof(uint64_t))) ||
+           !(tmp = malloc(ph.chunk * sizeof(float)))) {
+            goto done;
+        }
+        if(fseeko(fp, (off_t) (SAC_HEADER_SIZE + sizeof ph +
+                               ((size_t) comp * ph.nchunk + c0) * sizeof(sac_pack_entry)),
+                  SEEK_SET) != 0 ||
+           fread(idx, sizeof(sac_pack_entry), c1 - c0 + 1, fp) != c1 - c0 + 1) {
+            goto done;
+        }
+        nread += (c1 - c0 + 1) * sizeof(sac_pack_entry);
+        if(s->m->swap) {
+            sac_pack_entry_swap(idx, c1 - c0 + 1);
+        }
+    }
+    for(c = c0; n > 0 && c <= c1; c++) {
+        sac_pack_entry *p = &idx[c - c0];
+        k = MIN((size_t) ph.chunk, npts - c * ph.chunk);
+        if(p->n != k || p->len > SAC_PACK_CHUNK_MAX(ph.chunk) ||
+           p->off > ph.bytes || p->len > ph.bytes - p->off) {
+            goto done;
+        }
+        if(fseeko(fp, (off_t) (SAC_HEADER_SIZE + p->off), SEEK_SET) != 0 ||
+           fread(buf, 1, p->len, fp) != p->len) {
+            goto done;
+        }
+        memset(buf + p->len, 0, sizeof(uint64_t));
+        nread += p->len;
+        // Values a to b of this chunk are wanted
+        a = (c == c0) ? first - c * ph.chunk : 0;
+        b = (c == c1) ? first + n - c * ph.chunk : k;
+        i = c * ph.chunk + a - first;
+        if(a == 0 && b == k) {
+            if(sac_pack_decode(buf, p->len, k, y + i) != SAC_OK) {
+                goto done;
+            }
+        } else {
+            if(sac_pack_decode(buf, p->len, k, tmp) != SAC_OK) {
+                goto done;
+            }
+            memcpy(y + i, tmp + a, (b - a) * sizeof(float));
+        }
+        if(e) {
+            extrema_update(e, y + i, b - a);
+        }
+    }
+    if(fseeko(fp, (off_t) (SAC_HEADER_SIZE + ph.bytes), SEEK_SET) != 0) {
+        goto done;
+    }
+    if(bytes) {
+        *bytes += nread;
+    }
+    nerr = SAC_OK;
+ done:
+    FREE(idx);
+    FREE(buf);
+    FREE(tmp);
+    return nerr;
 }
 
 /**
- * @brief      Read a sac file
+ * @brief      Unpack data from a sac file with packed data in memory
  *
  * @private
  * @ingroup    sac
  * @memberof   sac
  *
- * @details    Read a sac file. Header values b, e, dist, az, baz, gcarc
- *             updated after read.  Data is read from either byte order
- *             and converted to the system's byte order
- *
- * @param      filename   file to read sac file from
- * @param      read_data  whether to read the header and data or just the header
- * @param      nerr       status code, 0 on success, non-zero on failure
- *
- * @return     sac file structure, NULL on failure
+ * @details    Unpack all values of data component \p comp, see
+ *             sac_pack_read().  Chunks are decoded in place, except a chunk
+ *             too close to the end of \p buf for the decoder to read ahead,
+ *             which is copied first.
+ *
+ * @param      s      sac file with the header read
+ * @param      buf    sac file in memory
+ * @param      len    size of \p buf in bytes, at least SAC_HEADER_SIZE
+ * @param      comp   data component, 0 for y, 1 for x
+ * @param      y      output data, npts values
+ * @param      e      running extrema to update, may be NULL
+ * @param      end    end of the packed data in \p buf on return, where a v7
+ *                    footer begins
+ *
+ * @return     0 on success, ERROR_READING_FILE on failure
  */
-sac *
-sac_read_internal(char *filename, int read_data, int *nerr) {
-    FILE *fp = NULL;
-    sac *s = NULL;
-
-    *nerr = 0;
-
-    if(!(s = sac_read_header_internal(filename, nerr, &fp))) {
-        goto error;
+static int
+sac_pack_read_buffer(sac *s, const unsigned char *buf, size_t len, int comp,
+                     float *y, extrema *e, size_t *end) {
+    int nerr = ERROR_READING_FILE;
+    size_t c = 0, k = 0;
+    size_t npts = (size_t) s->h->npts;
+    size_t avail = len - SAC_HEADER_SIZE;
+    const unsigned char *data = buf + SAC_HEADER_SIZE, *in = NULL;
+    unsigned char *tmp = NULL;
+    sac_pack_hdr ph;
+    sac_pack_entry p;
+
+    if(avail < sizeof ph) {
+        return ERROR_READING_FILE;
     }
-
-    if(read_data) {
-        sac_alloc(s);
-        s->m->nstart = 1;
-        s->m->nstop  = s->h->npts;
-        s->m->ntotal = s->h->npts;
-        s->m->nfillb = 0;
-        s->m->nfille = 0;
-        if((*nerr = sac_data_read(s, fp))) {
-            goto error;
-        }
+    memcpy(&ph, data, sizeof ph);
+    if(s->m->swap) {
+        sac_swap32(&ph.chunk, &ph.chunk, 2);
+        sac_swap64(&ph.bytes, &ph.bytes, 1);
     }
-
-    sac_header_v7_fill(s, fp, nerr);
-
-    fclose(fp);
-
-    sac_read_post(s, read_data);
-
-    return s;
-
- error:
-    if(s) {
-        sac_free(s);
-        s = NULL;
+    if(ph.chunk == 0 || ph.chunk > SAC_PACK_CHUNK_LIMIT ||
+       ph.nchunk != (npts + ph.chunk - 1) / ph.chunk || ph.bytes > avail ||
+       sizeof ph + ((size_t) comp + 1) * ph.nchunk * sizeof(sac_pack_entry) > ph.bytes) {
+        return ERROR_READING_FILE;
     }
-    if(fp) {
-        fclose(fp);
+    for(c = 0; c < ph.nchunk; c++) {
+        memcpy(&p, data + sizeof ph + ((size_t) comp * ph.nchunk + c) * sizeof p, sizeof p);
+        if(s->m->swap) {
+            sac_pack_entry_swap(&p, 1);
+        }
+        k = MIN((size_t) ph.chunk, npts - c * ph.chunk);
+        if(p.n != k || p.len > SAC_PACK_CHUNK_MAX(ph.chunk) ||
+           p.off > ph.bytes || p.len > ph.bytes - p.off) {
+            goto done;
+        }
+        in = data + p.off;
+        if(p.off + p.len + sizeof(uint64_t) > avail) {
+            if(!tmp && !(tmp = malloc(SAC_PACK_CHUNK_MAX(ph.chunk) + sizeof(uint64_t)))) {
+                goto done;
+            }
+            memcpy(tmp, in, p.len);
+            memset(tmp + p.len, 0, sizeof(uint64_t));
+            in = tmp;
+        }
+        if(sac_pack_decode(in, p.len, k, y + c * ph.chunk) != SAC_OK) {
+            goto done;
+        }
+        if(e) {
+            extrema_update(e, y + c * ph.chunk, k);
+        }
     }
-    return NULL;
+    *end = SAC_HEADER_SIZE + (size_t) ph.bytes;
+    nerr = SAC_OK;
+ done:
+    FREE(tmp);
+    return nerr;
 }
 
-#ifdef HAVE_FUNC_FMEMOPEN
-
 /**
- * @brief Write a sac file to a memory buffer
+ * @brief Swap the Sac Header
  *
- * @ingroup    sac
- * @memberof   sac
+ * @details Swap all floating point and integer values of the sac header
  *
- * @details    Create and write a sac file to a memory buffer
- *             It is the users responsibility to free() the returned
- *             memory
+ * @private
+ * @memberof sac
+ * @ingroup  sac
  *
- * @param      s     sac file structure to write
- * @param      nlen  length of memory buffer on return
+ * @param hdr    Sac Header to Swap, packed
  *
- * @return     memory buffer with sac file structure, NULL on error
+ * @date July 01, 2007 Initial Version -- B. Savage
  *
  */
-uint8_t *
-sac_write_to_memory(sac *s, uint32_t *len) {
-    size_t n = 0;
-    uint8_t *buf = NULL;
-    FILE *fp = NULL;
-
-    n = sac_size(s);
-
-    buf = calloc(n, sizeof(uint8_t));
-    if(!(fp = fmemopen(buf, n, "w"))) {
-        printf("Error opening memory for writing\n");
-        return NULL;
-    }
-
-    switch(s->h->nvhdr) {
-    case 7:  sac_copy_f64_to_f32(s); break;
-    case 6: break;
-    }
-
-    if(sac_header_write(s, fp) ||
-       sac_data_write(s, fp) ) {
-        goto error;
-    }
-    if(s->h->nvhdr == 7) {
-        if(sac_header_write_v7(s, fp)) {
-            goto error;
-        }
-    }
-
-    *len = n;
-    return buf;
+void
+sac_header_swap(void *hdr) {
+    sac_swap32(hdr, hdr, SAC_HEADER_NUMBERS);
+}
 
- error:
-    if(buf) {
-        free(buf);
-        buf = NULL;
+/**
+ * @brief      Swap an array of data in place
+ *
+ * @details    Swap an array of data in place,
+ *             typically the data component of a sac file
+ *
+ * @private
+ * @memberof sac
+ * @ingroup  sac
+ *
+ * @param      y   array to to be swapped in place
+ * @param      n   length of \p y
+ *
+ */
+void
+sac_data_swap(float *y, int n) {
+    if(n <= 0) {
+        return;
     }
-    *len = 0;
-    return NULL;
+    sac_swap32(y, y, (size_t) n);
 }
 
 /**
- * @brief Read a sac file from a memory buffer
+ * @brief      Copy strings from a sac file to a sac structure in memory
  *
+ * @private
  * @ingroup    sac
  * @memberof   sac
  *
- * @details    Read a sac file from a memory buffer
- *             It is the users responsibility to free() the returned
- *             sac file 
+ * @details    Copy character string from a sac file to a sac structure
+ *             in memory, appending C-termination characters at the end
+ *             This is the inverse of sac_copy_strings_strip_terminator().
+ *             Input \p src data is assumed to be concatenated unterminated
+ *             character strings as exists for a sac file saved to disk
  *
- * @param      buf   memory buffer to read from
- * @param      nlen  size of memory buffer in bytes
  *
- * @return     sac file structure read from memory buffer, NULL on error
+ * @param      s     Where to place the character strings with terminators
+ * @param      src   Packed Input character strings without terminators
  *
  */
-sac *
-sac_read_from_memory(const uint8_t *buf, size_t len) {
-    int nerr = 0;
-    FILE *fp = NULL;
-    if(!(fp = fmemopen((void *) buf, len, "r"))) {
-        printf("Error opening memory for reading\n");
-        return NULL;
-    }
-    sac *s = sac_new();
-    if(sac_header_read(s, fp)) {
-        goto error;
-    }
-    sac_alloc(s);
-    s->m->nstart = 1;
-    s->m->nstop  = s->h->npts;
-    s->m->ntotal = s->h->npts;
-    s->m->nfillb = 0;
-    s->m->nfille = 0;
-
-    if(sac_data_read(s, fp)) {
-        goto error;
-    }
-
-    sac_header_v7_fill(s, fp, &nerr);
-
-    fclose(fp);
-
-    sac_read_post(s, 1);
-
-    return s;
- error:
-    if(s) {
-        sac_free(s);
-        s = NULL;
+void
+sac_copy_strings_add_terminator(sac *s, char *src) {
+    int i = 0;
+    void *p = src;
+    for(i = SAC_STA; i <= SAC_INST; i++) {
+        if(i == SAC_EVENT2) {
+            continue;
+        }
+        char *dst = khdr(s, i-SAC_STA+1);
+        size_t n = (i == SAC_EVENT) ? 16 : 8;
+        memcpy(dst, p, n);
+        dst[n] = 0;
+        p += n;
     }
-    return NULL;
 }
-#endif /* HAVE_FUNC_FMEMOPEN */
 
 /**
- * @brief      initialize / fill a sac header
+ * @brief      Copy strings from a sac file to a packed string
  *
  * @private
  * @ingroup    sac
  * @memberof   sac
  *
- * @details    initialize / fill a sac header with default values
- *             - nvhdr  = \p SAC_HEADER_MAJOR_VERSION
- *             - leven  = TRUE
- *             - lpspol = FALSE
- *             - lovrok = TRUE
- *             - lcalda = TRUE
- *             - iftype  = ITIME
- *             - all other values are set to undefined, -12345
+ * @details    Copy character strings from a sac structure in memory
+ *             to a concatenated character string as would exist in a sac
+ *             file on disk.  Terminators are removed and strings are appended
+ *             in order as they appear on disk.  This is the inverse operation
+ *             of sac_copy_strings_add_terminator().  Order is important.
  *
- * @param      sh   pointer sac header
+ * @param      s     sac file to take strings from
+ * @param      dst   concatenated character string to place unterminated
+ *                   character string into.  
  *
  */
 void
-sac_hdr_init(sac_hdr *sh) {
-    if (sh) {
-        memcpy(sh, &NullSacHeader, sizeof(NullSacHeader));
-        sh->nvhdr = SAC_HEADER_MAJOR_VERSION;
-
-        sh->leven = TRUE;
-        sh->lpspol = FALSE;
-        sh->lovrok = TRUE;
-        sh->lcalda = TRUE;
-        sh->unused27 = TRUE;
-        sh->iftype = ITIME;
+sac_copy_strings_strip_terminator(sac *s, char *dst) {
+    int i = 0;
+    void *p = dst;
+    for(i = SAC_STA; i <= SAC_INST; i++) {
+        if(i == SAC_EVENT2) {
+            continue;
+        }
+        size_t n = (i == SAC_EVENT) ? 16 : 8;
+        memcpy(p, khdr(s, i-SAC_STA+1), n);
+        p += n;
     }
 }
 
 /**
- * @brief      Convert a time to index
+ * @brief      Encode a sac header as stored on disk
  *
+ * @private
  * @ingroup    sac
  * @memberof   sac
  *
- * @details    Convert a time value to a data point index. All values are
- *             relative to the `b` value 
+ * @details    Encode the numeric and character portions of a sac header
+ *             into \p buf, \p SAC_HEADER_SIZE bytes, as stored on disk.
+ *             For v7 files, 32-bit values are taken from the 64-bit header.
+ *             The sac file is not modified, all conversion happens in
+ *             \p buf.
  *
- * @param      s   sac file
- * @param      t   time value
+ * @param      s     sac file to encode the header from
+ * @param      buf   output buffer, at least \p SAC_HEADER_SIZE bytes
+ * @param      swap  if the header should be byteswapped
  *
- * @return     index of data point associated with the time
+ */
+void
+sac_header_encode(const sac *s, char *buf, int swap) {
+    sac_hdr h;
+    memcpy(&h, s->h, SAC_HEADER_NUMBERS_SIZE_BYTES_FILE);
+    if(s->h->nvhdr == SAC_HEADER_VERSION_7) {
+#define X(name,key) h.key = (float) s->z->key;
+        SAC_F64
+#undef X
+    }
+    if(swap) {
+        sac_swap32(buf, &h, SAC_HEADER_NUMBERS);
+    } else {
+        memcpy(buf, &h, SAC_HEADER_NUMBERS_SIZE_BYTES_FILE);
+    }
+    sac_copy_strings_strip_terminator((sac *) s, buf + SAC_HEADER_NUMBERS_SIZE_BYTES_FILE);
+}
+
+/**
+ * @brief Write a Sac Header
  *
- * @code
- * int i = 0;
- * sac *s = sac_new();
- * sac_set_float(s, SAC_B, 10.0);
- * sac_set_float(s, SAC_DELTA, 0.1);
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
  *
- * i = sac_time_to_index(s, 10.0);
- * assert_eq(i, 0);
+ * @details    The header is encoded into a local buffer, see
+ *             sac_header_encode(), the sac file is not modified
  *
- * i = sac_time_to_index(s, 20.0);
- * assert_eq(i, 100 );
- * @endcode
+ * @param s     - Sac file structure
+ * @param fp    - File pointer in which to write header to
+ * @param swap  - If the header should be byteswapped
+ *
+ * @return 0 on success, Non-zero on error
+ *     - ERROR_WRITING_FILE (115)
+ *
+ * @date March 12, 2020
  */
 int
-sac_time_to_index(sac *s, double t) {
-    double b, dt;
-    sac_get_float(s, SAC_B, &b);
-    sac_get_float(s, SAC_DELTA, &dt);
-    return (int) lround((t-b)/dt);
+sac_header_write(const sac *s, FILE *fp, int swap) {
+    char buf[SAC_HEADER_SIZE];
+    sac_header_encode(s, buf, swap);
+    if(fwrite(buf, sizeof buf, 1, fp) != 1) {
+        return ERROR_WRITING_FILE;
+    }
+    return SAC_OK;
 }
 
-
-
-/**
- * @brief    Start Time is before Begin value (B)
- * @private
- */
-#define START_BEFORE 1<<0
-/**
- * @brief    Start Time is between Begin (B) and End Value (E)
- * @private
- */
-#define START_INSIDE 1<<1
-/**
- * @brief    Start Time is after End value (E)
- * @private
- */
-#define START_AFTER  1<<2
 /**
- * @brief    End Time is before Start time (B)
+ * @brief      Number of samples in the data write bounce buffer
  * @private
  */
-#define END_BEFORE   1<<3
+#define SAC_WRITE_BUFFER 4096
+
 /**
- * @brief    End Time is between Begin (B) and End Value (E)
+ * @brief      Number of samples in the data read bounce buffer
  * @private
  */
-#define END_INSIDE   1<<4
+#define SAC_READ_BUFFER 4096
+
 /**
- * @brief    End Time is after End Value (E)
+ * @brief      Write data components to a file descriptor
+ *
  * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Data in the system's byte order is written directly.  Data to
+ *             be byteswapped is converted in chunks into a bounded bounce
+ *             buffer on the stack, the sac file is not modified.
+ *
+ * @param      s     sac file structure to write to
+ * @param      fp    file descriptor to write to
+ * @param      swap  if the data should be byteswapped
+ *
+ * @return     status code, 0 on success, non-zero on failure
+ *
  */
-#define END_AFTER    1<<5
+int
+sac_data_write(const sac *s, FILE *fp, int swap) {
+    size_t i = 0, k = 0;
+    size_t n = s->h->npts;
+    float buf[SAC_WRITE_BUFFER];
+    for(int j = 0; j < sac_comps((sac *) s); j++) {
+        const float *p = (j == 0) ? s->y : s->x;
+        if(!swap) {
+            if(fwrite(p, sizeof(float), n, fp) != n) {
+                return ERROR_WRITING_FILE;
+            }
+            continue;
+        }
+        for(i = 0; i < n; i += k) {
+            k = MIN(n - i, (size_t) SAC_WRITE_BUFFER);
+            sac_swap32(buf, p + i, k);
+            if(fwrite(buf, sizeof(float), k, fp) != k) {
+                return ERROR_WRITING_FILE;
+            }
+        }
+    }
+    return SAC_OK;
+}
 
+static int v7_keys[] = {
+#define X(name,key) SAC_##name ,
+    SAC_F64
+#undef X
+};
+static size_t v7_keys_length = sizeof(v7_keys) / sizeof(int);
 /**
- * @brief      characterize a cut window
+ * @brief      Encode the sac header version 7 as stored on disk
  *
  * @private
  * @ingroup    sac
  * @memberof   sac
  *
- * @details    characterize a cut window by determining the the location
- *             of the start and end of the cut window with the data
+ * @details    Encode the 64-bit v7 "footer" into \p buf, in the order
+ *             stored on disk.  The sac file is not modified.
  *
- * @param      s   sac file
+ * @param      s     sac file to encode the footer from
+ * @param      buf   output buffer, at least sizeof(sac_f64) bytes
+ * @param      swap  if the footer should be byteswapped
  *
- * @return     (START_BEFORE | START_INSIDE | START_AFTER) &
- *             (END_BEFORE | END_INSIDE | END_AFTER)
  */
-static int
-window_overlap(sac *s) {
-    int f = 0;
-    if(s->m->nstart < 1) {
-        f |= START_BEFORE;
-    } else if(s->m->nstart > s->h->npts) {
-        f |= START_AFTER;
-    } else {
-        f |= START_INSIDE;
-    }
-    if(s->m->nstop < 1) {
-        f |= END_BEFORE;
-    } else if(s->m->nstop > s->h->npts) {
-        f |= END_AFTER;
+void
+sac_header_v7_encode(const sac *s, char *buf, int swap) {
+    size_t i = 0;
+    double buffer[v7_keys_length];
+#define X(name,key) buffer[i++] = s->z->key;
+    SAC_F64
+#undef X
+    if(swap) {
+        sac_swap64(buf, buffer, v7_keys_length);
     } else {
-        f |= END_INSIDE;
+        memcpy(buf, buffer, sizeof(buffer));
     }
-    return f;
 }
 
 /**
- * @brief      get time value
+ * @brief Write the sac header version 7
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details Write the sac header version 7 to the end of a file.
+ *          file pointer must be positioned at the end of the data
+ *          section for write to be done properly
+ *
+ * @param s     - sac file structure to write out
+ * @param fp    - File descriptor to write to
+ * @param swap  - If the footer should be byteswapped
+ *
+ * @return nerr  - Error reporting value
+ *
+ * V7 of the header is a additional set of data at the end of the file
+ * following the data.  This routine only write the this "footer" of
+ * metadata, the v6 header I/O routines are still required
+ *
+ * @code
+ * int nerr = 0;
+ * sac *s = NULL;
+ * int host = byte_order();
+ * int little = !(host == ENDIAN_LITTLE);
+ * int big    = !(host == ENDIAN_BIG);
+ *
+ * s = sac_read("t/test_io_small.sac", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(s->m->swap, little);
+ *
+ * sac_set_v7(s);
+ * sac_write(s, "t/test_io_small_v7.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ *
+ * s = sac_read("t/test_io_big.sac", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(s->m->swap, big);
+ *
+ * sac_set_v7(s);
+ * sac_write(s, "t/test_io_big_v7.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ *
+ * s = sac_read("t/test_io_big_v7.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(s->m->swap, big);
+ * assert_eq(s->h->nvhdr, 7);
+ *
+ * FILE *fp = NULL;
+ * double v = 0.0;
+ * fprintf(stderr, "Checking raw data file\n");
+ * fp = fopen("t/test_io_big_v7.sac.tmp", "r");
+ * assert_ne(fp, NULL);
+ * fseek(fp, -8, SEEK_END);
+ * v = 0.0;
+ * assert_eq(fread(&v, sizeof(double), 1, fp), 1);
+ * if(s->m->swap) {
+ *    assert_ne(v, -12345.0);
+ *    swap_double((void *) &v);
+ * }
+ * assert_eq(v, -12345.0);
+ * fclose(fp);
+ *
+ * s = sac_read("t/test_io_small_v7.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(s->m->swap, little);
+ * assert_eq(s->h->nvhdr, 7);
+ *
+ * fprintf(stderr, "Checking raw data file\n");
+ * fp = fopen("t/test_io_small_v7.sac.tmp", "r");
+ * assert_ne(fp, NULL);
+ * fseek(fp, -8, SEEK_END);
+ * v = 0.0;
+ * assert_eq(fread(&v, sizeof(double), 1, fp), 1);
+ * if(s->m->swap) {
+ *    assert_ne(v, -12345.0);
+ *    swap_double((void *) &v);
+ * }
+ * assert_eq(v, -12345.0);
+ * fclose(fp);
+ *
+ * @endcode
+ */
+int
+sac_header_write_v7(const sac *s, FILE *fp, int swap) {
+    char buffer[sizeof(sac_f64)];
+    sac_header_v7_encode(s, buffer, swap);
+    if(fwrite(buffer, sizeof(buffer), 1, fp) != 1) {
+        return ERROR_WRITING_FILE;
+    }
+    return SAC_OK;
+}
+
+/**
+ * @brief     Read the sac header version 7
+ *
+ * @details   V7 of the header is a additional set of data at the end of the file
+ *            following the data.  This routine only reads the this "footer" of
+ *            metadata, the v6 header I/O routines are still required
+ *
+ *            Function places the file pointer at the beginning of the v7 header,
+ *            completes the read and then places the file pointer at its previous
+ *            position.  It is safe to call before reading data components.
+ *
+ * @ingroup    sac
+ * @memberof   sac
+ * @private
+ *
+ * @param  fp    File Pointer to open sac file for reading
+ * @param  s     sac file structure to fill
+ * @param  nerr  Error reporting value
+ *
+ */
+void
+sac_header_read_v7(FILE *fp, sac *s, int *nerr) {
+    size_t i = 0;
+    long offset = 0;
+    size_t n = 0;
+    double buffer[v7_keys_length];
+    *nerr = SAC_OK;
+
+    offset = ftell(fp);
+    fseek(fp, -1 * (int)(sizeof(double) * v7_keys_length), SEEK_END);
+
+    n = fread(buffer, sizeof(double), v7_keys_length, fp);
+    if(n != v7_keys_length) {
+        *nerr = ERROR_READING_FILE;
+        return;
+    }
+    if(s->m->swap) {
+        sac_swap64(buffer, buffer, v7_keys_length);
+    }
+    for(i = 0; i < v7_keys_length; i++) {
+        sac_set_f64(s, v7_keys[i], buffer[i]);
+    }
+    fseek(fp, offset, SEEK_SET);
+}
+
+/**
+ * @brief      Fill the v7 header
+ *
+ * @details    Fill the v7 header through either reading the v7 header
+ *             or copying v6 header values to the v7 header.  Reading of
+ *             the v7 header will only occur if the header version equals 7.
+ *
+ * @ingroup    sac
+ * @memberof   sac
+ * @private
+ *
+ * @param      s      sac file
+ * @param      fp     file begin read from
+ * @param      nerr   0 on success, non-zero on error
+ *
+ * @return     return type
+ */
+void
+sac_header_v7_fill(sac *s, FILE *fp, int *nerr) {
+    switch(s->h->nvhdr) {
+    case SAC_HEADER_VERSION_7:
+        sac_header_read_v7(fp, s, nerr);
+        sac_copy_f64_to_f32(s);
+        break;
+    case SAC_HEADER_VERSION_6:
+        sac_copy_f32_to_f64(s);
+        break;
+    }
+
+}
+
+/**
+ * @brief      Write a set of buffers to a file descriptor at an offset
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Write all buffers in \p iov with as few system calls as
+ *             possible, a single pwritev() in the usual case.  Short writes
+ *             are continued.  \p iov is modified in the process.
+ *
+ * @param      fd    file descriptor to write to
+ * @param      iov   buffers to write
+ * @param      n     number of buffers in \p iov
+ * @param      off   offset in the file to write at, updated on return
+ *
+ * @return     status code, 0 on success, ERROR_WRITING_FILE on failure
+ */
+static int
+sac_pwritev_all(int fd, struct iovec *iov, int n, off_t *off) {
+    ssize_t w = 0;
+    while(n > 0) {
+#ifdef HAVE_FUNC_PWRITEV
+        w = pwritev(fd, iov, n, *off);
+#else
+        w = pwrite(fd, iov->iov_base, iov->iov_len, *off);
+#endif /* HAVE_FUNC_PWRITEV */
+        if(w < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            return ERROR_WRITING_FILE;
+        }
+        *off += w;
+        while(n > 0 && (size_t) w >= iov->iov_len) {
+            w -= (ssize_t) iov->iov_len;
+            iov++;
+            n--;
+        }
+        if(n > 0) {
+            iov->iov_base = (char *) iov->iov_base + w;
+            iov->iov_len -= (size_t) w;
+        }
+    }
+    return SAC_OK;
+}
+
+/**
+ * @brief      Write a sac file to a file descriptor with vectored writes
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    The header, data components and v7 footer are gathered into
+ *             a single set of buffers and written with one pwritev(),
+ *             starting at the beginning of the file.  Data to be byteswapped
+ *             is converted into a bounded bounce buffer; files whose data
+ *             fits in the bounce buffer are still written with a single call,
+ *             larger files are written in bounce buffer sized pieces.  Packed
+ *             data is built in memory and written in the same single call.
+ *             The sac file is not modified.
+ *
+ * @param      s      sac file to write
+ * @param      fd     file descriptor open for writing
+ * @param      off    offset to write at, the end of the written data on return
+ * @param      swap   if the header and data should be byteswapped
+ * @param      flags  write flags
+ *                    - SAC_WRITE_PREALLOCATE - preallocate the file with
+ *                      fallocate(), if available
+ *                    - SAC_WRITE_PACK - pack the data, see sac_pack(), also
+ *                      done for files read with packed data and files with
+ *                      a quantization error set, see sac_set_quantize()
+ *
+ * @return     status code, 0 on success, non-zero on failure
+ */
+static int
+sac_write_vectored(const sac *s, int fd, off_t *off, int swap, int flags) {
+    int j = 0, niov = 0, nerr = 0;
+    int pack = (flags & SAC_WRITE_PACK) || s->m->pack || s->m->quantize > 0.0;
+    size_t i = 0, k = 0, used = 0, plen = 0;
+    size_t n = (size_t) s->h->npts;
+    struct iovec iov[4];
+    char hdr[SAC_HEADER_SIZE];
+    char v7[sizeof(sac_f64)];
+    float buf[SAC_WRITE_BUFFER];
+    unsigned char *packed = NULL;
+
+    if(pack && !(packed = sac_pack(s, swap, &plen))) {
+        return ERROR_WRITING_FILE;
+    }
+#ifdef HAVE_FUNC_FALLOCATE
+    if(flags & SAC_WRITE_PREALLOCATE) {
+        // Failure here is not fatal, e.g. file systems without support
+        (void) fallocate(fd, 0, *off, (pack) ? SAC_HEADER_SIZE + (off_t) (plen + sizeof v7) :
+                                               sac_size((sac *) s));
+    }
+#endif /* HAVE_FUNC_FALLOCATE */
+
+    sac_header_encode(s, hdr, swap);
+    if(pack) {
+        sac_header_pack_mark(hdr, swap);
+        iov[niov].iov_base = hdr;
+        iov[niov++].iov_len = sizeof hdr;
+        iov[niov].iov_base = packed;
+        iov[niov++].iov_len = plen;
+    } else {
+        iov[niov].iov_base = hdr;
+        iov[niov++].iov_len = sizeof hdr;
+    }
+
+    for(j = 0; !pack && j < sac_comps((sac *) s); j++) {
+        const float *p = (j == 0) ? s->y : s->x;
+        if(!swap) {
+            iov[niov].iov_base = (void *) p;
+            iov[niov++].iov_len = n * sizeof(float);
+            continue;
+        }
+        for(i = 0; i < n; i += k) {
+            if(used == SAC_WRITE_BUFFER) {
+                if((nerr = sac_pwritev_all(fd, iov, niov, off)) != SAC_OK) {
+                    return nerr;
+                }
+                niov = 0;
+                used = 0;
+            }
+            k = MIN(n - i, SAC_WRITE_BUFFER - used);
+            sac_swap32(buf + used, p + i, k);
+            iov[niov].iov_base = buf + used;
+            iov[niov++].iov_len = k * sizeof(float);
+            used += k;
+        }
+    }
+    if(s->h->nvhdr == SAC_HEADER_VERSION_7) {
+        sac_header_v7_encode(s, v7, swap);
+        iov[niov].iov_base = v7;
+        iov[niov++].iov_len = sizeof v7;
+    }
+    nerr = sac_pwritev_all(fd, iov, niov, off);
+    FREE(packed);
+    return nerr;
+}
+
+/**
+ * @brief      Prepare a sac file for writing
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    - Checks the number of points
+ *             - checks if the overwrite flag is "ok"
+ *             - updates the extra values (depmin, depmax, depmen), with
+ *               SAC_WRITE_DIRTY_EXTREMA only if the data was marked changed,
+ *               see sac_mark_data_dirty()
+ *             - updates the distance fields (dist, az, baz, gcarc) if
+ *               the locations changed
+ *             - checks and reports any time precison issues
+ *
+ *             Each step updates \p s, so concurrent writes of the same
+ *             file are only safe with SAC_WRITE_NO_UPDATE and data loaded
+ *
+ * @param      s           sac file to write
+ * @param      write_data  whether data will be written or just the header
+ * @param      flags       write flags, see sac_write_with_flags(), to skip
+ *                         the extrema, distance or precision updates
+ *
+ * @return     status code, 0 on success, non-zero on failure
+ */
+static int
+sac_write_prepare(sac *s, int write_data, int flags) {
+    int nerr = 0;
+    if(write_data && ((nerr = sac_check_npts(s->h->npts)) != SAC_OK)) {
+        return nerr;
+    }
+    if(write_data && !s->m->data_read && ((nerr = sac_data_load(s)) != SAC_OK)) {
+        return nerr;
+    }
+    if((nerr = sac_check_lovrok(s->h->lovrok)) != SAC_OK) {
+        return nerr;
+    }
+    if(write_data && !(flags & SAC_WRITE_NO_EXTREMA) &&
+       (s->m->data_dirty || !(flags & SAC_WRITE_DIRTY_EXTREMA))) {
+        sac_extrema(s);
+    }
+    if(!(flags & SAC_WRITE_NO_DISTAZ)) {
+        sac_update_distaz(s);
+    }
+    if(!(flags & SAC_WRITE_NO_PRECISION)) {
+        sac_check_time_precision(s);
+    }
+    return SAC_OK;
+}
+
+/**
+ * @brief      write a sac file to a file descriptor
+ *
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    write a sac file, header and data, to an open file descriptor
+ *             starting at the beginning of the file.  The whole file is
+ *             written with a single vectored write, pwritev(), when possible.
+ *             The file descriptor is not closed and the file is not truncated.
+ *             The byte order is the byte order of the file as read.
+ *
+ * @param      s      sac file to write
+ * @param      fd     file descriptor open for writing
+ * @param      flags  write flags
+ *                    - SAC_WRITE_PREALLOCATE - preallocate sac_size() bytes
+ *                      with fallocate(), if available
+ *                    - SAC_WRITE_NO_DISTAZ, SAC_WRITE_NO_EXTREMA,
+ *                      SAC_WRITE_NO_PRECISION - skip header updates, see
+ *                      sac_write_with_flags()
+ * @param      nerr   status code, 0 on success, non-zero on error
+ *
+ * @code
+ * int nerr = 0;
+ * sac *s = sac_read("t/test_io_big.sac", &nerr);
+ * assert_eq(nerr, 0);
+ * int fd = open("t/test_io_fd.sac.tmp", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+ * assert(fd >= 0);
+ * sac_write_fd(s, fd, SAC_WRITE_PREALLOCATE, &nerr);
+ * assert_eq(nerr, 0);
+ * close(fd);
+ * sac *c = sac_read("t/test_io_fd.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(c->m->swap, s->m->swap);
+ * assert_eq(memcmp(c->y, s->y, sizeof(float) * s->h->npts), 0);
+ * @endcode
+ */
+void
+sac_write_fd(sac *s, int fd, int flags, int *nerr) {
+    off_t off = 0;
+    if((*nerr = sac_write_prepare(s, TRUE, flags)) != SAC_OK) {
+        return;
+    }
+    *nerr = sac_write_vectored(s, fd, &off, s->m->swap, flags);
+}
+
+/**
+ * @brief      Open a new temporary file next to a file
+ *
+ * @private
+ * @ingroup    sac
+ *
+ * @details    The temporary file is created in the same directory as
+ *             \p filename, so it can be renamed over it.  If \p filename
+ *             exists, the temporary file takes its permissions and, where
+ *             permitted, its owner; otherwise it has the permissions of a
+ *             file created by sac_write()
+ *
+ * @param      filename  file the temporary file will replace
+ * @param      tmp       name of the temporary file, free with free()
+ *
+ * @return     file descriptor of the temporary file, -1 on failure
+ */
+static int
+sac_tmp_open(char *filename, char **tmp) {
+    static atomic_uint count;
+    int i = 0, fd = -1;
+    struct stat st;
+    size_t n = strlen(filename) + 64;
+    char *base = strrchr(filename, '/');
+    int dn = (base) ? (int) (base - filename + 1) : 0;
+
+    if(!(*tmp = malloc(n))) {
+        return -1;
+    }
+    base = filename + dn;
+    for(i = 0; i < 100 && fd < 0; i++) {
+        snprintf(*tmp, n, "%.*s.%s.%ld.%u.tmp", dn, filename, base, (long) getpid(),
+                 atomic_fetch_add_explicit(&count, 1, memory_order_relaxed));
+        if((fd = open(*tmp, O_RDWR | O_CREAT | O_EXCL, 0666)) < 0 && errno != EEXIST) {
+            break;
+        }
+    }
+    // Owner first, changing it may clear set-user-ID and set-group-ID bits
+    if(fd >= 0 && stat(filename, &st) == 0 &&
+       ((fchown(fd, st.st_uid, st.st_gid) != 0 && errno != EPERM) ||
+        fchmod(fd, st.st_mode & 07777) != 0)) {
+        close(fd);
+        unlink(*tmp);
+        fd = -1;
+    }
+    if(fd < 0) {
+        FREE(*tmp);
+    }
+    return fd;
+}
+
+/**
+ * @brief      Flush the directory entry of a file to disk
+ *
+ * @private
+ * @ingroup    sac
+ *
+ * @param      filename  file whose directory is flushed
+ *
+ * @return     0 on success, ERROR_WRITING_FILE on failure
+ */
+static int
+sac_dir_sync(char *filename) {
+    int fd = -1, nerr = SAC_OK;
+    char *p = strrchr(filename, '/');
+    char *dir = (p) ? strndup(filename, (size_t) (p - filename + 1)) : strdup(".");
+    if(!dir || (fd = open(dir, O_RDONLY | O_DIRECTORY)) < 0) {
+        FREE(dir);
+        return ERROR_WRITING_FILE;
+    }
+    if(fsync(fd) != 0) {
+        nerr = ERROR_WRITING_FILE;
+    }
+    close(fd);
+    FREE(dir);
+    return nerr;
+}
+
+/**
+ * @brief      Check if two files are in the same directory
+ *
+ * @private
+ *
+ * @param      a     first file
+ * @param      b     second file
+ *
+ * @return     1 if in the same directory, 0 otherwise
+ */
+static int
+sac_same_dir(const char *a, const char *b) {
+    const char *pa = strrchr(a, '/');
+    const char *pb = strrchr(b, '/');
+    if(!pa || !pb) {
+        return (!pa && !pb);
+    }
+    return (pa - a == pb - b && strncmp(a, b, (size_t) (pa - a)) == 0);
+}
+
+/**
+ * @brief      Write prepared sac files to disk
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Write files, each with a single vectored write, honoring the
+ *             atomic and fsync write flags, see sac_write_with_flags().
+ *             Atomic writes first write all files to temporary files; if
+ *             writing any fails, the temporary files are removed and no file
+ *             is replaced.  The temporary files are then renamed into place
+ *             one at a time, so each file is replaced atomically, but the
+ *             group is not: a failed rename or a crash while renaming leaves
+ *             the files before it replaced and the rest not.  With
+ *             SAC_WRITE_FSYNC_GROUP write back of all files is started before
+ *             waiting on any of them.
+ *
+ * @param      s         sac files to write, already prepared
+ * @param      filename  files to write to
+ * @param      swap      whether to swap each file before writing
+ * @param      n         number of files
+ * @param      flags     write flags
+ *
+ * @return     status code, 0 on success, non-zero on failure
+ */
+static int
+sac_write_commit(sac **s, char **filename, const int *swap, int n, int flags) {
+    int i = 0, nerr = SAC_OK;
+    int sync = flags & (SAC_WRITE_FSYNC | SAC_WRITE_FSYNC_GROUP);
+    off_t off = 0;
+    int *fd = calloc((size_t) n, sizeof(int));
+    char **tmp = calloc((size_t) n, sizeof(char *));
+
+    if(!fd || !tmp) {
+        nerr = ERROR_WRITING_FILE;
+        goto done;
+    }
+    for(i = 0; i < n; i++) {
+        fd[i] = -1;
+    }
+    for(i = 0; i < n && nerr == SAC_OK; i++) {
+        if(flags & SAC_WRITE_ATOMIC) {
+            fd[i] = sac_tmp_open(filename[i], &tmp[i]);
+        } else {
+            fd[i] = open(filename[i], O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        }
+        if(fd[i] < 0) {
+            nerr = ERROR_OPENING_FILE;
+            break;
+        }
+        off = 0;
+        nerr = sac_write_vectored(s[i], fd[i], &off, swap[i], flags);
+        if(nerr == SAC_OK && (flags & SAC_WRITE_FSYNC) && fdatasync(fd[i]) != 0) {
+            nerr = ERROR_WRITING_FILE;
+        }
+    }
+    if(nerr == SAC_OK && (flags & SAC_WRITE_FSYNC_GROUP)) {
+#ifdef HAVE_FUNC_SYNC_FILE_RANGE
+        for(i = 0; i < n; i++) {
+            (void) sync_file_range(fd[i], 0, 0, SYNC_FILE_RANGE_WRITE);
+        }
+#endif /* HAVE_FUNC_SYNC_FILE_RANGE */
+        for(i = 0; i < n; i++) {
+            if(fdatasync(fd[i]) != 0) {
+                nerr = ERROR_WRITING_FILE;
+            }
+        }
+    }
+    for(i = 0; i < n; i++) {
+        if(fd[i] >= 0 && close(fd[i]) != 0 && nerr == SAC_OK) {
+            nerr = ERROR_WRITING_FILE;
+        }
+    }
+    for(i = 0; i < n && nerr == SAC_OK; i++) {
+        if(tmp[i] && rename(tmp[i], filename[i]) != 0) {
+            nerr = ERROR_WRITING_FILE;
+            break;
+        }
+        FREE(tmp[i]);
+    }
+    for(i = 0; i < n && nerr == SAC_OK && sync; i++) {
+        if(i == 0 || !sac_same_dir(filename[i], filename[i-1])) {
+            nerr = sac_dir_sync(filename[i]);
+        }
+    }
+ done:
+    for(i = 0; tmp && i < n; i++) {
+        if(tmp[i]) {
+            unlink(tmp[i]);
+            FREE(tmp[i]);
+        }
+    }
+    FREE(fd);
+    FREE(tmp);
+    return nerr;
+}
+
+/**
+ * @brief      write many sac files to disk
+ *
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    write many sac files to disk, header and data, in their
+ *             original byte order.  With SAC_WRITE_ATOMIC all files are
+ *             written to temporary files before any is renamed into place,
+ *             so if writing any file fails, none are replaced.  Each file is
+ *             replaced atomically, but the group is not: the files are
+ *             renamed one at a time, and a failure or crash while renaming
+ *             can leave only some of them replaced.  With
+ *             SAC_WRITE_FSYNC_GROUP the files are flushed
+ *             to disk together, a group commit, which is much faster than
+ *             flushing each file with SAC_WRITE_FSYNC.
+ *
+ * @param      s          sac files to write
+ * @param      filename   filenames to write the sac files to
+ * @param      n          number of files
+ * @param      flags      write flags, see sac_write_with_flags()
+ * @param      nerr       status code, 0 on success, non-zero on failure
+ *
+ * @code
+ * int nerr = 0;
+ * sac *s[2] = { sac_read("t/test_io_big.sac", &nerr),
+ *               sac_read("t/test_io_small.sac", &nerr) };
+ * char *files[2] = { "t/test_io_group0.sac.tmp", "t/test_io_group1.sac.tmp" };
+ * sac_write_many(s, files, 2, SAC_WRITE_ATOMIC | SAC_WRITE_FSYNC_GROUP, &nerr);
+ * assert_eq(nerr, 0);
+ * for(int i = 0; i < 2; i++) {
+ *     sac *c = sac_read(files[i], &nerr);
+ *     assert_eq(nerr, 0);
+ *     assert_eq(memcmp(c->y, s[i]->y, sizeof(float) * s[i]->h->npts), 0);
+ * }
+ *
+ * // Nothing is replaced if any file fails
+ * char *bad[2] = { "t/test_io_group0.sac.tmp", "t/no-such-directory/file.sac" };
+ * s[0]->y[0] += 1.0;
+ * sac_write_many(s, bad, 2, SAC_WRITE_ATOMIC, &nerr);
+ * assert_ne(nerr, 0);
+ * sac *c = sac_read(files[0], &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(c->y[0], s[0]->y[0] - 1.0);
+ * @endcode
+ */
+void
+sac_write_many(sac **s, char **filename, int n, int flags, int *nerr) {
+    int i = 0;
+    int *swap = NULL;
+    *nerr = SAC_OK;
+    if(n <= 0) {
+        return;
+    }
+    if(!(swap = calloc((size_t) n, sizeof(int)))) {
+        *nerr = ERROR_WRITING_FILE;
+        return;
+    }
+    for(i = 0; i < n; i++) {
+        if((*nerr = sac_write_prepare(s[i], TRUE, flags)) != SAC_OK) {
+            FREE(swap);
+            return;
+        }
+        swap[i] = s[i]->m->swap;
+    }
+    *nerr = sac_write_commit(s, filename, swap, n, flags);
+    FREE(swap);
+}
+
+/**
+ * @brief      internal sac data writing function
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    internal sac data writing function.
+ *             - prepares the file, see sac_write_prepare()
+ *             - create a new file if writing data, atomically with
+ *               SAC_WRITE_ATOMIC, see sac_write_commit(), or update the
+ *               header of and existing file
+ *             - write the header, data and v7 footer in a single vectored
+ *               write, see sac_write_vectored(), or
+ *             - write the header and v7 footer of an existing file
+ *
+ * @param      s           sac file to write
+ * @param      filename    filename to write to
+ * @param      write_data  whether to write data or just the header
+ * @param      swap        whether to swap the data and header before writing,
+ *                         when only writing the header, the byte order of the
+ *                         existing file is used
+ * @param      flags       write flags, see sac_write_with_flags()
+ * @param      nerr        status code, 0 on success, non-zero on failure
+ *
+ */
+void
+sac_write_internal(sac *s, char *filename, int write_data, int swap, int flags, int *nerr) {
+    int fd = -1, pack = FALSE;
+    off_t end = 0;
+    struct stat st;
+    sac *old = NULL;
+    char hdr[SAC_HEADER_SIZE];
+    char v7[sizeof(sac_f64)];
+
+    if((*nerr = sac_write_prepare(s, write_data, flags)) != SAC_OK) {
+        return;
+    }
+
+    if(write_data) {
+        // Truncate or create, or write a temporary file and rename it
+        *nerr = sac_write_commit(&s, &filename, &swap, 1, flags);
+        return;
+    }
+
+    if(!(old = sac_read_header(filename, nerr))) {
+        return;
+    }
+    if(sac_int(s, SAC_NPTS) != sac_int(old, SAC_NPTS) ||
+       sac_int(s, SAC_HDR)  != sac_int(old, SAC_HDR)) {
+        sac_free(old);
+        *nerr = ERROR_WRITING_FILE;
+        return;
+    }
+    swap = old->m->swap; // Header must match the existing data
+    pack = old->m->pack;
+    sac_free(old);
+    old = NULL;
+
+    // Open existing file for writing
+    if((fd = open(filename, O_WRONLY)) < 0) {
+        *nerr = ERROR_FILE_DOES_NOT_EXIST;
+        return;
+    }
+    // The footer of packed data is at the end of the file
+    end = sac_size(s);
+    if(pack && fstat(fd, &st) == 0) {
+        end = st.st_size;
+    }
+    sac_header_encode(s, hdr, swap);
+    if(pack) {
+        sac_header_pack_mark(hdr, swap);
+    }
+    if(pwrite(fd, hdr, sizeof hdr, 0) != (ssize_t) sizeof hdr) {
+        *nerr = ERROR_WRITING_FILE;
+    }
+    if(*nerr == SAC_OK && s->h->nvhdr == SAC_HEADER_VERSION_7) {
+        sac_header_v7_encode(s, v7, swap);
+        if(pwrite(fd, v7, sizeof v7, end - (off_t) sizeof v7) != (ssize_t) sizeof v7) {
+            *nerr = ERROR_WRITING_FILE;
+        }
+    }
+    close(fd);
+}
+/**
+ * @brief      read sac data from a file pointer
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    read sac data from a file pointer.  Memory should already
+ *             be allocated and data will be swapped if the \p swap flag
+ *             is defined in the meta data.  depmin, depmax and depmen are
+ *             computed as the data is read, see sac_extrema()
+ *
+ * @param      s    sac data to read data into
+ * @param      fp   file pointer to read data from
+ *
+ * @return     0 on success, -1 if npts < 0, ERROR_READING_FILE on read error
+ */
+int
+sac_data_read(sac *s, FILE *fp) {
+    return sac_data_read_flags(s, fp, 0);
+}
+
+/**
+ * @brief      read sac data from a file pointer with read flags
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    read sac data as sac_data_read(), depmin, depmax and depmen
+ *             are not computed if SAC_READ_NO_EXTREMA is set in \p flags.
+ *             Packed data is unpacked, see sac_pack_read()
+ *
+ * @param      s      sac data to read data into
+ * @param      fp     file pointer to read data from
+ * @param      flags  read flags, see sac_read_with_flags()
+ *
+ * @return     0 on success, -1 if npts < 0, ERROR_READING_FILE on read error
+ */
+static int
+sac_data_read_flags(sac *s, FILE *fp, int flags) {
+    float *p;
+    int i;
+    int nerr;
+    size_t n;
+    extrema e;
+    if(s->h->npts <= 0) {
+        return -1;
+    }
+    n = (size_t) s->h->npts;
+    extrema_init(&e);
+    for(i = 0; i < sac_comps(s); i++) {
+        p = (i == 0) ? s->y : s->x ;
+        if(s->m->pack) {
+            nerr = sac_pack_read(s, fp, n, i, 0, n, p,
+                                 (i == 0 && !(flags & SAC_READ_NO_EXTREMA)) ? &e : NULL, NULL);
+        } else {
+            nerr = sac_data_read_fused(fp, p, n, s->m->swap,
+                                       (i == 0 && !(flags & SAC_READ_NO_EXTREMA)) ? &e : NULL);
+        }
+        if(nerr) {
+            return nerr;
+        }
+    }
+    if(!(flags & SAC_READ_NO_EXTREMA)) {
+        extrema_set(s, &e);
+    }
+    return 0;
+}
+
+/**
+ * @brief Check the Sac Header Version
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details This routine checks the header version for a number between
+ *          1 and \p SAC_HEADER_MAJOR_VERSION.  It check both the swapped
+ *          and non-swapped version to determine the byte-order of the file
+ *
+ * @param hdr    Sac Header to Check
+ * @param nerr   status code, 0 on success, non-zero on failure
+ *
+ * @return if header needs to be swapped or not or is not a sac file
+ *    - 1 if file needs to be swapped
+ *    - 0 if file does not need to be swapped
+ *    - -1 if there was an error checking the header
+ *
+ */
+int
+sac_check_header_version(float *hdr, int *nerr) {
+    int lswap;
+    int *ver;
+
+    lswap = FALSE;
+    *nerr = SAC_OK;
+    /* determine if the data needs to be swapped. */
+    ver = (int *) (hdr + SAC_VERSION_LOCATION);
+    if (*ver < 1 || *ver > SAC_HEADER_MAX_VERSION) {
+        byteswap_bsd((void *) ver, SAC_HEADER_SIZEOF_NUMBER);
+
+        if (*ver < 1 || *ver > SAC_HEADER_MAX_VERSION) {
+            *nerr = ERROR_NOT_A_SAC_FILE;
+            printf("not in sac format, nor byteswapped sac format.");
+            return -1;
+        } else {
+            /* swap back, so it can be */
+            byteswap_bsd((void *) ver, SAC_HEADER_SIZEOF_NUMBER);
+            lswap = TRUE;
+        }
+    }
+    return lswap;
+}
+
+
+/**
+ * @brief      Read a sac header from a file pointer
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Read a sac header from a file pointer
+ *
+ * @param      s   sac file to place header into
+ * @param      fp  file pointer to read header from
+ *
+ * @return     status code, 0 on success, non-zero on failure
+ */
+int
+sac_header_read(sac *s, FILE *fp) {
+    int nerr;
+    size_t n;
+    char str[SAC_HEADER_STRINGS * 8];
+
+    n = SAC_HEADER_NUMBERS;
+    if(fread((char *) s->h, sizeof(float), n, fp) != n) {
+        return ERROR_NOT_A_SAC_FILE;
+    }
+    s->m->swap = sac_check_header_version((float *) s->h, &nerr);
+    if(nerr) {
+        return ERROR_NOT_A_SAC_FILE;
+    }
+    if(s->m->swap) {
+        sac_header_swap((float *) s->h);
+    }
+
+    if(fread(str, 8, SAC_HEADER_STRINGS, fp) != SAC_HEADER_STRINGS) {
+        return ERROR_READING_FILE;
+    }
+    sac_copy_strings_add_terminator(s, str);
+    sac_header_pack(s);
+
+    return 0;
+}
+/**
+ * @brief      Read a sac header from a memory buffer
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Read a sac header from a memory buffer holding at least
+ *             \p SAC_HEADER_SIZE bytes, as laid out in a file on disk.
+ *             The byte order is determined and the header is converted to
+ *             the system's byte order. The buffer is not modified.
+ *
+ * @param      s    sac file to place header into
+ * @param      buf  memory buffer to read header from
+ *
+ * @return     status code, 0 on success, non-zero on failure
+ */
+int
+sac_header_read_buffer(sac *s, const char *buf) {
+    int nerr = 0;
+    memcpy(s->h, buf, SAC_HEADER_NUMBERS_SIZE_BYTES_FILE);
+    s->m->swap = sac_check_header_version((float *) s->h, &nerr);
+    if(nerr) {
+        return ERROR_NOT_A_SAC_FILE;
+    }
+    if(s->m->swap) {
+        sac_header_swap((float *) s->h);
+    }
+    sac_copy_strings_add_terminator(s, (char *) buf + SAC_HEADER_NUMBERS_SIZE_BYTES_FILE);
+    sac_header_pack(s);
+    return SAC_OK;
+}
+
+/**
+ * @brief      Fill the v7 header from a memory buffer
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Fill the v7 header from a memory buffer, this is the buffer
+ *             analog of sac_header_v7_fill().  If the header version is 7,
+ *             \p buf must point at the v7 footer following the data.
+ *             Otherwise v6 values are copied into the v7 header and \p buf
+ *             is not accessed.
+ *
+ * @param      s     sac file
+ * @param      buf   v7 footer
+ *
+ */
+void
+sac_header_v7_fill_buffer(sac *s, const char *buf) {
+    double buffer[v7_keys_length];
+    switch(s->h->nvhdr) {
+    case SAC_HEADER_VERSION_7:
+        memcpy(buffer, buf, sizeof(buffer));
+        if(s->m->swap) {
+            sac_swap64(buffer, buffer, v7_keys_length);
+        }
+        for(size_t i = 0; i < v7_keys_length; i++) {
+            sac_set_f64(s, v7_keys[i], buffer[i]);
+        }
+        sac_copy_f64_to_f32(s);
+        break;
+    case SAC_HEADER_VERSION_6:
+        sac_copy_f32_to_f64(s);
+        break;
+    }
+}
+
+/**
+ * @brief      Convert a system error to a sac status code
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @param      err   system error, errno
+ *
+ * @return     status code
+ *             - ERROR_FILE_DOES_NOT_EXIST if the file does not exist
+ *             - ERROR_READING_FILE otherwise
+ */
+static int
+sac_errno_to_nerr(int err) {
+    switch(err) {
+    case ENOENT:       /* File does not exit */
+        return ERROR_FILE_DOES_NOT_EXIST;
+    default:
+        break;
+    }
+    return ERROR_READING_FILE;
+}
+
+/**
+ * @brief      Check and clear the marker of a file being written
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Files being written with a sac_writer carry a marker and a
+ *             sequence number, stored twice, in unused header words:
+ *             - unused25 - SAC_LIVE_MAGIC while the file is being written
+ *             - unused26 - begin counter, sequence number of the header
+ *               publication, written before the header
+ *             - unused27 - end counter, written after the header
+ *
+ *             Each publication is three ordered writes, see
+ *             sac_header_publish(): the begin counter, the whole header
+ *             with the previous end counter, then the end counter.  Data is
+ *             always written before the header that publishes it, so the
+ *             header npts describes a prefix of samples already in the
+ *             file.  The file may be longer than the header describes and
+ *             the v7 footer is only written when the file is closed.
+ *             Differing counters indicate a header read while it was being
+ *             replaced; the header should be read again.  Equal counters
+ *             within a header are not enough on their own, as the words of
+ *             a header may be read in any order; readers of a file also read
+ *             the end counter before and the begin counter after the header,
+ *             see sac_header_live_confirm().
+ *             On success the marker is removed from the header and recorded
+ *             in the meta data.
+ *
+ * @param      s     sac file with the header just read
+ *
+ * @return     1 if the header is consistent, 0 if it should be read again
+ */
+static int
+sac_header_live(sac *s) {
+    s->m->live = FALSE;
+    s->m->seq = 0;
+    if(s->h->unused25 != SAC_LIVE_MAGIC) {
+        return 1;
+    }
+    if(s->h->unused26 != s->h->unused27) {
+        return 0;
+    }
+    s->m->live = TRUE;
+    s->m->seq = s->h->unused26;
+    s->h->unused25 = SAC_INT_UNDEFINED;
+    s->h->unused26 = SAC_INT_UNDEFINED;
+    s->h->unused27 = SAC_INT_UNDEFINED;
+    return 1;
+}
+
+/**
+ * @brief      Check the header of a file being written was not replaced while
+ *             it was read
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    The end counter, read before the header, and the begin
+ *             counter, read after it, must both match the sequence number
+ *             of the header, see sac_header_live().  Then the header was
+ *             completely written before it was read and no new header was
+ *             started until it was read.
+ *
+ * @param      s      sac file with a live header, see sac_header_live()
+ * @param      begin  begin counter, unused26, as stored on disk
+ * @param      end    end counter, unused27, as stored on disk
+ *
+ * @return     1 if the header is consistent, 0 if it should be read again
+ */
+static int
+sac_header_live_confirm(const sac *s, const char *begin, const char *end) {
+    int32_t b = 0, e = 0;
+    if(s->m->swap) {
+        sac_swap32(&b, begin, 1);
+        sac_swap32(&e, end, 1);
+    } else {
+        memcpy(&b, begin, sizeof b);
+        memcpy(&e, end, sizeof e);
+    }
+    return (b == s->m->seq && e == s->m->seq);
+}
+
+/**
+ * @brief      Wait before reading the header of a file being written again
+ *
+ * @private
+ * @ingroup    sac
+ *
+ * @details    The first SAC_LIVE_SPIN attempts are made immediately, later
+ *             attempts wait a millisecond so a busy writer can finish
+ *
+ * @param      i     attempts made so far, less one
+ */
+static void
+sac_header_live_backoff(int i) {
+    if(i >= SAC_LIVE_SPIN) {
+        poll(NULL, 0, 1);
+    }
+}
+
+/**
+ * @brief      Write the header of a file being written for concurrent readers
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Mark the header as being written with sequence number \p seq
+ *             and write, in order, the begin counter, the header with the
+ *             previous end counter, then the end counter, see
+ *             sac_header_live().  The header is written in the system's byte
+ *             order to \p fd or, if \p fd is negative, into \p map.  The sac
+ *             file is not modified.
+ *
+ * @param      s     sac file to write the header of
+ * @param      fd    file descriptor open for writing, or -1
+ * @param      map   writable mapping of the file, if \p fd is -1
+ * @param      seq   sequence number of the publication
+ *
+ * @return     0 on success, ERROR_WRITING_FILE on failure
+ */
+static int
+sac_header_publish(sac *s, int fd, char *map, int seq) {
+    int un[3] = { s->h->unused25, s->h->unused26, s->h->unused27 };
+    off_t b = SAC_LIVE_BEGIN * SAC_HEADER_SIZEOF_NUMBER;
+    off_t e = SAC_LIVE_END * SAC_HEADER_SIZEOF_NUMBER;
+    int32_t end = seq;
+    char hdr[SAC_HEADER_SIZE];
+
+    s->h->unused25 = SAC_LIVE_MAGIC;
+    s->h->unused26 = seq;
+    s->h->unused27 = seq - 1;
+    sac_header_encode(s, hdr, FALSE);
+    s->h->unused25 = un[0];
+    s->h->unused26 = un[1];
+    s->h->unused27 = un[2];
+    if(fd < 0) {
+        memcpy(map + b, hdr + b, sizeof end);
+        atomic_thread_fence(memory_order_release);
+        memcpy(map, hdr, sizeof hdr);
+        atomic_thread_fence(memory_order_release);
+        memcpy(map + e, &end, sizeof end);
+        return SAC_OK;
+    }
+    if(pwrite(fd, hdr + b, sizeof end, b) != (ssize_t) sizeof end ||
+       pwrite(fd, hdr, sizeof hdr, 0) != (ssize_t) sizeof hdr ||
+       pwrite(fd, &end, sizeof end, e) != (ssize_t) sizeof end) {
+        return ERROR_WRITING_FILE;
+    }
+    return SAC_OK;
+}
+
+/**
+ * @brief      Check the size of a file against its header
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Completed files must match the size computed from the header.
+ *             Files still being written may hold more data than their header
+ *             describes and do not yet have a v7 footer.  The size of packed
+ *             data is not known from the header alone.
+ *
+ * @param      s     sac file with the header read
+ * @param      size  size of the file in bytes
+ *
+ * @return     0 on success, ERROR_NOT_A_SAC_FILE if the size is incorrect
+ */
+static int
+sac_size_check(sac *s, off_t size) {
+    off_t expected = sac_size(s);
+    if(s->m->pack) {
+        // Packed data is checked as it is read, see sac_pack_read()
+        expected = SAC_HEADER_SIZE + (off_t) sizeof(sac_pack_hdr);
+        if(s->h->nvhdr == SAC_HEADER_VERSION_7) {
+            expected += (off_t) sizeof(sac_f64);
+        }
+        if(size >= expected) {
+            return SAC_OK;
+        }
+    } else if(s->m->live) {
+        if(s->h->nvhdr == SAC_HEADER_VERSION_7) {
+            expected -= (off_t) sizeof(sac_f64);
+        }
+        if(size >= expected) {
+            return SAC_OK;
+        }
+    } else if(size == expected) {
+        return SAC_OK;
+    }
+    printf("sacio: Actual file size %lld != expected file size: %lld [npts: %d]\n",
+           (long long int) size, (long long int) expected, s->h->npts);
+    return ERROR_NOT_A_SAC_FILE;
+}
+
+/**
+ * @brief      Read a sac header from a file descriptor
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Read the header and, for v7 files, the footer with positioned
+ *             reads.  The file position of \p fd is not used or changed.
+ *             Headers of files still being written are read again until
+ *             consistent, see sac_header_live().  Compressed files are
+ *             reported as ERROR_COMPRESSED_FILE, see sac_read_compressed().
+ *
+ * @param      fd        file descriptor open for reading
+ * @param      filename  filename to store in the meta data
+ * @param      size      size of the file on return, may be NULL
+ * @param      nerr      status code, 0 on success, non-zero on failure
+ *
+ * @return     sac file with only the header read, NULL on failure
+ *
+ */
+static sac *
+sac_header_read_fd(int fd, char *filename, off_t *size, int *nerr) {
+    int i = 0;
+    ssize_t n = 0;
+    sac *s = NULL;
+    struct stat stbuf;
+    char buf[SAC_HEADER_SIZE];
+    char v7[sizeof(sac_f64)];
+    char begin[SAC_HEADER_SIZEOF_NUMBER], end[SAC_HEADER_SIZEOF_NUMBER];
+
+    s = sac_new();
+    s->m->filename = strdup(filename);
+    for(i = 0; ; i++) {
+        // Once a file is known to be written, see sac_header_live_confirm()
+        if(i > 0 && pread(fd, end, sizeof end, SAC_LIVE_END * SAC_HEADER_SIZEOF_NUMBER) != (ssize_t) sizeof end) {
+            *nerr = ERROR_READING_FILE;
+            goto error;
+        }
+        if((n = pread(fd, buf, sizeof buf, 0)) < 0) {
+            *nerr = ERROR_NOT_A_SAC_FILE;
+            goto error;
+        }
+        if(sac_compression(buf, (size_t) n) != SAC_COMPRESS_NONE) {
+            *nerr = ERROR_COMPRESSED_FILE;
+            goto error;
+        }
+        if(n != (ssize_t) sizeof buf) {
+            *nerr = ERROR_NOT_A_SAC_FILE;
+            goto error;
+        }
+        if((*nerr = sac_header_read_buffer(s, buf)) != SAC_OK) {
+            goto error;
+        }
+        if(sac_header_live(s) &&
+           (!s->m->live ||
+            (i > 0 && pread(fd, begin, sizeof begin, SAC_LIVE_BEGIN * SAC_HEADER_SIZEOF_NUMBER) == (ssize_t) sizeof begin &&
+             sac_header_live_confirm(s, begin, end)))) {
+            break;
+        }
+        if(i == SAC_LIVE_RETRY) {
+            *nerr = ERROR_READING_FILE;
+            goto error;
+        }
+        sac_header_live_backoff(i);
+    }
+    // Size after the header, data is published before the header
+    if(fstat(fd, &stbuf) != 0) {
+        *nerr = sac_errno_to_nerr(errno);
+        goto error;
+    }
+    if((*nerr = sac_size_check(s, stbuf.st_size)) != SAC_OK) {
+        goto error;
+    }
+    if(s->h->nvhdr == SAC_HEADER_VERSION_7 && !s->m->live) {
+        if(pread(fd, v7, sizeof v7, stbuf.st_size - (off_t) sizeof v7) != (ssize_t) sizeof v7) {
+            *nerr = ERROR_READING_FILE;
+            goto error;
+        }
+        sac_header_v7_fill_buffer(s, v7);
+    } else {
+        sac_copy_f32_to_f64(s);
+    }
+    if(size) {
+        *size = stbuf.st_size;
+    }
+    return s;
+ error:
+    sac_free(s);
+    return NULL;
+}
+
+/**
+ * @brief Read statistics, see sac_io_stats_get()
+ * @private
+ */
+static struct {
+    atomic_uint_least64_t files;
+    atomic_uint_least64_t bytes;
+    atomic_uint_least64_t ns;
+    atomic_uint_least64_t bulk_files;
+    atomic_uint_least64_t dropped;
+} sac_io_stat;
+
+/**
+ * @brief      Get read statistics
+ *
+ * @ingroup    sac
+ *
+ * @details    Get the number of files and bytes read, the time spent
+ *             reading and the bytes released from the page cache by
+ *             bulk reads since the start of the program or the last
+ *             sac_io_stats_reset().  Statistics are collected by
+ *             sac_read(), sac_read_with_flags(), sac_read_with_cut(),
+ *             sac_read_with_cut_flags() and lazy data loads, sac_data().
+ *
+ * @param      st   output statistics
+ *
+ * @code
+ * int nerr = 0;
+ * sac_io_stats st;
+ * sac_io_stats_reset();
+ * sac *s = sac_read_with_flags("t/test_io_big.sac", SAC_READ_BULK, &nerr);
+ * assert_eq(nerr, 0);
+ * sac_io_stats_get(&st);
+ * assert_eq(st.files, 1);
+ * assert_eq(st.bulk_files, 1);
+ * assert_eq(st.bytes, (uint64_t) sac_size(s));
+ * assert(st.dropped == 0 || st.dropped == st.bytes);
+ *
+ * // Cut window hints only cover the data within the window
+ * sac *c = sac_read_with_cut_flags("t/test_io_big.sac", "Z", 10.0, "Z", 30.0,
+ *                                  CutUseBE, SAC_READ_BULK, &nerr);
+ * assert_eq(nerr, 0);
+ * sac_io_stats_get(&st);
+ * assert_eq(st.files, 2);
+ * assert_eq(st.bytes, (uint64_t) (sac_size(s) + sac_size(c)));
+ *
+ * sac_io_stats_reset();
+ * sac_io_stats_get(&st);
+ * assert_eq(st.files, 0);
+ * @endcode
+ */
+void
+sac_io_stats_get(sac_io_stats *st) {
+    st->files      = atomic_load_explicit(&sac_io_stat.files, memory_order_relaxed);
+    st->bytes      = atomic_load_explicit(&sac_io_stat.bytes, memory_order_relaxed);
+    st->ns         = atomic_load_explicit(&sac_io_stat.ns, memory_order_relaxed);
+    st->bulk_files = atomic_load_explicit(&sac_io_stat.bulk_files, memory_order_relaxed);
+    st->dropped    = atomic_load_explicit(&sac_io_stat.dropped, memory_order_relaxed);
+}
+
+/**
+ * @brief      Reset read statistics
+ *
+ * @ingroup    sac
+ *
+ * @details    Reset read statistics to zero, see sac_io_stats_get()
+ *
+ */
+void
+sac_io_stats_reset(void) {
+    atomic_store_explicit(&sac_io_stat.files, 0, memory_order_relaxed);
+    atomic_store_explicit(&sac_io_stat.bytes, 0, memory_order_relaxed);
+    atomic_store_explicit(&sac_io_stat.ns, 0, memory_order_relaxed);
+    atomic_store_explicit(&sac_io_stat.bulk_files, 0, memory_order_relaxed);
+    atomic_store_explicit(&sac_io_stat.dropped, 0, memory_order_relaxed);
+}
+
+/**
+ * @brief      Monotonic clock in nanoseconds, for read statistics
+ *
+ * @private
+ */
+static uint64_t
+sac_io_clock(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t) t.tv_sec * 1000000000u + (uint64_t) t.tv_nsec;
+}
+
+/**
+ * @brief      Give access hints for a range about to be read
+ *
+ * @private
+ * @ingroup    sac
+ *
+ * @details    For bulk reads, SAC_READ_BULK, the range \p off to
+ *             \p off + \p len is read sequentially and the kernel is
+ *             asked to start reading it ahead.  Nothing is done otherwise
+ *             or if posix_fadvise() is not available
+ *
+ * @param      fd     file descriptor
+ * @param      off    offset of the range in bytes
+ * @param      len    length of the range in bytes
+ * @param      flags  read flags, see sac_read_with_flags()
+ *
+ */
+static void
+sac_io_advise(int fd, off_t off, off_t len, int flags) {
+#ifdef HAVE_FUNC_POSIX_FADVISE
+    if(flags & SAC_READ_BULK) {
+        (void) posix_fadvise(fd, off, len, POSIX_FADV_SEQUENTIAL);
+        (void) posix_fadvise(fd, off, len, POSIX_FADV_WILLNEED);
+    }
+#else
+    UNUSED(fd);
+    UNUSED(off);
+    UNUSED(len);
+    UNUSED(flags);
+#endif /* HAVE_FUNC_POSIX_FADVISE */
+}
+
+/**
+ * @brief      Account for a completed read
+ *
+ * @private
+ * @ingroup    sac
+ *
+ * @details    Add a read to the statistics.  For bulk reads the file is
+ *             dropped from the page cache, so a single scan of a large
+ *             archive does not evict pages used by others
+ *
+ * @param      fd     file descriptor read from
+ * @param      bytes  bytes read
+ * @param      t0     start time of the read, from sac_io_clock()
+ * @param      flags  read flags, see sac_read_with_flags()
+ *
+ */
+static void
+sac_io_done(int fd, size_t bytes, uint64_t t0, int flags) {
+    atomic_fetch_add_explicit(&sac_io_stat.files, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&sac_io_stat.bytes, bytes, memory_order_relaxed);
+    atomic_fetch_add_explicit(&sac_io_stat.ns, sac_io_clock() - t0, memory_order_relaxed);
+    if(!(flags & SAC_READ_BULK)) {
+        return;
+    }
+    atomic_fetch_add_explicit(&sac_io_stat.bulk_files, 1, memory_order_relaxed);
+#ifdef HAVE_FUNC_POSIX_FADVISE
+    if(posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0) {
+        atomic_fetch_add_explicit(&sac_io_stat.dropped, bytes, memory_order_relaxed);
+    }
+#else
+    UNUSED(fd);
+#endif /* HAVE_FUNC_POSIX_FADVISE */
+}
+
+/**
+ * @brief Read the sac header
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Read a sac header, including the v7 footer, and return a file
+ *             pointer positioned at the start of the data
+ *
+ * @param      filename   file to read from
+ * @param      nerr       status error code, non-zero on failure
+ * @param      fp         returned file pointer
+ *
+ * @return     sac file with only the header read, NULL on failure
+ *
+ */
+static sac *
+sac_read_header_internal(char *filename, int *nerr, FILE **fp) {
+    int fd = -1;
+    sac *s = NULL;
+
+    if(!filename) {
+        *nerr = ERROR_FILE_DOES_NOT_EXIST;
+        return NULL;
+    }
+    if((fd = open(filename, O_RDONLY)) < 0) {
+        *nerr = sac_errno_to_nerr(errno);
+        return NULL;
+    }
+    if(!(s = sac_header_read_fd(fd, filename, NULL, nerr))) {
+        close(fd);
+        return NULL;
+    }
+    if(!(*fp = fdopen(fd, "rb"))) {
+        *nerr = ERROR_READING_FILE;
+        close(fd);
+        sac_free(s);
+        return NULL;
+    }
+    fseek(*fp, SAC_HEADER_SIZE, SEEK_SET);
+    return s;
+}
+
+/**
+ * @brief  Update meta data following (post) read
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details   Update the begin and end value, the distance, az, baz,
+ *            and great circle distance, check the precision of time picks
+ *            relative to the delta.  The min, max, and mean of the data
+ *            are computed as the data is read
+ *
+ * @param     s          sac file to check
+ * @param     flags      read flags, see sac_read_with_flags(), to skip
+ *                       updating b and e, the distance fields or the
+ *                       precision check
+ *
+ */
+static void
+sac_read_post(sac *s, int flags) {
+    if(!(flags & SAC_READ_NO_BE)) {
+        sac_be(s);
+    }
+    if(!(flags & SAC_READ_NO_DISTAZ)) {
+        sac_update_distaz(s);
+    }
+    if(!(flags & SAC_READ_NO_PRECISION)) {
+        sac_check_time_precision(s);
+    }
+}
+
+/**
+ * @brief      Read a sac file
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Read a sac file. Header values b, e, dist, az, baz, gcarc
+ *             updated after read.  Data is read from either byte order
+ *             and converted to the system's byte order
+ *
+ * @param      filename   file to read sac file from
+ * @param      read_data  whether to read the header and data or just the header
+ * @param      flags      read flags, see sac_read_with_flags()
+ * @param      nerr       status code, 0 on success, non-zero on failure
+ *
+ * @return     sac file structure, NULL on failure
+ */
+sac *
+sac_read_internal(char *filename, int read_data, int flags, int *nerr) {
+    FILE *fp = NULL;
+    sac *s = NULL;
+    uint64_t t0 = sac_io_clock();
+
+    *nerr = 0;
+
+    if(!(s = sac_read_header_internal(filename, nerr, &fp))) {
+        if(*nerr == ERROR_COMPRESSED_FILE) {
+            return sac_read_compressed(filename, read_data, FALSE, NULL, 0.0, NULL, 0.0,
+                                       CutNone, flags, nerr);
+        }
+        goto error;
+    }
+
+    if(read_data) {
+        sac_alloc(s);
+        s->m->nstart = 1;
+        s->m->nstop  = s->h->npts;
+        s->m->ntotal = s->h->npts;
+        s->m->nfillb = 0;
+        s->m->nfille = 0;
+        sac_io_advise(fileno(fp), SAC_HEADER_SIZE, (off_t) sac_size(s) - SAC_HEADER_SIZE, flags);
+        if((*nerr = sac_data_read_flags(s, fp, flags))) {
+            goto error;
+        }
+        sac_io_done(fileno(fp), (s->m->pack) ? (size_t) ftello(fp) : (size_t) sac_size(s), t0, flags);
+    }
+
+    fclose(fp);
+
+    sac_read_post(s, flags);
+
+    return s;
+
+ error:
+    if(s) {
+        sac_free(s);
+        s = NULL;
+    }
+    if(fp) {
+        fclose(fp);
+    }
+    return NULL;
+}
+
+/**
+ * @brief      Read a sac file from part of a file using a memory mapping
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Map \p size bytes at offset \p off of \p fd and read the sac
+ *             file they hold, see sac_read_mmap().  The offset need not be
+ *             page aligned.  The data components point into the mapping,
+ *             which is released with sac_free(); \p fd may be closed once
+ *             this returns.
+ *
+ * @param      fd        file descriptor open for reading
+ * @param      off       offset of the sac file in \p fd
+ * @param      size      size of the sac file in bytes
+ * @param      filename  filename to store in the meta data
+ * @param      nerr      status code, 0 on success, non-zero on failure,
+ *                       ERROR_PACKED_DATA for packed data and
+ *                       ERROR_COMPRESSED_FILE for gzip or zstd compressed
+ *                       files, which can not be mapped
+ *
+ * @return     sac file structure, NULL on failure
+ */
+static sac *
+sac_read_mmap_fd(int fd, off_t off, size_t size, char *filename, int *nerr) {
+    int i = 0;
+    int prot = PROT_READ;
+    int flags = MAP_SHARED;
+    char *map = NULL, *rec = NULL;
+    char begin[SAC_HEADER_SIZEOF_NUMBER], end[SAC_HEADER_SIZEOF_NUMBER];
+    size_t skew = (size_t) (off % (off_t) sysconf(_SC_PAGESIZE));
+    size_t len = skew + size;
+    sac *s = NULL;
+    extrema e;
+
+    *nerr = SAC_OK;
+    if(size == 0) {
+        *nerr = ERROR_NOT_A_SAC_FILE;
+        return NULL;
+    }
+
+    s = sac_new();
+    s->m->filename = strdup(filename);
+
+    // Determine the byte order from a read-only shared mapping
+    if((map = mmap(NULL, len, prot, flags, fd, off - (off_t) skew)) == MAP_FAILED) {
+        *nerr = ERROR_READING_FILE;
+        goto error;
+    }
+    s->m->map = map;
+    s->m->map_size = len;
+    rec = map + skew;
+    if(sac_compression(rec, size) != SAC_COMPRESS_NONE) {
+        *nerr = ERROR_COMPRESSED_FILE;
+        goto error;
+    }
+    if(size < SAC_HEADER_SIZE) {
+        *nerr = ERROR_NOT_A_SAC_FILE;
+        goto error;
+    }
+    for(i = 0; ; i++) {
+        // Counters read around the header, see sac_header_live_confirm()
+        memcpy(end, rec + SAC_LIVE_END * SAC_HEADER_SIZEOF_NUMBER, sizeof end);
+        atomic_thread_fence(memory_order_acquire);
+        if((*nerr = sac_header_read_buffer(s, rec)) != SAC_OK) {
+            goto error;
+        }
+        atomic_thread_fence(memory_order_acquire);
+        memcpy(begin, rec + SAC_LIVE_BEGIN * SAC_HEADER_SIZEOF_NUMBER, sizeof begin);
+        if(sac_header_live(s) && (!s->m->live || sac_header_live_confirm(s, begin, end))) {
+            break;
+        }
+        if(i == SAC_LIVE_RETRY) {
+            *nerr = ERROR_READING_FILE;
+            goto error;
+        }
+        sac_header_live_backoff(i);
+    }
+    if((*nerr = sac_size_check(s, (off_t) size)) != SAC_OK) {
+        goto error;
+    }
+    if(s->h->npts <= 0) {
+        *nerr = ERROR_READING_FILE;
+        goto error;
+    }
+    if(s->m->pack) {
+        *nerr = ERROR_PACKED_DATA;
+        goto error;
+    }
+
+    // Data in the non-native byte order is swapped into a private mapping
+    if(s->m->swap) {
+        munmap(map, len);
+        s->m->map = NULL;
+        prot  = PROT_READ | PROT_WRITE;
+        flags = MAP_PRIVATE;
+        if((map = mmap(NULL, len, prot, flags, fd, off - (off_t) skew)) == MAP_FAILED) {
+            *nerr = ERROR_READING_FILE;
+            goto error;
+        }
+        s->m->map = map;
+        rec = map + skew;
+    }
+
+    s->y = (float *) (rec + SAC_HEADER_SIZE);
+    if(sac_comps(s) == 2) {
+        s->x = s->y + s->h->npts;
+    }
+    extrema_init(&e);
+    sac_data_swap_extrema(s->y, (size_t) s->h->npts, s->m->swap, &e);
+    if(s->x) {
+        sac_data_swap_extrema(s->x, (size_t) s->h->npts, s->m->swap, NULL);
+    }
+    extrema_set(s, &e);
+    s->m->nstart = 1;
+    s->m->nstop  = s->h->npts;
+    s->m->ntotal = s->h->npts;
+    s->m->nfillb = 0;
+    s->m->nfille = 0;
+
+    if(s->m->live) {
+        sac_copy_f32_to_f64(s);
+    } else {
+        sac_header_v7_fill_buffer(s, rec + size - sizeof(sac_f64));
+    }
+
+    sac_read_post(s, 0);
+
+    return s;
+
+ error:
+    sac_free(s);
+    return NULL;
+}
+
+/**
+ * @brief      Read a sac file using a memory mapping
+ *
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Read a sac file by mapping it into memory.  The data components,
+ *             \p y and \p x, point directly into the mapped file and no copy
+ *             of the data is made.  If the file is not in the system's byte
+ *             order, a private copy-on-write mapping is used and the data is
+ *             byteswapped in place; the file itself is never modified.
+ *             The mapping is released with sac_free().
+ *
+ * @param      filename   file to read data and header from
+ * @param      nerr       status code, 0 on success, non-zero on failure
+ *
+ * @return     sac file structure, NULL on failure
+ *
+ * @warning    For files in the system's byte order the data is mapped read-only,
+ *             use sac_copy() to obtain a modifiable copy
+ *
+ * Reading a sac file with a memory mapping gives the same data as sac_read()
+ * @code
+ * int nerr = 0;
+ * sac *s = sac_read("t/test_io_big.sac", &nerr);
+ * assert_eq(nerr, 0);
+ * sac *m = sac_read_mmap("t/test_io_big.sac", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_ne(m->m->map, NULL);
+ * assert_eq(m->h->npts, s->h->npts);
+ * assert_eq(memcmp(m->y, s->y, sizeof(float) * s->h->npts), 0);
+ * assert_eq(m->h->depmax, s->h->depmax);
+ * sac_free(m);
+ *
+ * m = sac_read_mmap("t/test_uneven_small.sac", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_ne(m->x, NULL);
+ * sac_free(m);
+ *
+ * m = sac_read_mmap("sacio.c", &nerr);
+ * assert_eq(m, NULL);
+ * assert_eq(nerr, 1317);
+ *
+ * // Compressed files are read as sac_read() reads them
+ * int err = 0;
+ * m = sac_read_mmap("t/test_io_small.sac.gz", &nerr);
+ * sac_free(s);
+ * s = sac_read("t/test_io_small.sac.gz", &err);
+ * assert_eq(nerr, err);
+ * if(s) {
+ *     assert_eq(memcmp(m->y, s->y, sizeof(float) * s->h->npts), 0);
+ * }
+ * sac_free(m);
+ * @endcode
+ *
+ */
+sac *
+sac_read_mmap(char *filename, int *nerr) {
+    int fd = -1;
+    sac *s = NULL;
+    struct stat stbuf;
+
+    *nerr = SAC_OK;
+    if(!filename) {
+        *nerr = ERROR_FILE_DOES_NOT_EXIST;
+        return NULL;
+    }
+    if((fd = open(filename, O_RDONLY)) < 0) {
+        *nerr = sac_errno_to_nerr(errno);
+        return NULL;
+    }
+    if(fstat(fd, &stbuf) != 0) {
+        *nerr = sac_errno_to_nerr(errno);
+        close(fd);
+        return NULL;
+    }
+    s = sac_read_mmap_fd(fd, 0, (size_t) stbuf.st_size, filename, nerr);
+    close(fd);
+    // Packed and compressed data can not be mapped, it is read and unpacked
+    if(!s && (*nerr == ERROR_PACKED_DATA || *nerr == ERROR_COMPRESSED_FILE)) {
+        return sac_read(filename, nerr);
+    }
+    return s;
+}
+
+/**
+ * @defgroup bundle bundle
+ * @brief Many sac files in a single file with an index
+ */
+
+/**
+ * @brief      Magic at the end of a bundle, see sac_bundle_open()
+ * @private
+ */
+#define SAC_BUNDLE_MAGIC "SACBNDL1"
+
+/**
+ * @brief      Byte order mark of the index of a bundle
+ * @private
+ */
+#define SAC_BUNDLE_ORDER 0x01020304U
+
+/**
+ * @brief      Alignment of records in a bundle, so mapped data is aligned
+ * @private
+ */
+#define SAC_BUNDLE_ALIGN 8
+
+/**
+ * @brief      Round an offset up to the next record of a bundle
+ * @private
+ */
+#define SAC_BUNDLE_NEXT(off) (((off) + SAC_BUNDLE_ALIGN - 1) / SAC_BUNDLE_ALIGN * SAC_BUNDLE_ALIGN)
+
+/**
+ * @brief      Size of a NET.STA.LOC.CHA key of a bundle member
+ * @private
+ */
+#define SAC_BUNDLE_NSLC (4 * 9)
+
+typedef struct sac_bundle_entry sac_bundle_entry;
+/**
+ * @brief      index entry of a bundle member, stored in the byte order of the bundle
+ * @private
+ */
+struct sac_bundle_entry {
+    uint64_t off;      /**< @private offset of the record */
+    uint64_t size;     /**< @private size of the record in bytes */
+    int64_t b[2];      /**< @private time of the first sample, seconds and nanoseconds */
+    int64_t e[2];      /**< @private time of the last sample, seconds and nanoseconds */
+    uint64_t name;     /**< @private offset of the name in the name table */
+    uint64_t namelen;  /**< @private length of the name */
+    char net[8];       /**< @private network, not nul terminated */
+    char sta[8];       /**< @private station, not nul terminated */
+    char loc[8];       /**< @private location, not nul terminated */
+    char cha[8];       /**< @private channel, not nul terminated */
+};
+
+typedef struct sac_bundle_trailer sac_bundle_trailer;
+/**
+ * @brief      end of a bundle, stored in the byte order of the bundle
+ * @private
+ */
+struct sac_bundle_trailer {
+    uint64_t index;    /**< @private offset of the index */
+    uint64_t n;        /**< @private number of members */
+    uint64_t names;    /**< @private size of the name table, after the index */
+    uint32_t order;    /**< @private SAC_BUNDLE_ORDER */
+    uint32_t version;  /**< @private format version, 1 */
+    char magic[8];     /**< @private SAC_BUNDLE_MAGIC */
+};
+
+typedef struct sac_bundle_key sac_bundle_key;
+/**
+ * @brief      entry of the key table of a bundle, see sac_bundle_find()
+ * @private
+ */
+struct sac_bundle_key {
+    const char *key;   /**< @private name, station or NET.STA.LOC.CHA of the member */
+    size_t i;          /**< @private member */
+};
+
+/**
+ * @brief sac bundle, many sac files in a single file
+ * @private
+ */
+struct sac_bundle {
+    char *filename;            /**< @brief Bundle filename */
+    int fd;                    /**< @brief File descriptor */
+    int writable;              /**< @brief If members can be appended */
+    int dirty;                 /**< @brief If members were appended since the index was written */
+    off_t end;                 /**< @brief End of the records, where the index begins */
+    sac_bundle_member *m;      /**< @brief Members */
+    size_t n;                  /**< @brief Number of members */
+    size_t alloc;              /**< @brief Allocated members */
+    sac_bundle_key *keys;      /**< @brief Keys of the members, sorted, see sac_bundle_find() */
+    size_t nkeys;              /**< @brief Number of keys, three per member when up to date */
+    char *nslc;                /**< @brief NET.STA.LOC.CHA of each member, SAC_BUNDLE_NSLC bytes each */
+};
+
+/**
+ * @brief      byteswap bundle index entries in place
+ * @private
+ */
+static void
+sac_bundle_entry_swap(sac_bundle_entry *p, size_t n) {
+    size_t i = 0;
+    for(i = 0; i < n; i++) {
+        sac_swap64(&p[i].off, &p[i].off, 8);
+    }
+}
+
+/**
+ * @brief      Copy a header string into a fixed width index field
+ * @private
+ */
+static void
+sac_bundle_key_set(char *dst, const char *src) {
+    size_t n = strlen(src);
+    memset(dst, ' ', 8);
+    memcpy(dst, src, MIN(n, (size_t) 8));
+}
+
+/**
+ * @brief      Copy a fixed width index field into a nul terminated string
+ * @private
+ */
+static void
+sac_bundle_key_get(char *dst, const char *src) {
+    int n = 8;
+    while(n > 0 && src[n-1] == ' ') {
+        n--;
+    }
+    memcpy(dst, src, (size_t) n);
+    dst[n] = 0;
+}
+
+/**
+ * @brief      Add a member to a bundle
+ *
+ * @private
+ * @ingroup    bundle
+ *
+ * @details    The network, station, location, channel and time span are
+ *             taken from the header of \p s.  Times of files without a
+ *             reference time are set to undefined, SAC_INT_UNDEFINED.
+ *
+ * @param      b     bundle
+ * @param      s     header of the record
+ * @param      name  name of the member
+ * @param      off   offset of the record
+ * @param      size  size of the record in bytes
+ *
+ * @return     status code, 0 on success, non-zero on failure
+ */
+static int
+sac_bundle_add(sac_bundle *b, sac *s, const char *name, off_t off, size_t size) {
+    sac_bundle_member *m = NULL;
+    if(b->n == b->alloc) {
+        size_t alloc = (b->alloc) ? 2 * b->alloc : 64;
+        if(!(m = realloc(b->m, alloc * sizeof(sac_bundle_member)))) {
+            return ERROR_WRITING_FILE;
+        }
+        b->m = m;
+        b->alloc = alloc;
+    }
+    m = &b->m[b->n];
+    memset(m, 0, sizeof *m);
+    if(!(m->name = strdup(name))) {
+        return ERROR_WRITING_FILE;
+    }
+    m->off = off;
+    m->size = size;
+    sac_get_string(s, SAC_NET, m->net, sizeof m->net);
+    sac_get_string(s, SAC_STA, m->sta, sizeof m->sta);
+    sac_get_string(s, SAC_LOC, m->loc, sizeof m->loc);
+    sac_get_string(s, SAC_CHA, m->cha, sizeof m->cha);
+    if(!sac_get_time(s, SAC_B, &m->b) || !sac_get_time(s, SAC_E, &m->e)) {
+        m->b.tv_sec = m->b.tv_nsec = SAC_INT_UNDEFINED;
+        m->e.tv_sec = m->e.tv_nsec = SAC_INT_UNDEFINED;
+    }
+    b->n++;
+    b->dirty = TRUE;
+    return SAC_OK;
+}
+
+/**
+ * @brief      Remove all members of a bundle from memory
+ * @private
+ */
+static void
+sac_bundle_members_free(sac_bundle *b) {
+    size_t i = 0;
+    for(i = 0; i < b->n; i++) {
+        FREE(b->m[i].name);
+    }
+    FREE(b->m);
+    FREE(b->keys);
+    FREE(b->nslc);
+    b->n = 0;
+    b->alloc = 0;
+    b->nkeys = 0;
+}
+
+/**
+ * @brief      Order keys of a bundle by key, then by member
+ * @private
+ */
+static int
+sac_bundle_key_cmp(const void *pa, const void *pb) {
+    const sac_bundle_key *a = pa, *b = pb;
+    int c = strcmp(a->key, b->key);
+    if(c != 0) {
+        return c;
+    }
+    return (a->i > b->i) - (a->i < b->i);
+}
+
+/**
+ * @brief      Build the key table of a bundle
+ *
+ * @private
+ * @ingroup    bundle
+ *
+ * @details    Each member has three keys, its name, its station and
+ *             NET.STA.LOC.CHA, sorted so sac_bundle_find() is a binary
+ *             search.  Appending members leaves the table out of date; it is
+ *             rebuilt on the next search.
+ *
+ * @param      b     bundle
+ *
+ * @return     status code, 0 on success, ERROR_READING_FILE if memory
+ *             cannot be allocated
+ */
+static int
+sac_bundle_keys_build(sac_bundle *b) {
+    size_t i = 0;
+    FREE(b->keys);
+    FREE(b->nslc);
+    b->nkeys = 0;
+    if(b->n == 0) {
+        return SAC_OK;
+    }
+    if(!(b->keys = malloc(3 * b->n * sizeof(sac_bundle_key))) ||
+       !(b->nslc = malloc(b->n * SAC_BUNDLE_NSLC))) {
+        FREE(b->keys);
+        return ERROR_READING_FILE;
+    }
+    for(i = 0; i < b->n; i++) {
+        sac_bundle_member *m = &b->m[i];
+        char *nslc = b->nslc + i * SAC_BUNDLE_NSLC;
+        snprintf(nslc, SAC_BUNDLE_NSLC, "%s.%s.%s.%s", m->net, m->sta, m->loc, m->cha);
+        b->keys[b->nkeys++] = (sac_bundle_key) { m->name, i };
+        b->keys[b->nkeys++] = (sac_bundle_key) { m->sta, i };
+        b->keys[b->nkeys++] = (sac_bundle_key) { nslc, i };
+    }
+    qsort(b->keys, b->nkeys, sizeof(sac_bundle_key), sac_bundle_key_cmp);
+    return SAC_OK;
+}
+
+/**
+ * @brief      Read the index of a bundle
+ *
+ * @private
+ * @ingroup    bundle
+ *
+ * @param      b     bundle with the file open and no members
+ * @param      size  end of the trailer, the size of the file unless an
+ *                   append did not finish, see sac_bundle_index_find()
+ *
+ * @return     status code, 0 on success, ERROR_NOT_A_SAC_FILE if the file
+ *             is not a bundle, ERROR_READING_FILE if the index is damaged;
+ *             on failure the bundle has no members
+ */
+static int
+sac_bundle_index_read(sac_bundle *b, off_t size) {
+    int swap = FALSE, nerr = ERROR_READING_FILE;
+    size_t i = 0;
+    sac_bundle_trailer t;
+    sac_bundle_entry *idx = NULL;
+    char *names = NULL;
+
+    if(size < (off_t) sizeof t ||
+       pread(b->fd, &t, sizeof t, size - (off_t) sizeof t) != (ssize_t) sizeof t ||
+       memcmp(t.magic, SAC_BUNDLE_MAGIC, sizeof t.magic) != 0) {
+        return ERROR_NOT_A_SAC_FILE;
+    }
+    if(t.order != SAC_BUNDLE_ORDER) {
+        swap = TRUE;
+        sac_swap64(&t.index, &t.index, 3);
+        sac_swap32(&t.order, &t.order, 2);
+    }
+    if(t.order != SAC_BUNDLE_ORDER || t.version != 1) {
+        return ERROR_NOT_A_SAC_FILE;
+    }
+    if(t.index > (uint64_t) size || t.n > ((uint64_t) size - t.index) / sizeof(sac_bundle_entry) ||
+       t.names != (uint64_t) size - sizeof t - t.index - t.n * sizeof(sac_bundle_entry)) {
+        return ERROR_READING_FILE;
+    }
+    if(!(idx = malloc(t.n * sizeof(sac_bundle_entry) + t.names + 1)) ||
+       !(b->m = calloc(t.n + 1, sizeof(sac_bundle_member)))) {
+        goto done;
+    }
+    b->alloc = t.n + 1;
+    if(pread(b->fd, idx, t.n * sizeof(sac_bundle_entry) + t.names, (off_t) t.index) !=
+       (ssize_t) (t.n * sizeof(sac_bundle_entry) + t.names)) {
+        goto done;
+    }
+    if(swap) {
+        sac_bundle_entry_swap(idx, t.n);
+    }
+    names = (char *) (idx + t.n);
+    for(i = 0; i < t.n; i++) {
+        sac_bundle_entry *p = &idx[i];
+        sac_bundle_member *m = &b->m[i];
+        if(p->off % SAC_BUNDLE_ALIGN != 0 || p->off > t.index || p->size > t.index - p->off ||
+           p->name > t.names || p->namelen > t.names - p->name ||
+           !(m->name = strndup(names + p->name, p->namelen))) {
+            goto done;
+        }
+        m->off = (off_t) p->off;
+        m->size = (size_t) p->size;
+        m->b.tv_sec = p->b[0];
+        m->b.tv_nsec = p->b[1];
+        m->e.tv_sec = p->e[0];
+        m->e.tv_nsec = p->e[1];
+        sac_bundle_key_get(m->net, p->net);
+        sac_bundle_key_get(m->sta, p->sta);
+        sac_bundle_key_get(m->loc, p->loc);
+        sac_bundle_key_get(m->cha, p->cha);
+        b->n++;
+    }
+    b->end = (off_t) t.index;
+    nerr = SAC_OK;
+ done:
+    if(nerr != SAC_OK) {
+        sac_bundle_members_free(b);
+    }
+    FREE(idx);
+    return nerr;
+}
+
+/**
+ * @brief      Find the last complete index of a bundle
+ *
+ * @private
+ * @ingroup    bundle
+ *
+ * @details    Records appended to a bundle are only indexed when it is
+ *             closed, see sac_bundle_open().  If a bundle was not closed,
+ *             the file does not end with a trailer.  Trailers end at
+ *             multiples of 8 bytes, so the file is searched back from its
+ *             end for the last trailer whose index can be read.  Records
+ *             after it are not members.  The search reads up to the whole
+ *             file, so it is only made for bundles opened to append.
+ *
+ * @param      b     bundle with the file open and no members
+ * @param      size  size of the file
+ *
+ * @return     status code, 0 on success, ERROR_NOT_A_SAC_FILE if no index
+ *             is found
+ */
+static int
+sac_bundle_index_find(sac_bundle *b, off_t size) {
+    off_t lo = 0, hi = size / SAC_BUNDLE_ALIGN * SAC_BUNDLE_ALIGN, end = 0;
+    char buf[65536];
+
+    for(; hi > 0; hi = lo) {
+        lo = MAX(hi - (off_t) sizeof buf, (off_t) 0);
+        if(pread(b->fd, buf, (size_t) (hi - lo), lo) != (ssize_t) (hi - lo)) {
+            return ERROR_READING_FILE;
+        }
+        for(end = hi; end - (off_t) sizeof(sac_bundle_trailer) >= 0 && end - 8 >= lo; end -= SAC_BUNDLE_ALIGN) {
+            if(memcmp(buf + (end - 8 - lo), SAC_BUNDLE_MAGIC, 8) == 0 &&
+               sac_bundle_index_read(b, end) == SAC_OK) {
+                return SAC_OK;
+            }
+        }
+    }
+    return ERROR_NOT_A_SAC_FILE;
+}
+
+/**
+ * @brief      Write the index of a bundle after its records
+ *
+ * @private
+ * @ingroup    bundle
+ *
+ * @details    The index, name table and trailer are written with a single
+ *             pwritev() and the file is truncated after them.  The name table
+ *             is padded so the trailer ends at a multiple of 8 bytes, see
+ *             sac_bundle_index_find()
+ *
+ * @param      b     bundle open for appending
+ *
+ * @return     status code, 0 on success, non-zero on failure
+ */
+static int
+sac_bundle_index_write(sac_bundle *b) {
+    int nerr = ERROR_WRITING_FILE;
+    size_t i = 0, nnames = 0;
+    off_t off = 0;
+    sac_bundle_trailer t;
+    sac_bundle_entry *idx = NULL;
+    char *names = NULL;
+    struct iovec iov[3];
+
+    for(i = 0; i < b->n; i++) {
+        nnames += strlen(b->m[i].name);
+    }
+    if(!(idx = calloc(b->n + 1, sizeof(sac_bundle_entry))) || !(names = calloc(nnames + SAC_BUNDLE_ALIGN, 1))) {
+        goto done;
+    }
+    nnames = 0;
+    for(i = 0; i < b->n; i++) {
+        sac_bundle_member *m = &b->m[i];
+        sac_bundle_entry *p = &idx[i];
+        p->off = (uint64_t) m->off;
+        p->size = m->size;
+        p->b[0] = m->b.tv_sec;
+        p->b[1] = m->b.tv_nsec;
+        p->e[0] = m->e.tv_sec;
+        p->e[1] = m->e.tv_nsec;
+        p->name = nnames;
+        p->namelen = strlen(m->name);
+        memcpy(names + nnames, m->name, p->namelen);
+        nnames += p->namelen;
+        sac_bundle_key_set(p->net, m->net);
+        sac_bundle_key_set(p->sta, m->sta);
+        sac_bundle_key_set(p->loc, m->loc);
+        sac_bundle_key_set(p->cha, m->cha);
+    }
+    nnames = SAC_BUNDLE_NEXT(nnames);
+    b->end = SAC_BUNDLE_NEXT(b->end);
+    off = b->end;
+    memset(&t, 0, sizeof t);
+    t.index = (uint64_t) b->end;
+    t.n = b->n;
+    t.names = nnames;
+    t.order = SAC_BUNDLE_ORDER;
+    t.version = 1;
+    memcpy(t.magic, SAC_BUNDLE_MAGIC, sizeof t.magic);
+    iov[0].iov_base = idx;
+    iov[0].iov_len = b->n * sizeof(sac_bundle_entry);
+    iov[1].iov_base = names;
+    iov[1].iov_len = nnames;
+    iov[2].iov_base = &t;
+    iov[2].iov_len = sizeof t;
+    if((nerr = sac_pwritev_all(b->fd, iov, 3, &off)) == SAC_OK &&
+       ftruncate(b->fd, off) != 0) {
+        nerr = ERROR_WRITING_FILE;
+    }
+    if(nerr == SAC_OK) {
+        b->dirty = FALSE;
+    }
+ done:
+    FREE(idx);
+    FREE(names);
+    return nerr;
+}
+
+/**
+ * @brief      Open a bundle of sac files
+ *
+ * @ingroup    bundle
+ *
+ * @details    A bundle holds many sac files, records, in a single file, which
+ *             avoids the open and inode overhead of many small files.  Each
+ *             record is a complete sac file, header, data and v7 footer, as
+ *             written by sac_write() or as found on disk.  Records begin at
+ *             multiples of 8 bytes, so mapped data is aligned, and are
+ *             followed by an index of the offset, size, network, station,
+ *             location, channel, time span and name of each record, a table
+ *             of names and a fixed size trailer, which locates the index.
+ *             The index is stored in the byte order of the system writing it
+ *             and read in either byte order.
+ *
+ *             With SAC_BUNDLE_APPEND the bundle is created if it does not
+ *             exist and members can be added with sac_bundle_append() and
+ *             sac_bundle_append_file().  New records are written after the
+ *             existing index and trailer, which remain valid until
+ *             sac_bundle_close() writes the new index after the new records;
+ *             the space of the old index is not reused.  If a bundle is not
+ *             closed after appending, e.g. the program crashes, the records
+ *             appended are not members.  Opening it with SAC_BUNDLE_APPEND
+ *             then recovers it from its last complete index, which the next
+ *             sac_bundle_close() replaces.  Until then, and while records are
+ *             being appended, opening it to read fails with
+ *             ERROR_NOT_A_SAC_FILE.
+ *
+ * @param      filename  bundle filename
+ * @param      flags     0 to read, SAC_BUNDLE_APPEND to read and append
+ * @param      nerr      status code, 0 on success, non-zero on failure,
+ *                       ERROR_NOT_A_SAC_FILE if the file is not a bundle
+ *
+ * @return     bundle, close with sac_bundle_close(), NULL on failure
+ *
+ * @code
+ * int nerr = 0;
+ * sac *s = sac_read("t/test_io_small.sac", &nerr);
+ * unlink("t/test_io_bundle.tmp");
+ * sac_bundle *b = sac_bundle_open("t/test_io_bundle.tmp", SAC_BUNDLE_APPEND, &nerr);
+ * assert_eq(nerr, 0);
+ * sac_bundle_append_file(b, "t/test_io_small.sac", &nerr);
+ * assert_eq(nerr, 0);
+ * sac_bundle_append_file(b, "t/test_uneven_big.sac", &nerr);
+ * assert_eq(nerr, 0);
+ * sac_set_string(s, SAC_STA, "BNDL");
+ * sac_bundle_append(b, s, "bndl.sac", &nerr);
+ * assert_eq(nerr, 0);
+ * sac_bundle_append_file(b, "sacio.c", &nerr);
+ * assert_eq(nerr, 1317);
+ * sac_bundle_close(b, &nerr);
+ * assert_eq(nerr, 0);
+ *
+ * // Members are listed from the index and read without copying the data
+ * b = sac_bundle_open("t/test_io_bundle.tmp", 0, &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(sac_bundle_count(b), 3);
+ * const sac_bundle_member *m = sac_bundle_info(b, 2);
+ * assert_eq(strcmp(m->name, "bndl.sac"), 0);
+ * assert_eq(strcmp(m->sta, "BNDL"), 0);
+ * assert_eq(m->size, (size_t) sac_size(s));
+ * sac *c = sac_bundle_read(b, 0, &nerr);
+ * assert_eq(nerr, 0);
+ * assert_ne(c->m->map, NULL);
+ * assert_eq(memcmp(c->y, s->y, sizeof(float) * s->h->npts), 0);
+ * sac_free(c);
+ * c = sac_bundle_read_key(b, "t/test_uneven_big.sac", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_ne(c->x, NULL);
+ * sac_free(c);
+ * assert_eq(sac_bundle_find(b, "BNDL", 0), 2);
+ * assert_eq(sac_bundle_find(b, "BNDL", 3), -1);
+ * assert_eq(sac_bundle_find(b, "NOPE", 0), -1);
+ * c = sac_bundle_read_cut(b, 2, "B", 10.0, "B", 20.0, CutUseBE, &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(c->h->npts, 11);
+ * assert_eq(memcmp(c->y, s->y + 1, sizeof(float) * 11), 0);
+ * sac_free(c);
+ * sac_bundle_close(b, &nerr);
+ * assert_eq(nerr, 0);
+ *
+ * // Appending keeps existing members
+ * b = sac_bundle_open("t/test_io_bundle.tmp", SAC_BUNDLE_APPEND, &nerr);
+ * sac_bundle_append_file(b, "t/test_io_big.sac", &nerr);
+ * assert_eq(sac_bundle_find(b, "t/test_io_big.sac", 0), 3);
+ * sac_bundle_close(b, &nerr);
+ * b = sac_bundle_open("t/test_io_bundle.tmp", 0, &nerr);
+ * assert_eq(sac_bundle_count(b), 4);
+ * c = sac_bundle_read(b, 2, &nerr);
+ * assert_eq(memcmp(c->y, s->y, sizeof(float) * s->h->npts), 0);
+ * sac_free(c);
+ * sac_bundle_close(b, &nerr);
+ *
+ * // An unfinished append, a partial record after the index, is ignored
+ * // when opened to append, and only then
+ * int fd = open("t/test_io_bundle.tmp", O_WRONLY | O_APPEND);
+ * assert_eq(write(fd, "partial record", 14), 14);
+ * close(fd);
+ * b = sac_bundle_open("t/test_io_bundle.tmp", 0, &nerr);
+ * assert_eq(b, NULL);
+ * assert_eq(nerr, 1317);
+ * b = sac_bundle_open("t/test_io_bundle.tmp", SAC_BUNDLE_APPEND, &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(sac_bundle_count(b), 4);
+ * sac_bundle_append(b, s, "after.sac", &nerr);
+ * sac_bundle_close(b, &nerr);
+ * assert_eq(nerr, 0);
+ * b = sac_bundle_open("t/test_io_bundle.tmp", 0, &nerr);
+ * assert_eq(sac_bundle_count(b), 5);
+ * c = sac_bundle_read_key(b, "after.sac", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(memcmp(c->y, s->y, sizeof(float) * s->h->npts), 0);
+ * sac_free(c);
+ * c = sac_bundle_read(b, 3, &nerr);
+ * assert_eq(nerr, 0);
+ * sac_free(c);
+ * sac_bundle_close(b, &nerr);
+ *
+ * b = sac_bundle_open("t/test_io_small.sac", 0, &nerr);
+ * assert_eq(b, NULL);
+ * assert_eq(nerr, 1317);
+ * @endcode
+ */
+sac_bundle *
+sac_bundle_open(char *filename, int flags, int *nerr) {
+    int err = 0;
+    int append = (flags & SAC_BUNDLE_APPEND) ? TRUE : FALSE;
+    sac_bundle *b = NULL;
+    struct stat st;
+
+    *nerr = SAC_OK;
+    if(!filename) {
+        *nerr = ERROR_FILE_DOES_NOT_EXIST;
+        return NULL;
+    }
+    if(!(b = calloc(1, sizeof(sac_bundle))) || !(b->filename = strdup(filename))) {
+        *nerr = ERROR_OPENING_FILE;
+        FREE(b);
+        return NULL;
+    }
+    b->writable = append;
+    if((b->fd = open(filename, (append) ? O_RDWR | O_CREAT : O_RDONLY, 0666)) < 0) {
+        *nerr = sac_errno_to_nerr(errno);
+        goto error;
+    }
+    if(fstat(b->fd, &st) != 0) {
+        *nerr = sac_errno_to_nerr(errno);
+        goto error;
+    }
+    if(append && st.st_size == 0) {
+        b->dirty = TRUE;
+        return b;
+    }
+    if((*nerr = sac_bundle_index_read(b, st.st_size)) != SAC_OK) {
+        if(!append || sac_bundle_index_find(b, st.st_size) != SAC_OK) {
+            goto error;
+        }
+        // Replace the partial append with an index on close
+        b->dirty = TRUE;
+    }
+    if((*nerr = sac_bundle_keys_build(b)) != SAC_OK) {
+        goto error;
+    }
+    // Records are appended after everything in the file
+    if(append) {
+        b->end = st.st_size;
+    }
+    return b;
+ error:
+    b->dirty = FALSE;
+    sac_bundle_close(b, &err);
+    return NULL;
+}
+
+/**
+ * @brief      Append a sac file to a bundle
+ *
+ * @ingroup    bundle
+ *
+ * @details    The record is written as sac_write() would write it, with the
+ *             same header updates, in the byte order of \p s
+ *
+ * @param      b     bundle opened with SAC_BUNDLE_APPEND
+ * @param      s     sac file
+ * @param      name  name of the member, e.g. a filename
+ * @param      nerr  status code, 0 on success, non-zero on failure
+ */
+void
+sac_bundle_append(sac_bundle *b, sac *s, char *name, int *nerr) {
+    off_t off = 0;
+    if(!b || !b->writable || !s || !name) {
+        *nerr = ERROR_WRITING_FILE;
+        return;
+    }
+    if((*nerr = sac_write_prepare(s, TRUE, 0)) != SAC_OK) {
+        return;
+    }
+    b->end = SAC_BUNDLE_NEXT(b->end);
+    off = b->end;
+    if((*nerr = sac_write_vectored(s, b->fd, &off, s->m->swap, 0)) != SAC_OK) {
+        return;
+    }
+    if((*nerr = sac_bundle_add(b, s, name, b->end, (size_t) (off - b->end))) != SAC_OK) {
+        return;
+    }
+    b->end = off;
+}
+
+/**
+ * @brief      Append a sac file on disk to a bundle
+ *
+ * @ingroup    bundle
+ *
+ * @details    The file is copied into the bundle unchanged.  The member is
+ *             named \p filename.  Compressed files and files still being
+ *             written are not accepted.
+ *
+ * @param      b         bundle opened with SAC_BUNDLE_APPEND
+ * @param      filename  sac file to append
+ * @param      nerr      status code, 0 on success, non-zero on failure
+ */
+void
+sac_bundle_append_file(sac_bundle *b, char *filename, int *nerr) {
+    int fd = -1;
+    off_t size = 0, i = 0;
+    ssize_t k = 0;
+    sac *s = NULL;
+    char *buf = NULL;
+
+    *nerr = SAC_OK;
+    if(!b || !b->writable || !filename) {
+        *nerr = ERROR_WRITING_FILE;
+        return;
+    }
+    if((fd = open(filename, O_RDONLY)) < 0) {
+        *nerr = sac_errno_to_nerr(errno);
+        return;
+    }
+    if(!(s = sac_header_read_fd(fd, filename, &size, nerr))) {
+        goto done;
+    }
+    if(s->m->live) {
+        *nerr = ERROR_READING_FILE;
+        goto done;
+    }
+    if(!(buf = malloc(SAC_WRITE_BUFFER * sizeof(float)))) {
+        *nerr = ERROR_WRITING_FILE;
+        goto done;
+    }
+    b->end = SAC_BUNDLE_NEXT(b->end);
+    for(i = 0; i < size; i += k) {
+        if((k = pread(fd, buf, (size_t) MIN(size - i, (off_t) (SAC_WRITE_BUFFER * sizeof(float))), i)) <= 0) {
+            *nerr = ERROR_READING_FILE;
+            goto done;
+        }
+        if(pwrite(b->fd, buf, (size_t) k, b->end + i) != k) {
+            *nerr = ERROR_WRITING_FILE;
+            goto done;
+        }
+    }
+    if((*nerr = sac_bundle_add(b, s, filename, b->end, (size_t) size)) == SAC_OK) {
+        b->end += size;
+    }
+ done:
+    FREE(buf);
+    sac_free(s);
+    close(fd);
+}
+
+/**
+ * @brief      Number of members of a bundle
+ *
+ * @ingroup    bundle
+ *
+ * @param      b     bundle
+ *
+ * @return     number of members
+ */
+size_t
+sac_bundle_count(sac_bundle *b) {
+    return (b) ? b->n : 0;
+}
+
+/**
+ * @brief      Index entry of a member of a bundle
+ *
+ * @ingroup    bundle
+ *
+ * @param      b     bundle
+ * @param      i     member, from 0
+ *
+ * @return     index entry, valid until the bundle is closed, NULL if \p i
+ *             is out of range
+ */
+const sac_bundle_member *
+sac_bundle_info(sac_bundle *b, size_t i) {
+    return (b && i < b->n) ? &b->m[i] : NULL;
+}
+
+/**
+ * @brief      Find a member of a bundle
+ *
+ * @ingroup    bundle
+ *
+ * @details    Members match if \p key equals their name, their station or
+ *             NET.STA.LOC.CHA.  Keys are looked up in a table sorted when the
+ *             bundle is opened, see sac_bundle_keys_build().
+ *
+ * @param      b     bundle
+ * @param      key   name or key to search for
+ * @param      from  first member to check
+ *
+ * @return     index of the first matching member from \p from, -1 if none
+ */
+ssize_t
+sac_bundle_find(sac_bundle *b, const char *key, size_t from) {
+    size_t lo = 0, hi = 0, mid = 0;
+    int c = 0;
+    if(!b || !key) {
+        return -1;
+    }
+    if(b->nkeys != 3 * b->n && sac_bundle_keys_build(b) != SAC_OK) {
+        return -1;
+    }
+    // First key not before (key, from)
+    hi = b->nkeys;
+    while(lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        c = strcmp(b->keys[mid].key, key);
+        if(c < 0 || (c == 0 && b->keys[mid].i < from)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if(lo < b->nkeys && strcmp(b->keys[lo].key, key) == 0) {
+        return (ssize_t) b->keys[lo].i;
+    }
+    return -1;
+}
+
+/**
+ * @brief      Read a member of a bundle
+ *
+ * @ingroup    bundle
+ *
+ * @details    The record is mapped into memory and the data points into the
+ *             mapping, as with sac_read_mmap().  The sac file does not
+ *             depend on the bundle and may outlive it.  Members with packed
+ *             data are read and unpacked.
+ *
+ * @param      b     bundle
+ * @param      i     member, from 0
+ * @param      nerr  status code, 0 on success, non-zero on failure
+ *
+ * @return     sac file, free with sac_free(), NULL on failure
+ */
+sac *
+sac_bundle_read(sac_bundle *b, size_t i, int *nerr) {
+    sac *s = NULL;
+    sac_bundle_member *m = NULL;
+    if(!b || i >= b->n) {
+        *nerr = ERROR_READING_FILE;
+        return NULL;
+    }
+    m = &b->m[i];
+    s = sac_read_mmap_fd(b->fd, m->off, m->size, m->name, nerr);
+    if(!s && *nerr == ERROR_PACKED_DATA) {
+        uint8_t *buf = malloc(m->size);
+        *nerr = ERROR_READING_FILE;
+        if(buf && pread(b->fd, buf, m->size, m->off) == (ssize_t) m->size &&
+           (s = sac_read_buffer(buf, m->size, 0, nerr))) {
+            s->m->filename = strdup(m->name);
+        }
+        FREE(buf);
+    }
+    return s;
+}
+
+/**
+ * @brief      Read the first member of a bundle matching a key
+ *
+ * @ingroup    bundle
+ *
+ * @param      b     bundle
+ * @param      key   name or key, see sac_bundle_find()
+ * @param      nerr  status code, 0 on success, non-zero on failure,
+ *                   ERROR_FILE_DOES_NOT_EXIST if no member matches
+ *
+ * @return     sac file, free with sac_free(), NULL on failure
+ */
+sac *
+sac_bundle_read_key(sac_bundle *b, const char *key, int *nerr) {
+    ssize_t i = sac_bundle_find(b, key, 0);
+    if(i < 0) {
+        *nerr = ERROR_FILE_DOES_NOT_EXIST;
+        return NULL;
+    }
+    return sac_bundle_read(b, (size_t) i, nerr);
+}
+
+/**
+ * @brief      Read part of a member of a bundle
+ *
+ * @ingroup    bundle
+ *
+ * @details    The member is mapped, see sac_bundle_read(), and only the
+ *             window is copied, see sac_cut()
+ *
+ * @param      b       bundle
+ * @param      i       member, from 0
+ * @param      c1      reference header value for start of the window
+ * @param      t1      offset from \p c1 for the start of the window
+ * @param      c2      reference header value for end of the window
+ * @param      t2      offset from \p c2 for the end of the window
+ * @param      cutact  what to do with windows beyond the data
+ * @param      nerr    status code, 0 on success, non-zero on failure
+ *
+ * @return     sac file holding the window, free with sac_free(), NULL on failure
+ */
+sac *
+sac_bundle_read_cut(sac_bundle *b, size_t i, char *c1, double t1, char *c2, double t2,
+                    enum CutAction cutact, int *nerr) {
+    sac *s = NULL, *c = NULL;
+    if(!(s = sac_bundle_read(b, i, nerr))) {
+        return NULL;
+    }
+    c = sac_cut(s, c1, t1, c2, t2, cutact, nerr);
+    sac_free(s);
+    return c;
+}
+
+/**
+ * @brief      Close a bundle
+ *
+ * @ingroup    bundle
+ *
+ * @details    The index is written if members were appended.  \p b is freed.
+ *
+ * @param      b     bundle
+ * @param      nerr  status code, 0 on success, non-zero on failure
+ */
+void
+sac_bundle_close(sac_bundle *b, int *nerr) {
+    *nerr = SAC_OK;
+    if(!b) {
+        return;
+    }
+    if(b->writable && b->dirty && b->fd >= 0) {
+        *nerr = sac_bundle_index_write(b);
+    }
+    if(b->fd >= 0) {
+        close(b->fd);
+    }
+    sac_bundle_members_free(b);
+    FREE(b->filename);
+    FREE(b);
+}
+
+/**
+ * @brief      Read the packed data of a lazily read sac file
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @param      s     sac file
+ * @param      fd    file descriptor of the file, left open
+ * @param      t0    time the read started, see sac_io_clock()
+ *
+ * @return     status code, 0 on success, non-zero on failure
+ */
+static int
+sac_data_load_packed(sac *s, int fd, uint64_t t0) {
+    int nerr = SAC_OK, dfd = -1;
+    FILE *fp = NULL;
+    if((dfd = dup(fd)) < 0 || !(fp = fdopen(dfd, "rb"))) {
+        if(dfd >= 0) {
+            close(dfd);
+        }
+        return ERROR_READING_FILE;
+    }
+    sac_alloc(s);
+    if((nerr = sac_data_read_flags(s, fp, s->m->flags)) != SAC_OK) {
+        sac_data_release(s);
+    } else {
+        s->m->data_read = TRUE;
+        sac_io_done(fd, (size_t) ftello(fp), t0, s->m->flags);
+    }
+    fclose(fp);
+    return nerr;
+}
+
+/**
+ * @brief      Read the data of a lazily read sac file
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Read the data of a sac file read with SAC_READ_LAZY from its
+ *             file, byteswapping and computing extrema in the same pass.  The
+ *             file must still hold the same number of samples.
+ *
+ * @param      s     sac file
+ *
+ * @return     status code, 0 on success, non-zero on failure
+ */
+static int
+sac_data_load(sac *s) {
+    int fd = -1, j = 0, nerr = SAC_OK;
+    size_t i = 0, k = 0, npts = (size_t) s->h->npts;
+    off_t off = SAC_HEADER_SIZE;
+    sac *h = NULL;
+    extrema e;
+    float *y = NULL;
+    uint64_t t0 = sac_io_clock();
+
+    if(s->m->data_read) {
+        return SAC_OK;
+    }
+    if(!s->m->filename) {
+        return ERROR_FILE_DOES_NOT_EXIST;
+    }
+    if((fd = open(s->m->filename, O_RDONLY)) < 0) {
+        return sac_errno_to_nerr(errno);
+    }
+    if(!(h = sac_header_read_fd(fd, s->m->filename, NULL, &nerr))) {
+        goto done;
+    }
+    if(h->h->npts != s->h->npts || h->m->swap != s->m->swap || h->m->pack != s->m->pack) {
+        nerr = ERROR_READING_FILE;
+        goto done;
+    }
+    if(s->m->pack) {
+        nerr = sac_data_load_packed(s, fd, t0);
+        goto done;
+    }
+    sac_io_advise(fd, off, (off_t) (npts * sizeof(float)) * sac_comps(s), s->m->flags);
+    sac_alloc(s);
+    extrema_init(&e);
+    for(j = 0; j < sac_comps(s); j++) {
+        y = (j == 0) ? s->y : s->x;
+        for(i = 0; i < npts; i += k) {
+            k = MIN(npts - i, (size_t) SAC_DATA_BLOCK);
+            if(pread(fd, y + i, k * sizeof(float), off) != (ssize_t) (k * sizeof(float))) {
+                nerr = ERROR_READING_FILE;
+                sac_data_release(s);
+                goto done;
+            }
+            off += (off_t) (k * sizeof(float));
+            sac_data_swap_extrema(y + i, k, s->m->swap,
+                                  (j == 0 && !(s->m->flags & SAC_READ_NO_EXTREMA)) ? &e : NULL);
+        }
+    }
+    if(!(s->m->flags & SAC_READ_NO_EXTREMA)) {
+        extrema_set(s, &e);
+    }
+    s->m->data_read = TRUE;
+    sac_io_done(fd, (size_t) off, t0, s->m->flags);
+ done:
+    sac_free(h);
+    close(fd);
+    return nerr;
+}
+
+/**
+ * @brief      Get a data component, reading it if necessary
+ *
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Get a data component of a sac file.  For files read with
+ *             SAC_READ_LAZY, the data is read from the file on first access.
+ *
+ * @param      s     sac file
+ * @param      comp  data component, 0 for \p y, 1 for \p x
+ *
+ * @return     data component, NULL if the component does not exist or
+ *             the data could not be read
+ */
+float *
+sac_data(sac *s, int comp) {
+    if(!s || comp < 0 || comp >= sac_comps(s)) {
+        return NULL;
+    }
+    if(!s->m->data_read && sac_data_load(s) != SAC_OK) {
+        return NULL;
+    }
+    return (comp == 0) ? s->y : s->x;
+}
+
+/**
+ * @brief      Create a sac file as a writable memory mapping
+ *
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Create a file of exactly sac_size() bytes for the header
+ *             \p hdr with \p npts samples and map it into memory.  The data
+ *             components of the returned sac file, \p y and \p x, point
+ *             directly into the file so samples can be written in place with
+ *             no intermediate buffers.  The header and v7 footer are
+ *             written by sac_close_mapped().  Until then the file is marked
+ *             as being written, see sac_writer_publish(), with no samples.
+ *             The file is written in the system's byte order.  Space is
+ *             reserved with fallocate(), if available and supported by the
+ *             file system, so filling the mapping does not fail on a full
+ *             file system; if the space can not be reserved, e.g. the file
+ *             system is full, ERROR_WRITING_FILE is returned.  The file is
+ *             created under a temporary name and renamed over \p filename
+ *             once the space is reserved, so an existing file is only
+ *             replaced on success.
+ *
+ * @param      hdr       header template, copied, data is ignored
+ * @param      filename  file to create
+ * @param      npts      number of samples in each component
+ * @param      nerr      status code, 0 on success, non-zero on failure
+ *
+ * @return     sac file with data mapped from the file, NULL on failure
+ *
+ * @code
+ * int nerr = 0;
+ * struct stat st;
+ * sac *s = sac_read("t/test_io_small.sac", &nerr);
+ * sac *m = sac_create_mapped(s, "t/test_io_create_mapped.sac.tmp", 1000, &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(m->h->npts, 1000);
+ * for(int i = 0; i < 1000; i++) {
+ *     m->y[i] = (float) i;
+ * }
+ * stat("t/test_io_create_mapped.sac.tmp", &st);
+ * assert_eq(st.st_size, sac_size(m));
+ * sac_close_mapped(m, &nerr);
+ * assert_eq(nerr, 0);
+ *
+ * sac *c = sac_read("t/test_io_create_mapped.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(c->m->live, 0);
+ * assert_eq(c->h->npts, 1000);
+ * assert_eq(c->y[999], 999.0);
+ * assert_eq(c->h->depmax, 999.0);
+ *
+ * sac_set_v7(s);
+ * m = sac_create_mapped(s, "t/test_io_create_mapped_v7.sac.tmp", 10, &nerr);
+ * memset(m->y, 0, 10 * sizeof(float));
+ * sac_close_mapped(m, &nerr);
+ * c = sac_read("t/test_io_create_mapped_v7.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(c->h->nvhdr, 7);
+ * assert_eq(c->h->depmax, 0.0);
+ * @endcode
+ */
+sac *
+sac_create_mapped(sac *hdr, char *filename, int npts, int *nerr) {
+    int fd = -1;
+    char *map = NULL, *tmp = NULL;
+    size_t size = 0;
+    sac *s = NULL;
+
+    *nerr = SAC_OK;
+    if(!hdr || !filename) {
+        *nerr = ERROR_OPENING_FILE;
+        return NULL;
+    }
+    if((*nerr = sac_check_npts(npts)) != SAC_OK) {
+        return NULL;
+    }
+    if((*nerr = sac_check_lovrok(hdr->h->lovrok)) != SAC_OK) {
+        return NULL;
+    }
+    s = sac_new();
+    sac_header_copy(s, hdr);
+    s->m->filename = strdup(filename);
+    s->h->npts = npts;
+    size = (size_t) sac_size(s);
+
+    if((fd = sac_tmp_open(filename, &tmp)) < 0) {
+        *nerr = ERROR_OPENING_FILE;
+        goto error;
+    }
+#ifdef HAVE_FUNC_FALLOCATE
+    // Only file systems without support for fallocate() are not reserved
+    if(fallocate(fd, 0, 0, (off_t) size) != 0 && errno != EOPNOTSUPP && errno != ENOSYS) {
+        *nerr = ERROR_WRITING_FILE;
+        goto error;
+    }
+#endif /* HAVE_FUNC_FALLOCATE */
+    if(ftruncate(fd, (off_t) size) != 0) {
+        *nerr = ERROR_WRITING_FILE;
+        goto error;
+    }
+    if((map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED) {
+        *nerr = ERROR_WRITING_FILE;
+        goto error;
+    }
+    close(fd);
+    fd = -1;
+    s->m->map = map;
+    s->m->map_size = size;
+    s->y = (float *) (map + SAC_HEADER_SIZE);
+    if(sac_comps(s) == 2) {
+        s->x = s->y + npts;
+    }
+    s->m->nstart = 1;
+    s->m->nstop  = npts;
+    s->m->ntotal = npts;
+    s->m->nfillb = 0;
+    s->m->nfille = 0;
+
+    // Placeholder header, marked as being written with no samples
+    s->h->npts = 0;
+    sac_header_publish(s, -1, map, 1);
+    s->h->npts = npts;
+    if(rename(tmp, filename) != 0) {
+        *nerr = ERROR_WRITING_FILE;
+        goto error;
+    }
+    FREE(tmp);
+    return s;
+
+ error:
+    if(fd >= 0) {
+        close(fd);
+    }
+    if(tmp) {
+        unlink(tmp);
+        FREE(tmp);
+    }
+    sac_free(s);
+    return NULL;
+}
+
+/**
+ * @brief      Finalize and close a sac file created with sac_create_mapped()
+ *
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Compute depmin, depmax, depmen, e and distance values from the
+ *             mapped data, write the v7 footer and then the header into the
+ *             mapping, and release it.  \p s is freed.  Changes reach the file
+ *             through the page cache; use fsync() on the file for durability.
+ *
+ * @param      s     sac file from sac_create_mapped()
+ * @param      nerr  status code, 0 on success, non-zero on failure
+ *
+ */
+void
+sac_close_mapped(sac *s, int *nerr) {
+    char *map = NULL;
+
+    *nerr = SAC_OK;
+    if(!s || !(map = s->m->map)) {
+        *nerr = ERROR_WRITING_FILE;
+        sac_free(s);
+        return;
+    }
+    sac_extrema(s);
+    sac_be(s);
+    update_distaz(s);
+    sac_check_time_precision(s);
+    if(s->h->nvhdr == SAC_HEADER_VERSION_7) {
+        sac_header_v7_encode(s, map + s->m->map_size - sizeof(sac_f64), FALSE);
+    }
+    // Final values are published before the marker is removed
+    sac_header_publish(s, -1, map, 2);
+    sac_header_encode(s, map, FALSE);
+    sac_free(s);
+}
+
+/**
+ * @brief      Convert a sac file to the system's byte order, in place
+ *
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Convert a sac file on disk to the system's byte order.  The
+ *             header, data and v7 footer are byteswapped in place in blocks
+ *             without reading the file into a sac structure.  Files already
+ *             in the system's byte order are not modified.  The header is
+ *             written last, as it determines the byte order of the file.
+ *
+ * @warning    An interrupted conversion leaves a partially converted file
+ *
+ * @param      filename  sac file to convert
+ * @param      nerr      status code, 0 on success, non-zero on error
+ *
+ * @return     1 if the file was converted, 0 otherwise
+ *
+ * @code
+ * int nerr = 0;
+ * sac *s = sac_read("t/test_io_big.sac", &nerr);
+ * sac_write_byte_order(s, "t/test_io_to_native.sac.tmp", ByteOrderInput, &nerr);
+ * assert_eq(nerr, 0);
+ *
+ * sac_file_to_native("t/test_io_to_native.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(sac_file_to_native("t/test_io_to_native.sac.tmp", &nerr), 0);
+ * assert_eq(nerr, 0);
+ *
+ * sac *n = sac_read("t/test_io_to_native.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(n->m->swap, 0);
+ * assert_eq(memcmp(s->y, n->y, sizeof(float) * s->h->npts), 0);
+ * assert_eq(n->h->depmax, s->h->depmax);
+ * @endcode
+ */
+int
+sac_file_to_native(char *filename, int *nerr) {
+    int fd = -1;
+    int converted = 0;
+    off_t off = 0, end = 0;
+    size_t k = 0;
+    sac *s = NULL;
+    struct stat stbuf;
+    char hdr[SAC_HEADER_SIZE];
+    char v7[sizeof(sac_f64)];
+    float buf[SAC_WRITE_BUFFER];
+
+    *nerr = SAC_OK;
+    if(!filename) {
+        *nerr = ERROR_FILE_DOES_NOT_EXIST;
+        return 0;
+    }
+    if((fd = open(filename, O_RDWR)) < 0) {
+        *nerr = sac_errno_to_nerr(errno);
+        return 0;
+    }
+    if(fstat(fd, &stbuf) != 0) {
+        *nerr = sac_errno_to_nerr(errno);
+        goto done;
+    }
+    if(pread(fd, hdr, sizeof hdr, 0) != (ssize_t) sizeof hdr) {
+        *nerr = ERROR_NOT_A_SAC_FILE;
+        goto done;
+    }
+    s = sac_new();
+    if((*nerr = sac_header_read_buffer(s, hdr)) != SAC_OK) {
+        goto done;
+    }
+    if(sac_size(s) != stbuf.st_size) {
+        *nerr = ERROR_NOT_A_SAC_FILE;
+        goto done;
+    }
+    if(! s->m->swap) {
+        goto done;
+    }
+
+    // Data, all components
+    end = SAC_HEADER_SIZE + (off_t) sizeof(float) * s->h->npts * sac_comps(s);
+    for(off = SAC_HEADER_SIZE; off < end; off += (off_t) (k * sizeof(float))) {
+        k = (size_t) MIN((off_t) SAC_WRITE_BUFFER, (end - off) / (off_t) sizeof(float));
+        if(pread(fd, buf, k * sizeof(float), off) != (ssize_t) (k * sizeof(float))) {
+            *nerr = ERROR_READING_FILE;
+            goto done;
+        }
+        sac_swap32(buf, buf, k);
+        if(pwrite(fd, buf, k * sizeof(float), off) != (ssize_t) (k * sizeof(float))) {
+            *nerr = ERROR_WRITING_FILE;
+            goto done;
+        }
+    }
+    // v7 footer
+    if(s->h->nvhdr == SAC_HEADER_VERSION_7) {
+        if(pread(fd, v7, sizeof v7, end) != (ssize_t) sizeof v7) {
+            *nerr = ERROR_READING_FILE;
+            goto done;
+        }
+        sac_swap64(v7, v7, sizeof v7 / sizeof(double));
+        if(pwrite(fd, v7, sizeof v7, end) != (ssize_t) sizeof v7) {
+            *nerr = ERROR_WRITING_FILE;
+            goto done;
+        }
+    }
+    // Numeric header, strings are not byte order dependent
+    sac_swap32(hdr, hdr, SAC_HEADER_NUMBERS);
+    if(pwrite(fd, hdr, SAC_HEADER_NUMBERS_SIZE_BYTES_FILE, 0) !=
+       (ssize_t) SAC_HEADER_NUMBERS_SIZE_BYTES_FILE) {
+        *nerr = ERROR_WRITING_FILE;
+        goto done;
+    }
+    converted = 1;
+ done:
+    sac_free(s);
+    close(fd);
+    return converted;
+}
+
+/**
+ * @brief      Overwrite a range of samples of an existing sac file, in place
+ *
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Overwrite samples \p i0 to \p i0 + \p n - 1, counting from 0,
+ *             of the first data component of an existing file.  Samples are
+ *             written with pwrite() at SAC_HEADER_SIZE + 4 * \p i0 in the byte
+ *             order of the file; no other data is read or written.
+ *
+ *             depmin, depmax and depmen are updated incrementally from the
+ *             samples replaced and their replacements.  Only if a replaced
+ *             sample held the minimum or maximum, and the new samples do not
+ *             reach it, is the data scanned to find the new extrema.  The
+ *             header is rewritten in place, the v7 footer is not modified.
+ *             Files still being written by a sac_writer and files with
+ *             packed data are not modified.
+ *
+ * @param      filename  existing sac file
+ * @param      i0        index of the first sample to overwrite, from 0
+ * @param      y         new samples, in the system's byte order
+ * @param      n         number of samples in \p y
+ * @param      nerr      status code, 0 on success, non-zero on failure,
+ *                       ERROR_WRITING_FILE if the range is beyond the data
+ *
+ * @code
+ * int nerr = 0;
+ * float y[5] = { 1e3, 2e3, 3e3, 4e3, 5e3 };
+ * sac *s = sac_read("t/test_io_big.sac", &nerr);
+ * sac_write(s, "t/test_io_patch.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ *
+ * sac_write_samples("t/test_io_patch.sac.tmp", 10, y, 5, &nerr);
+ * assert_eq(nerr, 0);
+ * memcpy(s->y + 10, y, sizeof y);
+ * sac_extrema(s);
+ *
+ * sac *c = sac_read("t/test_io_patch.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(c->m->swap, s->m->swap);
+ * assert_eq(memcmp(c->y, s->y, sizeof(float) * s->h->npts), 0);
+ * assert_eq(c->h->depmax, 5e3);
+ * assert_eq(c->h->depmin, s->h->depmin);
+ * assert(fabs(c->h->depmen - s->h->depmen) < 1e-3);
+ *
+ * // Replace the maximum, requires a scan of the data
+ * memset(y, 0, sizeof y);
+ * sac_write_samples("t/test_io_patch.sac.tmp", 10, y, 5, &nerr);
+ * assert_eq(nerr, 0);
+ * memcpy(s->y + 10, y, sizeof y);
+ * sac_extrema(s);
+ * c = sac_read("t/test_io_patch.sac.tmp", &nerr);
+ * assert_eq(c->h->depmax, s->h->depmax);
+ *
+ * sac_write_samples("t/test_io_patch.sac.tmp", 98, y, 5, &nerr);
+ * assert_eq(nerr, 115);
+ * @endcode
+ */
+void
+sac_write_samples(char *filename, size_t i0, const float *y, size_t n, int *nerr) {
+    int fd = -1;
+    int rescan = FALSE;
+    size_t i = 0, k = 0, npts = 0;
+    off_t off = 0;
+    double sum = 0.0;
+    sac *s = NULL;
+    extrema eold, enew;
+    float buf[SAC_WRITE_BUFFER];
+    char hdr[SAC_HEADER_SIZE];
+
+    *nerr = SAC_OK;
+    if(!filename) {
+        *nerr = ERROR_FILE_DOES_NOT_EXIST;
+        return;
+    }
+    if((fd = open(filename, O_RDWR)) < 0) {
+        *nerr = sac_errno_to_nerr(errno);
+        return;
+    }
+    if(!(s = sac_header_read_fd(fd, filename, NULL, nerr))) {
+        goto done;
+    }
+    npts = (size_t) s->h->npts;
+    if(s->m->live || s->m->pack || i0 > npts || n > npts - i0) {
+        *nerr = ERROR_WRITING_FILE;
+        goto done;
+    }
+
+    // Read the samples replaced, then write their replacements
+    extrema_init(&eold);
+    extrema_init(&enew);
+    for(i = 0; i < n; i += k) {
+        k = MIN(n - i, (size_t) SAC_WRITE_BUFFER);
+        off = SAC_HEADER_SIZE + (off_t) ((i0 + i) * sizeof(float));
+        if(pread(fd, buf, k * sizeof(float), off) != (ssize_t) (k * sizeof(float))) {
+            *nerr = ERROR_READING_FILE;
+            goto done;
+        }
+        sac_data_swap_extrema(buf, k, s->m->swap, &eold);
+        extrema_update(&enew, y + i, k);
+        if(s->m->swap) {
+            sac_swap32(buf, y + i, k);
+        } else {
+            memcpy(buf, y + i, k * sizeof(float));
+        }
+        if(pwrite(fd, buf, k * sizeof(float), off) != (ssize_t) (k * sizeof(float))) {
+            *nerr = ERROR_WRITING_FILE;
+            goto done;
+        }
+    }
+    if(n == 0) {
+        goto done;
+    }
+
+    // Update extrema from the replaced and new samples where possible
+    if(s->h->depmin == SAC_FLOAT_UNDEFINED || s->h->depmax == SAC_FLOAT_UNDEFINED ||
+       s->h->depmen == SAC_FLOAT_UNDEFINED || n == npts) {
+        rescan = TRUE;
+    }
+    if(eold.min <= s->h->depmin && enew.min > eold.min) {
+        rescan = TRUE;
+    }
+    if(eold.max >= s->h->depmax && enew.max < eold.max) {
+        rescan = TRUE;
+    }
+    if(eold.nonfinite > 0) {
+        rescan = TRUE;
+    }
+    if(rescan) {
+        extrema_init(&enew);
+        for(i = 0; i < npts; i += k) {
+            k = MIN(npts - i, (size_t) SAC_WRITE_BUFFER);
+            off = SAC_HEADER_SIZE + (off_t) (i * sizeof(float));
+            if(pread(fd, buf, k * sizeof(float), off) != (ssize_t) (k * sizeof(float))) {
+                *nerr = ERROR_READING_FILE;
+                goto done;
+            }
+            sac_data_swap_extrema(buf, k, s->m->swap, &enew);
+        }
+        extrema_set(s, &enew);
+    } else {
+        sum = (double) s->h->depmen * (double) npts - eold.sum + enew.sum;
+        s->h->depmin = fminf(s->h->depmin, enew.min);
+        s->h->depmax = fmaxf(s->h->depmax, enew.max);
+        s->h->depmen = (float) (sum / (double) npts);
+        check_value(s->h->depmin, s->h->depmax, enew.nonfinite);
+    }
+    sac_header_encode(s, hdr, s->m->swap);
+    if(pwrite(fd, hdr, sizeof hdr, 0) != (ssize_t) sizeof hdr) {
+        *nerr = ERROR_WRITING_FILE;
+    }
+ done:
+    sac_free(s);
+    close(fd);
+}
+
+/**
+ * @brief      Sample types for reading data into caller owned buffers
+ * @private
+ */
+enum SampleType {
+    SampleFloat  = 0, /**< @brief float, 32-bit */
+    SampleDouble = 1, /**< @brief double, 64-bit */
+    SampleInt32  = 2, /**< @brief scaled 32-bit integer */
+};
+
+/**
+ * @brief      Convert a float to a scaled 32-bit integer
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Values are rounded to the nearest integer and saturated at
+ *             the limits of a 32-bit integer, NaN values are returned as 0
+ *
+ * @param      v      value to convert
+ * @param      scale  scale to multiply \p v by before conversion
+ *
+ * @return     converted value
+ */
+static int32_t
+float_to_int32(float v, double scale) {
+    double d = (double) v * scale;
+    if(isnan(d)) {
+        return 0;
+    }
+    if(d >= (double) INT32_MAX) {
+        return INT32_MAX;
+    }
+    if(d <= (double) INT32_MIN) {
+        return INT32_MIN;
+    }
+    return (int32_t) lrint(d);
+}
+
+/**
+ * @brief      Read a sac file into a caller owned buffer
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Read the header and then the data in blocks.  Each block is
+ *             read, byteswapped, scanned for extrema and converted to the
+ *             output type in a single pass.  Float output is read directly
+ *             into \p dst, other types are read through a small bounce buffer.
+ *             Packed data is unpacked a block at a time, see sac_pack_read().
+ *
+ * @param      filename  file to read
+ * @param      dst       output buffer of type \p type
+ * @param      n         capacity of \p dst in samples
+ * @param      type      type of \p dst
+ * @param      scale     scale for integer output
+ * @param      nerr      status code, 0 on success, non-zero on failure
+ *
+ * @return     sac file with only the header, NULL on failure
+ */
+static sac *
+sac_read_into_internal(char *filename, void *dst, size_t n, enum SampleType type,
+                       double scale, int *nerr) {
+    int fd = -1, dfd = -1, j = 0;
+    FILE *fp = NULL;
+    size_t i = 0, k = 0, m = 0, npts = 0, at = 0;
+    off_t off = 0;
+    sac *s = NULL;
+    extrema e;
+    float buf[SAC_READ_BUFFER];
+    float *src = NULL;
+
+    *nerr = SAC_OK;
+    if(!filename) {
+        *nerr = ERROR_FILE_DOES_NOT_EXIST;
+        return NULL;
+    }
+    if((fd = open(filename, O_RDONLY)) < 0) {
+        *nerr = sac_errno_to_nerr(errno);
+        return NULL;
+    }
+    if(!(s = sac_header_read_fd(fd, filename, NULL, nerr))) {
+        goto error;
+    }
+    if((*nerr = sac_check_npts(s->h->npts)) != SAC_OK) {
+        goto error;
+    }
+    npts = (size_t) s->h->npts;
+    if(npts * (size_t) sac_comps(s) > n) {
+        *nerr = ERROR_BUFFER_TOO_SMALL;
+        goto error;
+    }
+    if(s->m->pack) {
+        if((dfd = dup(fd)) < 0 || !(fp = fdopen(dfd, "rb"))) {
+            *nerr = ERROR_READING_FILE;
+            goto error;
+        }
+        dfd = -1;
+    }
+
+    extrema_init(&e);
+    off = SAC_HEADER_SIZE;
+    for(j = 0; j < sac_comps(s); j++) {
+        for(i = 0; i < npts; i += k) {
+            at = (size_t) j * npts + i;
+            if(type == SampleFloat) {
+                k = MIN(npts - i, (size_t) SAC_DATA_BLOCK);
+                src = (float *) dst + at;
+            } else {
+                k = MIN(npts - i, (size_t) SAC_READ_BUFFER);
+                src = buf;
+            }
+            if(fp) {
+                if((*nerr = sac_pack_read(s, fp, npts, j, i, k, src, (j == 0) ? &e : NULL, NULL)) != SAC_OK) {
+                    goto error;
+                }
+            } else {
+                if(pread(fd, src, k * sizeof(float), off) != (ssize_t) (k * sizeof(float))) {
+                    *nerr = ERROR_READING_FILE;
+                    goto error;
+                }
+                off += (off_t) (k * sizeof(float));
+                sac_data_swap_extrema(src, k, s->m->swap, (j == 0) ? &e : NULL);
+            }
+            if(type == SampleDouble) {
+                for(m = 0; m < k; m++) {
+                    ((double *) dst)[at + m] = (double) src[m];
+                }
+            } else if(type == SampleInt32) {
+                for(m = 0; m < k; m++) {
+                    ((int32_t *) dst)[at + m] = float_to_int32(src[m], scale);
+                }
+            }
+        }
+    }
+    if(fp) {
+        fclose(fp);
+    }
+    close(fd);
+    extrema_set(s, &e);
+    s->m->nstart = 1;
+    s->m->nstop  = s->h->npts;
+    s->m->ntotal = s->h->npts;
+    s->m->nfillb = 0;
+    s->m->nfille = 0;
+
+    sac_read_post(s, 0);
+
+    return s;
+
+ error:
+    if(s) {
+        sac_free(s);
+        s = NULL;
+    }
+    if(dfd >= 0) {
+        close(dfd);
+    }
+    if(fp) {
+        fclose(fp);
+    }
+    if(fd >= 0) {
+        close(fd);
+    }
+    return NULL;
+}
+
+/**
+ * @brief      Read a sac file into a caller owned float buffer
+ *
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Read a sac file header and data, with the data placed directly
+ *             into \p y and converted to the system's byte order.  No data
+ *             arrays are allocated.  For two component files, e.g. uneven or
+ *             spectral, the second component follows the first in \p y.
+ *             Header values are updated as in sac_read().
+ *
+ * @param      filename  file to read
+ * @param      y         output data, at least npts * sac_comps() values
+ * @param      n         capacity of \p y in samples
+ * @param      nerr      status code, 0 on success, non-zero on failure,
+ *                       ERROR_BUFFER_TOO_SMALL if \p y is too small
+ *
+ * @return     sac file with only the header, data in \p y, NULL on failure
+ *
+ * @code
+ * int nerr = 0;
+ * float y[1024];
+ * sac *s = sac_read("t/test_io_big.sac", &nerr);
+ * sac *h = sac_read_into_float("t/test_io_big.sac", y, 1024, &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(h->y, NULL);
+ * assert_eq(memcmp(y, s->y, sizeof(float) * s->h->npts), 0);
+ * assert_eq(h->h->depmax, s->h->depmax);
+ * assert_eq(h->h->depmen, s->h->depmen);
+ * sac_free(h);
+ *
+ * h = sac_read_into_float("t/test_io_big.sac", y, 10, &nerr);
+ * assert_eq(h, NULL);
+ * assert_eq(nerr, ERROR_BUFFER_TOO_SMALL);
+ * @endcode
+ */
+sac *
+sac_read_into_float(char *filename, float *y, size_t n, int *nerr) {
+    return sac_read_into_internal(filename, y, n, SampleFloat, 1.0, nerr);
+}
+
+/**
+ * @brief      Read a sac file into a caller owned double buffer
+ *
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Read a sac file as sac_read_into_float(), with the data
+ *             widened to double as it is read
+ *
+ * @param      filename  file to read
+ * @param      y         output data, at least npts * sac_comps() values
+ * @param      n         capacity of \p y in samples
+ * @param      nerr      status code, 0 on success, non-zero on failure,
+ *                       ERROR_BUFFER_TOO_SMALL if \p y is too small
+ *
+ * @return     sac file with only the header, data in \p y, NULL on failure
+ *
+ * @code
+ * int nerr = 0;
+ * double y[2048];
+ * sac *s = sac_read("t/test_uneven_small.sac", &nerr);
+ * sac *h = sac_read_into_double("t/test_uneven_small.sac", y, 2048, &nerr);
+ * assert_eq(nerr, 0);
+ * for(int i = 0; i < s->h->npts; i++) {
+ *     assert_eq(y[i], (double) s->y[i]);
+ *     assert_eq(y[s->h->npts + i], (double) s->x[i]);
+ * }
+ * sac_free(h);
+ * @endcode
+ */
+sac *
+sac_read_into_double(char *filename, double *y, size_t n, int *nerr) {
+    return sac_read_into_internal(filename, y, n, SampleDouble, 1.0, nerr);
+}
+
+/**
+ * @brief      Read a sac file into a caller owned scaled integer buffer
+ *
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Read a sac file as sac_read_into_float(), with each value
+ *             multiplied by \p scale and rounded to the nearest integer as
+ *             it is read.  Values beyond the range of a 32-bit integer are
+ *             saturated and NaN values are stored as 0.  Header values, e.g.
+ *             depmin and depmax, are those of the unscaled data.
+ *
+ * @param      filename  file to read
+ * @param      y         output data, at least npts * sac_comps() values
+ * @param      n         capacity of \p y in samples
+ * @param      scale     scale applied to each value before conversion
+ * @param      nerr      status code, 0 on success, non-zero on failure,
+ *                       ERROR_BUFFER_TOO_SMALL if \p y is too small
+ *
+ * @return     sac file with only the header, data in \p y, NULL on failure
+ *
+ * @code
+ * int nerr = 0;
+ * int32_t y[1024];
+ * sac *s = sac_read("t/test_io_big.sac", &nerr);
+ * sac *h = sac_read_into_int32("t/test_io_big.sac", y, 1024, 1000.0, &nerr);
+ * assert_eq(nerr, 0);
+ * for(int i = 0; i < s->h->npts; i++) {
+ *     assert_eq(y[i], (int32_t) lrint(s->y[i] * 1000.0));
+ * }
+ * sac_free(h);
+ * @endcode
+ */
+sac *
+sac_read_into_int32(char *filename, int32_t *y, size_t n, double scale, int *nerr) {
+    return sac_read_into_internal(filename, y, n, SampleInt32, scale, nerr);
+}
+
+/**
+ * @brief      Open a sac file for reading in fixed size blocks
+ *
+ * @ingroup    sac
+ * @memberof   sac_reader
+ *
+ * @details    Open a sac file for streaming reads.  The header, including the
+ *             v7 footer, is read and available immediately as \p r->s, with
+ *             values updated as in sac_read_header().  Data is then read with
+ *             sac_reader_next_block() into buffers of \p block samples owned
+ *             by the reader, so memory use is bounded by \p block regardless
+ *             of the length of the file.  Files still being written by a
+ *             sac_writer may be followed as they grow with sac_reader_wait().
+ *
+ * @param      filename  file to read
+ * @param      block     number of samples per block, must be greater than 0
+ * @param      nerr      status code, 0 on success, non-zero on failure,
+ *                       ERROR_PACKED_DATA for files with packed data
+ *
+ * @return     sac reader, NULL on failure, close with sac_reader_close()
+ *
+ * @code
+ * int nerr = 0;
+ * size_t n = 0;
+ * double b = 0.0, delta = 0.0;
+ * sac *s = sac_read("t/test_io_big.sac", &nerr);
+ * sac_get_float(s, SAC_B, &b);
+ * sac_get_float(s, SAC_DELTA, &delta);
+ * sac_reader *r = sac_reader_open("t/test_io_big.sac", 30, &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(r->s->h->npts, s->h->npts);
+ * assert_eq(r->s->y, NULL);
+ * while((n = sac_reader_next_block(r, &nerr)) > 0) {
+ *     assert(n <= 30);
+ *     assert_eq(memcmp(r->y, s->y + r->start, n * sizeof(float)), 0);
+ *     assert_eq(sac_reader_time(r), b + r->start * delta);
+ * }
+ * assert_eq(nerr, 0);
+ * assert_eq(r->start + r->n, (size_t) s->h->npts);
+ *
+ * assert_eq(sac_reader_seek_sample(r, 85), 0);
+ * assert_eq(sac_reader_next_block(r, &nerr), 15);
+ * assert_eq(r->start, 85);
+ * assert_eq(memcmp(r->y, s->y + 85, 15 * sizeof(float)), 0);
+ * assert_ne(sac_reader_seek_sample(r, 101), 0);
+ * assert_eq(r->live, 0);
+ * sac_reader_close(r);
+ *
+ * r = sac_reader_open("t/test_uneven_small.sac", 64, &nerr);
+ * s = sac_read("t/test_uneven_small.sac", &nerr);
+ * assert_eq(sac_reader_next_block(r, &nerr), 64);
+ * assert_eq(memcmp(r->x, s->x, 64 * sizeof(float)), 0);
+ * sac_reader_close(r);
+ * @endcode
+ */
+sac_reader *
+sac_reader_open(char *filename, size_t block, int *nerr) {
+    int fd = -1;
+    sac_reader *r = NULL;
+
+    *nerr = SAC_OK;
+    if(!filename) {
+        *nerr = ERROR_FILE_DOES_NOT_EXIST;
+        return NULL;
+    }
+    if(block == 0) {
+        *nerr = ERROR_BUFFER_TOO_SMALL;
+        return NULL;
+    }
+    if((fd = open(filename, O_RDONLY)) < 0) {
+        *nerr = sac_errno_to_nerr(errno);
+        return NULL;
+    }
+    r = calloc(1, sizeof(sac_reader));
+    r->fd = fd;
+    r->ifd = -1;
+    r->block = block;
+    if(!(r->s = sac_header_read_fd(fd, filename, NULL, nerr))) {
+        goto error;
+    }
+    r->live = r->s->m->live;
+    if(!r->live && (*nerr = sac_check_npts(r->s->h->npts)) != SAC_OK) {
+        goto error;
+    }
+    if(r->s->m->pack) {
+        *nerr = ERROR_PACKED_DATA;
+        goto error;
+    }
+    sac_read_post(r->s, 0);
+    r->y = calloc(block, sizeof(float));
+    if(sac_comps(r->s) == 2) {
+        r->x = calloc(block, sizeof(float));
+    }
+    return r;
+ error:
+    sac_reader_close(r);
+    return NULL;
+}
+
+/**
+ * @brief      Read the next block of data
+ *
+ * @ingroup    sac
+ * @memberof   sac_reader
+ *
+ * @details    Read up to \p r->block samples of each component into \p r->y,
+ *             and \p r->x for two component files, converted to the system's
+ *             byte order.  On return \p r->start is the sample index, from 0,
+ *             of the first sample of the block and \p r->n is the number of
+ *             samples in the block.
+ *
+ * @param      r     sac reader
+ * @param      nerr  status code, 0 on success, non-zero on failure
+ *
+ * @return     number of samples read, 0 at the end of the data or on failure
+ */
+size_t
+sac_reader_next_block(sac_reader *r, int *nerr) {
+    int j = 0;
+    size_t k = 0, npts = (size_t) r->s->h->npts;
+    off_t off = 0;
+    float *y = NULL;
+
+    *nerr = SAC_OK;
+    r->start = r->next;
+    r->n = 0;
+    if(r->next >= npts) {
+        return 0;
+    }
+    k = MIN(npts - r->next, r->block);
+    for(j = 0; j < sac_comps(r->s); j++) {
+        y = (j == 0) ? r->y : r->x;
+        off = SAC_HEADER_SIZE + (off_t) (((size_t) j * npts + r->next) * sizeof(float));
+        if(pread(r->fd, y, k * sizeof(float), off) != (ssize_t) (k * sizeof(float))) {
+            *nerr = ERROR_READING_FILE;
+            return 0;
+        }
+        sac_data_swap_extrema(y, k, r->s->m->swap, NULL);
+    }
+    r->n = k;
+    r->next += k;
+    return k;
+}
+
+/**
+ * @brief      Set the sample the next block starts at
+ *
+ * @ingroup    sac
+ * @memberof   sac_reader
+ *
+ * @param      r     sac reader
+ * @param      i     sample index, from 0, of the next block, npts seeks to
+ *                   the end of the data
+ *
+ * @return     0 on success, ERROR_READING_FILE if \p i is beyond the data
+ */
+int
+sac_reader_seek_sample(sac_reader *r, size_t i) {
+    if(i > (size_t) r->s->h->npts) {
+        return ERROR_READING_FILE;
+    }
+    r->next = i;
+    return SAC_OK;
+}
+
+/**
+ * @brief      Time of the first sample of the current block
+ *
+ * @ingroup    sac
+ * @memberof   sac_reader
+ *
+ * @details    Time is relative to the reference time and computed from the
+ *             64-bit begin and delta values, b + start * delta.  Only
+ *             meaningful for evenly spaced data.
+ *
+ * @param      r     sac reader
+ *
+ * @return     time of the first sample of the current block
+ */
+double
+sac_reader_time(sac_reader *r) {
+    return r->s->z->_b + (double) r->start * r->s->z->_delta;
+}
+
+/**
+ * @brief      Read the header of a file being written again
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac_reader
+ *
+ * @param      r     sac reader
+ *
+ * @return     status code, 0 on success, non-zero on failure
+ */
+static int
+sac_reader_refresh(sac_reader *r) {
+    int nerr = SAC_OK;
+    sac *n = NULL;
+    if(!(n = sac_header_read_fd(r->fd, r->s->m->filename, NULL, &nerr))) {
+        return nerr;
+    }
+    sac_header_copy(r->s, n);
+    r->s->m->live = n->m->live;
+    r->s->m->seq  = n->m->seq;
+    r->live = n->m->live;
+    sac_free(n);
+    sac_read_post(r->s, 0);
+    return SAC_OK;
+}
+
+/**
+ * @brief      Milliseconds on a monotonic clock
+ * @private
+ */
+static int64_t
+monotonic_ms(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (int64_t) t.tv_sec * 1000 + t.tv_nsec / 1000000;
+}
+
+/**
+ * @brief      Wait for a file being written to change
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac_reader
+ *
+ * @details    Wait on inotify for modifications to the file, if available,
+ *             otherwise sleep for a short interval
+ *
+ * @param      r     sac reader
+ * @param      ms    maximum time to wait in milliseconds
+ *
+ */
+static void
+sac_reader_sleep(sac_reader *r, int ms) {
+#ifdef HAVE_FUNC_INOTIFY_INIT1
+    char buf[4096];
+    struct pollfd p;
+    if(r->ifd >= 0) {
+        p.fd = r->ifd;
+        p.events = POLLIN;
+        p.revents = 0;
+        if(poll(&p, 1, ms) > 0) {
+            // Drain events, the header is read again regardless of the event
+            while(read(r->ifd, buf, sizeof buf) > 0) { }
+        }
+        return;
+    }
+#endif /* HAVE_FUNC_INOTIFY_INIT1 */
+    poll(NULL, 0, (ms < 0 || ms > 10) ? 10 : ms);
+}
+
+/**
+ * @brief      Wait for data to be published to a file being written
+ *
+ * @ingroup    sac
+ * @memberof   sac_reader
+ *
+ * @details    Follow a file being written by a sac_writer.  The header is
+ *             read again, and if no new samples are available the reader
+ *             waits, using inotify where available instead of polling, until
+ *             the writer publishes more samples, closes the file or
+ *             \p timeout_ms elapses.  Once the file is closed, \p r->live
+ *             is 0 and no further samples will be available.  New samples
+ *             are read with sac_reader_next_block().
+ *
+ * @param      r           sac reader
+ * @param      timeout_ms  maximum time to wait in milliseconds, 0 to check
+ *                         without waiting, negative to wait indefinitely
+ * @param      nerr        status code, 0 on success, non-zero on failure
+ *
+ * @return     number of samples available and not yet read
+ */
+size_t
+sac_reader_wait(sac_reader *r, int timeout_ms, int *nerr) {
+    int64_t end = monotonic_ms() + timeout_ms;
+    int64_t ms = 0;
+
+    *nerr = SAC_OK;
+#ifdef HAVE_FUNC_INOTIFY_INIT1
+    // Watch before reading the header, so no publication is missed
+    if(r->live && timeout_ms != 0 && r->ifd < 0) {
+        r->ifd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if(r->ifd >= 0 &&
+           inotify_add_watch(r->ifd, r->s->m->filename, IN_MODIFY | IN_CLOSE_WRITE) < 0) {
+            close(r->ifd);
+            r->ifd = -1;
+        }
+    }
+#endif /* HAVE_FUNC_INOTIFY_INIT1 */
+    for(;;) {
+        if(r->live && (*nerr = sac_reader_refresh(r)) != SAC_OK) {
+            return 0;
+        }
+        if((size_t) r->s->h->npts > r->next) {
+            return (size_t) r->s->h->npts - r->next;
+        }
+        if(!r->live) {
+            return 0;
+        }
+        ms = (timeout_ms < 0) ? -1 : end - monotonic_ms();
+        if(timeout_ms >= 0 && ms <= 0) {
+            return 0;
+        }
+        sac_reader_sleep(r, (int) ms);
+    }
+    return 0;
+}
+
+/**
+ * @brief      Close a sac reader
+ *
+ * @ingroup    sac
+ * @memberof   sac_reader
+ *
+ * @details    Close the file and free the header and block buffers
+ *
+ * @param      r     sac reader, may be NULL
+ */
+void
+sac_reader_close(sac_reader *r) {
+    if(!r) {
+        return;
+    }
+    if(r->fd >= 0) {
+        close(r->fd);
+    }
+    if(r->ifd >= 0) {
+        close(r->ifd);
+    }
+    sac_free(r->s);
+    FREE(r->y);
+    FREE(r->x);
+    free(r);
+}
+
+/**
+ * @brief      Write the current header and v7 footer of a streaming writer
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac_writer
+ *
+ * @details    Update npts, e, depmin, depmax and depmen from the samples
+ *             written so far and write the header.  The header is published
+ *             with the marker and a new sequence number, see
+ *             sac_header_publish().  While \p live, no v7 footer is written.
+ *             Otherwise the v7 footer is written following the last sample
+ *             and the final values are published before the final header
+ *             without the marker, so readers never see a completed header
+ *             without its footer.
+ *
+ * @param      w     sac writer
+ * @param      live  if the file is still being written
+ *
+ * @return     status code, 0 on success, ERROR_WRITING_FILE on failure
+ */
+static int
+sac_writer_patch(sac_writer *w, int live) {
+    int nerr = SAC_OK;
+    sac *s = w->s;
+    char hdr[SAC_HEADER_SIZE];
+    char v7[sizeof(sac_f64)];
+
+    s->h->npts = (int) w->npts;
+    if(w->npts > 0) {
+        s->h->depmen = (float) (w->sum / (double) w->npts);
+        sac_be(s);
+    }
+    if(!live && s->h->nvhdr == SAC_HEADER_VERSION_7) {
+        sac_header_v7_encode(s, v7, FALSE);
+        if(pwrite(w->fd, v7, sizeof v7, sac_size(s) - (off_t) sizeof v7) != (ssize_t) sizeof v7) {
+            return ERROR_WRITING_FILE;
+        }
+    }
+    if((nerr = sac_header_publish(s, w->fd, NULL, ++w->seq)) != SAC_OK || live) {
+        return nerr;
+    }
+    sac_header_encode(s, hdr, FALSE);
+    if(pwrite(w->fd, hdr, sizeof hdr, 0) != (ssize_t) sizeof hdr) {
+        return ERROR_WRITING_FILE;
+    }
+    return SAC_OK;
+}
+
+/**
+ * @brief      Publish the samples written so far to concurrent readers
+ *
+ * @ingroup    sac
+ * @memberof   sac_writer
+ *
+ * @details    Write a header describing all samples appended so far, marked
+ *             as still being written.  Readers, e.g. sac_read() or a
+ *             sac_reader following the file with sac_reader_wait(), always
+ *             see the samples of the last published header.
+ *
+ * @param      w     sac writer
+ * @param      nerr  status code, 0 on success, non-zero on failure
+ *
+ * @code
+ * int nerr = 0;
+ * sac *s = sac_read("t/test_io_small.sac", &nerr);
+ * sac_writer *w = sac_writer_open(s, "t/test_io_live.sac.tmp", &nerr);
+ * sac_reader *r = sac_reader_open("t/test_io_live.sac.tmp", 64, &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(r->live, 1);
+ * assert_eq(r->s->h->npts, 0);
+ * assert_eq(sac_reader_wait(r, 0, &nerr), 0);
+ *
+ * // Appended, but not published
+ * sac_writer_append(w, s->y, 40, &nerr);
+ * assert_eq(sac_reader_wait(r, 0, &nerr), 0);
+ * sac *c = sac_read_header("t/test_io_live.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(c->h->npts, 0);
+ *
+ * // Published
+ * sac_writer_publish(w, &nerr);
+ * assert_eq(sac_reader_wait(r, 1000, &nerr), 40);
+ * assert_eq(sac_reader_next_block(r, &nerr), 40);
+ * assert_eq(memcmp(r->y, s->y, 40 * sizeof(float)), 0);
+ * c = sac_read("t/test_io_live.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(c->m->live, 1);
+ * assert_eq(c->h->npts, 40);
+ * assert_eq(c->h->unused25, -12345);
+ *
+ * // Closed
+ * sac_writer_append(w, s->y + 40, s->h->npts - 40, &nerr);
+ * sac_writer_close(w, &nerr);
+ * assert_eq(sac_reader_wait(r, 1000, &nerr), (size_t) s->h->npts - 40);
+ * assert_eq(r->live, 0);
+ * assert_eq(sac_reader_next_block(r, &nerr), (size_t) s->h->npts - 40);
+ * assert_eq(memcmp(r->y, s->y + 40, (s->h->npts - 40) * sizeof(float)), 0);
+ * assert_eq(sac_reader_wait(r, 1000, &nerr), 0);
+ * sac_reader_close(r);
+ * c = sac_read("t/test_io_live.sac.tmp", &nerr);
+ * assert_eq(c->m->live, 0);
+ * @endcode
+ */
+void
+sac_writer_publish(sac_writer *w, int *nerr) {
+    *nerr = sac_writer_patch(w, TRUE);
+}
+
+/**
+ * @brief      Open a sac file for streaming writes
+ *
+ * @ingroup    sac
+ * @memberof   sac_writer
+ *
+ * @details    Create a sac file and write a placeholder header taken from
+ *             \p hdr, with no data.  Samples are added with
+ *             sac_writer_append() and the header, and v7 footer, is finalized
+ *             with sac_writer_close().  Until closed, the file is marked as
+ *             being written and readers see the samples published with
+ *             sac_writer_publish().  Memory use is constant regardless of
+ *             the number of samples written.  Only evenly spaced, single
+ *             component files are supported and the file is written in the
+ *             system's byte order.
+ *
+ * @param      hdr       header template, e.g. delta, b, reference time and
+ *                       station values; data and npts are ignored
+ * @param      filename  file to create
+ * @param      nerr      status code, 0 on success, non-zero on failure
+ *
+ * @return     sac writer, NULL on failure
+ *
+ * @code
+ * int nerr = 0;
+ * sac *s = sac_read("t/test_io_small.sac", &nerr);
+ * sac_writer *w = sac_writer_open(s, "t/test_io_stream.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ * for(int i = 0; i < s->h->npts; i += 7) {
+ *     int n = (s->h->npts - i < 7) ? s->h->npts - i : 7;
+ *     sac_writer_append(w, s->y + i, n, &nerr);
+ *     assert_eq(nerr, 0);
+ *     assert_eq(w->s->h->npts, i + n);
+ * }
+ * sac_writer_close(w, &nerr);
+ * assert_eq(nerr, 0);
+ *
+ * sac *c = sac_read("t/test_io_stream.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(c->h->npts, s->h->npts);
+ * assert_eq(memcmp(c->y, s->y, sizeof(float) * s->h->npts), 0);
+ * assert_eq(c->h->_e, s->h->_e);
+ * assert_eq(c->h->depmin, s->h->depmin);
+ * assert_eq(c->h->depmax, s->h->depmax);
+ *
+ * sac_set_v7(s);
+ * w = sac_writer_open(s, "t/test_io_stream_v7.sac.tmp", &nerr);
+ * sac_writer_append(w, s->y, s->h->npts, &nerr);
+ * sac_writer_close(w, &nerr);
+ * assert_eq(nerr, 0);
+ * c = sac_read("t/test_io_stream_v7.sac.tmp", &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(c->h->nvhdr, 7);
+ * assert_eq(memcmp(c->y, s->y, sizeof(float) * s->h->npts), 0);
+ * @endcode
+ */
+sac_writer *
+sac_writer_open(sac *hdr, char *filename, int *nerr) {
+    int fd = -1;
+    sac_writer *w = NULL;
+
+    *nerr = SAC_OK;
+    if(!hdr->h->leven || sac_comps(hdr) != 1) {
+        *nerr = ERROR_WRITING_FILE;
+        return NULL;
+    }
+    if((*nerr = sac_check_lovrok(hdr->h->lovrok)) != SAC_OK) {
+        return NULL;
+    }
+    if((fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0666)) < 0) {
+        *nerr = ERROR_OPENING_FILE;
+        return NULL;
+    }
+    w = calloc(1, sizeof(sac_writer));
+    w->fd = fd;
+    w->s = sac_new();
+    sac_header_copy(w->s, hdr);
+    w->s->m->filename = strdup(filename);
+    w->s->h->depmin = SAC_FLOAT_UNDEFINED;
+    w->s->h->depmax = SAC_FLOAT_UNDEFINED;
+    w->s->h->depmen = SAC_FLOAT_UNDEFINED;
+    update_distaz(w->s);
+    if((*nerr = sac_writer_patch(w, TRUE)) != SAC_OK) {
+        close(w->fd);
+        w->fd = -1;
+        sac_free(w->s);
+        free(w);
+        return NULL;
+    }
+    return w;
+}
+
+/**
+ * @brief      Append samples to a streaming sac file
+ *
+ * @ingroup    sac
+ * @memberof   sac_writer
+ *
+ * @details    Write samples following those already written.  The header
+ *             values npts, e, depmin, depmax and depmen in \p w->s are updated
+ *             incrementally; the header on disk is updated on close.
+ *
+ * @param      w     sac writer
+ * @param      y     samples to append
+ * @param      n     number of samples in \p y
+ * @param      nerr  status code, 0 on success, non-zero on failure
+ *
+ */
+void
+sac_writer_append(sac_writer *w, const float *y, size_t n, int *nerr) {
+    extrema e;
+    struct iovec iov;
+    off_t off = 0;
+
+    *nerr = SAC_OK;
+    if(n == 0) {
+        return;
+    }
+    if(w->npts + n > (size_t) INT32_MAX) {
+        *nerr = ERROR_WRITING_FILE;
+        return;
+    }
+    off = SAC_HEADER_SIZE + (off_t) (w->npts * sizeof(float));
+    iov.iov_base = (void *) y;
+    iov.iov_len = n * sizeof(float);
+    if((*nerr = sac_pwritev_all(w->fd, &iov, 1, &off)) != SAC_OK) {
+        return;
+    }
+
+    extrema_init(&e);
+    if(w->npts > 0) {
+        e.min = w->s->h->depmin;
+        e.max = w->s->h->depmax;
+    }
+    e.sum = w->sum;
+    e.n = w->npts;
+    e.nonfinite = w->nonfinite;
+    extrema_update(&e, y, n);
+
+    w->npts += n;
+    w->sum = e.sum;
+    w->nonfinite = e.nonfinite;
+    w->s->h->npts = (int) w->npts;
+    w->s->h->depmin = e.min;
+    w->s->h->depmax = e.max;
+    w->s->h->depmen = (float) (e.sum / (double) e.n);
+    sac_be(w->s);
+}
+
+/**
+ * @brief      Finalize and close a streaming sac file
+ *
+ * @ingroup    sac
+ * @memberof   sac_writer
+ *
+ * @details    Write the final header and, for v7 files, the footer, close
+ *             the file and free the writer.  A file with no samples is
+ *             still closed but is reported as an error.
+ *
+ * @param      w     sac writer
+ * @param      nerr  status code, 0 on success, non-zero on failure
+ *
+ */
+void
+sac_writer_close(sac_writer *w, int *nerr) {
+    *nerr = sac_writer_patch(w, FALSE);
+    if(*nerr == SAC_OK) {
+        if(w->npts == 0) {
+            *nerr = ERROR_WRITING_FILE;
+        } else {
+            check_value(w->s->h->depmin, w->s->h->depmax, w->nonfinite);
+            sac_check_time_precision(w->s);
+        }
+    }
+    if(close(w->fd) != 0 && *nerr == SAC_OK) {
+        *nerr = ERROR_WRITING_FILE;
+    }
+    sac_free(w->s);
+    free(w);
+}
+
+/**
+ * @brief      Write a sac file into a caller owned buffer
+ *
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    The header, data and v7 footer are copied into \p buf, in the
+ *             byte order of the file as read, byteswapped if needed.  The
+ *             layout is the same as sac_write(), with unpacked data, and
+ *             takes sac_size() bytes.  No FILE streams or intermediate
+ *             copies are used.
+ *
+ * @param      s      sac file to write
+ * @param      buf    output buffer
+ * @param      len    size of \p buf in bytes, at least sac_size()
+ * @param      flags  write flags, SAC_WRITE_NO_DISTAZ, SAC_WRITE_NO_EXTREMA
+ *                    or SAC_WRITE_NO_PRECISION, see sac_write_with_flags()
+ * @param      nerr   status code, 0 on success, non-zero on failure,
+ *                    ERROR_BUFFER_TOO_SMALL if \p len is too small
+ *
+ * @return     number of bytes written to \p buf, 0 on failure
+ *
+ * @code
+ * int nerr = 0;
+ * sac *s = sac_read("t/test_uneven_big.sac", &nerr);
+ * size_t n = (size_t) sac_size(s);
+ * char *buf = malloc(n);
+ * assert_eq(sac_write_buffer(s, buf, n - 1, 0, &nerr), 0);
+ * assert_eq(nerr, 1360);
+ * assert_eq(sac_write_buffer(s, buf, n, 0, &nerr), n);
+ * assert_eq(nerr, 0);
+ *
+ * // The buffer holds the same bytes as the file
+ * char *file = malloc(n);
+ * FILE *fp = fopen("t/test_uneven_big.sac", "rb");
+ * assert_eq(fread(file, 1, n, fp), n);
+ * fclose(fp);
+ * assert_eq(memcmp(buf, file, n), 0);
+ *
+ * // Read back with a copy, from a buffer in any byte order
+ * sac *c = sac_read_buffer(buf, n, 0, &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(memcmp(c->x, s->x, sizeof(float) * s->h->npts), 0);
+ * assert_eq(memcmp(c->y, s->y, sizeof(float) * s->h->npts), 0);
+ * assert_eq(c->h->depmax, s->h->depmax);
+ * sac_free(c);
+ * free(buf);
+ * free(file);
+ * @endcode
+ */
+size_t
+sac_write_buffer(sac *s, void *buf, size_t len, int flags, int *nerr) {
+    int j = 0;
+    size_t n = 0, size = 0;
+    char *p = (char *) buf;
+
+    if((*nerr = sac_write_prepare(s, TRUE, flags)) != SAC_OK) {
+        return 0;
+    }
+    n = (size_t) s->h->npts;
+    size = (size_t) sac_size(s);
+    if(!buf || len < size) {
+        *nerr = ERROR_BUFFER_TOO_SMALL;
+        return 0;
+    }
+    sac_header_encode(s, p, s->m->swap);
+    p += SAC_HEADER_SIZE;
+    for(j = 0; j < sac_comps(s); j++) {
+        const float *y = (j == 0) ? s->y : s->x;
+        if(s->m->swap) {
+            sac_swap32(p, y, n);
+        } else {
+            memcpy(p, y, n * sizeof(float));
+        }
+        p += n * sizeof(float);
+    }
+    if(s->h->nvhdr == SAC_HEADER_VERSION_7) {
+        sac_header_v7_encode(s, p, s->m->swap);
+    }
+    return size;
+}
+
+/**
+ * @brief      Read the header of a sac file in a memory buffer
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Bytes after the sac file are ignored.  Headers of files still
+ *             being written are accepted, see sac_header_live(); their v7
+ *             footer is not read.
+ *
+ * @param      buf     sac file in memory
+ * @param      len     size of \p buf in bytes
+ * @param      packed  if packed data is accepted, its size is checked as it
+ *                     is unpacked, see sac_pack_read_buffer()
+ * @param      nerr    status code, 0 on success, non-zero on failure,
+ *                     ERROR_PACKED_DATA for packed data not accepted
+ *
+ * @return     sac file with only the header read, NULL on failure
+ */
+static sac *
+sac_buffer_header(const void *buf, size_t len, int packed, int *nerr) {
+    size_t expected = 0;
+    sac *s = NULL;
+
+    *nerr = SAC_OK;
+    if(!buf || len < SAC_HEADER_SIZE) {
+        *nerr = ERROR_NOT_A_SAC_FILE;
+        return NULL;
+    }
+    s = sac_new();
+    if((*nerr = sac_header_read_buffer(s, buf)) != SAC_OK) {
+        goto error;
+    }
+    if(!sac_header_live(s)) {
+        *nerr = ERROR_READING_FILE;
+        goto error;
+    }
+    if(s->m->pack && !packed) {
+        *nerr = ERROR_PACKED_DATA;
+        goto error;
+    }
+    if(s->h->npts <= 0) {
+        *nerr = ERROR_READING_FILE;
+        goto error;
+    }
+    expected = (s->m->pack) ? SAC_HEADER_SIZE : (size_t) sac_size(s);
+    if(s->m->live && s->h->nvhdr == SAC_HEADER_VERSION_7) {
+        expected -= sizeof(sac_f64);
+    }
+    if(len < expected) {
+        *nerr = ERROR_NOT_A_SAC_FILE;
+        goto error;
+    }
+    s->m->nstart = 1;
+    s->m->nstop  = s->h->npts;
+    s->m->ntotal = s->h->npts;
+    s->m->nfillb = 0;
+    s->m->nfille = 0;
+    return s;
+ error:
+    sac_free(s);
+    return NULL;
+}
+
+/**
+ * @brief      Finish reading a sac file from a memory buffer
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @param      s       sac file with the header and data read
+ * @param      footer  v7 footer in memory, after the data
+ * @param      e       extrema of the data, NULL if not computed
+ * @param      flags   read flags, see sac_read_with_flags()
+ */
+static void
+sac_buffer_post(sac *s, const char *footer, extrema *e, int flags) {
+    if(e) {
+        extrema_set(s, e);
+    }
+    if(s->m->live) {
+        sac_copy_f32_to_f64(s);
+    } else {
+        sac_header_v7_fill_buffer(s, footer);
+    }
+    sac_read_post(s, flags);
+}
+
+/**
+ * @brief      Read a sac file from a memory buffer
+ *
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    The data is copied out of \p buf in a single pass, byteswapped
+ *             if needed, while the extrema are computed.  \p buf may be in
+ *             either byte order and need not be aligned.  Bytes after the
+ *             sac file, see sac_size(), are ignored.  Packed data is
+ *             unpacked, see SAC_WRITE_PACK.
+ *
+ * @param      buf    sac file in memory, e.g. from sac_write_buffer()
+ * @param      len    size of \p buf in bytes
+ * @param      flags  read flags, see sac_read_with_flags(), SAC_READ_LAZY
+ *                    is ignored
+ * @param      nerr   status code, 0 on success, non-zero on failure
+ *
+ * @return     sac file, free with sac_free(), NULL on failure
+ */
+sac *
+sac_read_buffer(const void *buf, size_t len, int flags, int *nerr) {
+    int j = 0;
+    size_t i = 0, k = 0, n = 0, end = 0;
+    sac *s = NULL;
+    extrema e;
+    const char *p = (const char *) buf + SAC_HEADER_SIZE;
+    const char *footer = NULL;
+
+    if(!(s = sac_buffer_header(buf, len, TRUE, nerr))) {
+        return NULL;
+    }
+    sac_alloc(s);
+    n = (size_t) s->h->npts;
+    extrema_init(&e);
+    footer = (const char *) buf + sac_size(s) - sizeof(sac_f64);
+    for(j = 0; j < sac_comps(s); j++) {
+        float *y = (j == 0) ? s->y : s->x;
+        if(s->m->pack) {
+            if((*nerr = sac_pack_read_buffer(s, buf, len, j, y,
+                                             (j == 0 && !(flags & SAC_READ_NO_EXTREMA)) ? &e : NULL,
+                                             &end)) != SAC_OK) {
+                sac_free(s);
+                return NULL;
+            }
+            footer = (const char *) buf + end;
+            if(s->h->nvhdr == SAC_HEADER_VERSION_7 && len - end < sizeof(sac_f64)) {
+                *nerr = ERROR_NOT_A_SAC_FILE;
+                sac_free(s);
+                return NULL;
+            }
+            continue;
+        }
+        for(i = 0; i < n; i += k) {
+            k = MIN(n - i, (size_t) SAC_DATA_BLOCK);
+            if(s->m->swap) {
+                sac_swap32(y + i, p + i * sizeof(float), k);
+            } else {
+                memcpy(y + i, p + i * sizeof(float), k * sizeof(float));
+            }
+            if(j == 0 && !(flags & SAC_READ_NO_EXTREMA)) {
+                extrema_update(&e, y + i, k);
+            }
+        }
+        p += n * sizeof(float);
+    }
+    sac_buffer_post(s, footer, (flags & SAC_READ_NO_EXTREMA) ? NULL : &e, flags);
+    return s;
+}
+
+/**
+ * @brief      View a sac file in a memory buffer without copying the data
+ *
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    The header is copied, the data components, \p y and \p x,
+ *             point into \p buf.  The buffer is borrowed: it must outlive
+ *             the sac file, and changes to the data are changes to the
+ *             buffer.  sac_free() does not release it.  Extrema are computed
+ *             from the data unless SAC_READ_NO_EXTREMA is given.
+ *
+ * @param      buf    sac file in memory, in the system's byte order and
+ *                    aligned to at least 4 bytes
+ * @param      len    size of \p buf in bytes
+ * @param      flags  read flags, see sac_read_with_flags(), SAC_READ_LAZY
+ *                    is ignored
+ * @param      nerr   status code, 0 on success, non-zero on failure,
+ *                    ERROR_BYTE_ORDER for a buffer not in the system's byte
+ *                    order or not aligned, ERROR_PACKED_DATA for packed data
+ *
+ * @return     sac file, free with sac_free(), NULL on failure
+ *
+ * @code
+ * int nerr = 0;
+ * sac *s = sac_read("t/test_io_small.sac", &nerr);
+ * sac_set_v7(s);
+ * size_t n = (size_t) sac_size(s);
+ * float *buf = malloc(n);
+ * s->m->swap = 0;
+ * sac_write_buffer(s, buf, n, 0, &nerr);
+ * sac *v = sac_view_buffer(buf, n, 0, &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq((char *) v->y, (char *) buf + 632);
+ * assert_eq(memcmp(v->y, s->y, sizeof(float) * s->h->npts), 0);
+ * assert_eq(v->h->nvhdr, 7);
+ * assert_eq(v->h->depmax, s->h->depmax);
+ * sac_free(v);
+ * assert_eq(buf[158], s->y[0]);
+ *
+ * // Buffers in the other byte order are read with a copy
+ * s->m->swap = 1;
+ * sac_write_buffer(s, buf, n, 0, &nerr);
+ * v = sac_view_buffer(buf, n, 0, &nerr);
+ * assert_eq(v, NULL);
+ * assert_eq(nerr, 1362);
+ * v = sac_read_buffer(buf, n, 0, &nerr);
+ * assert_eq(nerr, 0);
+ * assert_eq(memcmp(v->y, s->y, sizeof(float) * s->h->npts), 0);
+ * sac_free(v);
+ * free(buf);
+ * @endcode
+ */
+sac *
+sac_view_buffer(void *buf, size_t len, int flags, int *nerr) {
+    sac *s = NULL;
+    extrema e;
+
+    if(!(s = sac_buffer_header(buf, len, FALSE, nerr))) {
+        return NULL;
+    }
+    if(s->m->swap || ((uintptr_t) buf % sizeof(float)) != 0) {
+        *nerr = ERROR_BYTE_ORDER;
+        sac_free(s);
+        return NULL;
+    }
+    s->m->borrowed = TRUE;
+    s->y = (float *) ((char *) buf + SAC_HEADER_SIZE);
+    if(sac_comps(s) == 2) {
+        s->x = s->y + s->h->npts;
+    }
+    extrema_init(&e);
+    if(!(flags & SAC_READ_NO_EXTREMA)) {
+        extrema_update(&e, s->y, (size_t) s->h->npts);
+    }
+    sac_buffer_post(s, (const char *) buf + sac_size(s) - sizeof(sac_f64),
+                    (flags & SAC_READ_NO_EXTREMA) ? NULL : &e, flags);
+    return s;
+}
+
+/**
+ * @brief Write a sac file to a memory buffer
+ *
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Create and write a sac file to a memory buffer
+ *             It is the users responsibility to free() the returned
+ *             memory.  Header values are written as they are, see
+ *             sac_write_buffer().
+ *
+ * @param      s     sac file structure to write
+ * @param      nlen  length of memory buffer on return
+ *
+ * @return     memory buffer with sac file structure, NULL on error
+ *
+ */
+uint8_t *
+sac_write_to_memory(sac *s, uint32_t *len) {
+    int nerr = 0;
+    size_t n = (size_t) sac_size(s);
+    uint8_t *buf = NULL;
+
+    *len = 0;
+    if(!(buf = malloc(n))) {
+        return NULL;
+    }
+    if(sac_write_buffer(s, buf, n, SAC_WRITE_NO_UPDATE, &nerr) != n) {
+        FREE(buf);
+        return NULL;
+    }
+    *len = (uint32_t) n;
+    return buf;
+}
+
+/**
+ * @brief Read a sac file from a memory buffer
+ *
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Read a sac file from a memory buffer, see sac_read_buffer()
+ *             It is the users responsibility to free() the returned
+ *             sac file.
+ *
+ * @param      buf   memory buffer to read from
+ * @param      nlen  size of memory buffer in bytes
+ *
+ * @return     sac file structure read from memory buffer, NULL on error
+ *
+ */
+sac *
+sac_read_from_memory(const uint8_t *buf, size_t len) {
+    int nerr = 0;
+    return sac_read_buffer(buf, len, 0, &nerr);
+}
+
+/**
+ * @brief      initialize / fill a sac header
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    initialize / fill a sac header with default values
+ *             - nvhdr  = \p SAC_HEADER_MAJOR_VERSION
+ *             - leven  = TRUE
+ *             - lpspol = FALSE
+ *             - lovrok = TRUE
+ *             - lcalda = TRUE
+ *             - iftype  = ITIME
+ *             - all other values are set to undefined, -12345
+ *
+ * @param      sh   pointer sac header
+ *
+ */
+void
+sac_hdr_init(sac_hdr *sh) {
+    if (sh) {
+        memcpy(sh, &NullSacHeader, sizeof(NullSacHeader));
+        sh->nvhdr = SAC_HEADER_MAJOR_VERSION;
+
+        sh->leven = TRUE;
+        sh->lpspol = FALSE;
+        sh->lovrok = TRUE;
+        sh->lcalda = TRUE;
+        sh->unused27 = TRUE;
+        sh->iftype = ITIME;
+    }
+}
+
+/**
+ * @brief      Convert a time to index
+ *
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Convert a time value to a data point index. All values are
+ *             relative to the `b` value 
+ *
+ * @param      s   sac file
+ * @param      t   time value
+ *
+ * @return     index of data point associated with the time
+ *
+ * @code
+ * int i = 0;
+ * sac *s = sac_new();
+ * sac_set_float(s, SAC_B, 10.0);
+ * sac_set_float(s, SAC_DELTA, 0.1);
+ *
+ * i = sac_time_to_index(s, 10.0);
+ * assert_eq(i, 0);
+ *
+ * i = sac_time_to_index(s, 20.0);
+ * assert_eq(i, 100 );
+ * @endcode
+ */
+int
+sac_time_to_index(sac *s, double t) {
+    double b, dt;
+    sac_get_float(s, SAC_B, &b);
+    sac_get_float(s, SAC_DELTA, &dt);
+    return (int) lround((t-b)/dt);
+}
+
+
+
+/**
+ * @brief    Start Time is before Begin value (B)
+ * @private
+ */
+#define START_BEFORE 1<<0
+/**
+ * @brief    Start Time is between Begin (B) and End Value (E)
+ * @private
+ */
+#define START_INSIDE 1<<1
+/**
+ * @brief    Start Time is after End value (E)
+ * @private
+ */
+#define START_AFTER  1<<2
+/**
+ * @brief    End Time is before Start time (B)
+ * @private
+ */
+#define END_BEFORE   1<<3
+/**
+ * @brief    End Time is between Begin (B) and End Value (E)
+ * @private
+ */
+#define END_INSIDE   1<<4
+/**
+ * @brief    End Time is after End Value (E)
+ * @private
+ */
+#define END_AFTER    1<<5
+
+/**
+ * @brief      characterize a cut window
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    characterize a cut window by determining the the location
+ *             of the start and end of the cut window with the data
+ *
+ * @param      s   sac file
+ *
+ * @return     (START_BEFORE | START_INSIDE | START_AFTER) &
+ *             (END_BEFORE | END_INSIDE | END_AFTER)
+ */
+static int
+window_overlap(sac *s) {
+    int f = 0;
+    if(s->m->nstart < 1) {
+        f |= START_BEFORE;
+    } else if(s->m->nstart > s->h->npts) {
+        f |= START_AFTER;
+    } else {
+        f |= START_INSIDE;
+    }
+    if(s->m->nstop < 1) {
+        f |= END_BEFORE;
+    } else if(s->m->nstop > s->h->npts) {
+        f |= END_AFTER;
+    } else {
+        f |= END_INSIDE;
+    }
+    return f;
+}
+
+/**
+ * @brief      get time value
  *
  * @private
  * @ingroup    sac
@@ -3111,305 +8920,2350 @@ window_overlap(sac *s) {
  *
  * @details    get time value from the sac header
  *
- * @param      s     sac file
- * @param      c     time pick or "Z"
- *                   Z, B, E, O, A, F, T0 ... T9
- * @param      nerr  1301 on error, 0 on success
+ * @param      s     sac file
+ * @param      c     time pick or "Z"
+ *                   Z, B, E, O, A, F, T0 ... T9
+ * @param      nerr  1301 on error, 0 on success
+ *
+ * @return     time value
+ */
+static double
+sac_pick_ref_time(sac *s, char *c, int *nerr) {
+    double r = 0.0;
+    *nerr = 0;
+    switch(c[0]) {
+    case 'Z': r = 0.0; break;
+    case 'B': r = sac_float(s, SAC_B); break;
+    case 'E': r = sac_float(s, SAC_E); break;
+    case 'O': r = sac_float(s, SAC_O); break;
+    case 'A': r = sac_float(s, SAC_A); break;
+    case 'F': r = sac_float(s, SAC_F); break;
+    case 'T':
+        switch(c[1]) {
+        case '0': r = sac_float(s, SAC_T0); break;
+        case '1': r = sac_float(s, SAC_T1); break;
+        case '2': r = sac_float(s, SAC_T2); break;
+        case '3': r = sac_float(s, SAC_T3); break;
+        case '4': r = sac_float(s, SAC_T4); break;
+        case '5': r = sac_float(s, SAC_T5); break;
+        case '6': r = sac_float(s, SAC_T6); break;
+        case '7': r = sac_float(s, SAC_T7); break;
+        case '8': r = sac_float(s, SAC_T8); break;
+        case '9': r = sac_float(s, SAC_T9); break;
+        default: *nerr = 1301; break;
+        }
+        break;
+    default: *nerr = 1301; break;
+    }
+    return r;
+}
+
+/**
+ * @brief      calculate read window specifics
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    calculate read window values including:
+ *             - nread, offt, and skip
+ *             - nfille, nfillb, nstart, nstop (in sac meta)
+ *
+ * @param      s       sac file
+ * @param      c1      reference time pick for start
+ * @param      t1      relative time from time pick `c1`
+ * @param      c2      reference time pick for end
+ * @param      t2      relative time ffrom time pick `c2`
+ * @param      cutact  Behavior of cut
+ *                     - CutNone = 0
+ *                     - CutFatal = 1
+ *                     - CutUseBe = 2
+ *                     - CutFillZero = 3
+ * @param      nread   Number of point to read from file
+ * @param      offt    Points to fill with zero before writing
+ * @param      skip    Points to skip before reading
+ * @param      nerr    Status code
+ *
+ * @return     1 on success, 0 on failure
+ */
+static int
+sac_calc_read_window(sac *s, char *c1, double t1, char *c2, double t2, enum CutAction cutact, int *nread, int *offt, int *skip, int *nerr) {
+    *nerr = 0;
+    if(cutact == CutNone) {
+        s->m->nfillb = 0;
+        s->m->nfillb = 0;
+        s->m->nstart = 1;
+        s->m->nstop  = s->h->npts;
+        *nread = s->h->npts;
+        *offt  = 0;
+        *skip  = 0;
+    } else {
+        double r1 = sac_pick_ref_time(s, c1, nerr);
+        if(*nerr) {
+            goto error;
+        }
+        double r2 = sac_pick_ref_time(s, c2, nerr);
+        if(*nerr) {
+            goto error;
+        }
+
+        if(r1 == SAC_FLOAT_UNDEFINED) {
+            printf(" WARNING: Undefined starting cut for file %s\n"
+                   " Corrected by using file begin.\n", s->m->filename);
+        }
+        if(r2 == SAC_FLOAT_UNDEFINED) {
+            printf(" WARNING: Undefined starting cut for file %s\n"
+                   " Corrected by using file end.\n", s->m->filename);
+        }
+        t1 = (r1 == SAC_FLOAT_UNDEFINED) ? B(s) : r1 + t1;
+        t2 = (r2 == SAC_FLOAT_UNDEFINED) ? E(s) : r2 + t2;
+
+        s->m->nstart = sac_time_to_index(s, t1) + 1;
+        s->m->nstop  = sac_time_to_index(s, t2) + 1;
+
+        if(t1 >= t2) {
+            printf(" WARNING: Start cut greater than stop cut for file %s\n"
+                   "\ttime:  %f >= %f\n"
+                   "\tindex: %d >= %d\n", s->m->filename,
+                   t1, t2,
+                   s->m->nstart, s->m->nstop);
+            *nerr = ERROR_START_TIME_GREATER_THAN_STOP;
+            goto error;
+        }
+
+        int f = window_overlap(s);
+        if(cutact == CutUseBE) {
+            s->m->nfillb = 0;
+            s->m->nfille = 0;
+            if(s->m->nstart < 1) {
+                s->m->nstart = 1;
+                printf(" WARNING: Start cut less than file begin for file %s\n"
+                       " Corrected by using file begin.\n", s->m->filename);
+            }
+            if(s->m->nstop > s->h->npts) {
+                s->m->nstop = s->h->npts;
+                printf(" WARNING: Stop cut greater than file end for file %s\n"
+                       " Corrected by using file end.\n", s->m->filename);
+            }
+            *nread = s->m->nstop - s->m->nstart + 1;
+            *offt  = 0;
+            *skip  = MAX(s->m->nstart, 1) - 1;
+        } else if(cutact == CutFillZero) {
+            s->m->nfillb = MAX(1 - s->m->nstart, 0);
+            s->m->nfille = s->m->nstop - s->h->npts;
+            *nread = MIN(s->m->nstop, s->h->npts) - MAX(s->m->nstart, 1) + 1;
+            *offt  = s->m->nfillb;
+            *skip  = MAX(s->m->nstart, 1) - 1;
+        } else if(cutact == CutFatal) {
+            *nread = s->m->nstop - s->m->nstart + 1;
+            *skip  = s->m->nstart-1;
+            *offt  = 0;
+        }
+        if(cutact != CutFillZero) {
+            switch (f) {
+            case START_BEFORE | END_BEFORE:  *nerr = ERROR_STOP_TIME_LESS_THAN_BEGIN;    goto error; break; // |---| {-------}
+            case START_BEFORE | END_INSIDE:  *nerr = ERROR_START_TIME_LESS_THAN_BEGIN;   break; // |-----{---|---}
+            case START_BEFORE | END_AFTER:   *nerr = ERROR_CUT_TIMES_BEYOND_DATA_LIMITS; break; // |-----{-------}---|
+            case START_INSIDE | END_BEFORE:  *nerr = ERROR_START_TIME_GREATER_THAN_STOP; goto error; break;
+            case START_INSIDE | END_INSIDE:  *nerr = SAC_OK;                             break; //       {-|---|-}
+            case START_INSIDE | END_AFTER:   *nerr = ERROR_STOP_TIME_GREATER_THAN_END;   break; //       {---|---}---|
+            case START_AFTER  | END_BEFORE:  *nerr = ERROR_START_TIME_GREATER_THAN_STOP; goto error; break;
+            case START_AFTER  | END_INSIDE:  *nerr = ERROR_START_TIME_GREATER_THAN_STOP; goto error; break;
+            case START_AFTER  | END_AFTER:   *nerr = ERROR_START_TIME_GREATER_THAN_END;  break; //       {-------}  |-----|
+            }
+        }
+        if(cutact == CutFatal && (f != (START_INSIDE | END_INSIDE))) {
+            switch(*nerr) {
+            case ERROR_CUT_TIMES_BEYOND_DATA_LIMITS:
+            case ERROR_START_TIME_LESS_THAN_BEGIN:
+                printf(" WARNING: Start cut less than file begin for file %s\n", s->m->filename);
+                break;
+            case ERROR_STOP_TIME_GREATER_THAN_END:
+                printf(" WARNING: Stop cut greater than file end for file %s\n", s->m->filename);
+                break;
+            }
+            goto error;
+        }
+        if(*nread <= 0 && cutact != CutFillZero) {
+            goto error;
+        }
+
+        sac_set_float(s, SAC_B, B(s) + DT(s) * (double) (s->m->nstart - 1));
+        int npts = s->m->nstop - s->m->nstart + 1;
+        if(npts <= 0) {
+            goto error;
+        }
+        sac_set_int(s, SAC_NPTS, npts);
+        sac_be(s);
+    }
+    return 1;
+ error:
+    return 0;
+
+}
+
+/**
+ * @brief      read a sac file while cutting
+ *
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    read a sac file while cutting
+ *
+ * @param      filename  sac file to read
+ * @param      c1        reference time pick for start, see list below
+ * @param      t1        relative time from time pick `c1`
+ * @param      c2        reference time pick for end, see list below
+ * @param      t2        relative time ffrom time pick `c2`
+ * @param      cutact    Behavior of cut
+ *                       - CutNone = 0
+ *                       - CutFatal = 1
+ *                       - CutUseBE = 2
+ *                       - CutFillZero = 3
+ * @param      nerr      Status code, 0 on success, non-zero on Error
+ *
+ * @return     read and cut file on success, NULL on error
+ *
+ * @see        sac_read_with_cut_flags()
+ *
+ * @note       Time pick reference
+ *             - "Z" - Actual time
+ *             - "B" - Begin time
+ *             - "E" - End time
+ *             - "O" - Origin time
+ *             - "A" - First arrival time
+ *             - "F" - Final arrival time: SAC_F value
+ *             - "T0" to "T9" - t0 to t9 arrival times 
+ *
+ * @code
+ * int nerr = 0;
+ * double b = 0, e = 0;
+ * sac *s = NULL;
+ *
+ * s = sac_read_with_cut("t/test_io_small.sac", 
+ *                            "Z", 10.0,
+ *                            "Z", 30.0, CutUseBE, 
+ *                            &nerr);
+ * sac_get_float(s, SAC_B, &b);
+ * sac_get_float(s, SAC_E, &e);
+ * assert_eq(b, 10.0);
+ * assert_eq(e, 30.0);
+ *
+ * s = sac_read_with_cut("t/test_io_big.sac", 
+ *                       "Z", 10.0,
+ *                       "Z", 30.0, CutUseBE, 
+ *                       &nerr);
+ * sac_get_float(s, SAC_B, &b);
+ * sac_get_float(s, SAC_E, &e);
+ * assert_eq(b, 10.0);
+ * assert_eq(e, 30.0);
+ * @endcode
+ */
+sac *
+sac_read_with_cut(char *filename,
+                  char* c1, double t1,
+                  char* c2, double t2,
+                  enum CutAction cutact, int *nerr) {
+    return sac_read_with_cut_flags(filename, c1, t1, c2, t2, cutact, 0, nerr);
+}
+
+/**
+ * @brief      read a sac file while cutting with options
+ *
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    read a sac file while cutting, see sac_read_with_cut().
+ *             With SAC_READ_BULK only the data within the cut window is
+ *             hinted to be read ahead and the file is dropped from the page
+ *             cache after reading
+ *
+ * @param      filename  sac file to read
+ * @param      c1        reference time pick for start
+ * @param      t1        relative time from time pick `c1`
+ * @param      c2        reference time pick for end
+ * @param      t2        relative time ffrom time pick `c2`
+ * @param      cutact    Behavior of cut
+ * @param      flags     read flags, see sac_read_with_flags(),
+ *                       SAC_READ_LAZY is ignored
+ * @param      nerr      Status code, 0 on success, non-zero on Error
+ *
+ * @return     read and cut file on success, NULL on error
+ *
+ */
+sac *
+sac_read_with_cut_flags(char *filename,
+                        char* c1, double t1,
+                        char* c2, double t2,
+                        enum CutAction cutact, int flags, int *nerr) {
+    FILE *fp = NULL;
+    sac *s = NULL;
+    int nread = 0, offt = 0;
+    int skip = 0;
+    size_t n = 0, nb = 0, nr = 0, bytes = 0, total = 0;
+    extrema e;
+    uint64_t t0 = sac_io_clock();
+    if(cutact != CutNone && (!isfinite(t1) || !isfinite(t2))) {
+        *nerr = ERROR_START_TIME_GREATER_THAN_STOP;
+        goto error;
+    }
+
+    if(!(s = sac_read_header_internal(filename, nerr, &fp))) {
+        if(*nerr == ERROR_COMPRESSED_FILE) {
+            return sac_read_compressed(filename, TRUE, TRUE, c1, t1, c2, t2,
+                                       cutact, flags, nerr);
+        }
+        goto error;
+    }
+    if(! s->h->leven ) {
+        *nerr = ERROR_CANT_CUT_UNEVENLY_SPACED_FILE;
+        goto error;
+    }
+    if(s->h->iftype != ITIME) {
+        *nerr = ERROR_CANT_CUT_SPECTRAL_FILE;
+        goto error;
+    }
+
+    // The window replaces npts, packed data is indexed by the file's npts
+    total = (size_t) MAX(s->h->npts, 0);
+    if(!sac_calc_read_window(s, c1, t1, c2, t2, cutact,
+                             &nread, &offt, &skip, nerr)) {
+        goto error;
+    }
+
+    sac_alloc(s);
+
+    if(skip > 0 && !s->m->pack) {
+        fseek(fp,  skip * (int) SAC_DATA_SIZE, SEEK_CUR);
+    }
+    // Zero fill before, data, and zero fill after, are scanned in order
+    n  = (size_t) s->h->npts;
+    nb = MIN((size_t) offt, n);
+    nr = (nread > 0) ? MIN((size_t) nread, n - nb) : 0;
+    bytes = SAC_HEADER_SIZE + nr * SAC_DATA_SIZE;
+    if(!s->m->pack) {
+        sac_io_advise(fileno(fp), (off_t) ftell(fp), (off_t) (nr * SAC_DATA_SIZE), flags);
+    }
+    extrema_init(&e);
+    extrema_update(&e, s->y, nb);
+    if(nr > 0 && s->m->pack) {
+        // Only chunks overlapping the window are read and unpacked
+        bytes = SAC_HEADER_SIZE;
+        if(sac_pack_read(s, fp, total, 0, (size_t) skip, nr, s->y + nb, &e, &bytes) != SAC_OK) {
+            *nerr = ERROR_READING_FILE;
+            goto error;
+        }
+    } else if(nr > 0) {
+        if(sac_data_read_fused(fp, s->y + nb, nr, s->m->swap, &e) != SAC_OK) {
+            *nerr = ERROR_READING_FILE;
+            goto error;
+        }
+    }
+    extrema_update(&e, s->y + nb + nr, n - nb - nr);
+    if(!(flags & SAC_READ_NO_EXTREMA)) {
+        extrema_set(s, &e);
+    }
+    sac_io_done(fileno(fp), bytes, t0, flags);
+    fclose(fp);
+
+    sac_read_post(s, flags);
+
+    return s;
+ error:
+    if(fp) {
+        fclose(fp);
+    }
+    if(s) {
+        sac_free(s);
+        s = NULL;
+    }
+    return NULL;
+}
+
+#define SAC_Z_CHUNK        65536      /**< @private Size of compressed input reads */
+#define SAC_Z_WINDOW       32768      /**< @private Size of the deflate window kept at gzip index points */
+#define SAC_Z_MEMBER       0x100      /**< @private Index point at the start of a gzip member or zstd frame */
+#define SAC_Z_INDEX_MAGIC  "SACZIDX1" /**< @private Magic of a sidecar seek index */
+#define SAC_Z_INDEX_SPAN   (1 << 20)  /**< @private Default uncompressed bytes between index points */
+
+typedef struct sac_zpoint sac_zpoint;
+/**
+ * @brief access point of a sidecar seek index
+ * @private
+ *
+ * @details gzip points not at a member start are followed in the index
+ *          by \p wlen bytes of uncompressed data preceding the point
+ */
+struct sac_zpoint {
+    uint64_t uoff;   /**< @private uncompressed offset */
+    uint64_t coff;   /**< @private compressed offset */
+    uint32_t bits;   /**< @private unused bits in the byte before coff, or SAC_Z_MEMBER */
+    uint32_t wlen;   /**< @private length of the window following the point */
+};
+
+typedef struct sac_zindex sac_zindex;
+/**
+ * @brief header of a sidecar seek index, native byte order
+ * @private
+ */
+struct sac_zindex {
+    char magic[8];     /**< @private SAC_Z_INDEX_MAGIC */
+    uint32_t type;     /**< @private compression format */
+    uint32_t n;        /**< @private number of points */
+    uint64_t usize;    /**< @private uncompressed size */
+    uint64_t csize;    /**< @private compressed size */
+    int64_t mtime;     /**< @private modification time of the compressed file, seconds */
+    int64_t mtime_ns;  /**< @private modification time of the compressed file, nanoseconds */
+};
+
+typedef struct sac_zfile sac_zfile;
+/**
+ * @brief compressed sac file being read
+ * @private
+ */
+struct sac_zfile {
+    int type;                       /**< @private compression format */
+    int fd;                         /**< @private compressed file */
+    int ifd;                        /**< @private sidecar seek index, -1 if none */
+    int raw;                        /**< @private gzip inflating raw deflate data */
+    uint64_t coff;                  /**< @private compressed offset of the next input read */
+    uint64_t uoff;                  /**< @private uncompressed offset of the next output */
+    uint64_t cread;                 /**< @private compressed bytes read */
+    sac_zindex idx;                 /**< @private seek index header */
+    size_t in_pos;                  /**< @private position of unused input */
+    size_t in_len;                  /**< @private length of input */
+    unsigned char in[SAC_Z_CHUNK];  /**< @private input */
+#ifdef HAVE_ZLIB
+    z_stream z;                     /**< @private gzip stream */
+#endif /* HAVE_ZLIB */
+#ifdef HAVE_ZSTD
+    ZSTD_DStream *d;                /**< @private zstd stream */
+#endif /* HAVE_ZSTD */
+};
+
+/**
+ * @brief      Determine the compression of a file from its first bytes
+ *
+ * @private
+ * @ingroup    sac
+ *
+ * @details    gzip and zstd magic numbers are checked, sac files whose
+ *             delta happens to match a magic number are recognized by a
+ *             valid header version
+ *
+ * @param      buf   first bytes of the file
+ * @param      n     number of bytes in \p buf
+ *
+ * @return     compression format, SAC_COMPRESS_NONE if not compressed
+ */
+static int
+sac_compression(const char *buf, size_t n) {
+    int32_t ver = 0;
+    int type = SAC_COMPRESS_NONE;
+    const unsigned char *p = (const unsigned char *) buf;
+    if(n >= 3 && p[0] == 0x1f && p[1] == 0x8b && p[2] == 0x08) {
+        type = SAC_COMPRESS_GZIP;
+    } else if(n >= 4 && p[0] == 0x28 && p[1] == 0xb5 && p[2] == 0x2f && p[3] == 0xfd) {
+        type = SAC_COMPRESS_ZSTD;
+    }
+    if(type != SAC_COMPRESS_NONE && n >= SAC_HEADER_SIZE) {
+        memcpy(&ver, buf + SAC_VERSION_LOCATION * SAC_HEADER_SIZEOF_NUMBER, sizeof ver);
+        if(ver >= 1 && ver <= SAC_HEADER_MAX_VERSION) {
+            return SAC_COMPRESS_NONE;
+        }
+        byteswap_bsd(&ver, sizeof ver);
+        if(ver >= 1 && ver <= SAC_HEADER_MAX_VERSION) {
+            return SAC_COMPRESS_NONE;
+        }
+    }
+    return type;
+}
+
+/**
+ * @brief      Sidecar seek index filename of a compressed file
+ *
+ * @private
+ *
+ * @param      filename  compressed file
+ *
+ * @return     filename with ".idx" appended, free with free()
+ */
+static char *
+sac_zindex_filename(const char *filename) {
+    size_t n = strlen(filename) + 5;
+    char *p = malloc(n);
+    if(p) {
+        snprintf(p, n, "%s.idx", filename);
+    }
+    return p;
+}
+
+/**
+ * @brief      Refill the compressed input if it is used up
+ *
+ * @private
+ *
+ * @param      zf    compressed file
+ *
+ * @return     1 if input is available, 0 at the end of the file
+ */
+static int
+sac_zfile_fill(sac_zfile *zf) {
+    ssize_t n = 0;
+    if(zf->in_pos < zf->in_len) {
+        return 1;
+    }
+    if((n = pread(zf->fd, zf->in, sizeof zf->in, (off_t) zf->coff)) <= 0) {
+        return 0;
+    }
+    zf->in_pos = 0;
+    zf->in_len = (size_t) n;
+    zf->coff  += (uint64_t) n;
+    zf->cread += (uint64_t) n;
+    return 1;
+}
+
+/**
+ * @brief      Position a compressed file at an access point
+ *
+ * @private
+ *
+ * @param      zf      compressed file
+ * @param      p       access point
+ * @param      window  uncompressed data preceding a gzip point, p->wlen bytes
+ *
+ * @return     0 on success, ERROR_READING_FILE on failure
+ */
+static int
+sac_zfile_reset(sac_zfile *zf, const sac_zpoint *p, const unsigned char *window) {
+    zf->in_pos = zf->in_len = 0;
+    zf->uoff = p->uoff;
+    zf->coff = p->coff;
+    switch(zf->type) {
+#ifdef HAVE_ZLIB
+    case SAC_COMPRESS_GZIP:
+        zf->raw = !(p->bits & SAC_Z_MEMBER);
+        if(inflateReset2(&zf->z, (zf->raw) ? -15 : 15 + 32) != Z_OK) {
+            return ERROR_READING_FILE;
+        }
+        if(!zf->raw) {
+            break;
+        }
+        if(p->bits) {
+            zf->coff -= 1;
+            if(!sac_zfile_fill(zf)) {
+                return ERROR_READING_FILE;
+            }
+            inflatePrime(&zf->z, (int) p->bits, zf->in[zf->in_pos++] >> (8 - p->bits));
+        }
+        if(inflateSetDictionary(&zf->z, window, p->wlen) != Z_OK) {
+            return ERROR_READING_FILE;
+        }
+        break;
+#endif /* HAVE_ZLIB */
+#ifdef HAVE_ZSTD
+    case SAC_COMPRESS_ZSTD:
+        if(ZSTD_isError(ZSTD_initDStream(zf->d))) {
+            return ERROR_READING_FILE;
+        }
+        break;
+#endif /* HAVE_ZSTD */
+    default:
+        UNUSED(window);
+        return ERROR_COMPRESSED_FILE;
+    }
+    return SAC_OK;
+}
+
+/**
+ * @brief      Close a compressed file
+ *
+ * @private
+ *
+ * @param      zf    compressed file
+ */
+static void
+sac_zfile_close(sac_zfile *zf) {
+    if(!zf) {
+        return;
+    }
+#ifdef HAVE_ZLIB
+    if(zf->type == SAC_COMPRESS_GZIP) {
+        inflateEnd(&zf->z);
+    }
+#endif /* HAVE_ZLIB */
+#ifdef HAVE_ZSTD
+    if(zf->d) {
+        ZSTD_freeDStream(zf->d);
+    }
+#endif /* HAVE_ZSTD */
+    if(zf->ifd >= 0) {
+        close(zf->ifd);
+    }
+    if(zf->fd >= 0) {
+        close(zf->fd);
+    }
+    free(zf);
+}
+
+/**
+ * @brief      Open a compressed file
+ *
+ * @private
+ *
+ * @details    The compression is detected from the first bytes of the file.
+ *             A sidecar seek index, filename.idx, is used if it matches the
+ *             size and modification time of the file.
+ *
+ * @param      filename  compressed file
+ * @param      nerr      status code, 0 on success, non-zero on failure,
+ *                       ERROR_COMPRESSED_FILE if the compression is not
+ *                       supported
+ *
+ * @return     compressed file, NULL on failure
+ */
+static sac_zfile *
+sac_zfile_open(char *filename, int *nerr) {
+    ssize_t n = 0;
+    char *iname = NULL;
+    struct stat st, ist;
+    sac_zfile *zf = NULL;
+    sac_zpoint start = { 0, 0, SAC_Z_MEMBER, 0 };
+
+    if(!(zf = calloc(1, sizeof(sac_zfile)))) {
+        *nerr = ERROR_READING_FILE;
+        return NULL;
+    }
+    zf->ifd = -1;
+    if((zf->fd = open(filename, O_RDONLY)) < 0) {
+        *nerr = sac_errno_to_nerr(errno);
+        goto error;
+    }
+    if((n = pread(zf->fd, zf->in, SAC_HEADER_SIZE, 0)) < 0 || fstat(zf->fd, &st) != 0) {
+        *nerr = ERROR_READING_FILE;
+        goto error;
+    }
+    zf->type = sac_compression((char *) zf->in, (size_t) n);
+    switch(zf->type) {
+#ifdef HAVE_ZLIB
+    case SAC_COMPRESS_GZIP:
+        if(inflateInit2(&zf->z, 15 + 32) != Z_OK) {
+            zf->type = SAC_COMPRESS_NONE;
+            *nerr = ERROR_READING_FILE;
+            goto error;
+        }
+        break;
+#endif /* HAVE_ZLIB */
+#ifdef HAVE_ZSTD
+    case SAC_COMPRESS_ZSTD:
+        if(!(zf->d = ZSTD_createDStream())) {
+            *nerr = ERROR_READING_FILE;
+            goto error;
+        }
+        break;
+#endif /* HAVE_ZSTD */
+    case SAC_COMPRESS_NONE:
+        *nerr = ERROR_NOT_A_SAC_FILE;
+        goto error;
+    default:
+        zf->type = SAC_COMPRESS_NONE;
+        *nerr = ERROR_COMPRESSED_FILE;
+        goto error;
+    }
+    if((*nerr = sac_zfile_reset(zf, &start, NULL)) != SAC_OK) {
+        goto error;
+    }
+    if((iname = sac_zindex_filename(filename)) && (zf->ifd = open(iname, O_RDONLY)) >= 0) {
+        if(fstat(zf->ifd, &ist) != 0 ||
+           pread(zf->ifd, &zf->idx, sizeof zf->idx, 0) != (ssize_t) sizeof zf->idx ||
+           memcmp(zf->idx.magic, SAC_Z_INDEX_MAGIC, sizeof zf->idx.magic) != 0 ||
+           zf->idx.type != (uint32_t) zf->type ||
+           zf->idx.csize != (uint64_t) st.st_size ||
+           zf->idx.mtime != (int64_t) st.st_mtim.tv_sec ||
+           zf->idx.mtime_ns != (int64_t) st.st_mtim.tv_nsec) {
+            close(zf->ifd);
+            zf->ifd = -1;
+        }
+    }
+    FREE(iname);
+    return zf;
+ error:
+    FREE(iname);
+    sac_zfile_close(zf);
+    return NULL;
+}
+
+/**
+ * @brief      Decompress data from a compressed file
+ *
+ * @private
+ *
+ * @details    Concatenated gzip members and zstd frames are read as a
+ *             single stream
  *
- * @return     time value
+ * @param      zf    compressed file
+ * @param      buf   output buffer
+ * @param      n     number of bytes to read
+ *
+ * @return     number of bytes read, less than \p n at the end of the data,
+ *             -1 on failure
  */
-static double
-sac_pick_ref_time(sac *s, char *c, int *nerr) {
-    double r = 0.0;
-    *nerr = 0;
-    switch(c[0]) {
-    case 'Z': r = 0.0; break;
-    case 'B': r = sac_float(s, SAC_B); break;
-    case 'E': r = sac_float(s, SAC_E); break;
-    case 'O': r = sac_float(s, SAC_O); break;
-    case 'A': r = sac_float(s, SAC_A); break;
-    case 'F': r = sac_float(s, SAC_F); break;
-    case 'T':
-        switch(c[1]) {
-        case '0': r = sac_float(s, SAC_T0); break;
-        case '1': r = sac_float(s, SAC_T1); break;
-        case '2': r = sac_float(s, SAC_T2); break;
-        case '3': r = sac_float(s, SAC_T3); break;
-        case '4': r = sac_float(s, SAC_T4); break;
-        case '5': r = sac_float(s, SAC_T5); break;
-        case '6': r = sac_float(s, SAC_T6); break;
-        case '7': r = sac_float(s, SAC_T7); break;
-        case '8': r = sac_float(s, SAC_T8); break;
-        case '9': r = sac_float(s, SAC_T9); break;
-        default: *nerr = 1301; break;
+static ssize_t
+sac_zfile_read(sac_zfile *zf, void *buf, size_t n) {
+    int more = 0;
+    size_t done = 0, k = 0, used = 0;
+    unsigned char *out = (unsigned char *) buf;
+    while(done < n) {
+        more = sac_zfile_fill(zf);
+        k = MIN(n - done, (size_t) UINT32_MAX);
+        used = zf->in_pos;
+        switch(zf->type) {
+#ifdef HAVE_ZLIB
+        case SAC_COMPRESS_GZIP: {
+            int ret = 0;
+            zf->z.next_in   = zf->in + zf->in_pos;
+            zf->z.avail_in  = (uInt) (zf->in_len - zf->in_pos);
+            zf->z.next_out  = out + done;
+            zf->z.avail_out = (uInt) k;
+            ret = inflate(&zf->z, Z_NO_FLUSH);
+            zf->in_pos = zf->in_len - zf->z.avail_in;
+            k -= zf->z.avail_out;
+            if(ret == Z_STREAM_END) {
+                // Skip the trailer of a member inflated as raw data
+                for(size_t t = 0; zf->raw && t < 8; t++) {
+                    if(!sac_zfile_fill(zf)) {
+                        return -1;
+                    }
+                    zf->in_pos++;
+                }
+                zf->raw = FALSE;
+                if(inflateReset2(&zf->z, 15 + 32) != Z_OK) {
+                    return -1;
+                }
+                // Another member may follow
+                more = sac_zfile_fill(zf);
+                used = SIZE_MAX;
+            } else if(ret != Z_OK && ret != Z_BUF_ERROR) {
+                return -1;
+            }
+            break;
+        }
+#endif /* HAVE_ZLIB */
+#ifdef HAVE_ZSTD
+        case SAC_COMPRESS_ZSTD: {
+            ZSTD_inBuffer in = { zf->in, zf->in_len, zf->in_pos };
+            ZSTD_outBuffer o = { out + done, k, 0 };
+            if(ZSTD_isError(ZSTD_decompressStream(zf->d, &o, &in))) {
+                return -1;
+            }
+            zf->in_pos = in.pos;
+            k = o.pos;
+            break;
+        }
+#endif /* HAVE_ZSTD */
+        default:
+            UNUSED(out);
+            UNUSED(more);
+            UNUSED(used);
+            return -1;
+        }
+        done += k;
+        if(k == 0 && used == zf->in_pos) {
+            if(more) {
+                return -1;
+            }
+            break;
+        }
+    }
+    zf->uoff += done;
+    return (ssize_t) done;
+}
+
+/**
+ * @brief      Read exactly \p n bytes from a compressed file
+ *
+ * @private
+ *
+ * @param      zf    compressed file
+ * @param      buf   output buffer
+ * @param      n     number of bytes
+ *
+ * @return     0 on success, ERROR_READING_FILE on failure or short read
+ */
+static int
+sac_zfile_read_all(sac_zfile *zf, void *buf, size_t n) {
+    return (sac_zfile_read(zf, buf, n) == (ssize_t) n) ? SAC_OK : ERROR_READING_FILE;
+}
+
+/**
+ * @brief      Position a compressed file at an uncompressed offset
+ *
+ * @private
+ *
+ * @details    Without a seek index data is decompressed and discarded up to
+ *             \p uoff, starting again from the beginning if needed.  With an
+ *             index decompression starts at the closest preceding access
+ *             point.
+ *
+ * @param      zf    compressed file
+ * @param      uoff  uncompressed offset
+ *
+ * @return     0 on success, non-zero on failure
+ */
+static int
+sac_zfile_seek(sac_zfile *zf, uint64_t uoff) {
+    int nerr = SAC_OK;
+    uint32_t i = 0;
+    off_t off = sizeof(sac_zindex), best = 0;
+    sac_zpoint p = { 0, 0, SAC_Z_MEMBER, 0 }, q;
+    unsigned char *window = NULL;
+    char skip[4096];
+
+    for(i = 0; zf->ifd >= 0 && i < zf->idx.n; i++) {
+        if(pread(zf->ifd, &q, sizeof q, off) != (ssize_t) sizeof q) {
+            return ERROR_READING_FILE;
+        }
+        if(q.uoff > uoff) {
+            break;
+        }
+        p = q;
+        best = off + (off_t) sizeof q;
+        off += (off_t) (sizeof q + q.wlen);
+    }
+    if(uoff < zf->uoff || p.uoff > zf->uoff) {
+        if(p.wlen > 0) {
+            if(!(window = malloc(p.wlen)) ||
+               pread(zf->ifd, window, p.wlen, best) != (ssize_t) p.wlen) {
+                FREE(window);
+                return ERROR_READING_FILE;
+            }
+        }
+        nerr = sac_zfile_reset(zf, &p, window);
+        FREE(window);
+        if(nerr != SAC_OK) {
+            return nerr;
+        }
+    }
+    while(zf->uoff < uoff) {
+        size_t k = (size_t) MIN(uoff - zf->uoff, (uint64_t) sizeof skip);
+        if(sac_zfile_read(zf, skip, k) != (ssize_t) k) {
+            return ERROR_READING_FILE;
+        }
+    }
+    return SAC_OK;
+}
+
+/**
+ * @brief      Read a compressed sac file
+ *
+ * @private
+ * @ingroup    sac
+ * @memberof   sac
+ *
+ * @details    Read a gzip or zstd compressed sac file, decompressing it as
+ *             it is read.  Cut reads with a sidecar seek index, see
+ *             sac_compressed_index(), only decompress the header, the v7
+ *             footer and the data covering the cut window.  Cut reads
+ *             without an index read the whole file and cut it, see sac_cut().
+ *
+ * @param      filename   compressed file
+ * @param      read_data  whether to read the data or just the header
+ * @param      cut        whether to cut the file, see sac_read_with_cut()
+ * @param      c1         reference time pick for start
+ * @param      t1         relative time from time pick `c1`
+ * @param      c2         reference time pick for end
+ * @param      t2         relative time from time pick `c2`
+ * @param      cutact     Behavior of cut
+ * @param      flags      read flags, see sac_read_with_flags()
+ * @param      nerr       status code, 0 on success, non-zero on failure
+ *
+ * @return     sac file, NULL on failure
+ */
+static sac *
+sac_read_compressed(char *filename, int read_data, int cut,
+                    char *c1, double t1, char *c2, double t2,
+                    enum CutAction cutact, int flags, int *nerr) {
+    int j = 0, ret = 0, nread = 0, offt = 0, skip = 0;
+    size_t n = 0, nb = 0, nr = 0;
+    uint64_t t0 = sac_io_clock();
+    char hdr[SAC_HEADER_SIZE];
+    char v7[sizeof(sac_f64)];
+    char c = 0;
+    sac *s = NULL, *out = NULL;
+    sac_zfile *zf = NULL;
+    extrema e;
+
+    *nerr = SAC_OK;
+    if(!(zf = sac_zfile_open(filename, nerr))) {
+        return NULL;
+    }
+    // Without access points past the start cut the whole file, rather
+    // than decompress it twice
+    if(cut && (zf->ifd < 0 || zf->idx.n < 2)) {
+        sac_zfile_close(zf);
+        if(!(s = sac_read_compressed(filename, TRUE, FALSE, NULL, 0.0, NULL, 0.0,
+                                     CutNone, flags, nerr))) {
+            return NULL;
+        }
+        out = sac_cut(s, c1, t1, c2, t2, cutact, nerr);
+        sac_free(s);
+        return out;
+    }
+    s = sac_new();
+    s->m->filename = strdup(filename);
+    if((*nerr = sac_zfile_read_all(zf, hdr, sizeof hdr)) != SAC_OK ||
+       (*nerr = sac_header_read_buffer(s, hdr)) != SAC_OK) {
+        goto error;
+    }
+    if(!sac_header_live(s) || s->m->live) {
+        *nerr = ERROR_READING_FILE;
+        goto error;
+    }
+    if(s->m->pack) {
+        *nerr = ERROR_COMPRESSED_FILE;
+        goto error;
+    }
+    if(zf->ifd >= 0 && (*nerr = sac_size_check(s, (off_t) zf->idx.usize)) != SAC_OK) {
+        goto error;
+    }
+    n = (size_t) MAX(s->h->npts, 0);
+
+    if(read_data && !cut) {
+        if((*nerr = sac_check_npts(s->h->npts)) != SAC_OK || n == 0) {
+            *nerr = ERROR_READING_FILE;
+            goto error;
+        }
+        sac_alloc(s);
+        extrema_init(&e);
+        for(j = 0; j < sac_comps(s); j++) {
+            float *y = (j == 0) ? s->y : s->x;
+            if((*nerr = sac_zfile_read_all(zf, y, n * sizeof(float))) != SAC_OK) {
+                goto error;
+            }
+            sac_data_swap_extrema(y, n, s->m->swap,
+                                  (j == 0 && !(flags & SAC_READ_NO_EXTREMA)) ? &e : NULL);
+        }
+        if(!(flags & SAC_READ_NO_EXTREMA)) {
+            extrema_set(s, &e);
+        }
+        s->m->nstart = 1;
+        s->m->nstop  = s->h->npts;
+        s->m->ntotal = s->h->npts;
+        s->m->nfillb = 0;
+        s->m->nfille = 0;
+    }
+    if(s->h->nvhdr == SAC_HEADER_VERSION_7) {
+        if((*nerr = sac_zfile_seek(zf, (uint64_t) sac_size(s) - sizeof v7)) != SAC_OK ||
+           (*nerr = sac_zfile_read_all(zf, v7, sizeof v7)) != SAC_OK) {
+            goto error;
+        }
+        sac_header_v7_fill_buffer(s, v7);
+    } else {
+        sac_copy_f32_to_f64(s);
+    }
+    // Complete reads check the size, as done for uncompressed files
+    if(read_data && !cut && sac_zfile_read(zf, &c, 1) != 0) {
+        *nerr = sac_size_check(s, (off_t) zf->uoff + 1);
+        goto error;
+    }
+
+    if(cut) {
+        if(cutact != CutNone && (!isfinite(t1) || !isfinite(t2))) {
+            *nerr = ERROR_START_TIME_GREATER_THAN_STOP;
+            goto error;
+        }
+        if(!s->h->leven) {
+            *nerr = ERROR_CANT_CUT_UNEVENLY_SPACED_FILE;
+            goto error;
+        }
+        if(s->h->iftype != ITIME) {
+            *nerr = ERROR_CANT_CUT_SPECTRAL_FILE;
+            goto error;
+        }
+        if(!sac_calc_read_window(s, c1, t1, c2, t2, cutact, &nread, &offt, &skip, nerr)) {
+            goto error;
+        }
+        sac_alloc(s);
+        n  = (size_t) s->h->npts;
+        nb = MIN((size_t) offt, n);
+        nr = (nread > 0) ? MIN((size_t) nread, n - nb) : 0;
+        extrema_init(&e);
+        extrema_update(&e, s->y, nb);
+        // Keep warnings about the window in nerr, as for uncompressed files
+        if(nr > 0) {
+            if((ret = sac_zfile_seek(zf, SAC_HEADER_SIZE + (uint64_t) skip * SAC_DATA_SIZE)) != SAC_OK ||
+               (ret = sac_zfile_read_all(zf, s->y + nb, nr * sizeof(float))) != SAC_OK) {
+                *nerr = ret;
+                goto error;
+            }
+            sac_data_swap_extrema(s->y + nb, nr, s->m->swap, &e);
+        }
+        extrema_update(&e, s->y + nb + nr, n - nb - nr);
+        if(!(flags & SAC_READ_NO_EXTREMA)) {
+            extrema_set(s, &e);
+        }
+    }
+    sac_io_done(zf->fd, (size_t) zf->cread, t0, flags);
+    sac_zfile_close(zf);
+    sac_read_post(s, flags);
+    return s;
+ error:
+    sac_zfile_close(zf);
+    sac_free(s);
+    return NULL;
+}
+
+/**
+ * @brief      Add an access point to a sidecar seek index being built
+ *
+ * @private
+ *
+ * @param      fd      index file
+ * @param      off     offset to write the point at, advanced past it
+ * @param      p       access point
+ * @param      window  ring buffer of uncompressed data, gzip only
+ * @param      pos     position in \p window of the next output byte
+ *
+ * @return     0 on success, ERROR_WRITING_FILE on failure
+ */
+static int
+sac_zindex_add(int fd, off_t *off, sac_zpoint *p, const unsigned char *window, size_t pos) {
+    struct iovec iov[3];
+    iov[0].iov_base = p;
+    iov[0].iov_len  = sizeof *p;
+    // Oldest data first, the ring holds the last SAC_Z_WINDOW bytes
+    if(p->wlen < SAC_Z_WINDOW) {
+        iov[1].iov_base = (void *) window;
+        iov[1].iov_len  = p->wlen;
+        iov[2].iov_base = NULL;
+        iov[2].iov_len  = 0;
+    } else {
+        iov[1].iov_base = (void *) (window + pos);
+        iov[1].iov_len  = SAC_Z_WINDOW - pos;
+        iov[2].iov_base = (void *) window;
+        iov[2].iov_len  = pos;
+    }
+    return sac_pwritev_all(fd, iov, 3, off);
+}
+
+/**
+ * @brief      Build a sidecar seek index for a compressed sac file
+ *
+ * @ingroup    sac
+ *
+ * @details    Build a seek index, written to filename.idx, holding access
+ *             points about every \p span uncompressed bytes.  Cut reads of
+ *             the file, sac_read_with_cut(), then only decompress the data
+ *             covering the cut window.
+ *
+ *             gzip access points are at deflate block boundaries and keep
+ *             the preceding 32 KiB of data, as in zlib's zran example.
+ *             zstd access points are frame boundaries, so only files made
+ *             of many frames, e.g. in the zstd seekable format, can be
+ *             accessed part way through.
+ *
+ *             An index is only used while the compressed file keeps the
+ *             size and modification time it had when indexed.
+ *
+ * @param      filename  gzip or zstd compressed sac file
+ * @param      span      uncompressed bytes between access points, 0 for
+ *                       the default of 1 MiB
+ * @param      nerr      status code, 0 on success, non-zero on failure,
+ *                       ERROR_COMPRESSED_FILE if the compression is not
+ *                       supported
+ *
+ * @code
+ * int nerr = 0;
+ * sac *s = sac_read("t/test_io_small.sac.gz", &nerr);
+ * if(nerr != ERROR_COMPRESSED_FILE) {
+ *     assert_eq(nerr, 0);
+ *     sac *c = sac_read("t/test_io_small.sac", &nerr);
+ *     assert_eq(memcmp(s->h, c->h, sizeof(sac_hdr)), 0);
+ *     assert_eq(memcmp(s->y, c->y, sizeof(float) * c->h->npts), 0);
+ *
+ *     sac_compressed_index("t/test_io_small.sac.gz", 64, &nerr);
+ *     assert_eq(nerr, 0);
+ *     s = sac_read_with_cut("t/test_io_small.sac.gz", "Z", 10.0, "Z", 30.0, CutUseBE, &nerr);
+ *     assert_eq(nerr, 0);
+ *     c = sac_read_with_cut("t/test_io_small.sac", "Z", 10.0, "Z", 30.0, CutUseBE, &nerr);
+ *     assert_eq(memcmp(s->h, c->h, sizeof(sac_hdr)), 0);
+ *     assert_eq(memcmp(s->y, c->y, sizeof(float) * c->h->npts), 0);
+ *     unlink("t/test_io_small.sac.gz.idx");
+ *
+ *     // Enough deflate blocks for several access points
+ *     s = sac_read("t/test_io_long.sac.gz", &nerr);
+ *     assert_eq(nerr, 0);
+ *     sac_write(s, "t/test_io_long.sac.tmp", &nerr);
+ *     assert_eq(nerr, 0);
+ *     sac_compressed_index("t/test_io_long.sac.gz", 16384, &nerr);
+ *     assert_eq(nerr, 0);
+ *     uint32_t n = 0;
+ *     FILE *fp = fopen("t/test_io_long.sac.gz.idx", "rb");
+ *     assert_eq(fseek(fp, 12, SEEK_SET), 0);
+ *     assert_eq(fread(&n, sizeof n, 1, fp), 1);
+ *     fclose(fp);
+ *     assert_eq(n >= 2, 1);
+ *     double win[][2] = { {10.0, 20.0}, {100.0, 150.0}, {190.0, 199.0} };
+ *     for(size_t i = 0; i < sizeof win / sizeof win[0]; i++) {
+ *         s = sac_read_with_cut("t/test_io_long.sac.gz", "B", win[i][0], "B", win[i][1], CutUseBE, &nerr);
+ *         assert_eq(nerr, 0);
+ *         c = sac_read_with_cut("t/test_io_long.sac.tmp", "B", win[i][0], "B", win[i][1], CutUseBE, &nerr);
+ *         assert_eq(nerr, 0);
+ *         assert_eq(memcmp(s->h, c->h, sizeof(sac_hdr)), 0);
+ *         assert_eq(memcmp(s->y, c->y, sizeof(float) * c->h->npts), 0);
+ *     }
+ *     unlink("t/test_io_long.sac.gz.idx");
+ * }
+ * s = sac_read("t/test_io_big.sac.zst", &nerr);
+ * if(nerr != ERROR_COMPRESSED_FILE) {
+ *     assert_eq(nerr, 0);
+ *     sac *c = sac_read("t/test_io_big.sac", &nerr);
+ *     assert_eq(memcmp(s->h, c->h, sizeof(sac_hdr)), 0);
+ *     assert_eq(memcmp(s->y, c->y, sizeof(float) * c->h->npts), 0);
+ * }
+ * @endcode
+ */
+void
+sac_compressed_index(char *filename, size_t span, int *nerr) {
+    int fd = -1;
+    off_t off = sizeof(sac_zindex);
+    size_t pos = 0;
+    uint64_t last = 0, usize = 0;
+    char *iname = NULL, *tmp = NULL;
+    unsigned char *window = NULL;
+    struct stat st;
+    sac_zindex idx;
+    sac_zpoint p = { 0, 0, SAC_Z_MEMBER, 0 };
+    sac_zfile *zf = NULL;
+
+    *nerr = SAC_OK;
+    span = (span > 0) ? span : SAC_Z_INDEX_SPAN;
+    if(!(zf = sac_zfile_open(filename, nerr))) {
+        return;
+    }
+    if(zf->ifd >= 0) {
+        close(zf->ifd);
+        zf->ifd = -1;
+    }
+    memset(&idx, 0, sizeof idx);
+    memcpy(idx.magic, SAC_Z_INDEX_MAGIC, sizeof idx.magic);
+    idx.type = (uint32_t) zf->type;
+    if(fstat(zf->fd, &st) != 0 ||
+       !(iname = sac_zindex_filename(filename)) ||
+       !(window = malloc(SAC_Z_WINDOW)) ||
+       (fd = sac_tmp_open(iname, &tmp)) < 0) {
+        *nerr = ERROR_WRITING_FILE;
+        goto done;
+    }
+    if((*nerr = sac_zindex_add(fd, &off, &p, window, 0)) != SAC_OK) {
+        goto done;
+    }
+    idx.n = 1;
+    switch(zf->type) {
+#ifdef HAVE_ZLIB
+    case SAC_COMPRESS_GZIP: {
+        // Inflate a block at a time into a ring of the last 32 KiB
+        int ret = Z_OK, eof = FALSE, ended = FALSE;
+        uint64_t cin = 0;
+        zf->z.avail_in  = 0;
+        zf->z.avail_out = 0;
+        do {
+            if(zf->z.avail_in == 0 && !eof) {
+                zf->in_pos = zf->in_len;
+                if(sac_zfile_fill(zf)) {
+                    zf->z.next_in  = zf->in;
+                    zf->z.avail_in = (uInt) zf->in_len;
+                } else {
+                    eof = TRUE;
+                }
+            }
+            if(zf->z.avail_out == 0) {
+                zf->z.next_out  = window;
+                zf->z.avail_out = SAC_Z_WINDOW;
+            }
+            uInt ain = zf->z.avail_in, aout = zf->z.avail_out;
+            ret = inflate(&zf->z, Z_BLOCK);
+            cin   += ain - zf->z.avail_in;
+            usize += aout - zf->z.avail_out;
+            pos    = SAC_Z_WINDOW - zf->z.avail_out;
+            if(ain != zf->z.avail_in || aout != zf->z.avail_out) {
+                ended = FALSE;
+            }
+            if(ret == Z_STREAM_END) {
+                // Another member may follow, starting a new point
+                ended = TRUE;
+                if(inflateReset(&zf->z) != Z_OK) {
+                    *nerr = ERROR_READING_FILE;
+                    goto done;
+                }
+                if(usize - last >= span && cin < (uint64_t) st.st_size) {
+                    p.uoff = usize;
+                    p.coff = cin;
+                    p.bits = SAC_Z_MEMBER;
+                    p.wlen = 0;
+                    if((*nerr = sac_zindex_add(fd, &off, &p, window, pos)) != SAC_OK) {
+                        goto done;
+                    }
+                    idx.n++;
+                    last = usize;
+                }
+            } else if(ret != Z_OK && ret != Z_BUF_ERROR) {
+                *nerr = ERROR_READING_FILE;
+                goto done;
+            } else if((zf->z.data_type & 128) && !(zf->z.data_type & 64) &&
+                      usize - last >= span) {
+                p.uoff = usize;
+                p.coff = cin;
+                p.bits = (uint32_t) (zf->z.data_type & 7);
+                p.wlen = (uint32_t) MIN(usize, (uint64_t) SAC_Z_WINDOW);
+                if((*nerr = sac_zindex_add(fd, &off, &p, window, pos)) != SAC_OK) {
+                    goto done;
+                }
+                idx.n++;
+                last = usize;
+            }
+        } while(!eof || ret != Z_BUF_ERROR);
+        if(!ended) {
+            *nerr = ERROR_READING_FILE;
+            goto done;
         }
         break;
-    default: *nerr = 1301; break;
     }
-    return r;
+#endif /* HAVE_ZLIB */
+#ifdef HAVE_ZSTD
+    case SAC_COMPRESS_ZSTD: {
+        // Frame ends are access points
+        int more = TRUE, ended = FALSE;
+        size_t ret = 0;
+        while(more) {
+            more = sac_zfile_fill(zf);
+            ZSTD_inBuffer in = { zf->in, (more) ? zf->in_len : 0, (more) ? zf->in_pos : 0 };
+            ZSTD_outBuffer o = { window, SAC_Z_WINDOW, 0 };
+            ret = ZSTD_decompressStream(zf->d, &o, &in);
+            if(ZSTD_isError(ret)) {
+                *nerr = ERROR_READING_FILE;
+                goto done;
+            }
+            if(in.pos != in.size || o.pos > 0 || in.size > 0) {
+                ended = (ret == 0);
+            }
+            if(more) {
+                zf->in_pos = in.pos;
+            }
+            usize += o.pos;
+            // Output may be pending at the end of the input
+            more = more || o.pos == o.size;
+            if(ret == 0 && usize - last >= span &&
+               (zf->in_pos < zf->in_len || zf->coff < (uint64_t) st.st_size)) {
+                p.uoff = usize;
+                p.coff = zf->coff - (zf->in_len - zf->in_pos);
+                p.bits = SAC_Z_MEMBER;
+                p.wlen = 0;
+                if((*nerr = sac_zindex_add(fd, &off, &p, window, 0)) != SAC_OK) {
+                    goto done;
+                }
+                idx.n++;
+                last = usize;
+            }
+        }
+        if(!ended) {
+            *nerr = ERROR_READING_FILE;
+            goto done;
+        }
+        break;
+    }
+#endif /* HAVE_ZSTD */
+    }
+    idx.usize    = usize;
+    idx.csize    = (uint64_t) st.st_size;
+    idx.mtime    = (int64_t) st.st_mtim.tv_sec;
+    idx.mtime_ns = (int64_t) st.st_mtim.tv_nsec;
+    if(pwrite(fd, &idx, sizeof idx, 0) != (ssize_t) sizeof idx) {
+        *nerr = ERROR_WRITING_FILE;
+        goto done;
+    }
+    if(close(fd) != 0 || rename(tmp, iname) != 0) {
+        fd = -1;
+        *nerr = ERROR_WRITING_FILE;
+        goto done;
+    }
+    fd = -1;
+    FREE(tmp);
+ done:
+    if(fd >= 0) {
+        close(fd);
+    }
+    if(tmp) {
+        unlink(tmp);
+        FREE(tmp);
+    }
+    FREE(iname);
+    FREE(window);
+    sac_zfile_close(zf);
+}
+
+/**
+ * @brief Maximum number of files read at once by a sac_batch by default
+ * @private
+ */
+#define SAC_BATCH_DEPTH 256
+
+/**
+ * @brief Stages of a file read by a sac_batch
+ * @private
+ */
+enum {
+    SAC_BATCH_QUEUED = 0, /**< @private not started */
+    SAC_BATCH_OPEN,       /**< @private opening and getting the size */
+    SAC_BATCH_FILE,       /**< @private reading the whole file */
+    SAC_BATCH_HEADER,     /**< @private reading the header and v7 footer, cut */
+    SAC_BATCH_DATA,       /**< @private reading the cut window */
+    SAC_BATCH_DONE,       /**< @private read, waiting to be returned */
+};
+
+/**
+ * @brief Operations of a file read, stored in the low bits of the user data
+ * @private
+ */
+enum {
+    SAC_BATCH_OP_OPEN = 0,  /**< @private openat */
+    SAC_BATCH_OP_STATX,     /**< @private statx */
+    SAC_BATCH_OP_READ,      /**< @private read of header, data or file */
+    SAC_BATCH_OP_FOOTER,    /**< @private read of the v7 footer */
+    SAC_BATCH_OP_MASK = 3,  /**< @private mask of the operation bits */
+};
+
+typedef struct sac_batch_item sac_batch_item;
+/**
+ * @brief single file read by a sac_batch
+ * @private
+ */
+struct sac_batch_item {
+    char *filename;        /**< @private file to read */
+    int index;             /**< @private index returned by sac_batch_add() */
+    int cut;               /**< @private if the file is cut on read */
+    char *c1;              /**< @private reference time pick for start */
+    char *c2;              /**< @private reference time pick for end */
+    double t1;             /**< @private relative time from c1 */
+    double t2;             /**< @private relative time from c2 */
+    enum CutAction cutact; /**< @private behavior of cut */
+    int stage;             /**< @private current stage of the read */
+    int ops;               /**< @private operations in flight */
+    int fd;                /**< @private file descriptor */
+    int nerr;              /**< @private status code */
+    uint64_t t0;           /**< @private start time, for read statistics */
+    off_t size;            /**< @private size of the file in bytes */
+    char *buf;             /**< @private destination of the current read */
+    size_t len;            /**< @private length of the current read */
+    size_t done;           /**< @private bytes of the current read completed */
+    off_t off;             /**< @private file offset of the current read */
+    char *file;            /**< @private whole file contents */
+    size_t nb;             /**< @private zero filled samples before the cut window */
+    size_t nr;             /**< @private samples read within the cut window */
+    sac *s;                /**< @private file read */
+    sac_batch_item *next;  /**< @private next completed read */
+#ifdef HAVE_IO_URING
+    struct statx stx;      /**< @private file status */
+#endif /* HAVE_IO_URING */
+    char hdr[SAC_HEADER_SIZE];     /**< @private header, cut */
+    char footer[sizeof(sac_f64)];  /**< @private v7 footer, cut */
+};
+
+#ifdef HAVE_IO_URING
+typedef struct sac_uring sac_uring;
+/**
+ * @brief io_uring submission and completion rings
+ * @private
+ */
+struct sac_uring {
+    int fd;                      /**< @private ring file descriptor */
+    unsigned *sq_head;           /**< @private submission head, kernel owned */
+    unsigned *sq_tail;           /**< @private submission tail */
+    unsigned *sq_mask;           /**< @private submission index mask */
+    unsigned *sq_entries;        /**< @private submission ring size */
+    unsigned *sq_array;          /**< @private submission index array */
+    unsigned *cq_head;           /**< @private completion head */
+    unsigned *cq_tail;           /**< @private completion tail, kernel owned */
+    unsigned *cq_mask;           /**< @private completion index mask */
+    struct io_uring_sqe *sqes;   /**< @private submission entries */
+    struct io_uring_cqe *cqes;   /**< @private completion entries */
+    void *sq_map;                /**< @private submission ring mapping */
+    void *cq_map;                /**< @private completion ring mapping */
+    size_t sq_size;              /**< @private submission ring mapping size */
+    size_t cq_size;              /**< @private completion ring mapping size */
+    size_t sqes_size;            /**< @private submission entries mapping size */
+    unsigned tail;               /**< @private local submission tail */
+    unsigned queued;             /**< @private entries not yet submitted */
+};
+#endif /* HAVE_IO_URING */
+
+/**
+ * @brief asynchronous batch reader
+ * @private
+ */
+struct sac_batch {
+    sac_batch_item **item;  /**< @private files to read, in order added */
+    int n;                  /**< @private number of files */
+    int alloc;              /**< @private allocated number of files */
+    int started;            /**< @private number of files started */
+    int returned;           /**< @private number of files returned */
+    int active;             /**< @private files started and not yet done */
+    int depth;              /**< @private maximum active files */
+    int flags;              /**< @private read flags */
+    sac_batch_item *head;   /**< @private first completed read */
+    sac_batch_item *tail;   /**< @private last completed read */
+#ifdef HAVE_IO_URING
+    int uring;              /**< @private if the io_uring is available */
+    sac_uring r;            /**< @private io_uring */
+#endif /* HAVE_IO_URING */
+};
+
+#ifdef HAVE_IO_URING
+/**
+ * @brief      Release an io_uring
+ *
+ * @private
+ *
+ * @param      r     io_uring
+ */
+static void
+sac_uring_free(sac_uring *r) {
+    if(r->sqes && r->sqes != MAP_FAILED) {
+        munmap(r->sqes, r->sqes_size);
+    }
+    if(r->cq_map && r->cq_map != MAP_FAILED && r->cq_map != r->sq_map) {
+        munmap(r->cq_map, r->cq_size);
+    }
+    if(r->sq_map && r->sq_map != MAP_FAILED) {
+        munmap(r->sq_map, r->sq_size);
+    }
+    if(r->fd >= 0) {
+        close(r->fd);
+    }
+    memset(r, 0, sizeof *r);
+    r->fd = -1;
 }
 
 /**
- * @brief      calculate read window specifics
+ * @brief      Check the kernel supports the operations of a batch read
  *
  * @private
- * @ingroup    sac
- * @memberof   sac
  *
- * @details    calculate read window values including:
- *             - nread, offt, and skip
- *             - nfille, nfillb, nstart, nstop (in sac meta)
+ * @details    openat, statx and read need Linux 5.6; older kernels set up
+ *             the ring but fail each of these operations
  *
- * @param      s       sac file
- * @param      c1      reference time pick for start
- * @param      t1      relative time from time pick `c1`
- * @param      c2      reference time pick for end
- * @param      t2      relative time ffrom time pick `c2`
- * @param      cutact  Behavior of cut
- *                     - CutNone = 0
- *                     - CutFatal = 1
- *                     - CutUseBe = 2
- *                     - CutFillZero = 3
- * @param      nread   Number of point to read from file
- * @param      offt    Points to fill with zero before writing
- * @param      skip    Points to skip before reading
- * @param      nerr    Status code
+ * @param      r     io_uring
  *
- * @return     1 on success, 0 on failure
+ * @return     0 if all operations are supported, -1 otherwise
  */
 static int
-sac_calc_read_window(sac *s, char *c1, double t1, char *c2, double t2, enum CutAction cutact, int *nread, int *offt, int *skip, int *nerr) {
-    *nerr = 0;
-    if(cutact == CutNone) {
-        s->m->nfillb = 0;
-        s->m->nfillb = 0;
-        s->m->nstart = 1;
-        s->m->nstop  = s->h->npts;
-        *nread = s->h->npts;
-        *offt  = 0;
-        *skip  = 0;
-    } else {
-        double r1 = sac_pick_ref_time(s, c1, nerr);
-        if(*nerr) {
-            goto error;
-        }
-        double r2 = sac_pick_ref_time(s, c2, nerr);
-        if(*nerr) {
-            goto error;
-        }
+sac_uring_probe(sac_uring *r) {
+    static const int ops[] = { IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ };
+    size_t i = 0;
+    int ret = -1;
+    struct io_uring_probe *p = NULL;
 
-        if(r1 == SAC_FLOAT_UNDEFINED) {
-            printf(" WARNING: Undefined starting cut for file %s\n"
-                   " Corrected by using file begin.\n", s->m->filename);
-        }
-        if(r2 == SAC_FLOAT_UNDEFINED) {
-            printf(" WARNING: Undefined starting cut for file %s\n"
-                   " Corrected by using file end.\n", s->m->filename);
+    if(!(p = calloc(1, sizeof *p + 256 * sizeof(struct io_uring_probe_op)))) {
+        return -1;
+    }
+    if(syscall(__NR_io_uring_register, r->fd, IORING_REGISTER_PROBE, p, 256) == 0) {
+        ret = 0;
+        for(i = 0; i < sizeof ops / sizeof ops[0]; i++) {
+            if(ops[i] > p->last_op || !(p->ops[ops[i]].flags & IO_URING_OP_SUPPORTED)) {
+                ret = -1;
+            }
         }
-        t1 = (r1 == SAC_FLOAT_UNDEFINED) ? B(s) : r1 + t1;
-        t2 = (r2 == SAC_FLOAT_UNDEFINED) ? E(s) : r2 + t2;
-
-        s->m->nstart = sac_time_to_index(s, t1) + 1;
-        s->m->nstop  = sac_time_to_index(s, t2) + 1;
+    }
+    free(p);
+    return ret;
+}
 
-        if(t1 >= t2) {
-            printf(" WARNING: Start cut greater than stop cut for file %s\n"
-                   "\ttime:  %f >= %f\n"
-                   "\tindex: %d >= %d\n", s->m->filename,
-                   t1, t2,
-                   s->m->nstart, s->m->nstop);
-            *nerr = ERROR_START_TIME_GREATER_THAN_STOP;
+/**
+ * @brief      Create an io_uring
+ *
+ * @private
+ *
+ * @param      r        io_uring to initialize
+ * @param      entries  number of submission entries
+ *
+ * @return     0 on success, -1 if io_uring or the operations used are not
+ *             available
+ */
+static int
+sac_uring_init(sac_uring *r, unsigned entries) {
+    struct io_uring_params p;
+    char *sq = NULL, *cq = NULL;
+
+    memset(r, 0, sizeof *r);
+    memset(&p, 0, sizeof p);
+    if((r->fd = (int) syscall(__NR_io_uring_setup, entries, &p)) < 0) {
+        r->fd = -1;
+        return -1;
+    }
+    if(sac_uring_probe(r) != 0) {
+        goto error;
+    }
+    r->sq_size   = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    r->cq_size   = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    r->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    if(p.features & IORING_FEAT_SINGLE_MMAP) {
+        r->sq_size = r->cq_size = MAX(r->sq_size, r->cq_size);
+    }
+    r->sq_map = mmap(NULL, r->sq_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQ_RING);
+    if(r->sq_map == MAP_FAILED) {
+        goto error;
+    }
+    r->cq_map = r->sq_map;
+    if(!(p.features & IORING_FEAT_SINGLE_MMAP)) {
+        r->cq_map = mmap(NULL, r->cq_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_CQ_RING);
+        if(r->cq_map == MAP_FAILED) {
             goto error;
         }
+    }
+    r->sqes = mmap(NULL, r->sqes_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQES);
+    if(r->sqes == MAP_FAILED) {
+        goto error;
+    }
+    sq = (char *) r->sq_map;
+    cq = (char *) r->cq_map;
+    r->sq_head    = (unsigned *) (sq + p.sq_off.head);
+    r->sq_tail    = (unsigned *) (sq + p.sq_off.tail);
+    r->sq_mask    = (unsigned *) (sq + p.sq_off.ring_mask);
+    r->sq_entries = (unsigned *) (sq + p.sq_off.ring_entries);
+    r->sq_array   = (unsigned *) (sq + p.sq_off.array);
+    r->cq_head    = (unsigned *) (cq + p.cq_off.head);
+    r->cq_tail    = (unsigned *) (cq + p.cq_off.tail);
+    r->cq_mask    = (unsigned *) (cq + p.cq_off.ring_mask);
+    r->cqes       = (struct io_uring_cqe *) (cq + p.cq_off.cqes);
+    r->tail       = *r->sq_tail;
+    return 0;
+ error:
+    sac_uring_free(r);
+    return -1;
+}
 
-        int f = window_overlap(s);
-        if(cutact == CutUseBE) {
-            s->m->nfillb = 0;
-            s->m->nfille = 0;
-            if(s->m->nstart < 1) {
-                s->m->nstart = 1;
-                printf(" WARNING: Start cut less than file begin for file %s\n"
-                       " Corrected by using file begin.\n", s->m->filename);
-            }
-            if(s->m->nstop > s->h->npts) {
-                s->m->nstop = s->h->npts;
-                printf(" WARNING: Stop cut greater than file end for file %s\n"
-                       " Corrected by using file end.\n", s->m->filename);
-            }
-            *nread = s->m->nstop - s->m->nstart + 1;
-            *offt  = 0;
-            *skip  = MAX(s->m->nstart, 1) - 1;
-        } else if(cutact == CutFillZero) {
-            s->m->nfillb = MAX(1 - s->m->nstart, 0);
-            s->m->nfille = s->m->nstop - s->h->npts;
-            *nread = MIN(s->m->nstop, s->h->npts) - MAX(s->m->nstart, 1) + 1;
-            *offt  = s->m->nfillb;
-            *skip  = MAX(s->m->nstart, 1) - 1;
-        } else if(cutact == CutFatal) {
-            *nread = s->m->nstop - s->m->nstart + 1;
-            *skip  = s->m->nstart-1;
-            *offt  = 0;
-        }
-        if(cutact != CutFillZero) {
-            switch (f) {
-            case START_BEFORE | END_BEFORE:  *nerr = ERROR_STOP_TIME_LESS_THAN_BEGIN;    goto error; break; // |---| {-------}
-            case START_BEFORE | END_INSIDE:  *nerr = ERROR_START_TIME_LESS_THAN_BEGIN;   break; // |-----{---|---}
-            case START_BEFORE | END_AFTER:   *nerr = ERROR_CUT_TIMES_BEYOND_DATA_LIMITS; break; // |-----{-------}---|
-            case START_INSIDE | END_BEFORE:  *nerr = ERROR_START_TIME_GREATER_THAN_STOP; goto error; break;
-            case START_INSIDE | END_INSIDE:  *nerr = SAC_OK;                             break; //       {-|---|-}
-            case START_INSIDE | END_AFTER:   *nerr = ERROR_STOP_TIME_GREATER_THAN_END;   break; //       {---|---}---|
-            case START_AFTER  | END_BEFORE:  *nerr = ERROR_START_TIME_GREATER_THAN_STOP; goto error; break;
-            case START_AFTER  | END_INSIDE:  *nerr = ERROR_START_TIME_GREATER_THAN_STOP; goto error; break;
-            case START_AFTER  | END_AFTER:   *nerr = ERROR_START_TIME_GREATER_THAN_END;  break; //       {-------}  |-----|
-            }
-        }
-        if(cutact == CutFatal && (f != (START_INSIDE | END_INSIDE))) {
-            switch(*nerr) {
-            case ERROR_CUT_TIMES_BEYOND_DATA_LIMITS:
-            case ERROR_START_TIME_LESS_THAN_BEGIN:
-                printf(" WARNING: Start cut less than file begin for file %s\n", s->m->filename);
-                break;
-            case ERROR_STOP_TIME_GREATER_THAN_END:
-                printf(" WARNING: Stop cut greater than file end for file %s\n", s->m->filename);
-                break;
+/**
+ * @brief      Submit queued entries and optionally wait for completions
+ *
+ * @private
+ *
+ * @param      r     io_uring
+ * @param      wait  number of completions to wait for
+ *
+ * @return     0 on success, negative errno on failure
+ */
+static int
+sac_uring_submit(sac_uring *r, unsigned wait) {
+    long ret = 0;
+    atomic_store_explicit((_Atomic unsigned *) r->sq_tail, r->tail, memory_order_release);
+    while(r->queued > 0 || wait > 0) {
+        ret = syscall(__NR_io_uring_enter, r->fd, r->queued, wait,
+                      (wait > 0) ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+        if(ret < 0) {
+            if(errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+                continue;
             }
-            goto error;
+            return -errno;
         }
-        if(*nread <= 0 && cutact != CutFillZero) {
-            goto error;
+        r->queued -= (unsigned) ret;
+        wait = 0;
+    }
+    return 0;
+}
+
+/**
+ * @brief      Get a cleared submission entry, submitting if the ring is full
+ *
+ * @private
+ *
+ * @param      r     io_uring
+ *
+ * @return     submission entry, NULL on failure
+ */
+static struct io_uring_sqe *
+sac_uring_sqe(sac_uring *r) {
+    unsigned head = 0, i = 0;
+    struct io_uring_sqe *sqe = NULL;
+    head = atomic_load_explicit((_Atomic unsigned *) r->sq_head, memory_order_acquire);
+    if(r->tail - head >= *r->sq_entries) {
+        if(sac_uring_submit(r, 0) != 0) {
+            return NULL;
         }
+    }
+    i = r->tail & *r->sq_mask;
+    sqe = &r->sqes[i];
+    memset(sqe, 0, sizeof *sqe);
+    r->sq_array[i] = i;
+    r->tail++;
+    r->queued++;
+    return sqe;
+}
 
-        sac_set_float(s, SAC_B, B(s) + DT(s) * (double) (s->m->nstart - 1));
-        int npts = s->m->nstop - s->m->nstart + 1;
-        if(npts <= 0) {
-            goto error;
+/**
+ * @brief      Queue an operation of a batch read
+ *
+ * @private
+ *
+ * @param      r       io_uring
+ * @param      it      file being read
+ * @param      op      operation, stored with the item in the user data
+ * @param      opcode  io_uring operation
+ * @param      fd      file descriptor
+ * @param      addr    buffer or path
+ * @param      len     length of the buffer or statx mask
+ * @param      off     file offset or statx buffer
+ * @param      flags   statx flags, 0 for reads and opens
+ *
+ * @return     0 on success, ERROR_READING_FILE on failure
+ */
+static int
+sac_batch_queue(sac_uring *r, sac_batch_item *it, int op, int opcode,
+                int fd, void *addr, unsigned len, uint64_t off, unsigned flags) {
+    struct io_uring_sqe *sqe = NULL;
+    if(!(sqe = sac_uring_sqe(r))) {
+        return ERROR_READING_FILE;
+    }
+    sqe->opcode    = (uint8_t) opcode;
+    sqe->fd        = fd;
+    sqe->addr      = (uint64_t) (uintptr_t) addr;
+    sqe->len       = len;
+    sqe->off       = off;
+    sqe->statx_flags = flags;
+    sqe->user_data = (uint64_t) (uintptr_t) it | (uint64_t) op;
+    it->ops++;
+    return SAC_OK;
+}
+#endif /* HAVE_IO_URING */
+
+/**
+ * @brief      Create an asynchronous batch reader
+ *
+ * @ingroup    sac
+ *
+ * @details    Read many sac files at once.  Files are added with
+ *             sac_batch_add() or sac_batch_add_cut() and returned, in the
+ *             order they complete, by sac_batch_next().  Opening, getting
+ *             the size and reading of up to \p depth files are submitted
+ *             together through io_uring, keeping the device queue full
+ *             when reads are latency bound.  Each file is read with a
+ *             single read, cut files with a header read and a read of the
+ *             cut window.  Without io_uring, or on kernels before Linux
+ *             5.6 which lack its openat, statx and read operations, files
+ *             are read one at a time with sac_read_with_flags() and
+ *             sac_read_with_cut_flags().
+ *
+ * @param      depth  maximum number of files in flight, 0 for the default
+ * @param      flags  read flags, see sac_read_with_flags(),
+ *                    SAC_READ_LAZY is ignored
+ * @param      nerr   status code, 0 on success, non-zero on failure
+ *
+ * @return     batch reader, NULL on failure, free with sac_batch_free()
+ *
+ * @code
+ * int nerr = 0, i = 0, k = 0, n = 0;
+ * char *files[] = { "t/test_io_big.sac", "t/test_io_small.sac",
+ *                   "t/test_uneven_small.sac", "t/non-existant-file" };
+ * sac_batch *b = sac_batch_new(2, 0, &nerr);
+ * assert_eq(nerr, 0);
+ * for(i = 0; i < 4; i++) {
+ *     assert_eq(sac_batch_add(b, files[i], &nerr), i);
+ * }
+ * assert_eq(sac_batch_add_cut(b, "t/test_io_big.sac", "Z", 10.0, "Z", 30.0,
+ *                             CutUseBE, &nerr), 4);
+ * sac *s = NULL;
+ * while((s = sac_batch_next(b, &k, &nerr)) || k >= 0) {
+ *     n++;
+ *     if(k == 3) {
+ *         assert_eq(s, NULL);
+ *         assert_ne(nerr, 0);
+ *         continue;
+ *     }
+ *     assert_eq(nerr, 0);
+ *     sac *c = (k == 4) ?
+ *         sac_read_with_cut("t/test_io_big.sac", "Z", 10.0, "Z", 30.0, CutUseBE, &nerr) :
+ *         sac_read(files[k], &nerr);
+ *     assert_eq(memcmp(s->h, c->h, sizeof(sac_hdr)), 0);
+ *     assert_eq(memcmp(s->y, c->y, sizeof(float) * c->h->npts), 0);
+ *     if(c->x) {
+ *         assert_eq(memcmp(s->x, c->x, sizeof(float) * c->h->npts), 0);
+ *     }
+ *     sac_free(c);
+ *     sac_free(s);
+ * }
+ * assert_eq(n, 5);
+ * sac_batch_free(b);
+ * @endcode
+ *
+ * Compressed files are read as sac_read() reads them
+ * @code
+ * int nerr = 0, k = 0, err = 0;
+ * char *files[] = { "t/test_io_small.sac.gz", "t/test_io_big.sac.zst" };
+ * sac_batch *b = sac_batch_new(2, 0, &nerr);
+ * sac_batch_add(b, files[0], &nerr);
+ * sac_batch_add(b, files[1], &nerr);
+ * sac_batch_add_cut(b, files[0], "Z", 10.0, "Z", 30.0, CutUseBE, &nerr);
+ * sac *s = NULL;
+ * while((s = sac_batch_next(b, &k, &nerr)) || k >= 0) {
+ *     sac *c = (k == 2) ?
+ *         sac_read_with_cut(files[0], "Z", 10.0, "Z", 30.0, CutUseBE, &err) :
+ *         sac_read(files[k], &err);
+ *     assert_eq(nerr, err);
+ *     if(c) {
+ *         assert_eq(memcmp(s->h, c->h, sizeof(sac_hdr)), 0);
+ *         assert_eq(memcmp(s->y, c->y, sizeof(float) * c->h->npts), 0);
+ *     }
+ *     sac_free(c);
+ *     sac_free(s);
+ * }
+ * sac_batch_free(b);
+ * @endcode
+ */
+sac_batch *
+sac_batch_new(int depth, int flags, int *nerr) {
+    sac_batch *b = NULL;
+    *nerr = SAC_OK;
+    if(!(b = calloc(1, sizeof(sac_batch)))) {
+        *nerr = ERROR_READING_FILE;
+        return NULL;
+    }
+    b->depth = (depth > 0) ? depth : SAC_BATCH_DEPTH;
+    b->flags = flags & ~SAC_READ_LAZY;
+#ifdef HAVE_IO_URING
+    // Each file has at most two operations in flight
+    b->uring = (sac_uring_init(&b->r, (unsigned) (2 * b->depth)) == 0);
+#endif /* HAVE_IO_URING */
+    return b;
+}
+
+/**
+ * @brief      Add a file to a batch reader
+ *
+ * @private
+ *
+ * @param      b         batch reader
+ * @param      filename  file to read
+ * @param      nerr      status code, 0 on success, non-zero on failure
+ *
+ * @return     file to read, NULL on failure
+ */
+static sac_batch_item *
+sac_batch_item_new(sac_batch *b, char *filename, int *nerr) {
+    sac_batch_item *it = NULL;
+    sac_batch_item **item = NULL;
+    *nerr = SAC_OK;
+    if(!filename) {
+        *nerr = ERROR_FILE_DOES_NOT_EXIST;
+        return NULL;
+    }
+    if(b->n == b->alloc) {
+        int alloc = (b->alloc > 0) ? 2 * b->alloc : 64;
+        if(!(item = realloc(b->item, sizeof(sac_batch_item *) * (size_t) alloc))) {
+            *nerr = ERROR_READING_FILE;
+            return NULL;
         }
-        sac_set_int(s, SAC_NPTS, npts);
-        sac_be(s);
+        b->item = item;
+        b->alloc = alloc;
+    }
+    if(!(it = calloc(1, sizeof(sac_batch_item)))) {
+        *nerr = ERROR_READING_FILE;
+        return NULL;
+    }
+    it->filename = strdup(filename);
+    it->index = b->n;
+    it->fd = -1;
+    b->item[b->n++] = it;
+    return it;
+}
+
+/**
+ * @brief      Add a file to a batch reader
+ *
+ * @ingroup    sac
+ *
+ * @details    Add a file to be read, see sac_batch_new()
+ *
+ * @param      b         batch reader
+ * @param      filename  file to read
+ * @param      nerr      status code, 0 on success, non-zero on failure
+ *
+ * @return     index of the file, returned with the file by sac_batch_next(),
+ *             -1 on failure
+ */
+int
+sac_batch_add(sac_batch *b, char *filename, int *nerr) {
+    sac_batch_item *it = NULL;
+    if(!(it = sac_batch_item_new(b, filename, nerr))) {
+        return -1;
+    }
+    return it->index;
+}
+
+/**
+ * @brief      Add a file to a batch reader to be cut on read
+ *
+ * @ingroup    sac
+ *
+ * @details    Add a file to be read within a cut window, see
+ *             sac_read_with_cut() and sac_batch_new().  Only the header,
+ *             v7 footer and data within the cut window are read
+ *
+ * @param      b         batch reader
+ * @param      filename  file to read
+ * @param      c1        reference time pick for start
+ * @param      t1        relative time from time pick `c1`
+ * @param      c2        reference time pick for end
+ * @param      t2        relative time from time pick `c2`
+ * @param      cutact    Behavior of cut
+ * @param      nerr      status code, 0 on success, non-zero on failure
+ *
+ * @return     index of the file, returned with the file by sac_batch_next(),
+ *             -1 on failure
+ */
+int
+sac_batch_add_cut(sac_batch *b, char *filename,
+                  char *c1, double t1, char *c2, double t2,
+                  enum CutAction cutact, int *nerr) {
+    sac_batch_item *it = NULL;
+    if(!(it = sac_batch_item_new(b, filename, nerr))) {
+        return -1;
+    }
+    it->cut    = TRUE;
+    it->c1     = (c1) ? strdup(c1) : NULL;
+    it->c2     = (c2) ? strdup(c2) : NULL;
+    it->t1     = t1;
+    it->t2     = t2;
+    it->cutact = cutact;
+    return it->index;
+}
+
+/**
+ * @brief      Complete a file read and queue it to be returned
+ *
+ * @private
+ *
+ * @param      b     batch reader
+ * @param      it    file read
+ */
+static void
+sac_batch_done(sac_batch *b, sac_batch_item *it) {
+    if(it->fd >= 0) {
+        close(it->fd);
+        it->fd = -1;
+    }
+    FREE(it->file);
+    if(it->nerr != SAC_OK && it->s) {
+        sac_free(it->s);
+        it->s = NULL;
+    }
+    it->stage = SAC_BATCH_DONE;
+    it->next = NULL;
+    if(b->tail) {
+        b->tail->next = it;
+    } else {
+        b->head = it;
+    }
+    b->tail = it;
+    b->active--;
+}
+
+/**
+ * @brief      Read a file synchronously
+ *
+ * @private
+ *
+ * @details    Used when io_uring is not available and for files being
+ *             written, whose headers may need to be read more than once
+ *
+ * @param      b     batch reader
+ * @param      it    file to read
+ */
+static void
+sac_batch_read_sync(sac_batch *b, sac_batch_item *it) {
+    if(it->s) {
+        sac_free(it->s);
+        it->s = NULL;
+    }
+    if(it->cut) {
+        it->s = sac_read_with_cut_flags(it->filename, it->c1, it->t1, it->c2, it->t2,
+                                        it->cutact, b->flags, &it->nerr);
+    } else {
+        it->s = sac_read_with_flags(it->filename, b->flags, &it->nerr);
     }
-    return 1;
- error:
-    return 0;
+    sac_batch_done(b, it);
+}
 
+#ifdef HAVE_IO_URING
+/**
+ * @brief      Queue a read into the item's current read buffer
+ *
+ * @private
+ *
+ * @param      b     batch reader
+ * @param      it    file being read
+ *
+ * @return     0 on success, non-zero on failure
+ */
+static int
+sac_batch_read(sac_batch *b, sac_batch_item *it) {
+    size_t n = MIN(it->len - it->done, (size_t) INT32_MAX);
+    return sac_batch_queue(&b->r, it, SAC_BATCH_OP_READ, IORING_OP_READ, it->fd,
+                           it->buf + it->done, (unsigned) n,
+                           (uint64_t) it->off + it->done, 0);
 }
 
 /**
- * @brief      read a sac file while cutting
+ * @brief      Start reading a file, open it
  *
- * @ingroup    sac
- * @memberof   sac
+ * @private
  *
- * @details    read a sac file while cutting
+ * @details    The size is read once the file is open, see sac_batch_stat()
  *
- * @param      filename  sac file to read
- * @param      c1        reference time pick for start, see list below
- * @param      t1        relative time from time pick `c1`
- * @param      c2        reference time pick for end, see list below
- * @param      t2        relative time ffrom time pick `c2`
- * @param      cutact    Behavior of cut
- *                       - CutNone = 0
- *                       - CutFatal = 1
- *                       - CutUseBE = 2
- *                       - CutFillZero = 3
- * @param      nerr      Status code, 0 on success, non-zero on Error
+ * @param      b     batch reader
+ * @param      it    file to read
  *
- * @return     read and cut file on success, NULL on error
+ * @return     0 on success, non-zero on failure
+ */
+static int
+sac_batch_start(sac_batch *b, sac_batch_item *it) {
+    it->t0 = sac_io_clock();
+    it->stage = SAC_BATCH_OPEN;
+    b->active++;
+    return sac_batch_queue(&b->r, it, SAC_BATCH_OP_OPEN, IORING_OP_OPENAT,
+                           AT_FDCWD, it->filename, 0, 0, 0);
+}
+
+/**
+ * @brief      Get the size of a file just opened
  *
- * @note       Time pick reference
- *             - "Z" - Actual time
- *             - "B" - Begin time
- *             - "E" - End time
- *             - "O" - Origin time
- *             - "A" - First arrival time
- *             - "F" - Final arrival time: SAC_F value
- *             - "T0" to "T9" - t0 to t9 arrival times 
+ * @private
  *
- * @code
- * int nerr = 0;
- * double b = 0, e = 0;
- * sac *s = NULL;
+ * @details    The size is read from the open file, not its path, so a file
+ *             renamed over the path after the open, e.g. by an atomic write,
+ *             does not change the size of the file being read
  *
- * s = sac_read_with_cut("t/test_io_small.sac", 
- *                            "Z", 10.0,
- *                            "Z", 30.0, CutUseBE, 
- *                            &nerr);
- * sac_get_float(s, SAC_B, &b);
- * sac_get_float(s, SAC_E, &e);
- * assert_eq(b, 10.0);
- * assert_eq(e, 30.0);
+ * @param      b     batch reader
+ * @param      it    file being read
  *
- * s = sac_read_with_cut("t/test_io_big.sac", 
- *                       "Z", 10.0,
- *                       "Z", 30.0, CutUseBE, 
- *                       &nerr);
- * sac_get_float(s, SAC_B, &b);
- * sac_get_float(s, SAC_E, &e);
- * assert_eq(b, 10.0);
- * assert_eq(e, 30.0);
- * @endcode
+ * @return     0 on success, non-zero on failure
  */
-sac *
-sac_read_with_cut(char *filename,
-                  char* c1, double t1,
-                  char* c2, double t2,
-                  enum CutAction cutact, int *nerr) {
-    FILE *fp = NULL;
-    sac *s = NULL;
-    int nread = 0, offt = 0;
-    int skip = 0;
-    if(cutact != CutNone && (!isfinite(t1) || !isfinite(t2))) {
-        *nerr = ERROR_START_TIME_GREATER_THAN_STOP;
-        goto error;
-    }
+static int
+sac_batch_stat(sac_batch *b, sac_batch_item *it) {
+    static char empty[] = "";
+    return sac_batch_queue(&b->r, it, SAC_BATCH_OP_STATX, IORING_OP_STATX,
+                           it->fd, empty, STATX_SIZE,
+                           (uint64_t) (uintptr_t) &it->stx, AT_EMPTY_PATH);
+}
 
-    if(!(s = sac_read_header_internal(filename, nerr, &fp))) {
-        goto error;
+/**
+ * @brief      Continue reading a file after it is opened
+ *
+ * @private
+ *
+ * @details    Whole files are read with a single read, cut files read the
+ *             header and the v7 footer
+ *
+ * @param      b     batch reader
+ * @param      it    file being read
+ */
+static void
+sac_batch_opened(sac_batch *b, sac_batch_item *it) {
+    it->size = (off_t) it->stx.stx_size;
+    // Compressed files may be smaller than a header
+    if(it->size < SAC_HEADER_SIZE) {
+        close(it->fd);
+        it->fd = -1;
+        sac_batch_read_sync(b, it);
+        return;
     }
-    if(! s->h->leven ) {
-        *nerr = ERROR_CANT_CUT_UNEVENLY_SPACED_FILE;
-        goto error;
+    if(!it->cut) {
+        if(!(it->file = malloc((size_t) it->size))) {
+            it->nerr = ERROR_READING_FILE;
+            sac_batch_done(b, it);
+            return;
+        }
+        sac_io_advise(it->fd, 0, it->size, b->flags);
+        it->stage = SAC_BATCH_FILE;
+        it->buf   = it->file;
+        it->len   = (size_t) it->size;
+        it->done  = 0;
+        it->off   = 0;
+        it->nerr  = sac_batch_read(b, it);
+    } else {
+        it->stage = SAC_BATCH_HEADER;
+        it->buf   = it->hdr;
+        it->len   = sizeof it->hdr;
+        it->done  = 0;
+        it->off   = 0;
+        it->nerr  = sac_batch_read(b, it);
+        if(it->nerr == SAC_OK && it->size >= SAC_HEADER_SIZE + (off_t) sizeof it->footer) {
+            it->nerr = sac_batch_queue(&b->r, it, SAC_BATCH_OP_FOOTER, IORING_OP_READ, it->fd,
+                                       it->footer, sizeof it->footer,
+                                       (uint64_t) (it->size - (off_t) sizeof it->footer), 0);
+        }
     }
-    if(s->h->iftype != ITIME) {
-        *nerr = ERROR_CANT_CUT_SPECTRAL_FILE;
-        goto error;
+    if(it->nerr != SAC_OK && it->ops == 0) {
+        sac_batch_done(b, it);
     }
+}
 
-    sac_header_v7_fill(s, fp, nerr);
-
-    if(!sac_calc_read_window(s, c1, t1, c2, t2, cutact,
-                             &nread, &offt, &skip, nerr)) {
-        goto error;
+/**
+ * @brief      Parse a header read by a batch reader
+ *
+ * @private
+ *
+ * @param      b       batch reader
+ * @param      it      file being read
+ * @param      hdr     header
+ * @param      footer  v7 footer, may be NULL if the file is too small
+ *
+ * @return     1 on success, 0 if the file was read synchronously or
+ *             failed and is done
+ */
+static int
+sac_batch_header(sac_batch *b, sac_batch_item *it, const char *hdr, const char *footer) {
+    sac *s = NULL;
+    int compressed = (sac_compression(hdr, SAC_HEADER_SIZE) != SAC_COMPRESS_NONE);
+    s = it->s = sac_new();
+    s->m->filename = strdup(it->filename);
+    if(!compressed && (it->nerr = sac_header_read_buffer(s, hdr)) != SAC_OK) {
+        sac_batch_done(b, it);
+        return 0;
+    }
+    // Headers being written are read again, packed data is read directly
+    // and compressed files are decompressed, see sac_read_compressed()
+    if(compressed || !sac_header_live(s) || s->m->live || s->m->pack) {
+        close(it->fd);
+        it->fd = -1;
+        FREE(it->file);
+        sac_batch_read_sync(b, it);
+        return 0;
+    }
+    if((it->nerr = sac_size_check(s, it->size)) != SAC_OK) {
+        sac_batch_done(b, it);
+        return 0;
+    }
+    if(s->m->live || !footer) {
+        sac_copy_f32_to_f64(s);
+    } else {
+        sac_header_v7_fill_buffer(s, footer);
     }
+    return 1;
+}
 
+/**
+ * @brief      Finish reading a whole file
+ *
+ * @private
+ *
+ * @param      b     batch reader
+ * @param      it    file read
+ */
+static void
+sac_batch_file(sac_batch *b, sac_batch_item *it) {
+    int j = 0;
+    size_t n = 0;
+    extrema e;
+    sac *s = NULL;
+    if(!sac_batch_header(b, it, it->file,
+                         it->file + it->size - (off_t) sizeof(sac_f64))) {
+        return;
+    }
+    s = it->s;
+    if(s->h->npts <= 0) {
+        it->nerr = ERROR_READING_FILE;
+        sac_batch_done(b, it);
+        return;
+    }
+    n = (size_t) s->h->npts;
     sac_alloc(s);
+    extrema_init(&e);
+    for(j = 0; j < sac_comps(s); j++) {
+        float *y = (j == 0) ? s->y : s->x;
+        memcpy(y, it->file + SAC_HEADER_SIZE + (size_t) j * n * sizeof(float), n * sizeof(float));
+        sac_data_swap_extrema(y, n, s->m->swap,
+                              (j == 0 && !(b->flags & SAC_READ_NO_EXTREMA)) ? &e : NULL);
+    }
+    if(!(b->flags & SAC_READ_NO_EXTREMA)) {
+        extrema_set(s, &e);
+    }
+    s->m->nstart = 1;
+    s->m->nstop  = s->h->npts;
+    s->m->ntotal = s->h->npts;
+    s->m->nfillb = 0;
+    s->m->nfille = 0;
+    sac_io_done(it->fd, (size_t) it->size, it->t0, b->flags);
+    sac_read_post(s, b->flags);
+    sac_batch_done(b, it);
+}
 
-    if(skip > 0) {
-        fseek(fp,  skip * (int) SAC_DATA_SIZE, SEEK_CUR);
+/**
+ * @brief      Continue reading a cut file after the header is read
+ *
+ * @private
+ *
+ * @details    Determine the cut window and read only the data within it
+ *
+ * @param      b     batch reader
+ * @param      it    file being read
+ */
+static void
+sac_batch_cut(sac_batch *b, sac_batch_item *it) {
+    int nread = 0, offt = 0, skip = 0;
+    size_t n = 0;
+    sac *s = NULL;
+    int has_footer = (it->size >= SAC_HEADER_SIZE + (off_t) sizeof it->footer);
+    if(!sac_batch_header(b, it, it->hdr, has_footer ? it->footer : NULL)) {
+        return;
     }
-    if(nread > 0) {
-        size_t nr = (size_t) nread;
-        if(fread(s->y + offt, SAC_DATA_SIZE, nr, fp) != nr) {
-            *nerr = ERROR_READING_FILE;
-            goto error;
-        }
-        if(s->m->swap) {
-            sac_data_swap(s->y, s->h->npts);
+    s = it->s;
+    if(it->cutact != CutNone && (!isfinite(it->t1) || !isfinite(it->t2))) {
+        it->nerr = ERROR_START_TIME_GREATER_THAN_STOP;
+    } else if(!s->h->leven) {
+        it->nerr = ERROR_CANT_CUT_UNEVENLY_SPACED_FILE;
+    } else if(s->h->iftype != ITIME) {
+        it->nerr = ERROR_CANT_CUT_SPECTRAL_FILE;
+    }
+    if(it->nerr != SAC_OK ||
+       !sac_calc_read_window(s, it->c1, it->t1, it->c2, it->t2, it->cutact,
+                             &nread, &offt, &skip, &it->nerr)) {
+        sac_batch_done(b, it);
+        return;
+    }
+    sac_alloc(s);
+    n      = (size_t) s->h->npts;
+    it->nb = MIN((size_t) offt, n);
+    it->nr = (nread > 0) ? MIN((size_t) nread, n - it->nb) : 0;
+    it->stage = SAC_BATCH_DATA;
+    it->buf   = (char *) (s->y + it->nb);
+    it->len   = it->nr * sizeof(float);
+    it->done  = 0;
+    it->off   = SAC_HEADER_SIZE + (off_t) skip * (off_t) SAC_DATA_SIZE;
+    if(it->len == 0) {
+        return;
+    }
+    sac_io_advise(it->fd, it->off, (off_t) it->len, b->flags);
+    if((it->nerr = sac_batch_read(b, it)) != SAC_OK) {
+        sac_batch_done(b, it);
+    }
+}
+
+/**
+ * @brief      Finish reading a cut file
+ *
+ * @private
+ *
+ * @param      b     batch reader
+ * @param      it    file read
+ */
+static void
+sac_batch_cut_data(sac_batch *b, sac_batch_item *it) {
+    extrema e;
+    sac *s = it->s;
+    size_t n = (size_t) s->h->npts;
+    extrema_init(&e);
+    extrema_update(&e, s->y, it->nb);
+    sac_data_swap_extrema(s->y + it->nb, it->nr, s->m->swap, &e);
+    extrema_update(&e, s->y + it->nb + it->nr, n - it->nb - it->nr);
+    if(!(b->flags & SAC_READ_NO_EXTREMA)) {
+        extrema_set(s, &e);
+    }
+    sac_io_done(it->fd, SAC_HEADER_SIZE + it->nr * SAC_DATA_SIZE, it->t0, b->flags);
+    sac_read_post(s, b->flags);
+    sac_batch_done(b, it);
+}
+
+/**
+ * @brief      Handle the completion of an operation
+ *
+ * @private
+ *
+ * @param      b     batch reader
+ * @param      it    file being read
+ * @param      op    operation completed
+ * @param      res   result of the operation, negative errno on failure
+ */
+static void
+sac_batch_complete(sac_batch *b, sac_batch_item *it, int op, int res) {
+    it->ops--;
+    if(res < 0 && it->nerr == SAC_OK) {
+        it->nerr = sac_errno_to_nerr(-res);
+    }
+    if(res >= 0) {
+        switch(op) {
+        case SAC_BATCH_OP_OPEN:
+            it->fd = res;
+            if(it->nerr == SAC_OK) {
+                it->nerr = sac_batch_stat(b, it);
+            }
+            break;
+        case SAC_BATCH_OP_READ:
+            it->done += (size_t) res;
+            if(it->done < it->len && it->nerr == SAC_OK) {
+                // Short reads are continued, end of file is an error
+                it->nerr = (res > 0) ? sac_batch_read(b, it) : ERROR_READING_FILE;
+            }
+            break;
+        case SAC_BATCH_OP_FOOTER:
+            if((size_t) res != sizeof it->footer && it->nerr == SAC_OK) {
+                it->nerr = ERROR_READING_FILE;
+            }
+            break;
         }
     }
-    fclose(fp);
+    if(it->ops > 0) {
+        return;
+    }
+    if(it->nerr != SAC_OK) {
+        sac_batch_done(b, it);
+        return;
+    }
+    switch(it->stage) {
+    case SAC_BATCH_OPEN:   sac_batch_opened(b, it);   break;
+    case SAC_BATCH_FILE:   sac_batch_file(b, it);     break;
+    case SAC_BATCH_HEADER: sac_batch_cut(b, it);      break;
+    case SAC_BATCH_DATA:   sac_batch_cut_data(b, it); break;
+    }
+    // Cut windows without data are complete without a read
+    if(it->stage == SAC_BATCH_DATA && it->ops == 0 && it->len == 0) {
+        sac_batch_cut_data(b, it);
+    }
+}
 
-    sac_read_post(s, TRUE);
+/**
+ * @brief      Start files, submit operations and handle completions
+ *
+ * @private
+ *
+ * @param      b     batch reader
+ *
+ * @return     0 on success, non-zero on failure
+ */
+static int
+sac_batch_poll(sac_batch *b) {
+    unsigned head = 0, tail = 0;
+    sac_batch_item *it = NULL;
+    while(b->active < b->depth && b->started < b->n) {
+        it = b->item[b->started++];
+        if((it->nerr = sac_batch_start(b, it)) != SAC_OK && it->ops == 0) {
+            sac_batch_done(b, it);
+        }
+    }
+    if(b->active == 0) {
+        return SAC_OK;
+    }
+    if(sac_uring_submit(&b->r, 1) != 0) {
+        return ERROR_READING_FILE;
+    }
+    head = *b->r.cq_head;
+    tail = atomic_load_explicit((_Atomic unsigned *) b->r.cq_tail, memory_order_acquire);
+    for( ; head != tail; head++) {
+        struct io_uring_cqe *cqe = &b->r.cqes[head & *b->r.cq_mask];
+        uint64_t data = cqe->user_data;
+        int res = cqe->res;
+        atomic_store_explicit((_Atomic unsigned *) b->r.cq_head, head + 1, memory_order_release);
+        it = (sac_batch_item *) (uintptr_t) (data & ~(uint64_t) SAC_BATCH_OP_MASK);
+        sac_batch_complete(b, it, (int) (data & SAC_BATCH_OP_MASK), res);
+    }
+    return SAC_OK;
+}
+#endif /* HAVE_IO_URING */
 
+/**
+ * @brief      Get the next file read by a batch reader
+ *
+ * @ingroup    sac
+ *
+ * @details    Wait for and return the next file read, in the order files
+ *             complete, see sac_batch_new().  Files that fail to be read
+ *             are returned as NULL with their index and status code.
+ *
+ * @param      b      batch reader
+ * @param      index  index of the file from sac_batch_add(), -1 when all
+ *                    files have been returned
+ * @param      nerr   status code of the file, 0 on success, non-zero on failure
+ *
+ * @return     file read, owned by the caller, NULL on failure or when
+ *             all files have been returned
+ */
+sac *
+sac_batch_next(sac_batch *b, int *index, int *nerr) {
+    sac *s = NULL;
+    sac_batch_item *it = NULL;
+    *index = -1;
+    *nerr = SAC_OK;
+    while(!b->head) {
+        if(b->returned == b->n) {
+            return NULL;
+        }
+#ifdef HAVE_IO_URING
+        if(b->uring) {
+            if((*nerr = sac_batch_poll(b)) != SAC_OK) {
+                return NULL;
+            }
+            continue;
+        }
+#endif /* HAVE_IO_URING */
+        it = b->item[b->started++];
+        b->active++;
+        sac_batch_read_sync(b, it);
+    }
+    it = b->head;
+    if(!(b->head = it->next)) {
+        b->tail = NULL;
+    }
+    b->returned++;
+    *index = it->index;
+    *nerr = it->nerr;
+    s = it->s;
+    it->s = NULL;
     return s;
- error:
-    if(fp) {
-        fclose(fp);
+}
+
+/**
+ * @brief      Free a batch reader
+ *
+ * @ingroup    sac
+ *
+ * @details    Free a batch reader.  Files still being read are waited
+ *             for and discarded, files not yet started are not read
+ *
+ * @param      b     batch reader
+ */
+void
+sac_batch_free(sac_batch *b) {
+    int i = 0, n = 0;
+    if(!b) {
+        return;
     }
-    if(s) {
-        sac_free(s);
-        s = NULL;
+    n = b->n;
+#ifdef HAVE_IO_URING
+    if(b->uring) {
+        // The kernel may still write into buffers of active files
+        b->n = b->started;
+        while(b->active > 0 && sac_batch_poll(b) == SAC_OK) {
+        }
+        sac_uring_free(&b->r);
     }
-    return NULL;
+#endif /* HAVE_IO_URING */
+    for(i = 0; i < n; i++) {
+        sac_batch_item *it = b->item[i];
+        if(it->s) {
+            sac_free(it->s);
+        }
+        if(it->fd >= 0) {
+            close(it->fd);
+        }
+        FREE(it->file);
+        FREE(it->filename);
+        FREE(it->c1);
+        FREE(it->c2);
+        FREE(it);
+    }
+    FREE(b->item);
+    FREE(b);
 }
 
 /**
@@ -3506,6 +11360,9 @@ sac_cut(sac *sin, char *c1, double t1, char *c2, double t2, enum CutAction cutac
     if(!sin) {
         return NULL;
     }
+    if(!sin->m->data_read && (*nerr = sac_data_load(sin)) != SAC_OK) {
+        return NULL;
+    }
     if(cutact != CutNone && (!isfinite(t1) || !isfinite(t2))) {
         *nerr = ERROR_START_TIME_GREATER_THAN_STOP;
         goto error;
@@ -3564,11 +11421,22 @@ sac_meta_new() {
         m->swap = FALSE;
         m->filename = NULL;
         m->data_read = TRUE;
+        m->flags = 0;
+        m->data_dirty = TRUE;
+        m->distaz_valid = FALSE;
         m->nstop = 0;
         m->nstart = 0;
         m->nfillb = 0;
         m->nfille = 0;
         m->ntotal = 0;
+        m->map = NULL;
+        m->map_size = 0;
+        m->live = FALSE;
+        m->seq = 0;
+        m->pack = FALSE;
+        m->quantize = 0.0;
+        m->quantize_relative = FALSE;
+        m->borrowed = FALSE;
     }
     return m;
 }
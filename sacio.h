@@ -60,6 +60,20 @@ enum CheckByteOrderFlag {
     CheckByteOrderOn  = TRUE,  /**< @brief Check byte order on comparison, aliases to 1 */
 };
 
+/**
+ * @brief Byte order of a sac file written to disk
+ *
+ * @memberof sac
+ * @ingroup sac
+ *
+ */
+enum ByteOrder {
+    ByteOrderInput  = 0, /**< @brief Byte order of the file as it was read */
+    ByteOrderNative = 1, /**< @brief Byte order of the system */
+    ByteOrderLittle = 2, /**< @brief Little endian byte order */
+    ByteOrderBig    = 3, /**< @brief Big endian byte order */
+};
+
 /**
  * @brief Verbose Flag
  *
@@ -444,6 +458,8 @@ struct sac_hdr {
 /** \endcond */
 CASSERT(sizeof(struct sac_hdr) == 656, SacHeader_h)
 
+#define SAC_DISTAZ_KEY 10 /**< @private @brief Number of header values checked for distance updates */
+
 typedef struct _sacmeta sacmeta;
 /**
  * Sac Meta Data
@@ -458,6 +474,18 @@ struct _sacmeta {
     int nfillb; /**<< \brief Points before the first point to read */
     int nfille; /**<< \brief Points after the last point to read  */
     int ntotal; /**<< \brief total number of points */
+    void *map;  /**<< \brief Memory mapped file backing the data, if mapped */
+    size_t map_size; /**<< \brief Size of the memory mapped file in bytes */
+    int live;   /**<< \brief If the file was still being written when read */
+    int seq;    /**<< \brief Header sequence number of a file being written */
+    int flags;  /**<< \brief Read flags used when data is loaded on first access */
+    int data_dirty; /**<< \brief If data changed since depmin, depmax, depmen were computed */
+    int distaz_valid; /**<< \brief If distaz holds the values of the last distance update */
+    double distaz[SAC_DISTAZ_KEY]; /**<< \brief Header values of the last distance update */
+    int pack;   /**<< \brief If the data is stored packed, see SAC_WRITE_PACK */
+    double quantize; /**<< \brief Largest error of data written, 0 for lossless, see sac_set_quantize() */
+    int quantize_relative; /**<< \brief If quantize is relative to the largest absolute value */
+    int borrowed; /**<< \brief If the data points into a caller owned buffer, see sac_view_buffer() */
 };
 
 typedef struct _sac_f64 sac_f64;
@@ -506,6 +534,92 @@ struct sac {
     int *sddhdr;         /**< @brief  @private SDD Header - Length MWESHD - 164 */
 };
 
+typedef struct sac_reader sac_reader;
+/**
+ * @brief sac streaming reader, data read in fixed size blocks
+ *
+ */
+struct sac_reader {
+    sac *s;              /**< @brief  sac header, data is not read */
+    float *y;            /**< @brief  first data component of the current block */
+    float *x;            /**< @brief  second data component of the current block */
+    size_t n;            /**< @brief  number of samples in the current block */
+    size_t start;        /**< @brief  sample index of the current block, from 0 */
+    size_t block;        /**< @brief  @private maximum samples per block */
+    size_t next;         /**< @brief  @private sample index of the next block */
+    int live;            /**< @brief  if the file is still being written */
+    int fd;              /**< @brief  @private file descriptor */
+    int ifd;             /**< @brief  @private inotify file descriptor, if following */
+};
+
+typedef struct sac_writer sac_writer;
+/**
+ * @brief sac streaming writer, data appended as it arrives
+ *
+ */
+struct sac_writer {
+    sac *s;              /**< @brief  sac header, updated as data is appended */
+    size_t npts;         /**< @brief  number of samples written */
+    double sum;          /**< @brief  @private sum of samples written */
+    size_t nonfinite;    /**< @brief  @private number of inf or nan samples */
+    int seq;             /**< @brief  @private sequence number of the last published header */
+    int fd;              /**< @brief  @private file descriptor */
+};
+
+typedef struct sac_io_stats sac_io_stats;
+/**
+ * @brief read statistics, accumulated over all sac files read
+ *
+ * @details Throughput is bytes / ns; dropped is the part of bytes
+ *          released from the page cache by bulk reads, see SAC_READ_BULK
+ */
+struct sac_io_stats {
+    uint64_t files;      /**< @brief  number of files read */
+    uint64_t bytes;      /**< @brief  number of bytes read */
+    uint64_t ns;         /**< @brief  time spent reading, nanoseconds */
+    uint64_t bulk_files; /**< @brief  number of files read with SAC_READ_BULK */
+    uint64_t dropped;    /**< @brief  bytes released from the page cache */
+};
+
+/** @brief asynchronous batch reader, see sac_batch_new() */
+typedef struct sac_batch sac_batch;
+
+typedef struct sac_bundle_member sac_bundle_member;
+/**
+ * @brief index entry of a member of a bundle, see sac_bundle_open()
+ *
+ * @details Times are SAC_INT_UNDEFINED for members without a reference time
+ */
+struct sac_bundle_member {
+    char *name;          /**< @brief  member name, e.g. the file it was read from */
+    off_t off;           /**< @brief  offset of the record in the bundle */
+    size_t size;         /**< @brief  size of the record in bytes */
+    char net[9];         /**< @brief  network, knetwk */
+    char sta[9];         /**< @brief  station, kstnm */
+    char loc[9];         /**< @brief  location, khole */
+    char cha[9];         /**< @brief  channel, kcmpnm */
+    timespec64 b;        /**< @brief  time of the first sample */
+    timespec64 e;        /**< @brief  time of the last sample */
+};
+
+/** @brief bundle of sac files, see sac_bundle_open() */
+typedef struct sac_bundle sac_bundle;
+
+typedef struct sac_packet sac_packet;
+/**
+ * @brief timestamped packet of samples for a single channel
+ *
+ */
+struct sac_packet {
+    timespec64 t;        /**< @brief  time of the first sample */
+    size_t n;            /**< @brief  number of samples */
+    sac_packet *next;    /**< @brief  @private queue link */
+    float y[];           /**< @brief  samples */
+};
+
+typedef struct sac_ingest sac_ingest;
+typedef struct sac_channel sac_channel;
+
 typedef struct complexf_t complexf;
 typedef struct complexd_t complexd;
 
@@ -531,18 +645,124 @@ sac * sac_new(void);
 void  sac_free(sac *s);
 /** @brief Read a sac file */
 sac * sac_read(char *filename, int *nerr);
+/** @brief Read a sac file with options */
+sac * sac_read_with_flags(char *filename, int flags, int *nerr);
+/** @brief Write a sac file with options */
+void sac_write_with_flags(sac *s, char *filename, int flags, int *nerr);
+/** @brief Write many sac files, atomically and flushed together */
+void sac_write_many(sac **s, char **filename, int n, int flags, int *nerr);
+/** @brief Mark data as changed, see SAC_WRITE_DIRTY_EXTREMA */
+void sac_mark_data_dirty(sac *s);
+/** @brief Get a data component, reading it if necessary */
+float * sac_data(sac *s, int comp);
 /** @brief Read a sac file in alphanumeric format */
 sac * sac_read_alpha(char *filename, int *nerr);
 /** @brief Read a sac file within a cut window */
 sac * sac_read_with_cut(char *filename, char *c1, double t1, char *c2, double t2, enum CutAction cutact, int *nerr);
+/** @brief Read a sac file within a cut window with options */
+sac * sac_read_with_cut_flags(char *filename, char *c1, double t1, char *c2, double t2, enum CutAction cutact, int flags, int *nerr);
+/** @brief Create an asynchronous batch reader */
+sac_batch * sac_batch_new(int depth, int flags, int *nerr);
+/** @brief Add a file to a batch reader */
+int sac_batch_add(sac_batch *b, char *filename, int *nerr);
+/** @brief Add a file to a batch reader to be cut on read */
+int sac_batch_add_cut(sac_batch *b, char *filename, char *c1, double t1, char *c2, double t2, enum CutAction cutact, int *nerr);
+/** @brief Get the next file read by a batch reader */
+sac * sac_batch_next(sac_batch *b, int *index, int *nerr);
+/** @brief Free a batch reader */
+void sac_batch_free(sac_batch *b);
+/** @brief Get read statistics */
+void sac_io_stats_get(sac_io_stats *st);
+/** @brief Reset read statistics */
+void sac_io_stats_reset(void);
+/** @brief Build a seek index for a compressed sac file */
+void sac_compressed_index(char *filename, size_t span, int *nerr);
 /** @brief Cut a sac file returning a new sac file */
 sac * sac_cut(sac *sin, char *c1, double t1, char *c2, double t2, enum CutAction cutact, int *nerr);
 /** @brief Read a sac header */
 sac * sac_read_header(char *filename, int *nerr);
+/** @brief Read a sac file using a memory mapping */
+sac * sac_read_mmap(char *filename, int *nerr);
+/** @brief Write a sac file into a caller owned buffer */
+size_t sac_write_buffer(sac *s, void *buf, size_t len, int flags, int *nerr);
+/** @brief Read a sac file from a memory buffer, copying the data */
+sac * sac_read_buffer(const void *buf, size_t len, int flags, int *nerr);
+/** @brief View a sac file in a native byte order memory buffer without copying the data */
+sac * sac_view_buffer(void *buf, size_t len, int flags, int *nerr);
+/** @brief Open a bundle of sac files */
+sac_bundle * sac_bundle_open(char *filename, int flags, int *nerr);
+/** @brief Append a sac file to a bundle */
+void  sac_bundle_append(sac_bundle *b, sac *s, char *name, int *nerr);
+/** @brief Append a sac file on disk to a bundle, unchanged */
+void  sac_bundle_append_file(sac_bundle *b, char *filename, int *nerr);
+/** @brief Number of members of a bundle */
+size_t sac_bundle_count(sac_bundle *b);
+/** @brief Index entry of a member of a bundle */
+const sac_bundle_member * sac_bundle_info(sac_bundle *b, size_t i);
+/** @brief Find a member of a bundle by name or key */
+ssize_t sac_bundle_find(sac_bundle *b, const char *key, size_t from);
+/** @brief Read a member of a bundle using a memory mapping */
+sac * sac_bundle_read(sac_bundle *b, size_t i, int *nerr);
+/** @brief Read the first member of a bundle matching a key */
+sac * sac_bundle_read_key(sac_bundle *b, const char *key, int *nerr);
+/** @brief Read part of a member of a bundle */
+sac * sac_bundle_read_cut(sac_bundle *b, size_t i, char *c1, double t1, char *c2, double t2, enum CutAction cutact, int *nerr);
+/** @brief Close a bundle, writing its index if members were appended */
+void  sac_bundle_close(sac_bundle *b, int *nerr);
+/** @brief Read a sac file into a caller owned float buffer */
+sac * sac_read_into_float(char *filename, float *y, size_t n, int *nerr);
+/** @brief Read a sac file into a caller owned double buffer */
+sac * sac_read_into_double(char *filename, double *y, size_t n, int *nerr);
+/** @brief Read a sac file into a caller owned scaled integer buffer */
+sac * sac_read_into_int32(char *filename, int32_t *y, size_t n, double scale, int *nerr);
+/** @brief Open a sac file for reading in fixed size blocks */
+sac_reader * sac_reader_open(char *filename, size_t block, int *nerr);
+/** @brief Read the next block of data */
+size_t sac_reader_next_block(sac_reader *r, int *nerr);
+/** @brief Set the sample the next block starts at */
+int    sac_reader_seek_sample(sac_reader *r, size_t i);
+/** @brief Time of the first sample of the current block */
+double sac_reader_time(sac_reader *r);
+/** @brief Wait for data to be published to a file being written */
+size_t sac_reader_wait(sac_reader *r, int timeout_ms, int *nerr);
+/** @brief Close a sac reader */
+void   sac_reader_close(sac_reader *r);
 /** @brief Write a sac file */
 void  sac_write(sac *s, char *filename, int *nerr);
+/** @brief Open a sac file for streaming writes */
+sac_writer * sac_writer_open(sac *hdr, char *filename, int *nerr);
+/** @brief Append samples to a streaming sac file */
+void  sac_writer_append(sac_writer *w, const float *y, size_t n, int *nerr);
+/** @brief Publish the samples written so far to concurrent readers */
+void  sac_writer_publish(sac_writer *w, int *nerr);
+/** @brief Finalize and close a streaming sac file */
+void  sac_writer_close(sac_writer *w, int *nerr);
 /** @brief Write a sac file header for an existing file*/
 void sac_write_header(sac *s, char *filename, int *nerr);
+/** @brief Write a sac file to a file descriptor */
+void  sac_write_fd(sac *s, int fd, int flags, int *nerr);
+/** @brief Write a sac file in a specific byte order */
+void  sac_write_byte_order(sac *s, char *filename, enum ByteOrder order, int *nerr);
+/** @brief Create a sac file as a writable memory mapping */
+sac * sac_create_mapped(sac *hdr, char *filename, int npts, int *nerr);
+/** @brief Finalize and close a sac file created with sac_create_mapped() */
+void  sac_close_mapped(sac *s, int *nerr);
+/** @brief Convert a sac file on disk to the system's byte order, in place */
+int   sac_file_to_native(char *filename, int *nerr);
+/** @brief Overwrite a range of samples of an existing sac file, in place */
+void  sac_write_samples(char *filename, size_t i0, const float *y, size_t n, int *nerr);
+/** @brief Create a new time rotating ingest */
+sac_ingest * sac_ingest_new(char *rotate, int *nerr);
+/** @brief Add a channel to an ingest */
+sac_channel * sac_ingest_add_channel(sac_ingest *in, sac *hdr, char *pattern, int *nerr);
+/** @brief Create a sample packet */
+sac_packet * sac_packet_new(timespec64 t, const float *y, size_t n);
+/** @brief Push a packet onto a channel, lock-free */
+void   sac_ingest_push(sac_channel *c, sac_packet *p);
+/** @brief Write all pushed packets */
+size_t sac_ingest_flush(sac_ingest *in, int *nerr);
+/** @brief Flush, close all files and free an ingest */
+void   sac_ingest_free(sac_ingest *in, int *nerr);
 /** @brief Write a sac file in alphanumeric format */
 void  sac_write_alpha(sac *s, char *filename, int *nerr);
 /** @brief Copy a sac object  */
@@ -560,6 +780,8 @@ void  sac_data_copy(sac *to, sac *from);
 sac * sac_copy(sac *s);
 void  sac_set_v7(sac *s);
 void  sac_set_v6(sac *s);
+/** @brief Set the error allowed when writing the data, quantized and packed */
+void  sac_set_quantize(sac *s, double error, int relative);
 
 void sac_check_time_precision(sac *s);
 
@@ -613,6 +835,28 @@ Spheroid spheroid(int ibody);
 #define SAC_NO_BYTESWAP_FILE      0 /**< @brief Do not byteswap file */
 #define SAC_BYTESWAP_FILE         1 /**< @brief Byteswap the file  */
 
+#define SAC_WRITE_PREALLOCATE     (1 << 0) /**< @brief Preallocate file space before writing */
+
+#define SAC_WRITE_NO_DISTAZ       (1 << 1) /**< @brief Do not update dist, az, baz and gcarc on write */
+#define SAC_WRITE_NO_EXTREMA      (1 << 2) /**< @brief Do not update depmin, depmax and depmen on write */
+#define SAC_WRITE_NO_PRECISION    (1 << 3) /**< @brief Do not check time precision on write */
+#define SAC_WRITE_ATOMIC          (1 << 4) /**< @brief Write to a temporary file and rename it into place */
+#define SAC_WRITE_FSYNC           (1 << 5) /**< @brief Flush each file to disk before returning */
+#define SAC_WRITE_FSYNC_GROUP     (1 << 6) /**< @brief Flush files to disk together, see sac_write_many() */
+#define SAC_WRITE_PACK            (1 << 7) /**< @brief Store data losslessly compressed in chunks, see sac_write_with_flags() */
+#define SAC_WRITE_DIRTY_EXTREMA   (1 << 8) /**< @brief Update depmin, depmax and depmen only for data marked changed, see sac_mark_data_dirty() */
+#define SAC_WRITE_NO_UPDATE       (SAC_WRITE_NO_DISTAZ | SAC_WRITE_NO_EXTREMA | SAC_WRITE_NO_PRECISION) /**< @brief Write header values as they are */
+
+#define SAC_READ_LAZY             (1 << 0) /**< @brief Read data on first access, see sac_data() */
+#define SAC_READ_NO_BE            (1 << 1) /**< @brief Do not update b and e on read */
+#define SAC_READ_NO_DISTAZ        (1 << 2) /**< @brief Do not update dist, az, baz and gcarc on read */
+#define SAC_READ_NO_EXTREMA       (1 << 3) /**< @brief Do not update depmin, depmax and depmen on read */
+#define SAC_READ_NO_PRECISION     (1 << 4) /**< @brief Do not check time precision on read */
+#define SAC_READ_BULK             (1 << 5) /**< @brief Read once, hint sequential access and drop from the page cache */
+#define SAC_READ_NO_UPDATE        (SAC_READ_NO_BE | SAC_READ_NO_DISTAZ | SAC_READ_NO_EXTREMA | SAC_READ_NO_PRECISION) /**< @brief Keep header values as stored in the file */
+
+#define SAC_BUNDLE_APPEND         (1 << 0) /**< @brief Open a bundle to append members, creating it if needed, see sac_bundle_open() */
+
 /** \endcond */
 
 /**
@@ -1136,6 +1380,10 @@ static struct sac_hdr NullSacHeader = {
 #define ERROR_START_TIME_GREATER_THAN_STOP  1328     /**< @brief Cut time time is greater than stop value */
 #define ERROR_CANT_CUT_UNEVENLY_SPACED_FILE 1356     /**< @brief Error cuting unevenly spaced file */
 #define ERROR_READING_CARD_IMAGE_HEADER     1319     /**< @brief Error reading an sac alphanumeric file */
+#define ERROR_BUFFER_TOO_SMALL              1360     /**< @brief Caller provided buffer is too small for the data */
+#define ERROR_COMPRESSED_FILE               1361     /**< @brief Compressed file and the compression is not supported */
+#define ERROR_BYTE_ORDER                    1362     /**< @brief Data is not in the system's byte order or not aligned */
+#define ERROR_PACKED_DATA                   1363     /**< @brief Data is packed and can not be mapped or streamed, see SAC_WRITE_PACK */
 
 #endif /* __SACIO_H__ */
 
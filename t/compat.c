@@ -140,4 +140,37 @@ main() {
     wsac1("t/test_spec_big.sac.tmp", y, &nlen, &beg, &del, &nerr, -1);
     assert(nerr == 0);
 
+    // Extrema are computed from the data written
+    rsac1("t/test_io_small.sac", y, &nlen, &beg, &del, &max, &nerr, -1);
+    assert(nerr == 0);
+    for(int i = 0; i < nlen; i++) {
+        y[i] *= 100.0;
+    }
+    wsac0("t/test_io_small_scaled.sac.tmp", x, y, &nerr, -1);
+    assert(nerr == 0);
+    sac *s = sac_read_header("t/test_io_small_scaled.sac.tmp", &nerr);
+    assert(nerr == 0);
+    assert(s->h->depmax == 100.0);
+    assert(s->h->depmin == 0.0);
+    sac_free(s);
+
+    y[0] = -50.0;
+    wsac1("t/test_io_small_scaled.sac.tmp", y, &nlen, &beg, &del, &nerr, -1);
+    assert(nerr == 0);
+    s = sac_read_header("t/test_io_small_scaled.sac.tmp", &nerr);
+    assert(nerr == 0);
+    assert(s->h->depmax == 100.0);
+    assert(s->h->depmin == -50.0);
+    sac_free(s);
+
+    for(int i = 0; i < nlen; i++) {
+        x[i] = (float) i;
+    }
+    y[1] = 200.0;
+    wsac2("t/test_io_small_scaled.sac.tmp", y, &nlen, x, &nerr, -1);
+    assert(nerr == 0);
+    s = sac_read_header("t/test_io_small_scaled.sac.tmp", &nerr);
+    assert(nerr == 0);
+    assert(s->h->depmax == 200.0);
+    sac_free(s);
 }
@@ -62,6 +62,8 @@ main(int argc, char *argv[]) {
 #include <stdlib.h>\n\
 #include <string.h>\n\
 #include <math.h>\n\
+#include <fcntl.h>\n\
+#include <unistd.h>\n\
 \n\
 #include <assert.h>\n\
 #define assert_eq(a,b) assert((a) == (b))\n\
@@ -2,6 +2,9 @@
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
+#include <signal.h>
+#include <dirent.h>
+#include <sys/resource.h>
 
 #include "sacio.h"
 
@@ -236,6 +239,52 @@ main() {
     sac_set_float(s, SAC_A, SAC_FLOAT_UNDEFINED);
     sac_get_string(s, SAC_AMARKER, tmp, sizeof(tmp));
     printf("%s\n", tmp);
+    sac_free(s);
+
+    // Data edited in place updates the extrema on write
+    s = sac_read("t/test_io_small.sac", &nerr);
+    assert(nerr == 0);
+    for(i = 0; i < s->h->npts; i++) {
+        s->y[i] *= 10.0;
+    }
+    sac_write(s, "t/test_io_scaled.sac.tmp", &nerr);
+    assert(nerr == 0);
+    sac_free(s);
+    s = sac_read_header("t/test_io_scaled.sac.tmp", &nerr);
+    assert(nerr == 0);
+    assert(s->h->depmax == 10.0);
+    assert(s->h->depmin == 0.0);
+
+    // Failing to reserve space for a mapped file keeps the existing file
+    struct rlimit old, lim;
+    struct dirent *d = NULL;
+    DIR *dir = NULL;
+    sac *m = NULL;
+    sac_free(s);
+    s = sac_read("t/test_io_scaled.sac.tmp", &nerr);
+    assert(nerr == 0);
+    sac_write(s, "t/test_io_mapped_keep.sac.tmp", &nerr);
+    assert(nerr == 0);
+    signal(SIGXFSZ, SIG_IGN);
+    getrlimit(RLIMIT_FSIZE, &old);
+    lim = old;
+    lim.rlim_cur = 4096;
+    setrlimit(RLIMIT_FSIZE, &lim);
+    m = sac_create_mapped(s, "t/test_io_mapped_keep.sac.tmp", 100000, &nerr);
+    setrlimit(RLIMIT_FSIZE, &old);
+    assert(m == NULL);
+    assert(nerr != 0);
+    sac_free(s);
+    s = sac_read("t/test_io_mapped_keep.sac.tmp", &nerr);
+    assert(nerr == 0);
+    assert(s->h->npts == 100);
+    assert(s->h->depmax == 10.0);
+    assert((dir = opendir("t")));
+    while((d = readdir(dir))) {
+        assert(strncmp(d->d_name, ".test_io_mapped_keep", 20) != 0);
+    }
+    closedir(dir);
+    sac_free(s);
 
     return 0;
 }
@@ -0,0 +1,2365 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <assert.h>
+#define assert_eq(a,b) assert((a) == (b))
+#define assert_ne(a,b) assert((a) != (b))
+
+void swap_double(void *v) {
+  char t = 0;
+  char *p = (char *) v;
+  for(size_t i = 0; i < 8/2; i++) {
+      size_t j = 8-i-1;
+      t = p[i]; p[i] = p[j]; p[j] = t;
+  }
+}
+
+enum {
+    ENDIAN_BIG,
+    ENDIAN_LITTLE
+};
+int
+byte_order() {
+    int byte_order;
+    short int word = 0x0001;
+    char *byte = (char *) &word;
+    byte_order = (! byte[0]) ? ENDIAN_BIG : ENDIAN_LITTLE;
+    return byte_order;
+} 
+#include <sacio.h>
+
+void test_00000() {
+     int nerr = 0;
+     sac *s = sac_read("t/test_io_small.sac", &nerr);
+     assert_ne(s, NULL);
+     assert_eq(nerr, 0);
+}
+void test_00001() {
+     int nerr = 0;
+     fprintf(stderr, "Error expected - non existant file\n");
+     sac *s = sac_read("non-existant-file", &nerr);
+     assert_eq(s, NULL);
+     assert_eq(nerr, 108);
+     fprintf(stderr, "Error expected - non existant file: Done\n");
+}
+void test_00002() {
+     int nerr = 0;
+     fprintf(stderr, "Error expected - wrong file type\n");
+     sac *s = sac_read("sacio.c", &nerr);
+     assert_eq(s, NULL);
+     assert_eq(nerr, 1317);
+     fprintf(stderr, "Error expected - wrong file type: Done\n");
+}
+void test_00003() {
+     int nerr = 0;
+     sac *f = sac_read("t/test_io_big.sac", &nerr);
+     sac *s = sac_read_with_flags("t/test_io_big.sac", SAC_READ_LAZY, &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(s->y, NULL);
+     assert_eq(s->h->npts, f->h->npts);
+     assert_eq(s->h->gcarc, f->h->gcarc);
+     
+     float *y = sac_data(s, 0);
+     assert_ne(y, NULL);
+     assert_eq(y, s->y);
+     assert_eq(memcmp(y, f->y, sizeof(float) * f->h->npts), 0);
+     assert_eq(sac_data(s, 0), y);
+     assert_eq(sac_data(s, 1), NULL);
+     
+     // Data is loaded before writing or copying
+     s = sac_read_with_flags("t/test_io_big.sac", SAC_READ_LAZY, &nerr);
+     sac_write(s, "t/test_io_lazy.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     sac *c = sac_read("t/test_io_lazy.sac.tmp", &nerr);
+     assert_eq(memcmp(c->y, f->y, sizeof(float) * f->h->npts), 0);
+}
+void test_00004() {
+     int nerr = 0;
+     float y[5] = { 1e3, 2e3, 3e3, 4e3, 5e3 };
+     sac *s = sac_read("t/test_io_big.sac", &nerr);
+     sac_set_float(s, SAC_E, 1.0);
+     sac_write_with_flags(s, "t/test_io_noupdate.sac.tmp", SAC_WRITE_NO_DISTAZ, &nerr);
+     assert_eq(nerr, 0);
+     sac_write_samples("t/test_io_noupdate.sac.tmp", 0, y, 5, &nerr);
+     
+     sac *c = sac_read_with_flags("t/test_io_noupdate.sac.tmp", SAC_READ_NO_UPDATE, &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(c->h->_e, 1.0);
+     assert_eq(c->h->depmax, 5e3);
+     assert_eq(memcmp(c->y, y, sizeof y), 0);
+     
+     // Extrema not updated when written
+     c->h->depmax = 1.0;
+     sac_write_with_flags(c, "t/test_io_noupdate.sac.tmp", SAC_WRITE_NO_EXTREMA, &nerr);
+     c = sac_read_with_flags("t/test_io_noupdate.sac.tmp", SAC_READ_NO_EXTREMA, &nerr);
+     assert_eq(c->h->depmax, 1.0);
+     c = sac_read("t/test_io_noupdate.sac.tmp", &nerr);
+     assert_eq(c->h->depmax, 5e3);
+     assert_ne(c->h->_e, 1.0);
+}
+void test_00005() {
+     int nerr = 0;
+     sac *s = sac_read_header("t/test_io_small.sac", &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(s->x, NULL);
+     assert_eq(s->y, NULL);
+     assert_ne(s->h, NULL);
+}
+void test_00006() {
+     int nerr = 0;
+     sac *s = sac_read_header("non-existant-file", &nerr);
+     assert_eq(s, NULL);
+     assert_eq(nerr, 108);
+     s = sac_read_header("sacio.c", &nerr);
+     assert_eq(s, NULL);
+     assert_eq(nerr, 1317);
+}
+void test_00007() {
+     int nerr = 0;
+     sac *s = sac_read("t/test_io_small.sac", &nerr);
+     assert_eq(nerr, 0);
+     sac_write(s, "t/test_io_small.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+}
+void test_00008() {
+     int nerr = 0;
+     sac *s = sac_read("t/test_io_big.sac", &nerr);
+     assert_eq(nerr, 0);
+     sac *c = sac_copy(s);
+     sac_write(s, "t/test_io_big.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(memcmp(s->y, c->y, sizeof(float) * s->h->npts), 0);
+     assert_eq(memcmp(s->h, c->h, sizeof(sac_hdr)), 0);
+     sac_free(c);
+     c = sac_read("t/test_io_big.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(c->m->swap, s->m->swap);
+     assert_eq(memcmp(s->y, c->y, sizeof(float) * s->h->npts), 0);
+}
+void test_00009() {
+     int nerr = 0;
+     sac *s = sac_read("t/test_io_small.sac", &nerr);
+     sac_write_with_flags(s, "t/test_io_atomic.sac.tmp", SAC_WRITE_ATOMIC | SAC_WRITE_FSYNC, &nerr);
+     assert_eq(nerr, 0);
+     sac *c = sac_read("t/test_io_atomic.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(memcmp(c->y, s->y, sizeof(float) * s->h->npts), 0);
+     
+     // Permissions of the file replaced are kept
+     struct stat st;
+     chmod("t/test_io_atomic.sac.tmp", 0640);
+     sac_write_with_flags(s, "t/test_io_atomic.sac.tmp", SAC_WRITE_ATOMIC, &nerr);
+     assert_eq(nerr, 0);
+     stat("t/test_io_atomic.sac.tmp", &st);
+     assert_eq(st.st_mode & 0777, 0640);
+}
+void test_00010() {
+     int nerr = 0;
+     sac *s = sac_new();
+     sac_set_int(s, SAC_NPTS, 20000);
+     sac_set_float(s, SAC_DELTA, 0.01);
+     sac_set_float(s, SAC_B, 0.0);
+     sac_alloc(s);
+     for(int i = 0; i < 20000; i++) {
+     s->y[i] = floorf(1000.0f * sinf(0.01f * i));
+     }
+     s->y[100] = -0.0f;
+     sac_write_with_flags(s, "t/test_io_pack.sac.tmp", SAC_WRITE_PACK, &nerr);
+     assert_eq(nerr, 0);
+     FILE *fp = fopen("t/test_io_pack.sac.tmp", "rb");
+     fseek(fp, 0, SEEK_END);
+     assert_eq(ftell(fp) < sac_size(s) / 2, 1);
+     fclose(fp);
+     sac *c = sac_read("t/test_io_pack.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(c->m->pack, 1);
+     assert_eq(memcmp(c->y, s->y, sizeof(float) * 20000), 0);
+     assert_eq(c->h->depmax, s->h->depmax);
+     c = sac_read_with_cut("t/test_io_pack.sac.tmp", "B", 50.0, "B", 52.0, CutUseBE, &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(c->h->npts, 201);
+     assert_eq(memcmp(c->y, s->y + 5000, sizeof(float) * 201), 0);
+     
+     // Lazy, memory mapped and caller buffer reads unpack the data
+     c = sac_read_with_flags("t/test_io_pack.sac.tmp", SAC_READ_LAZY, &nerr);
+     assert_eq(memcmp(sac_data(c, 0), s->y, sizeof(float) * 20000), 0);
+     c = sac_read_mmap("t/test_io_pack.sac.tmp", &nerr);
+     assert_eq(memcmp(c->y, s->y, sizeof(float) * 20000), 0);
+     float *y = malloc(sizeof(float) * 20000);
+     sac_read_into_float("t/test_io_pack.sac.tmp", y, 20000, &nerr);
+     assert_eq(memcmp(y, s->y, sizeof(float) * 20000), 0);
+     free(y);
+     
+     // Files in memory are unpacked, but can not be viewed in place
+     fp = fopen("t/test_io_pack.sac.tmp", "rb");
+     fseek(fp, 0, SEEK_END);
+     size_t len = (size_t) ftell(fp);
+     char *buf = malloc(len);
+     rewind(fp);
+     assert_eq(fread(buf, 1, len, fp), len);
+     fclose(fp);
+     c = sac_read_buffer(buf, len, 0, &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(memcmp(c->y, s->y, sizeof(float) * 20000), 0);
+     assert_eq(c->h->depmax, s->h->depmax);
+     c = sac_read_buffer(buf, len - 1, 0, &nerr);
+     assert_eq(c, NULL);
+     assert_eq(nerr, 114);
+     c = sac_view_buffer(buf, len, 0, &nerr);
+     assert_eq(c, NULL);
+     assert_eq(nerr, 1363);
+     free(buf);
+     
+     // Noise is stored raw, never larger than the values plus the index
+     sac_set_int(s, SAC_NPTS, 100000);
+     sac_alloc(s);
+     srand(1);
+     for(int i = 0; i < 100000; i++) {
+     s->y[i] = (float) rand() / RAND_MAX - 0.5f;
+     }
+     sac_write_with_flags(s, "t/test_io_pack.sac.tmp", SAC_WRITE_PACK, &nerr);
+     assert_eq(nerr, 0);
+     fp = fopen("t/test_io_pack.sac.tmp", "rb");
+     fseek(fp, 0, SEEK_END);
+     assert_eq(ftell(fp) <= sac_size(s) + 16 + 25 * 24, 1);
+     fclose(fp);
+     c = sac_read("t/test_io_pack.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(memcmp(c->y, s->y, sizeof(float) * 100000), 0);
+     c = sac_read_with_cut("t/test_io_pack.sac.tmp", "B", 500.0, "B", 502.0, CutUseBE, &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(memcmp(c->y, s->y + 50000, sizeof(float) * 201), 0);
+     
+     // Two component, byteswapped and v7 files
+     s = sac_read("t/test_uneven_small.sac", &nerr);
+     s->h->nvhdr = 7;
+     s->m->swap = !s->m->swap;
+     sac_write_with_flags(s, "t/test_io_pack.sac.tmp", SAC_WRITE_PACK, &nerr);
+     c = sac_read("t/test_io_pack.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(memcmp(c->x, s->x, sizeof(float) * s->h->npts), 0);
+     assert_eq(memcmp(c->y, s->y, sizeof(float) * s->h->npts), 0);
+     assert_eq(c->h->_b, s->h->_b);
+     fp = fopen("t/test_io_pack.sac.tmp", "rb");
+     fseek(fp, 0, SEEK_END);
+     len = (size_t) ftell(fp);
+     buf = malloc(len);
+     rewind(fp);
+     assert_eq(fread(buf, 1, len, fp), len);
+     fclose(fp);
+     c = sac_read_buffer(buf, len, 0, &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(memcmp(c->x, s->x, sizeof(float) * s->h->npts), 0);
+     assert_eq(memcmp(c->y, s->y, sizeof(float) * s->h->npts), 0);
+     assert_eq(c->h->_b, s->h->_b);
+     free(buf);
+}
+void test_00011() {
+     int nerr = 0;
+     sac *s = sac_read("t/test_io_small.sac", &nerr);
+     assert_eq(nerr, 0);
+     sac_write_header(s, "t/test_io_small.sac", &nerr);
+     assert_eq(nerr, 0);
+}
+void test_00012() {
+     int nerr = 0;
+     sac *s = sac_read("t/test_io_small.sac", &nerr);
+     assert_eq(nerr, 0);
+     sac_write_header(s, "non-existant-file", &nerr );
+     assert_eq(nerr, 108);
+}
+void test_00013() {
+     int nerr = 0;
+     sac *s = sac_read("t/test_io_small.sac", &nerr);
+     assert_eq(nerr, 0);
+     sac_write_header(s, "sacio.c", &nerr);
+     assert_eq(nerr, 1317);
+}
+void test_00014() {
+     int nerr = 0;
+     int little = (byte_order() == ENDIAN_LITTLE);
+     sac *s = sac_read("t/test_io_small.sac", &nerr);
+     assert_eq(nerr, 0);
+     
+     sac_write_byte_order(s, "t/test_io_order_big.sac.tmp", ByteOrderBig, &nerr);
+     assert_eq(nerr, 0);
+     sac *b = sac_read("t/test_io_order_big.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(b->m->swap, little);
+     assert_eq(memcmp(s->y, b->y, sizeof(float) * s->h->npts), 0);
+     
+     sac_write_byte_order(b, "t/test_io_order_native.sac.tmp", ByteOrderNative, &nerr);
+     assert_eq(nerr, 0);
+     sac *n = sac_read("t/test_io_order_native.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(n->m->swap, 0);
+     assert_eq(memcmp(s->y, n->y, sizeof(float) * s->h->npts), 0);
+}
+void test_00015() {
+     assert_eq(sac_is_timeval(SAC_B), 1);
+     assert_eq(sac_is_timeval(SAC_DEPMAX), 0);
+}
+void test_00016() {
+     int nerr = 0;
+     double t = 0.0;
+     sac *s = sac_read("t/test_io_small.sac", &nerr);
+     sac_set_pick(s, 3, 13.50);
+     sac_get_float(s, SAC_T3, &t);
+     assert_eq(t, 13.50);
+}
+void test_00017() {
+     int nerr = 0;
+     double t = 0.0;
+     sac *s = sac_read("t/test_io_small.sac", &nerr);
+     sac_set_pick(s, 3, 13.50);
+     sac_get_pick(s, 3, &t);
+     assert_eq(t, 13.50);
+}
+void test_00018() {
+     int nerr = 0;
+     double t = 0.0;
+     sac *s = sac_read("t/test_io_small.sac", &nerr);
+     sac_set_float(s, SAC_DELTA, 1.0/3.0);
+     
+     // Get delta, 32bit value, from the v6 header
+     sac_get_float(s, SAC_DELTA, &t);
+     assert_ne(t, 1.0/3.0);
+     
+     // Switch to the v7 header
+     sac_set_v7(s);
+     
+     // Get delta, 64bit value, from the v7 footer
+     sac_get_float(s, SAC_DELTA, &t);
+     assert_eq(t, 1.0/3.0);
+}
+void test_00019() {
+     int nerr = 0;
+     double t = 0.0;
+     sac *s = sac_read("t/test_io_small.sac", &nerr);
+     sac_set_float(s, SAC_DELTA, 1.0/3.0);
+     
+     // Switch to the v7 header
+     sac_set_v7(s);
+     
+     // Get delta, 64bit value, from the v7 footer
+     sac_get_float(s, SAC_DELTA, &t);
+     assert_eq(t, 1.0/3.0);
+     
+     // Switch to the v6 header
+     sac_set_v6(s);
+     
+     // Get delta, 32bit value, from the v6 header
+     sac_get_float(s, SAC_DELTA, &t);
+     assert_ne(t, 1.0/3.0);
+     
+}
+void test_00020() {
+     int nerr = 0;
+     sac *s = sac_new();
+     sac_set_int(s, SAC_NPTS, 20000);
+     sac_set_float(s, SAC_DELTA, 0.01);
+     sac_set_float(s, SAC_B, 0.0);
+     sac_alloc(s);
+     for(int i = 0; i < 20000; i++) {
+     s->y[i] = 3.7f * sinf(0.01f * i) * expf(-0.0001f * i) + 0.001f * (i % 7);
+     }
+     // Values within 1% of the largest amplitude
+     sac_set_quantize(s, 0.01, 1);
+     sac_write(s, "t/test_io_quant.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     FILE *fp = fopen("t/test_io_quant.sac.tmp", "rb");
+     fseek(fp, 0, SEEK_END);
+     assert_eq(ftell(fp) < sac_size(s) / 3, 1);
+     fclose(fp);
+     sac *c = sac_read("t/test_io_quant.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(c->m->pack, 1);
+     for(int i = 0; i < 20000; i++) {
+     assert_eq(fabsf(c->y[i] - s->y[i]) <= 0.01 * 3.7, 1);
+     }
+     c = sac_read_with_cut("t/test_io_quant.sac.tmp", "B", 50.0, "B", 52.0, CutUseBE, &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(c->h->npts, 201);
+     assert_eq(fabsf(c->y[0] - s->y[5000]) <= 0.01 * 3.7, 1);
+     
+     // Absolute errors, chunks are stored exactly when that is smaller
+     for(int i = 0; i < 20000; i++) {
+     s->y[i] = (i < 8192) ? floorf(s->y[i]) : s->y[i] * 1000.0f;
+     }
+     sac_set_quantize(s, 0.5, 0);
+     sac_write(s, "t/test_io_quant.sac.tmp", &nerr);
+     c = sac_read("t/test_io_quant.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(memcmp(c->y, s->y, sizeof(float) * 8192), 0);
+     for(int i = 8192; i < 20000; i++) {
+     assert_eq(fabsf(c->y[i] - s->y[i]) <= 0.5, 1);
+     }
+}
+void test_00021() {
+     int v = 0;
+     sac *s = sac_new();
+     assert_ne(s, NULL);
+     assert_eq(s->x, NULL);
+     assert_eq(s->y, NULL);
+     
+     sac_get_int(s, SAC_EVEN, &v);
+     assert_eq(v, TRUE);
+     
+     sac_get_int(s, SAC_POLARITY, &v);
+     assert_eq(v, FALSE);
+     
+     sac_get_int(s, SAC_OVERWRITE, &v);
+     assert_eq(v, TRUE);
+     
+     sac_get_int(s, SAC_CALC_DIST_AZ, &v);
+     assert_eq(v, TRUE);
+     
+     sac_get_int(s, SAC_FILE_TYPE, &v);
+     assert_eq(v, ITIME);
+}
+void test_00022() {
+     sac *s = sac_new();
+     sac_set_int(s, SAC_NPTS, 100);
+     sac_alloc(s);
+     assert_ne(s->y, NULL);
+     sac_free(s);
+     
+}
+void test_00023() {
+     sac *s = sac_new();
+     sac_set_int(s, SAC_NPTS, 100);
+     sac_alloc(s);
+     assert_ne(s->y, NULL);
+     assert_eq(s->x, NULL);
+     
+     // Set the file type to Amplitude/Phase (2 components)
+     sac_set_int(s, SAC_FILE_TYPE, IAMPH);
+     sac_alloc(s);
+     assert_ne(s->y, NULL);
+     assert_ne(s->x, NULL);
+}
+void test_00024() {
+     int nerr = 0;
+     sac *s = sac_read("t/test_io_small.sac", &nerr);
+     assert_eq(nerr, 0);
+     
+     // Write the sac file into alpha-numeric format
+     sac_write_alpha(s, "t/test_io_small_alpha.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+}
+void test_00025() {
+     int nerr = 0;
+     sac *s = sac_read_alpha("t/test_spec_alpha.sac", &nerr);
+     assert_eq(nerr, 0);
+     assert_ne(s, NULL);
+}
+void test_00026() {
+     int nerr = 0;
+     sac *s = sac_read_alpha("non-existant-file", &nerr);
+     assert_eq(nerr, 101);
+     assert_eq(s, NULL);
+}
+void test_00027() {
+     int nerr = 0;
+     fprintf(stderr, "Error expected - not an alpha numeric file\n");
+     sac *s = sac_read_alpha("t/test_io_small.sac", &nerr);
+     assert_eq(nerr, 1319);
+     assert_eq(s, NULL);
+     fprintf(stderr, "Error expected - not an alpha numeric file: Done\n");
+}
+void test_00028() {
+     double e = 0.0;
+     sac *s = sac_new();
+     sac_set_int(s, SAC_NPTS, 100);
+     sac_set_float(s, SAC_DELTA, 1.0);
+     sac_set_float(s, SAC_B, 0.0);
+     sac_be(s);
+     sac_get_float(s, SAC_E, &e);
+     assert_eq(e, 99.0);
+}
+void test_00029() {
+     Spheroid s = spheroid(-12345);
+     assert_eq(s.a, 6378160.0);
+     assert_eq(s.f, 0.00335293);
+     
+     s = spheroid(-1);
+     assert_eq(s.ibody, -12345);
+     s = spheroid( ISUN );
+     assert_eq(s.a, 696000000.0);
+     assert_eq(s.f, 8.189e-6);
+     s = spheroid( IEARTH );
+     assert_eq(s.a, 6378137.0);
+     assert_eq(s.f, 1.0/298.257223563);
+     s = spheroid( IMARS );
+     assert_eq(s.a, 3396190.0);
+     assert_eq(s.f, 1.0/169.89444722361179);
+     s = spheroid( IMOON );
+     assert_eq(s.a, 1737400.0);
+     assert_eq(s.f, 0.0);
+     s = spheroid( IVENUS );
+     assert_eq(s.a, 6051800.0);
+     assert_eq(s.f, 0.0);
+     s = spheroid( IMERCURY );
+     assert_eq(s.a, 2439700.0);
+     assert_eq(s.f, 0.0);
+}
+void test_00030() {
+     double gcarc = 0.0;
+     sac *s = sac_new();
+     sac_set_float(s, SAC_EVLO,  0.0);
+     sac_set_float(s, SAC_EVLA,  0.0);
+     sac_set_float(s, SAC_STLO, 10.0);
+     sac_set_float(s, SAC_STLA,  0.0);
+     sac_set_int(s, SAC_BODY_TYPE, IEARTH);
+     update_distaz(s);
+     sac_get_float(s, SAC_GCARC, &gcarc);
+     assert_eq(gcarc, 10.03364086151123);
+     
+     sac_set_int(s, SAC_BODY_TYPE, -12345);
+     update_distaz(s);
+     sac_get_float(s, SAC_GCARC, &gcarc);
+     assert_eq(gcarc, 10.033641815185547);
+}
+void test_00031() {
+     double gcarc = 0.0;
+     sac *s = sac_new();
+     sac_set_float(s, SAC_EVLO,  0.0);
+     sac_set_float(s, SAC_EVLA,  0.0);
+     sac_set_float(s, SAC_STLO, 10.0);
+     sac_set_float(s, SAC_STLA,  0.0);
+     sac_set_int(s, SAC_BODY_TYPE, IEARTH);
+     update_distaz(s);
+     sac_get_float(s, SAC_GCARC, &gcarc);
+     assert_eq(gcarc, 10.03364086151123);
+}
+void test_00032() {
+     sac *new = NULL;
+     int n_old = 0, n_new = 0;
+     int nerr = 0;
+     
+     // Read in an existing file
+     sac *old = sac_read("t/test_io_small.sac", &nerr);
+     assert_eq(nerr, 0);
+     
+     // Create a new sac file
+     new = sac_new();
+     sac_get_int(new, SAC_NPTS, &n_new);
+     assert_eq(n_new, SAC_INT_UNDEFINED);
+     
+     // Copy header from old file to new file
+     sac_header_copy(new, old);
+     
+     // Compare number of points
+     sac_get_int(new, SAC_NPTS, &n_new);
+     sac_get_int(old, SAC_NPTS, &n_old);
+     assert_eq(n_new, n_old);
+     
+}
+void test_00033() {
+     sac *new = NULL;
+     char f_old[256]= {0}, f_new[256] = {0};
+     int nerr = 0;
+     
+     // Read in an existing file
+     sac *old = sac_read("t/test_io_small.sac", &nerr);
+     assert_eq(nerr, 0);
+     
+     // Create a new sac file
+     new = sac_new();
+     sac_get_string(new, SAC_FILENAME, f_new, sizeof f_new);
+     assert_eq(strcmp(f_new, ""), 0);
+     
+     // Copy meta data from old file to new file
+     sac_meta_copy(new, old);
+     
+     // Compare number of points
+     sac_get_string(new, SAC_FILENAME, f_new, sizeof f_new);
+     sac_get_string(old, SAC_FILENAME, f_old, sizeof f_old);
+     assert_eq(strcmp(f_new, f_old), 0);
+     
+}
+void test_00034() {
+     sac *new = NULL;
+     int nerr = 0;
+     
+     // Read in an existing file
+     sac *old = sac_read("t/test_io_small.sac", &nerr);
+     assert_eq(nerr, 0);
+     assert_ne(old->y, NULL);
+     
+     // Create a new sac file
+     new = sac_new();
+     assert_eq(new->y, NULL);
+     
+     // Copy header from old file to new file
+     sac_header_copy(new, old);
+     
+     // Copy header from old file to new fiel
+     sac_data_copy(new, old);
+     
+     assert_ne(new->y, NULL);
+     
+}
+void test_00035() {
+     sac *new = NULL;
+     int n_old = 0, n_new = 0;
+     int nerr = 0;
+     
+     // Read in an existing file
+     sac *old = sac_read("t/test_io_small.sac", &nerr);
+     assert_eq(nerr, 0);
+     assert_ne(old->y, NULL);
+     
+     // Create a new sac file
+     new = sac_copy(old);
+     assert_ne(new->y, NULL);
+     
+     // Check the number of points
+     sac_get_int(old, SAC_NPTS, &n_old);
+     sac_get_int(new, SAC_NPTS, &n_new);
+     assert_eq(n_old, n_new);
+     
+}
+void test_00036() {
+     size_t n = 0;
+     size_t sac_header_size = 632;
+     sac *s = sac_new();
+     n = sac_size(s);
+     assert_eq(n, 0);
+     sac_set_int(s, SAC_NPTS, 1);
+     n = sac_size(s);
+     assert_eq(n, sac_header_size + 4 * 1);
+     
+     // Change to v7
+     sac_set_v7(s);
+     n = sac_size(s);
+     assert_eq(n, sac_header_size + 1 * 4 + 22 * 8);
+     
+}
+void test_00037() {
+     int n = 0;
+     sac *s = sac_new();
+     n = sac_comps(s);
+     assert_eq(n, 1);
+     
+     // Unevenly spaced time series file
+     sac_set_int(s, SAC_EVEN, 0);
+     n = sac_comps(s);
+     assert_eq(n, 2);
+     
+     // Evenly spaced xy file
+     sac_set_int(s, SAC_EVEN, 1);
+     sac_set_int(s, SAC_FILE_TYPE, IXY);
+     n = sac_comps(s);
+     assert_eq(n, 1);
+     
+     // Unevenly spaced xy file
+     sac_set_int(s, SAC_EVEN, 0);
+     sac_set_int(s, SAC_FILE_TYPE, IXY);
+     n = sac_comps(s);
+     assert_eq(n, 2);
+     
+     // Real - Imaginary data file
+     sac_set_int(s, SAC_FILE_TYPE, IRLIM);
+     n = sac_comps(s);
+     assert_eq(n, 2);
+     
+     // Amplitude - Phase data file
+     sac_set_int(s, SAC_FILE_TYPE, IAMPH);
+     n = sac_comps(s);
+     assert_eq(n, 2);
+     
+}
+void test_00038() {
+     int i = 0;
+     double v = 0.0;
+     sac *s = sac_new();
+     
+     // Define a data series, line from 0 to 99
+     sac_set_int(s, SAC_NPTS, 100);
+     sac_alloc(s);
+     for(i = 0; i < 100; i++) {
+     s->y[i] = (float) i;
+     }
+     
+     // Determine min, max and mean of data
+     sac_extrema(s);
+     
+     // Get min, max and mean
+     sac_get_float(s, SAC_DEPMIN, &v);
+     assert_eq(v, 0.0);
+     sac_get_float(s, SAC_DEPMAX, &v);
+     assert_eq(v, 99.0);
+     sac_get_float(s, SAC_DEPMEN, &v);
+     assert_eq(v, 49.5);
+}
+void test_00039() {
+     int nerr = 0;
+     sac *s = sac_read("t/test_io_big.sac", &nerr);
+     float depmax = s->h->depmax;
+     double gcarc = 0.0;
+     
+     // Writes rescan the data by default
+     s->y[0] = depmax + 1.0;
+     sac_write(s, "t/test_io_dirty.sac.tmp", &nerr);
+     assert_eq(s->h->depmax, depmax + 1.0);
+     
+     // Header only changes do not rescan marked data
+     sac_set_string(s, SAC_STA, "ABCD");
+     s->y[0] = depmax + 2.0;
+     sac_write_with_flags(s, "t/test_io_dirty.sac.tmp", SAC_WRITE_DIRTY_EXTREMA, &nerr);
+     assert_eq(s->h->depmax, depmax + 1.0);
+     
+     sac_mark_data_dirty(s);
+     sac_write_with_flags(s, "t/test_io_dirty.sac.tmp", SAC_WRITE_DIRTY_EXTREMA, &nerr);
+     assert_eq(s->h->depmax, depmax + 2.0);
+     
+     // Location changes, from setters or directly, update the distance
+     sac_set_float(s, SAC_EVLA, 0.0);
+     sac_set_float(s, SAC_EVLO, 0.0);
+     sac_set_float(s, SAC_STLA, 0.0);
+     sac_set_float(s, SAC_STLO, 10.0);
+     sac_write(s, "t/test_io_dirty.sac.tmp", &nerr);
+     sac_get_float(s, SAC_GCARC, &gcarc);
+     assert(fabs(gcarc - 10.0336) < 1e-3);
+     s->h->_stlo = 20.0;
+     sac_write(s, "t/test_io_dirty.sac.tmp", &nerr);
+     sac_get_float(s, SAC_GCARC, &gcarc);
+     assert(fabs(gcarc - 20.0) < 0.1);
+}
+void test_00040() {
+     int nerr = 0;
+     sac *s = NULL;
+     int host = byte_order();
+     int little = !(host == ENDIAN_LITTLE);
+     int big    = !(host == ENDIAN_BIG);
+     
+     s = sac_read("t/test_io_small.sac", &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(s->m->swap, little);
+     
+     sac_set_v7(s);
+     sac_write(s, "t/test_io_small_v7.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     
+     s = sac_read("t/test_io_big.sac", &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(s->m->swap, big);
+     
+     sac_set_v7(s);
+     sac_write(s, "t/test_io_big_v7.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     
+     s = sac_read("t/test_io_big_v7.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(s->m->swap, big);
+     assert_eq(s->h->nvhdr, 7);
+     
+     FILE *fp = NULL;
+     double v = 0.0;
+     fprintf(stderr, "Checking raw data file\n");
+     fp = fopen("t/test_io_big_v7.sac.tmp", "r");
+     assert_ne(fp, NULL);
+     fseek(fp, -8, SEEK_END);
+     v = 0.0;
+     assert_eq(fread(&v, sizeof(double), 1, fp), 1);
+     if(s->m->swap) {
+     assert_ne(v, -12345.0);
+     swap_double((void *) &v);
+     }
+     assert_eq(v, -12345.0);
+     fclose(fp);
+     
+     s = sac_read("t/test_io_small_v7.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(s->m->swap, little);
+     assert_eq(s->h->nvhdr, 7);
+     
+     fprintf(stderr, "Checking raw data file\n");
+     fp = fopen("t/test_io_small_v7.sac.tmp", "r");
+     assert_ne(fp, NULL);
+     fseek(fp, -8, SEEK_END);
+     v = 0.0;
+     assert_eq(fread(&v, sizeof(double), 1, fp), 1);
+     if(s->m->swap) {
+     assert_ne(v, -12345.0);
+     swap_double((void *) &v);
+     }
+     assert_eq(v, -12345.0);
+     fclose(fp);
+     
+}
+void test_00041() {
+     int nerr = 0;
+     sac *s = sac_read("t/test_io_big.sac", &nerr);
+     assert_eq(nerr, 0);
+     int fd = open("t/test_io_fd.sac.tmp", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+     assert(fd >= 0);
+     sac_write_fd(s, fd, SAC_WRITE_PREALLOCATE, &nerr);
+     assert_eq(nerr, 0);
+     close(fd);
+     sac *c = sac_read("t/test_io_fd.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(c->m->swap, s->m->swap);
+     assert_eq(memcmp(c->y, s->y, sizeof(float) * s->h->npts), 0);
+}
+void test_00042() {
+     int nerr = 0;
+     sac *s[2] = { sac_read("t/test_io_big.sac", &nerr),
+     sac_read("t/test_io_small.sac", &nerr) };
+     char *files[2] = { "t/test_io_group0.sac.tmp", "t/test_io_group1.sac.tmp" };
+     sac_write_many(s, files, 2, SAC_WRITE_ATOMIC | SAC_WRITE_FSYNC_GROUP, &nerr);
+     assert_eq(nerr, 0);
+     for(int i = 0; i < 2; i++) {
+     sac *c = sac_read(files[i], &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(memcmp(c->y, s[i]->y, sizeof(float) * s[i]->h->npts), 0);
+     }
+     
+     // Nothing is replaced if any file fails
+     char *bad[2] = { "t/test_io_group0.sac.tmp", "t/no-such-directory/file.sac" };
+     s[0]->y[0] += 1.0;
+     sac_write_many(s, bad, 2, SAC_WRITE_ATOMIC, &nerr);
+     assert_ne(nerr, 0);
+     sac *c = sac_read(files[0], &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(c->y[0], s[0]->y[0] - 1.0);
+}
+void test_00043() {
+     int nerr = 0;
+     sac_io_stats st;
+     sac_io_stats_reset();
+     sac *s = sac_read_with_flags("t/test_io_big.sac", SAC_READ_BULK, &nerr);
+     assert_eq(nerr, 0);
+     sac_io_stats_get(&st);
+     assert_eq(st.files, 1);
+     assert_eq(st.bulk_files, 1);
+     assert_eq(st.bytes, (uint64_t) sac_size(s));
+     assert(st.dropped == 0 || st.dropped == st.bytes);
+     
+     // Cut window hints only cover the data within the window
+     sac *c = sac_read_with_cut_flags("t/test_io_big.sac", "Z", 10.0, "Z", 30.0,
+     CutUseBE, SAC_READ_BULK, &nerr);
+     assert_eq(nerr, 0);
+     sac_io_stats_get(&st);
+     assert_eq(st.files, 2);
+     assert_eq(st.bytes, (uint64_t) (sac_size(s) + sac_size(c)));
+     
+     sac_io_stats_reset();
+     sac_io_stats_get(&st);
+     assert_eq(st.files, 0);
+}
+void test_00044() {
+     int nerr = 0;
+     sac *s = sac_read("t/test_io_big.sac", &nerr);
+     assert_eq(nerr, 0);
+     sac *m = sac_read_mmap("t/test_io_big.sac", &nerr);
+     assert_eq(nerr, 0);
+     assert_ne(m->m->map, NULL);
+     assert_eq(m->h->npts, s->h->npts);
+     assert_eq(memcmp(m->y, s->y, sizeof(float) * s->h->npts), 0);
+     assert_eq(m->h->depmax, s->h->depmax);
+     sac_free(m);
+     
+     m = sac_read_mmap("t/test_uneven_small.sac", &nerr);
+     assert_eq(nerr, 0);
+     assert_ne(m->x, NULL);
+     sac_free(m);
+     
+     m = sac_read_mmap("sacio.c", &nerr);
+     assert_eq(m, NULL);
+     assert_eq(nerr, 1317);
+     
+     // Compressed files are read as sac_read() reads them
+     int err = 0;
+     m = sac_read_mmap("t/test_io_small.sac.gz", &nerr);
+     sac_free(s);
+     s = sac_read("t/test_io_small.sac.gz", &err);
+     assert_eq(nerr, err);
+     if(s) {
+     assert_eq(memcmp(m->y, s->y, sizeof(float) * s->h->npts), 0);
+     }
+     sac_free(m);
+}
+void test_00045() {
+     int nerr = 0;
+     sac *s = sac_read("t/test_io_small.sac", &nerr);
+     unlink("t/test_io_bundle.tmp");
+     sac_bundle *b = sac_bundle_open("t/test_io_bundle.tmp", SAC_BUNDLE_APPEND, &nerr);
+     assert_eq(nerr, 0);
+     sac_bundle_append_file(b, "t/test_io_small.sac", &nerr);
+     assert_eq(nerr, 0);
+     sac_bundle_append_file(b, "t/test_uneven_big.sac", &nerr);
+     assert_eq(nerr, 0);
+     sac_set_string(s, SAC_STA, "BNDL");
+     sac_bundle_append(b, s, "bndl.sac", &nerr);
+     assert_eq(nerr, 0);
+     sac_bundle_append_file(b, "sacio.c", &nerr);
+     assert_eq(nerr, 1317);
+     sac_bundle_close(b, &nerr);
+     assert_eq(nerr, 0);
+     
+     // Members are listed from the index and read without copying the data
+     b = sac_bundle_open("t/test_io_bundle.tmp", 0, &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(sac_bundle_count(b), 3);
+     const sac_bundle_member *m = sac_bundle_info(b, 2);
+     assert_eq(strcmp(m->name, "bndl.sac"), 0);
+     assert_eq(strcmp(m->sta, "BNDL"), 0);
+     assert_eq(m->size, (size_t) sac_size(s));
+     sac *c = sac_bundle_read(b, 0, &nerr);
+     assert_eq(nerr, 0);
+     assert_ne(c->m->map, NULL);
+     assert_eq(memcmp(c->y, s->y, sizeof(float) * s->h->npts), 0);
+     sac_free(c);
+     c = sac_bundle_read_key(b, "t/test_uneven_big.sac", &nerr);
+     assert_eq(nerr, 0);
+     assert_ne(c->x, NULL);
+     sac_free(c);
+     assert_eq(sac_bundle_find(b, "BNDL", 0), 2);
+     assert_eq(sac_bundle_find(b, "BNDL", 3), -1);
+     assert_eq(sac_bundle_find(b, "NOPE", 0), -1);
+     c = sac_bundle_read_cut(b, 2, "B", 10.0, "B", 20.0, CutUseBE, &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(c->h->npts, 11);
+     assert_eq(memcmp(c->y, s->y + 1, sizeof(float) * 11), 0);
+     sac_free(c);
+     sac_bundle_close(b, &nerr);
+     assert_eq(nerr, 0);
+     
+     // Appending keeps existing members
+     b = sac_bundle_open("t/test_io_bundle.tmp", SAC_BUNDLE_APPEND, &nerr);
+     sac_bundle_append_file(b, "t/test_io_big.sac", &nerr);
+     assert_eq(sac_bundle_find(b, "t/test_io_big.sac", 0), 3);
+     sac_bundle_close(b, &nerr);
+     b = sac_bundle_open("t/test_io_bundle.tmp", 0, &nerr);
+     assert_eq(sac_bundle_count(b), 4);
+     c = sac_bundle_read(b, 2, &nerr);
+     assert_eq(memcmp(c->y, s->y, sizeof(float) * s->h->npts), 0);
+     sac_free(c);
+     sac_bundle_close(b, &nerr);
+     
+     // An unfinished append, a partial record after the index, is ignored
+     // when opened to append, and only then
+     int fd = open("t/test_io_bundle.tmp", O_WRONLY | O_APPEND);
+     assert_eq(write(fd, "partial record", 14), 14);
+     close(fd);
+     b = sac_bundle_open("t/test_io_bundle.tmp", 0, &nerr);
+     assert_eq(b, NULL);
+     assert_eq(nerr, 1317);
+     b = sac_bundle_open("t/test_io_bundle.tmp", SAC_BUNDLE_APPEND, &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(sac_bundle_count(b), 4);
+     sac_bundle_append(b, s, "after.sac", &nerr);
+     sac_bundle_close(b, &nerr);
+     assert_eq(nerr, 0);
+     b = sac_bundle_open("t/test_io_bundle.tmp", 0, &nerr);
+     assert_eq(sac_bundle_count(b), 5);
+     c = sac_bundle_read_key(b, "after.sac", &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(memcmp(c->y, s->y, sizeof(float) * s->h->npts), 0);
+     sac_free(c);
+     c = sac_bundle_read(b, 3, &nerr);
+     assert_eq(nerr, 0);
+     sac_free(c);
+     sac_bundle_close(b, &nerr);
+     
+     b = sac_bundle_open("t/test_io_small.sac", 0, &nerr);
+     assert_eq(b, NULL);
+     assert_eq(nerr, 1317);
+}
+void test_00046() {
+     int nerr = 0;
+     struct stat st;
+     sac *s = sac_read("t/test_io_small.sac", &nerr);
+     sac *m = sac_create_mapped(s, "t/test_io_create_mapped.sac.tmp", 1000, &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(m->h->npts, 1000);
+     for(int i = 0; i < 1000; i++) {
+     m->y[i] = (float) i;
+     }
+     stat("t/test_io_create_mapped.sac.tmp", &st);
+     assert_eq(st.st_size, sac_size(m));
+     sac_close_mapped(m, &nerr);
+     assert_eq(nerr, 0);
+     
+     sac *c = sac_read("t/test_io_create_mapped.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(c->m->live, 0);
+     assert_eq(c->h->npts, 1000);
+     assert_eq(c->y[999], 999.0);
+     assert_eq(c->h->depmax, 999.0);
+     
+     sac_set_v7(s);
+     m = sac_create_mapped(s, "t/test_io_create_mapped_v7.sac.tmp", 10, &nerr);
+     memset(m->y, 0, 10 * sizeof(float));
+     sac_close_mapped(m, &nerr);
+     c = sac_read("t/test_io_create_mapped_v7.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(c->h->nvhdr, 7);
+     assert_eq(c->h->depmax, 0.0);
+}
+void test_00047() {
+     int nerr = 0;
+     sac *s = sac_read("t/test_io_big.sac", &nerr);
+     sac_write_byte_order(s, "t/test_io_to_native.sac.tmp", ByteOrderInput, &nerr);
+     assert_eq(nerr, 0);
+     
+     sac_file_to_native("t/test_io_to_native.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(sac_file_to_native("t/test_io_to_native.sac.tmp", &nerr), 0);
+     assert_eq(nerr, 0);
+     
+     sac *n = sac_read("t/test_io_to_native.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(n->m->swap, 0);
+     assert_eq(memcmp(s->y, n->y, sizeof(float) * s->h->npts), 0);
+     assert_eq(n->h->depmax, s->h->depmax);
+}
+void test_00048() {
+     int nerr = 0;
+     float y[5] = { 1e3, 2e3, 3e3, 4e3, 5e3 };
+     sac *s = sac_read("t/test_io_big.sac", &nerr);
+     sac_write(s, "t/test_io_patch.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     
+     sac_write_samples("t/test_io_patch.sac.tmp", 10, y, 5, &nerr);
+     assert_eq(nerr, 0);
+     memcpy(s->y + 10, y, sizeof y);
+     sac_extrema(s);
+     
+     sac *c = sac_read("t/test_io_patch.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(c->m->swap, s->m->swap);
+     assert_eq(memcmp(c->y, s->y, sizeof(float) * s->h->npts), 0);
+     assert_eq(c->h->depmax, 5e3);
+     assert_eq(c->h->depmin, s->h->depmin);
+     assert(fabs(c->h->depmen - s->h->depmen) < 1e-3);
+     
+     // Replace the maximum, requires a scan of the data
+     memset(y, 0, sizeof y);
+     sac_write_samples("t/test_io_patch.sac.tmp", 10, y, 5, &nerr);
+     assert_eq(nerr, 0);
+     memcpy(s->y + 10, y, sizeof y);
+     sac_extrema(s);
+     c = sac_read("t/test_io_patch.sac.tmp", &nerr);
+     assert_eq(c->h->depmax, s->h->depmax);
+     
+     sac_write_samples("t/test_io_patch.sac.tmp", 98, y, 5, &nerr);
+     assert_eq(nerr, 115);
+}
+void test_00049() {
+     int nerr = 0;
+     float y[1024];
+     sac *s = sac_read("t/test_io_big.sac", &nerr);
+     sac *h = sac_read_into_float("t/test_io_big.sac", y, 1024, &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(h->y, NULL);
+     assert_eq(memcmp(y, s->y, sizeof(float) * s->h->npts), 0);
+     assert_eq(h->h->depmax, s->h->depmax);
+     assert_eq(h->h->depmen, s->h->depmen);
+     sac_free(h);
+     
+     h = sac_read_into_float("t/test_io_big.sac", y, 10, &nerr);
+     assert_eq(h, NULL);
+     assert_eq(nerr, ERROR_BUFFER_TOO_SMALL);
+}
+void test_00050() {
+     int nerr = 0;
+     double y[2048];
+     sac *s = sac_read("t/test_uneven_small.sac", &nerr);
+     sac *h = sac_read_into_double("t/test_uneven_small.sac", y, 2048, &nerr);
+     assert_eq(nerr, 0);
+     for(int i = 0; i < s->h->npts; i++) {
+     assert_eq(y[i], (double) s->y[i]);
+     assert_eq(y[s->h->npts + i], (double) s->x[i]);
+     }
+     sac_free(h);
+}
+void test_00051() {
+     int nerr = 0;
+     int32_t y[1024];
+     sac *s = sac_read("t/test_io_big.sac", &nerr);
+     sac *h = sac_read_into_int32("t/test_io_big.sac", y, 1024, 1000.0, &nerr);
+     assert_eq(nerr, 0);
+     for(int i = 0; i < s->h->npts; i++) {
+     assert_eq(y[i], (int32_t) lrint(s->y[i] * 1000.0));
+     }
+     sac_free(h);
+}
+void test_00052() {
+     int nerr = 0;
+     size_t n = 0;
+     double b = 0.0, delta = 0.0;
+     sac *s = sac_read("t/test_io_big.sac", &nerr);
+     sac_get_float(s, SAC_B, &b);
+     sac_get_float(s, SAC_DELTA, &delta);
+     sac_reader *r = sac_reader_open("t/test_io_big.sac", 30, &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(r->s->h->npts, s->h->npts);
+     assert_eq(r->s->y, NULL);
+     while((n = sac_reader_next_block(r, &nerr)) > 0) {
+     assert(n <= 30);
+     assert_eq(memcmp(r->y, s->y + r->start, n * sizeof(float)), 0);
+     assert_eq(sac_reader_time(r), b + r->start * delta);
+     }
+     assert_eq(nerr, 0);
+     assert_eq(r->start + r->n, (size_t) s->h->npts);
+     
+     assert_eq(sac_reader_seek_sample(r, 85), 0);
+     assert_eq(sac_reader_next_block(r, &nerr), 15);
+     assert_eq(r->start, 85);
+     assert_eq(memcmp(r->y, s->y + 85, 15 * sizeof(float)), 0);
+     assert_ne(sac_reader_seek_sample(r, 101), 0);
+     assert_eq(r->live, 0);
+     sac_reader_close(r);
+     
+     r = sac_reader_open("t/test_uneven_small.sac", 64, &nerr);
+     s = sac_read("t/test_uneven_small.sac", &nerr);
+     assert_eq(sac_reader_next_block(r, &nerr), 64);
+     assert_eq(memcmp(r->x, s->x, 64 * sizeof(float)), 0);
+     sac_reader_close(r);
+}
+void test_00053() {
+     int nerr = 0;
+     sac *s = sac_read("t/test_io_small.sac", &nerr);
+     sac_writer *w = sac_writer_open(s, "t/test_io_live.sac.tmp", &nerr);
+     sac_reader *r = sac_reader_open("t/test_io_live.sac.tmp", 64, &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(r->live, 1);
+     assert_eq(r->s->h->npts, 0);
+     assert_eq(sac_reader_wait(r, 0, &nerr), 0);
+     
+     // Appended, but not published
+     sac_writer_append(w, s->y, 40, &nerr);
+     assert_eq(sac_reader_wait(r, 0, &nerr), 0);
+     sac *c = sac_read_header("t/test_io_live.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(c->h->npts, 0);
+     
+     // Published
+     sac_writer_publish(w, &nerr);
+     assert_eq(sac_reader_wait(r, 1000, &nerr), 40);
+     assert_eq(sac_reader_next_block(r, &nerr), 40);
+     assert_eq(memcmp(r->y, s->y, 40 * sizeof(float)), 0);
+     c = sac_read("t/test_io_live.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(c->m->live, 1);
+     assert_eq(c->h->npts, 40);
+     assert_eq(c->h->unused25, -12345);
+     
+     // Closed
+     sac_writer_append(w, s->y + 40, s->h->npts - 40, &nerr);
+     sac_writer_close(w, &nerr);
+     assert_eq(sac_reader_wait(r, 1000, &nerr), (size_t) s->h->npts - 40);
+     assert_eq(r->live, 0);
+     assert_eq(sac_reader_next_block(r, &nerr), (size_t) s->h->npts - 40);
+     assert_eq(memcmp(r->y, s->y + 40, (s->h->npts - 40) * sizeof(float)), 0);
+     assert_eq(sac_reader_wait(r, 1000, &nerr), 0);
+     sac_reader_close(r);
+     c = sac_read("t/test_io_live.sac.tmp", &nerr);
+     assert_eq(c->m->live, 0);
+}
+void test_00054() {
+     int nerr = 0;
+     sac *s = sac_read("t/test_io_small.sac", &nerr);
+     sac_writer *w = sac_writer_open(s, "t/test_io_stream.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     for(int i = 0; i < s->h->npts; i += 7) {
+     int n = (s->h->npts - i < 7) ? s->h->npts - i : 7;
+     sac_writer_append(w, s->y + i, n, &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(w->s->h->npts, i + n);
+     }
+     sac_writer_close(w, &nerr);
+     assert_eq(nerr, 0);
+     
+     sac *c = sac_read("t/test_io_stream.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(c->h->npts, s->h->npts);
+     assert_eq(memcmp(c->y, s->y, sizeof(float) * s->h->npts), 0);
+     assert_eq(c->h->_e, s->h->_e);
+     assert_eq(c->h->depmin, s->h->depmin);
+     assert_eq(c->h->depmax, s->h->depmax);
+     
+     sac_set_v7(s);
+     w = sac_writer_open(s, "t/test_io_stream_v7.sac.tmp", &nerr);
+     sac_writer_append(w, s->y, s->h->npts, &nerr);
+     sac_writer_close(w, &nerr);
+     assert_eq(nerr, 0);
+     c = sac_read("t/test_io_stream_v7.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(c->h->nvhdr, 7);
+     assert_eq(memcmp(c->y, s->y, sizeof(float) * s->h->npts), 0);
+}
+void test_00055() {
+     int nerr = 0;
+     sac *s = sac_read("t/test_uneven_big.sac", &nerr);
+     size_t n = (size_t) sac_size(s);
+     char *buf = malloc(n);
+     assert_eq(sac_write_buffer(s, buf, n - 1, 0, &nerr), 0);
+     assert_eq(nerr, 1360);
+     assert_eq(sac_write_buffer(s, buf, n, 0, &nerr), n);
+     assert_eq(nerr, 0);
+     
+     // The buffer holds the same bytes as the file
+     char *file = malloc(n);
+     FILE *fp = fopen("t/test_uneven_big.sac", "rb");
+     assert_eq(fread(file, 1, n, fp), n);
+     fclose(fp);
+     assert_eq(memcmp(buf, file, n), 0);
+     
+     // Read back with a copy, from a buffer in any byte order
+     sac *c = sac_read_buffer(buf, n, 0, &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(memcmp(c->x, s->x, sizeof(float) * s->h->npts), 0);
+     assert_eq(memcmp(c->y, s->y, sizeof(float) * s->h->npts), 0);
+     assert_eq(c->h->depmax, s->h->depmax);
+     sac_free(c);
+     free(buf);
+     free(file);
+}
+void test_00056() {
+     int nerr = 0;
+     sac *s = sac_read("t/test_io_small.sac", &nerr);
+     sac_set_v7(s);
+     size_t n = (size_t) sac_size(s);
+     float *buf = malloc(n);
+     s->m->swap = 0;
+     sac_write_buffer(s, buf, n, 0, &nerr);
+     sac *v = sac_view_buffer(buf, n, 0, &nerr);
+     assert_eq(nerr, 0);
+     assert_eq((char *) v->y, (char *) buf + 632);
+     assert_eq(memcmp(v->y, s->y, sizeof(float) * s->h->npts), 0);
+     assert_eq(v->h->nvhdr, 7);
+     assert_eq(v->h->depmax, s->h->depmax);
+     sac_free(v);
+     assert_eq(buf[158], s->y[0]);
+     
+     // Buffers in the other byte order are read with a copy
+     s->m->swap = 1;
+     sac_write_buffer(s, buf, n, 0, &nerr);
+     v = sac_view_buffer(buf, n, 0, &nerr);
+     assert_eq(v, NULL);
+     assert_eq(nerr, 1362);
+     v = sac_read_buffer(buf, n, 0, &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(memcmp(v->y, s->y, sizeof(float) * s->h->npts), 0);
+     sac_free(v);
+     free(buf);
+}
+void test_00057() {
+     int i = 0;
+     sac *s = sac_new();
+     sac_set_float(s, SAC_B, 10.0);
+     sac_set_float(s, SAC_DELTA, 0.1);
+     
+     i = sac_time_to_index(s, 10.0);
+     assert_eq(i, 0);
+     
+     i = sac_time_to_index(s, 20.0);
+     assert_eq(i, 100 );
+}
+void test_00058() {
+     int nerr = 0;
+     double b = 0, e = 0;
+     sac *s = NULL;
+     
+     s = sac_read_with_cut("t/test_io_small.sac",
+     "Z", 10.0,
+     "Z", 30.0, CutUseBE,
+     &nerr);
+     sac_get_float(s, SAC_B, &b);
+     sac_get_float(s, SAC_E, &e);
+     assert_eq(b, 10.0);
+     assert_eq(e, 30.0);
+     
+     s = sac_read_with_cut("t/test_io_big.sac",
+     "Z", 10.0,
+     "Z", 30.0, CutUseBE,
+     &nerr);
+     sac_get_float(s, SAC_B, &b);
+     sac_get_float(s, SAC_E, &e);
+     assert_eq(b, 10.0);
+     assert_eq(e, 30.0);
+}
+void test_00059() {
+     int nerr = 0;
+     sac *s = sac_read("t/test_io_small.sac.gz", &nerr);
+     if(nerr != ERROR_COMPRESSED_FILE) {
+     assert_eq(nerr, 0);
+     sac *c = sac_read("t/test_io_small.sac", &nerr);
+     assert_eq(memcmp(s->h, c->h, sizeof(sac_hdr)), 0);
+     assert_eq(memcmp(s->y, c->y, sizeof(float) * c->h->npts), 0);
+     
+     sac_compressed_index("t/test_io_small.sac.gz", 64, &nerr);
+     assert_eq(nerr, 0);
+     s = sac_read_with_cut("t/test_io_small.sac.gz", "Z", 10.0, "Z", 30.0, CutUseBE, &nerr);
+     assert_eq(nerr, 0);
+     c = sac_read_with_cut("t/test_io_small.sac", "Z", 10.0, "Z", 30.0, CutUseBE, &nerr);
+     assert_eq(memcmp(s->h, c->h, sizeof(sac_hdr)), 0);
+     assert_eq(memcmp(s->y, c->y, sizeof(float) * c->h->npts), 0);
+     unlink("t/test_io_small.sac.gz.idx");
+     
+     // Enough deflate blocks for several access points
+     s = sac_read("t/test_io_long.sac.gz", &nerr);
+     assert_eq(nerr, 0);
+     sac_write(s, "t/test_io_long.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     sac_compressed_index("t/test_io_long.sac.gz", 16384, &nerr);
+     assert_eq(nerr, 0);
+     uint32_t n = 0;
+     FILE *fp = fopen("t/test_io_long.sac.gz.idx", "rb");
+     assert_eq(fseek(fp, 12, SEEK_SET), 0);
+     assert_eq(fread(&n, sizeof n, 1, fp), 1);
+     fclose(fp);
+     assert_eq(n >= 2, 1);
+     double win[][2] = { {10.0, 20.0}, {100.0, 150.0}, {190.0, 199.0} };
+     for(size_t i = 0; i < sizeof win / sizeof win[0]; i++) {
+     s = sac_read_with_cut("t/test_io_long.sac.gz", "B", win[i][0], "B", win[i][1], CutUseBE, &nerr);
+     assert_eq(nerr, 0);
+     c = sac_read_with_cut("t/test_io_long.sac.tmp", "B", win[i][0], "B", win[i][1], CutUseBE, &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(memcmp(s->h, c->h, sizeof(sac_hdr)), 0);
+     assert_eq(memcmp(s->y, c->y, sizeof(float) * c->h->npts), 0);
+     }
+     unlink("t/test_io_long.sac.gz.idx");
+     }
+     s = sac_read("t/test_io_big.sac.zst", &nerr);
+     if(nerr != ERROR_COMPRESSED_FILE) {
+     assert_eq(nerr, 0);
+     sac *c = sac_read("t/test_io_big.sac", &nerr);
+     assert_eq(memcmp(s->h, c->h, sizeof(sac_hdr)), 0);
+     assert_eq(memcmp(s->y, c->y, sizeof(float) * c->h->npts), 0);
+     }
+}
+void test_00060() {
+     int nerr = 0, i = 0, k = 0, n = 0;
+     char *files[] = { "t/test_io_big.sac", "t/test_io_small.sac",
+     "t/test_uneven_small.sac", "t/non-existant-file" };
+     sac_batch *b = sac_batch_new(2, 0, &nerr);
+     assert_eq(nerr, 0);
+     for(i = 0; i < 4; i++) {
+     assert_eq(sac_batch_add(b, files[i], &nerr), i);
+     }
+     assert_eq(sac_batch_add_cut(b, "t/test_io_big.sac", "Z", 10.0, "Z", 30.0,
+     CutUseBE, &nerr), 4);
+     sac *s = NULL;
+     while((s = sac_batch_next(b, &k, &nerr)) || k >= 0) {
+     n++;
+     if(k == 3) {
+     assert_eq(s, NULL);
+     assert_ne(nerr, 0);
+     continue;
+     }
+     assert_eq(nerr, 0);
+     sac *c = (k == 4) ?
+     sac_read_with_cut("t/test_io_big.sac", "Z", 10.0, "Z", 30.0, CutUseBE, &nerr) :
+     sac_read(files[k], &nerr);
+     assert_eq(memcmp(s->h, c->h, sizeof(sac_hdr)), 0);
+     assert_eq(memcmp(s->y, c->y, sizeof(float) * c->h->npts), 0);
+     if(c->x) {
+     assert_eq(memcmp(s->x, c->x, sizeof(float) * c->h->npts), 0);
+     }
+     sac_free(c);
+     sac_free(s);
+     }
+     assert_eq(n, 5);
+     sac_batch_free(b);
+}
+void test_00061() {
+     int nerr = 0, k = 0, err = 0;
+     char *files[] = { "t/test_io_small.sac.gz", "t/test_io_big.sac.zst" };
+     sac_batch *b = sac_batch_new(2, 0, &nerr);
+     sac_batch_add(b, files[0], &nerr);
+     sac_batch_add(b, files[1], &nerr);
+     sac_batch_add_cut(b, files[0], "Z", 10.0, "Z", 30.0, CutUseBE, &nerr);
+     sac *s = NULL;
+     while((s = sac_batch_next(b, &k, &nerr)) || k >= 0) {
+     sac *c = (k == 2) ?
+     sac_read_with_cut(files[0], "Z", 10.0, "Z", 30.0, CutUseBE, &err) :
+     sac_read(files[k], &err);
+     assert_eq(nerr, err);
+     if(c) {
+     assert_eq(memcmp(s->h, c->h, sizeof(sac_hdr)), 0);
+     assert_eq(memcmp(s->y, c->y, sizeof(float) * c->h->npts), 0);
+     }
+     sac_free(c);
+     sac_free(s);
+     }
+     sac_batch_free(b);
+}
+void test_00062() {
+     int nerr = 0;
+     double b = 0, e = 0;
+     sac *cut = NULL;
+     
+     sac *s = sac_read("t/test_io_small.sac", &nerr);
+     assert_eq(nerr, 0);
+     
+     // Cut the sac file, returning a new file
+     cut = sac_cut(s, "Z", 10.0, "Z", 30.0, CutUseBE, &nerr);
+     
+     sac_get_float(cut, SAC_B, &b);
+     sac_get_float(cut, SAC_E, &e);
+     assert_eq(b, 10.0);
+     assert_eq(e, 30.0);
+}
+void test_00063() {
+     char sta[18] = {0};
+     sac *s = sac_new();
+     // Set a string, SAC_KSTNM and SAC_STA are the same
+     sac_set_string(s, SAC_KSTNM, "PAS");
+     sac_get_string(s, SAC_STA, sta, sizeof sta);
+     assert_eq(strcmp(sta, "PAS"), 0);
+     
+     // Most input strings are truncated at 8 characters
+     //     SAC_KNETWK and SAC_NET are the same
+     sac_set_string(s, SAC_KNETWK, "123456789012345");
+     sac_get_string(s, SAC_NET, sta, sizeof sta);
+     assert_eq(strcmp(sta, "12345678"), 0);
+     
+     // ... except for the Event name, it gets 16 characters
+     //     SAC_KEVNM and SAC_EVENT are the same
+     sac_set_string(s, SAC_EVENT, "1234567890123456789");
+     sac_get_string(s, SAC_KEVNM, sta, sizeof sta);
+     assert_eq(strcmp(sta, "1234567890123456"), 0);
+     
+}
+void test_00064() {
+     char sta[18] = {0};
+     sac *s = sac_new();
+     // Set a string, SAC_KSTNM and SAC_STA are the same
+     sac_set_string(s, SAC_KSTNM, "PAS");
+     sac_get_string(s, SAC_STA, sta, sizeof sta);
+     assert_eq(strcmp(sta, "PAS"), 0);
+     
+     // Most input strings are truncated at 8 characters
+     //     SAC_KNETWK and SAC_NET are the same
+     sac_set_string(s, SAC_KNETWK, "123456789012345");
+     sac_get_string(s, SAC_NET, sta, sizeof sta);
+     assert_eq(strcmp(sta, "12345678"), 0);
+     
+     // ... except for the Event name, it gets 16 characters
+     //     SAC_KEVNM and SAC_EVENT are the same
+     sac_set_string(s, SAC_EVENT, "1234567890123456789");
+     sac_get_string(s, SAC_KEVNM, sta, sizeof sta);
+     assert_eq(strcmp(sta, "1234567890123456"), 0);
+     
+}
+void test_00065() {
+     double dt = 0.0;
+     sac *s = sac_new();
+     sac_set_float(s, SAC_DELTA, 0.25);
+     sac_get_float(s, SAC_DELTA, &dt);
+     assert_eq(dt, 0.25);
+}
+void test_00066() {
+     double dt = 0.0;
+     sac *s = sac_new();
+     sac_set_float(s, SAC_DELTA, 0.25);
+     sac_get_float(s, SAC_DELTA, &dt);
+     assert_eq(dt, 0.25);
+}
+void test_00067() {
+     int n = 0;
+     sac *s = sac_new();
+     sac_set_int(s, SAC_NPTS, 2600);
+     sac_get_int(s, SAC_NPTS, &n);
+     assert_eq(n, 2600);
+}
+void test_00068() {
+     int n = 0;
+     sac *s = sac_new();
+     sac_set_int(s, SAC_NPTS, 2600);
+     sac_get_int(s, SAC_NPTS, &n);
+     assert_eq(n, 2600);
+}
+void test_00069() {
+     sac *s = sac_new();
+     int ok = sac_hdr_defined(s, SAC_EVEN, SAC_FILE_TYPE, NULL);
+     assert_eq(ok, 1);
+}
+void test_00070() {
+     timespec64 t = {-1,-1};
+     sac *s = sac_new();
+     sac_set_int(s, SAC_YEAR, 1970);
+     sac_set_int(s, SAC_DAY,  2);
+     sac_set_int(s, SAC_HOUR, 0);
+     sac_set_int(s, SAC_MIN,  0);
+     sac_set_int(s, SAC_SEC,  0);
+     sac_set_int(s, SAC_MSEC, 0);
+     
+     sac_get_time_ref(s, &t);
+     assert_eq(t.tv_sec, 60*60*24);
+     assert_eq(t.tv_nsec, 0);
+}
+void test_00071() {
+     timespec64 t = {-1,-1};
+     timespec64 b = {-1,-1};
+     sac *s = sac_new();
+     timespec64_parse("1970/01/02T00:00:00", &t);
+     sac_set_time(s, t);
+     sac_set_float(s, SAC_B, 0.0);
+     
+     sac_get_time(s, SAC_B, &b);
+     assert_eq(b.tv_sec, 60*60*24);
+     assert_eq(b.tv_nsec, 0);
+}
+void test_00072() {
+     int io = 0;
+     timespec64 t = {0,0}, t2 = {0,0};
+     sac *s = sac_new();
+     timespec64_parse("1970/01/02T00:00:00", &t);
+     sac_set_time(s, t);
+     
+     sac_get_time_ref(s, &t2);
+     assert_eq(t2.tv_sec, 60*60*24);
+     assert_eq(t2.tv_nsec, 0);
+     
+     sac_get_int(s, SAC_ZERO_TIME, &io);
+     assert_eq(io, IO);
+}
+void test_00073() {
+     char code[32] = {0};
+     sac *s = sac_new();
+     sac_set_string(s, SAC_NET, "CI");
+     sac_set_string(s, SAC_STA, "PAS");
+     sac_set_string(s, SAC_LOC, "");
+     sac_set_string(s, SAC_CHA, "BHZ");
+     
+     sac_fmt(code, sizeof code, "%Z", s);
+     assert_eq(strcmp(code, "CI.PAS..BHZ"), 0);
+}
+void test_00074() {
+     int nerr = 0;
+     sac *s1 = NULL;
+     sac *s2 = NULL;
+     
+     // Compare two version of the same file
+     s1 = sac_read("t/test_io_small.sac", &nerr);
+     s2 = sac_copy(s1);
+     
+     assert_eq(sac_compare(s1, s2, 1e-4, CheckByteOrderOff, VerboseOff), 0);
+     
+     s2->y[0] += 1e-5;
+     assert_eq(sac_compare(s1, s2, 1e-4, CheckByteOrderOff, VerboseOff), 0);
+     assert_eq(sac_compare(s1, s2, 1e-6, CheckByteOrderOff, VerboseOff), 1);
+     
+     // Compare two files ....
+     s1 = sac_read("t/test_io_small.sac", &nerr);
+     s2 = sac_read("t/test_io_big.sac", &nerr);
+     
+     // ... ignoring the byte order
+     assert_eq(sac_compare(s1, s2, 1e-4, CheckByteOrderOff, VerboseOff), 0);
+     // ... checking the byte order
+     assert_eq(sac_compare(s1, s2, 1e-4, CheckByteOrderOn,  VerboseOff), 1);
+     
+     // Compare two differnt files
+     s1 = sac_read("t/test_io_small.sac", &nerr);
+     s2 = sac_new();
+     assert_eq(sac_compare(s1, s2, 1e-4, CheckByteOrderOn,  VerboseOff), 1);
+     
+}
+void test_00075() {
+     timespec64 t = {0,0};
+     t = timespec64_now();
+     timespec64_print(&t);
+}
+void test_00076() {
+     timespec64 t = timespec64_undef();
+     assert_eq(t.tv_sec, -62167219200);
+     assert_eq(t.tv_nsec, 0);
+}
+void test_00077() {
+     int64_t y = 0;
+     int m = 0, d = 0,  j = 0;
+     timespec64 t = {0,0};
+     t = timespec64_from_yjhmsf(1999, 60, 10, 34, 59, 0);
+     timespec64_to_ymd(&t, &y, &m, &d, &j);
+     assert_eq(y, 1999);
+     assert_eq(m, 3);
+     assert_eq(d, 1);
+     assert_eq(j, 60);
+}
+void test_00078() {
+     int64_t y = 0;
+     int m = 0, d = 0,  j = 0;
+     timespec64 t = {0,0};
+     t = timespec64_from_ymdhmsf(2000, 3, 1, 10, 34, 59, 0);
+     timespec64_to_ymd(&t, &y, &m, &d, &j);
+     assert_eq(y, 2000);
+     assert_eq(m, 3);
+     assert_eq(d, 1);
+     assert_eq(j, 61);
+}
+void test_00079() {
+     char out[64] = {0};
+     timespec64 t = {0,0};
+     
+     timespec64_parse("1994/160", &t);
+     strftime64t(out, sizeof out, "%F %T", &t);
+     assert_eq(strcmp(out, "1994-06-09 00:00:00"), 0);
+     
+     timespec64_parse("1992-10-31T23:59:59.999", &t);
+     strftime64t(out, sizeof out, "%F %T", &t);
+     assert_eq(strcmp(out, "1992-10-31 23:59:59"), 0);
+     
+}
+void test_00080() {
+     timespec64 t = {0,0};
+     timespec64_parse("1994/160", &t);
+     timespec64_print(&t);
+}
+void test_00081() {
+     char out[64] = {0};
+     timespec64 t  = {0,0};
+     timespec64 t1 = {0,0};
+     duration d = {0,0};
+     
+     timespec64_parse("1970/001", &t);
+     assert_eq(t.tv_sec, 0);
+     
+     duration_parse("1year", &d);
+     assert_eq(d.type, Duration_Years);
+     assert_eq(d.n, 1);
+     
+     t1 = timespec64_add_duration(t, &d);
+     assert_eq(t1.tv_sec, 365*24*60*60);
+     assert_eq(t1.tv_nsec, 0);
+     
+     strftime64t(out, sizeof out, "%F %T", &t1);
+     assert_eq(strcmp(out, "1971-01-01 00:00:00"), 0);
+     
+}
+void test_00082() {
+     char out[64] = {0};
+     timespec64 t = {0,0};
+     duration d = {0,0};
+     
+     timespec64_parse("1994/160T12:34:56.789", &t);
+     duration_parse("1h", &d);
+     t = timespec64_floor_duration(t, &d);
+     strftime64t(out, sizeof out, "%F %T.%3f", &t);
+     assert_eq(strcmp(out, "1994-06-09 12:00:00.000"), 0);
+     
+     duration_parse("6h", &d);
+     t = timespec64_floor_duration(t, &d);
+     strftime64t(out, sizeof out, "%F %T", &t);
+     assert_eq(strcmp(out, "1994-06-09 12:00:00"), 0);
+     
+     duration_parse("1day", &d);
+     t = timespec64_floor_duration(t, &d);
+     t = timespec64_add_duration(t, &d);
+     strftime64t(out, sizeof out, "%F %T", &t);
+     assert_eq(strcmp(out, "1994-06-10 00:00:00"), 0);
+     
+     duration_parse("1mon", &d);
+     t = timespec64_floor_duration(t, &d);
+     strftime64t(out, sizeof out, "%F %T", &t);
+     assert_eq(strcmp(out, "1994-06-01 00:00:00"), 0);
+     
+     duration_parse("1dec", &d);
+     t = timespec64_floor_duration(t, &d);
+     strftime64t(out, sizeof out, "%F %T", &t);
+     assert_eq(strcmp(out, "1990-01-01 00:00:00"), 0);
+}
+void test_00083() {
+     timespec64 a = {0,0};
+     timespec64 b = {0,0};
+     
+     timespec64_parse("1994/01", &a);
+     timespec64_parse("1994/02", &b);
+     
+     assert_eq(timespec64_cmp(&a, &b), -1);
+     assert_eq(timespec64_cmp(&b, &a), +1);
+     assert_eq(timespec64_cmp(&a, &a),  0);
+}
+void test_00084() {
+     char out[64] = {0};
+     timespec64 t = {0,0};
+     strptime64t("1994 03 01 23:59:47", "%Y %m %d %H:%M:%S", &t);
+     
+     strftime64t(out, sizeof out, "%F %T", &t);
+     assert_eq(strcmp(out, "1994-03-01 23:59:47"), 0);
+}
+void test_00085() {
+     char out[64] = {0};
+     timespec64 t = {0,0};
+     strptime64t("1994 03 01 23:59:47", "%Y %m %d %H:%M:%S", &t);
+     
+     strftime64t(out, sizeof out, "%F %T", &t);
+     assert_eq(strcmp(out, "1994-03-01 23:59:47"), 0);
+}
+void test_00086() {
+     duration *d = duration_new();
+     assert_eq(d->n, 0);
+     assert_eq(d->type, Duration_None);
+}
+void test_00087() {
+     duration d = {0,0};
+     duration_init(&d);
+     
+     assert_eq(d.n, 0);
+     assert_eq(d.type, Duration_None);
+}
+void test_00088() {
+     duration d = {0,0};
+     
+     duration_parse("8w", &d);
+     assert_eq(d.n, 8);
+     assert_eq(d.type, Duration_Weeks);
+     
+     duration_parse("50years", &d);
+     assert_eq(d.n, 50);
+     assert_eq(d.type, Duration_Years);
+     
+     duration_parse("-15days", &d);
+     assert_eq(d.n, -15);
+     assert_eq(d.type, Duration_Days);
+}
+void test_00089() {
+     duration *d = duration_from_string("3000s");
+     assert_eq(d->n, 3000);
+     assert_eq(d->type, Duration_Seconds);
+}
+void test_00090() {
+     int64_t y = 0;
+     int m = 0, d = 0, j = 0;
+     timespec64 t = {0,0};
+     timespec64_parse("1999/365", &t);
+     timespec64_to_ymd(&t, &y, &m, &d, &j);
+     assert_eq(y, 1999);
+     assert_eq(m,   12);
+     assert_eq(d,   31);
+     assert_eq(j,  365);
+}
+void test_00091() {
+     void fstrcpy(char *dst, size_t ndst, char *src, int nsrc);
+     char dst[32] = {0};
+     char small[4] = {0};
+     char *src = "hello there        ";
+     
+     fstrcpy(dst, sizeof dst, "hello", 5);
+     assert_eq(strcmp(dst, "hello"), 0);
+     
+     fstrcpy(dst, sizeof dst, "hello", -1);
+     assert_eq(strcmp(dst, "hello"), 0);
+     
+     fstrcpy(dst, sizeof dst, "hello", 4);
+     assert_eq(strcmp(dst, "hell"), 0);
+     
+     fstrcpy(dst, sizeof dst, "hello        ", 5);
+     assert_eq(strcmp(dst, "hello"), 0);
+     
+     fstrcpy(small, sizeof small, src, 11);
+     assert_eq(strcmp(small, "hel"), 0);
+     
+}
+void test_00092() {
+     void fstrput(char *dst, int ndst, char *src, size_t nsrc, int null_terminate);
+     
+     char dst[16] = {0};
+     char src[32] = {0};
+     strcpy(src, "hello there");
+     
+     fstrput(dst, sizeof dst, src, strlen(src), 0);
+     assert_eq(memcmp(dst, "hello there     ", sizeof dst), 0);
+     
+     fstrput(dst, sizeof dst, src, strlen(src), 1);
+     assert_eq(memcmp(dst, "hello there\0    ", sizeof dst), 0);
+     
+     fstrput(dst, sizeof dst, "v", 1, 0);
+     assert_eq(memcmp(dst, "v               ", sizeof dst), 0);
+     
+     fstrput(dst, sizeof dst, "v", 1, 1);
+     assert_eq(memcmp(dst, "v\0              ", sizeof dst), 0);
+     
+     fstrput(dst, sizeof dst, "123456789012345678901234567890", 30, 0);
+     assert_eq(memcmp(dst, "1234567890123456", sizeof dst), 0);
+     
+     fstrput(dst, sizeof dst, "123456789012345678901234567890", 30, 1);
+     assert_eq(memcmp(dst, "123456789012345\0", sizeof dst), 0);
+     
+}
+void test_00093() {
+     #define MAX 2000
+     
+     int nlen = 0, max = MAX, nerr = 0;
+     float y[MAX], beg = 0.0, del = 0.0;
+     
+     rsac1("t/test_io_small.sac", y, &nlen, &beg, &del, &max, &nerr, -1);
+     assert_eq(nerr, 0);
+     assert_eq(beg, 0.0);
+     assert_eq(del, 1.0);
+     assert_eq(nlen, 100);
+}
+void test_00094() {
+     #define MAX 2000
+     int nlen = 0, max = MAX, nerr = 0;
+     float y[MAX];
+     float beg = 0.0, del = 0.0;
+     max = 10;
+     rsac1("t/test_io_small.sac", y, &nlen, &beg, &del, &max, &nerr, -1);
+     assert_eq(nerr, -803);
+}
+void test_00095() {
+     #define MAX 2000
+     int nerr = 0, max = MAX, nlen = 0;
+     float y[MAX] = {0}, beg = 0.0, del = 0.0;
+     rsac1("t/test_uneven_small.sac", y, &nlen, &beg, &del, &max, &nerr, -1);
+     assert_eq(nerr, 801);
+}
+void test_00096() {
+     #define MAX 2000
+     int nerr = 0, max = MAX, nlen = 0;
+     float y[MAX] = {0}, beg = 0.0, del = 0.0;
+     rsac1("t/unicorns.sac", y, &nlen, &beg, &del, &max, &nerr, -1);
+     assert_eq(nerr, 108);
+}
+void test_00097() {
+     #define MAX 2000
+     float y[MAX] = {0}, x[MAX] = {0};
+     int nlen = 0, nerr = 0, max = MAX;
+     rsac2("t/test_uneven_big.sac", y, &nlen, x, &max, &nerr, -1);
+     assert_eq(nerr, 0);
+}
+void test_00098() {
+     #define MAX 2000
+     int nerr = 0, max = MAX, nlen = 0;
+     float y[MAX] = {0}, x[MAX] = {0};
+     max = 10;
+     rsac2("t/test_uneven_big.sac", y, &nlen, x, &max, &nerr, -1);
+     assert_eq(nerr, -803);
+}
+void test_00099() {
+     #define MAX 2000
+     int nerr = 0, max = MAX, nlen = 0;
+     float y[MAX] = {0}, x[MAX] = {0};
+     rsac2("t/test_io_big.sac", y, &nlen, x, &max, &nerr, -1);
+     assert_eq(nerr, 802);
+}
+void test_00100() {
+     #define MAX 2000
+     int nerr = 0, max = MAX, nlen = 0;
+     float y[MAX] = {0}, x[MAX] = {0};
+     rsac2("t/unicorns.sac", y, &nlen, x, &max, &nerr, -1);
+     assert_eq(nerr, 108);
+}
+void test_00101() {
+     int nerr = 0, even = 0, nvhdr = 0;
+     float dt = 0.0;
+     char ftype[16] = {0};
+     newhdr();
+     getlhv("leven", &even, &nerr, -1);
+     assert_eq(even, 1);
+     
+     getihv("iftype", ftype, &nerr, -1, sizeof ftype);
+     assert_eq(strcmp(ftype, "ITIME   "), 0);
+     
+     getnhv("nvhdr", &nvhdr, &nerr, -1);
+     assert_eq(nvhdr, 6);
+     
+     getfhv("delta", &dt, &nerr, -1);
+     assert_eq(dt, SAC_FLOAT_UNDEFINED);
+     
+}
+void test_00102() {
+     int nerr = 0;
+     int nvhdr = 0;
+     char ftype[16] = {0};
+     float dt = 0.0;
+     
+     rsach("t/test_io_small.sac", &nerr, -1);
+     assert_eq(nerr, 0);
+     
+     getihv("iftype", ftype, &nerr, -1, sizeof ftype);
+     assert_eq(strcmp(ftype, "ITIME   "), 0);
+     
+     getnhv("nvhdr", &nvhdr, &nerr, -1);
+     assert_eq(nvhdr, 6);
+     
+     getfhv("delta", &dt, &nerr, -1);
+     assert_eq(dt, 1.0);
+     
+}
+void test_00103() {
+     int nerr = 0, npts = 0;
+     float x[MAX] = {0}, y[MAX] = {0}, b = 0.0, dt = 0.0;
+     newhdr();
+     
+     npts = 3;
+     setnhv("npts", &npts, &nerr, -1);
+     assert_eq(nerr, 0);
+     
+     setihv("iftype", "itime", &nerr, -1, -1);
+     assert_eq(nerr, 0);
+     
+     b = 0.0;
+     setfhv("b", &b, &nerr, -1);
+     assert_eq(nerr, 0);
+     
+     dt = 1.0;
+     setfhv("delta", &dt, &nerr, -1);
+     assert_eq(nerr, 0);
+     
+     y[0] = 0.0;
+     y[1] = 1.0;
+     y[2] = 2.0;
+     
+     wsac0("t/test.wsac0.sac.tmp", x, y, &nerr, -1);
+     assert_eq(nerr, 0);
+     
+}
+void test_00104() {
+     #define PI M_PI
+     int i = 0;
+     int nerr = 0, npts = 0;
+     float x[MAX] = {0}, y[MAX] = {0}, b = 0.0, dt = 0.0;
+     newhdr();
+     
+     npts = 8;
+     setnhv("npts", &npts, &nerr, -1);
+     npts = 3; // Saved NPTS
+     setnhv("nsnpts", &npts, &nerr, -1);
+     
+     setihv("iftype", "iamph", &nerr, -1, -1);
+     
+     b = 0.0;
+     setfhv("b", &b, &nerr, -1);
+     setfhv("sb", &b, &nerr, -1);
+     
+     dt = 0.125;
+     setfhv("delta", &dt, &nerr, -1);
+     dt = 1.0; // Saved delta
+     setfhv("sdelta", &dt, &nerr, -1);
+     
+     for(i = 0; i < 8; i++) {
+     y[i] = 1.0;
+     }
+     for(i = 1; i < 4; i++) {
+     x[  i] = -((double) i) * PI/4.0;
+     x[8-i] =  ((double) i) * PI/4.0;
+     }
+     x[0] = 0.0;
+     x[4] = PI;
+     
+     wsac0("t/test.wsac0.sac.tmp", x, y, &nerr, -1);
+     assert_eq(nerr, 0);
+     
+}
+void test_00105() {
+     int nerr = 0, npts = 0;
+     float y[MAX] = {0}, b = 0.0, dt = 0.0;
+     newhdr();
+     
+     setihv("iftype", "itime", &nerr, -1, -1);
+     assert_eq(nerr, 0);
+     
+     npts = 3;
+     b = 0.0;
+     dt = 1.0;
+     
+
+     y[0] = 0.0;
+     y[1] = 1.0;
+     y[2] = 2.0;
+     
+     wsac1("t/test.wsac1.sac.tmp", y, &npts, &b, &dt, &nerr, -1);
+     assert_eq(nerr, 0);
+     
+}
+void test_00106() {
+     #define PI M_PI
+     int i = 0;
+     int nerr = 0, npts = 0;
+     float x[MAX] = {0}, y[MAX] = {0}, b = 0.0, dt = 0.0;
+     newhdr();
+     
+     npts = 3; // Saved NPTS
+     setnhv("nsnpts", &npts, &nerr, -1);
+     npts = 8;
+     setnhv("npts", &npts, &nerr, -1);
+     
+     setihv("iftype", "iamph", &nerr, -1, -1);
+     
+     b = 0.0;
+     setfhv("b", &b, &nerr, -1);
+     setfhv("sb", &b, &nerr, -1);
+     
+     dt = 0.125;
+     setfhv("delta", &dt, &nerr, -1);
+     dt = 1.0; // Saved delta
+     setfhv("sdelta", &dt, &nerr, -1);
+     
+     for(i = 0; i < 8; i++) {
+     y[i] = 1.0;
+     }
+     for(i = 1; i < 4; i++) {
+     x[  i] = -((double) i) * PI/4.0;
+     x[8-i] =  ((double) i) * PI/4.0;
+     }
+     x[0] = 0.0;
+     x[4] = PI;
+     
+     wsac2("t/test.wsac2.sac.tmp", y, &npts, x, &nerr, -1);
+     assert_eq(nerr, 0);
+     
+}
+void test_00107() {
+     #define MAX 2000
+     int nlen = 0, max = MAX, nerr = 0;
+     float y[MAX];
+     float beg = 0.0, del = 0.0;
+     double del8 = 0.0;
+     rsac1("t/test_io_small.sac", y, &nlen, &beg, &del, &max, &nerr, -1);
+     assert_eq(nerr, 0);
+     
+     getdhv("delta", &del8, &nerr, -1);
+     assert_eq(nerr, 0);
+     assert_eq(del8, 1.0);
+}
+void test_00108() {
+     #define MAX 2000
+     int nlen = 0, max = MAX, nerr = 0;
+     float y[MAX];
+     float beg = 0.0, del = 0.0;
+     float del4 = 0.0;
+     rsac1("t/test_io_small.sac", y, &nlen, &beg, &del, &max, &nerr, -1);
+     assert_eq(nerr, 0);
+     
+     getfhv("delta", &del4, &nerr, -1);
+     assert_eq(nerr, 0);
+     assert_eq(del4, 1.0);
+     assert_eq(del4, del);
+}
+void test_00109() {
+     #define MAX 2000
+     int nlen = 0, max = MAX, nerr = 0;
+     float y[MAX];
+     float beg = 0.0, del = 0.0;
+     char value[32] = {0};
+     rsac1("t/test_io_small.sac", y, &nlen, &beg, &del, &max, &nerr, -1);
+     assert_eq(nerr, 0);
+     
+     getihv("iftype", value, &nerr, -1, sizeof value);
+     assert_eq(nerr, 0);
+     assert_eq(strcmp(value, "ITIME   "), 0);
+}
+void test_00110() {
+     #define MAX 2000
+     int nlen = 0, max = MAX, nerr = 0;
+     float y[MAX];
+     float beg = 0.0, del = 0.0;
+     char value[32] = {0};
+     rsac1("t/test_io_small.sac", y, &nlen, &beg, &del, &max, &nerr, -1);
+     assert_eq(nerr, 0);
+     
+     getkhv("kcmpnm", value, &nerr, -1, sizeof value);
+     assert_eq(nerr, 0);
+     assert_eq(strcmp(value, "Q       "), 0);
+     
+     getkhv("knetwk", value, &nerr, -1, sizeof value);
+     assert_eq(nerr, 1336);
+     assert_eq(strcmp(value, "-12345  "), 0);
+}
+void test_00111() {
+     #define MAX 2000
+     int nlen = 0, max = MAX, nerr = 0;
+     float y[MAX];
+     float beg = 0.0, del = 0.0;
+     int value = 0;
+     rsac1("t/test_io_small.sac", y, &nlen, &beg, &del, &max, &nerr, -1);
+     assert_eq(nerr, 0);
+     
+     getnhv("npts", &value, &nerr, -1);
+     assert_eq(nerr, 0);
+     assert_eq(value, 100);
+     
+     getnhv("nvhdr", &value, &nerr, -1);
+     assert_eq(nerr, 0);
+     assert_eq(value, 6);
+     
+     getnhv("nzyear", &value, &nerr, -1);
+     assert_eq(nerr, 1336);
+     assert_eq(value, -12345);
+}
+void test_00112() {
+     #define MAX 2000
+     int nlen = 0, max = MAX, nerr = 0;
+     float y[MAX];
+     float beg = 0.0, del = 0.0;
+     int value = 0;
+     rsac1("t/test_io_small.sac", y, &nlen, &beg, &del, &max, &nerr, -1);
+     assert_eq(nerr, 0);
+     
+     getlhv("leven", &value, &nerr, -1);
+     assert_eq(nerr, 0);
+     assert_eq(value, 1);
+     
+     getlhv("lcalda", &value, &nerr, -1);
+     assert_eq(nerr, 0);
+     assert_eq(value, 1);
+     
+}
+void test_00113() {
+     #define MAX 2000
+     int nlen = 0, max = MAX, nerr = 0, nvhdr = 0;
+     float y[MAX];
+     float beg = 0.0, del = 0.0;
+     double value = 0.0;
+     rsac1("t/test_io_small.sac", y, &nlen, &beg, &del, &max, &nerr, -1);
+     assert_eq(nerr, 0);
+     
+     value = 1.0/3.0;
+     setdhv("t0", &value, &nerr, -1);
+     assert_eq(nerr, 0);
+     
+     value = 0.0;
+     getdhv("t0", &value, &nerr, -1);
+     assert_eq(nerr, 0);
+     assert_eq(value, (float)(1.0/3.0));
+     
+     nvhdr = 7;
+     setnhv("nvhdr", &nvhdr, &nerr, -1);
+     
+     value = 0.0;
+     getdhv("t0", &value, &nerr, -1);
+     assert_eq(nerr, 0);
+     assert_eq(value, (double)(1.0/3.0));
+     
+}
+void test_00114() {
+     
+     int byte_order = TRUE;
+     int verbose    = FALSE;
+     #define MAX 2000
+     int nlen = 0, max = MAX, nerr = 0;
+     float y[MAX];
+     float beg = 0.0, del = 0.0;
+     
+     rsac1("t/test_io_small.sac", y, &nlen, &beg, &del, &max, &nerr, -1);
+     
+     assert_eq(sac_compare_to_file("t/test_io_small.sac", y, 1e-4, byte_order, verbose), 0);
+     
+     byte_order = TRUE;
+     assert_eq(sac_compare_to_file("t/test_io_big.sac", y, 1e-4, byte_order, verbose), 1);
+     byte_order = FALSE;
+     assert_eq(sac_compare_to_file("t/test_io_big.sac", y, 1e-4, byte_order, verbose), 0);
+     
+     y[0] += 1e-5;
+     assert_eq(sac_compare_to_file("t/test_io_small.sac", y, 1e-4, byte_order, verbose), 0);
+     assert_eq(sac_compare_to_file("t/test_io_small.sac", y, 1e-6, byte_order, verbose), 1);
+     
+     assert_eq(sac_compare_to_file("t/test_io_small.sac", y, 1e-6, byte_order, verbose), 1);
+     
+}
+void test_00115() {
+     int nerr = 0;
+     char out[64] = {0};
+     float y[90];
+     timespec64 t = {0,0}, tf = {0,0};
+     
+     remove("t/test_ingest_000030.sac.tmp");
+     remove("t/test_ingest_000100.sac.tmp");
+     sac_ingest *in = sac_ingest_new("1min", &nerr);
+     assert_eq(nerr, 0);
+     
+     // Template header, 1 sample per second
+     sac *hdr = sac_new();
+     sac_set_float(hdr, SAC_DELTA, 1.0);
+     sac_set_float(hdr, SAC_B, 0.0);
+     hdr->h->iftype = ITIME;
+     hdr->h->leven = 1;
+     hdr->h->nvhdr = 6;
+     sac_channel *c = sac_ingest_add_channel(in, hdr, "t/test_ingest_%H%M%S.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     
+     // 90 samples starting at 00:00:30 in 3 packets, crossing 00:01:00
+     for(int i = 0; i < 90; i++) {
+     y[i] = (float) i;
+     }
+     timespec64_parse("2000/001T00:00:30", &t);
+     for(int i = 0; i < 3; i++) {
+     timespec64 ti = t;
+     ti.tv_sec += i * 30;
+     sac_ingest_push(c, sac_packet_new(ti, y + i * 30, 30));
+     }
+     sac_ingest_flush(in, &nerr);
+     assert_eq(nerr, 0);
+     sac_ingest_free(in, &nerr);
+     assert_eq(nerr, 0);
+     
+     sac *a = sac_read("t/test_ingest_000030.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(a->h->npts, 30);
+     assert_eq(a->y[29], 29.0);
+     sac_get_time_ref(a, &tf);
+     strftime64t(out, sizeof out, "%FT%T", &tf);
+     assert_eq(strcmp(out, "2000-01-01T00:00:30"), 0);
+     
+     sac *b = sac_read("t/test_ingest_000100.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(b->h->npts, 60);
+     assert_eq(b->y[0], 30.0);
+     assert_eq(b->h->_b, 0.0);
+     assert_eq(b->h->depmax, 89.0);
+}
+void test_00116() {
+     int nerr = 0;
+     float y[100] = {0};
+     timespec64 t = {0,0};
+     remove("t/test_ingest_00.sac.tmp");
+     remove("t/test_ingest_00.sac.1.tmp");
+     
+     sac_ingest *in = sac_ingest_new("1h", &nerr);
+     sac *hdr = sac_new();
+     sac_set_float(hdr, SAC_DELTA, 1.0);
+     hdr->h->iftype = ITIME;
+     hdr->h->leven = 1;
+     hdr->h->nvhdr = 6;
+     sac_channel *c = sac_ingest_add_channel(in, hdr, "t/test_ingest_%H.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     
+     // A gap within the hour starts a second file with the same time pattern
+     timespec64_parse("2000/001T00:00:00", &t);
+     sac_ingest_push(c, sac_packet_new(t, y, 100));
+     sac_ingest_flush(in, &nerr);
+     assert_eq(nerr, 0);
+     t.tv_sec += 700;
+     sac_ingest_push(c, sac_packet_new(t, y, 10));
+     sac_ingest_free(in, &nerr);
+     assert_eq(nerr, 0);
+     
+     sac *a = sac_read("t/test_ingest_00.sac.tmp", &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(a->h->npts, 100);
+     sac *b = sac_read("t/test_ingest_00.sac.1.tmp", &nerr);
+     assert_eq(nerr, 0);
+     assert_eq(b->h->npts, 10);
+}
+
+int main() {
+     test_00000();
+     test_00001();
+     test_00002();
+     test_00003();
+     test_00004();
+     test_00005();
+     test_00006();
+     test_00007();
+     test_00008();
+     test_00009();
+     test_00010();
+     test_00011();
+     test_00012();
+     test_00013();
+     test_00014();
+     test_00015();
+     test_00016();
+     test_00017();
+     test_00018();
+     test_00019();
+     test_00020();
+     test_00021();
+     test_00022();
+     test_00023();
+     test_00024();
+     test_00025();
+     test_00026();
+     test_00027();
+     test_00028();
+     test_00029();
+     test_00030();
+     test_00031();
+     test_00032();
+     test_00033();
+     test_00034();
+     test_00035();
+     test_00036();
+     test_00037();
+     test_00038();
+     test_00039();
+     test_00040();
+     test_00041();
+     test_00042();
+     test_00043();
+     test_00044();
+     test_00045();
+     test_00046();
+     test_00047();
+     test_00048();
+     test_00049();
+     test_00050();
+     test_00051();
+     test_00052();
+     test_00053();
+     test_00054();
+     test_00055();
+     test_00056();
+     test_00057();
+     test_00058();
+     test_00059();
+     test_00060();
+     test_00061();
+     test_00062();
+     test_00063();
+     test_00064();
+     test_00065();
+     test_00066();
+     test_00067();
+     test_00068();
+     test_00069();
+     test_00070();
+     test_00071();
+     test_00072();
+     test_00073();
+     test_00074();
+     test_00075();
+     test_00076();
+     test_00077();
+     test_00078();
+     test_00079();
+     test_00080();
+     test_00081();
+     test_00082();
+     test_00083();
+     test_00084();
+     test_00085();
+     test_00086();
+     test_00087();
+     test_00088();
+     test_00089();
+     test_00090();
+     test_00091();
+     test_00092();
+     test_00093();
+     test_00094();
+     test_00095();
+     test_00096();
+     test_00097();
+     test_00098();
+     test_00099();
+     test_00100();
+     test_00101();
+     test_00102();
+     test_00103();
+     test_00104();
+     test_00105();
+     test_00106();
+     test_00107();
+     test_00108();
+     test_00109();
+     test_00110();
+     test_00111();
+     test_00112();
+     test_00113();
+     test_00114();
+     test_00115();
+     test_00116();
+}
@@ -0,0 +1,76 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+
+#include "sacio.h"
+
+#define NTHREADS 8
+#define NWRITES  16
+
+static sac *s = NULL;
+
+/* Write the same sac file from many threads, see sac_write_with_flags() */
+static void *
+writer(void *arg) {
+    int i = 0, nerr = 0;
+    long k = (long) arg;
+    int flags[] = { SAC_WRITE_NO_UPDATE,
+                    SAC_WRITE_NO_UPDATE | SAC_WRITE_ATOMIC,
+                    SAC_WRITE_NO_UPDATE | SAC_WRITE_PACK };
+    char file[64];
+    size_t n = (size_t) sac_size(s);
+    char *buf = malloc(n);
+
+    assert(buf);
+    for(i = 0; i < NWRITES; i++) {
+        snprintf(file, sizeof file, "t/test_threads_%ld.sac.tmp", k);
+        sac_write_with_flags(s, file, flags[(k + i) % 3], &nerr);
+        assert(nerr == 0);
+        assert(sac_write_buffer(s, buf, n, SAC_WRITE_NO_UPDATE, &nerr) == n);
+        assert(nerr == 0);
+    }
+    free(buf);
+    return NULL;
+}
+
+int
+main() {
+    long i = 0;
+    int nerr = 0;
+    pthread_t t[NTHREADS];
+    sac_hdr h;
+
+    s = sac_read("t/test_io_big.sac", &nerr);
+    assert(nerr == 0);
+    // Changed data is written as it is, without updating the extrema
+    s->y[0] = 100.0;
+    sac_mark_data_dirty(s);
+    memcpy(&h, s->h, sizeof h);
+
+    for(i = 0; i < NTHREADS; i++) {
+        assert(pthread_create(&t[i], NULL, writer, (void *) i) == 0);
+    }
+    for(i = 0; i < NTHREADS; i++) {
+        assert(pthread_join(t[i], NULL) == 0);
+    }
+    assert(memcmp(&h, s->h, sizeof h) == 0);
+
+    for(i = 0; i < NTHREADS; i++) {
+        char file[64];
+        snprintf(file, sizeof file, "t/test_threads_%ld.sac.tmp", i);
+        sac *c = sac_read(file, &nerr);
+        assert(nerr == 0);
+        assert(c->h->npts == s->h->npts);
+        assert(memcmp(c->y, s->y, sizeof(float) * (size_t) s->h->npts) == 0);
+        sac_free(c);
+        c = sac_read_header(file, &nerr);
+        assert(nerr == 0);
+        assert(c->h->depmax == h.depmax);
+        sac_free(c);
+    }
+    sac_free(s);
+    return 0;
+}
@@ -387,7 +387,112 @@ timespec64_add_duration(timespec64 a, duration *d) {
     case Duration_Centuries: tm.tm_year   += d->n * 100; break;
     }
     b.tv_sec  = timegm64(&tm);
-    b.tv_nsec = a.tv_sec;
+    b.tv_nsec = a.tv_nsec;
+    return b;
+}
+
+/**
+ * @brief Round a timespec64 down to a calendar aligned duration boundary
+ *
+ * @memberof timespec64
+ * @ingroup time
+ *
+ * @details Round a time down to the start of the duration interval containing
+ *   it.  Seconds, minutes, hours, days and weeks are aligned to multiples of
+ *   the duration from the epoch, 1970/01/01 00:00:00, e.g. `6h` aligns to
+ *   00, 06, 12 and 18 hours UTC.  Months are aligned to the first day of
+ *   the month and years, decades and centuries to the first day of the year,
+ *   both to multiples of the duration.  Durations of zero or less and
+ *   Duration_None return the input time.
+ *
+ * @param a  timespec64 value
+ * @param d  duration to align to
+ *
+ * @return aligned timespec64 value, with no fractional seconds
+ *
+ * @code
+ * char out[64] = {0};
+ * timespec64 t = {0,0};
+ * duration d = {0,0};
+ *
+ * timespec64_parse("1994/160T12:34:56.789", &t);
+ * duration_parse("1h", &d);
+ * t = timespec64_floor_duration(t, &d);
+ * strftime64t(out, sizeof out, "%F %T.%3f", &t);
+ * assert_eq(strcmp(out, "1994-06-09 12:00:00.000"), 0);
+ *
+ * duration_parse("6h", &d);
+ * t = timespec64_floor_duration(t, &d);
+ * strftime64t(out, sizeof out, "%F %T", &t);
+ * assert_eq(strcmp(out, "1994-06-09 12:00:00"), 0);
+ *
+ * duration_parse("1day", &d);
+ * t = timespec64_floor_duration(t, &d);
+ * t = timespec64_add_duration(t, &d);
+ * strftime64t(out, sizeof out, "%F %T", &t);
+ * assert_eq(strcmp(out, "1994-06-10 00:00:00"), 0);
+ *
+ * duration_parse("1mon", &d);
+ * t = timespec64_floor_duration(t, &d);
+ * strftime64t(out, sizeof out, "%F %T", &t);
+ * assert_eq(strcmp(out, "1994-06-01 00:00:00"), 0);
+ *
+ * duration_parse("1dec", &d);
+ * t = timespec64_floor_duration(t, &d);
+ * strftime64t(out, sizeof out, "%F %T", &t);
+ * assert_eq(strcmp(out, "1990-01-01 00:00:00"), 0);
+ * @endcode
+ */
+timespec64
+timespec64_floor_duration(timespec64 a, duration *d) {
+    struct TM tm;
+    int64_t n = 0, year = 0;
+    int64_t unit = 0;
+    timespec64 b = { 0, 0 };
+    if(!d || d->n <= 0 || d->type == Duration_None) {
+        return a;
+    }
+    switch(d->type) {
+    case Duration_None:    break;
+    case Duration_Seconds: unit = 1;          break;
+    case Duration_Minutes: unit = 60;         break;
+    case Duration_Hours:   unit = 3600;       break;
+    case Duration_Days:    unit = 86400;      break;
+    case Duration_Weeks:   unit = 7 * 86400;  break;
+    case Duration_Months:
+    case Duration_Years:
+    case Duration_Decades:
+    case Duration_Centuries:
+        break;
+    }
+    if(unit > 0) {
+        n = unit * d->n;
+        b.tv_sec = a.tv_sec - (((a.tv_sec % n) + n) % n);
+        return b;
+    }
+    gmtime64_r(&a.tv_sec, &tm);
+    tm.tm_sec  = 0;
+    tm.tm_min  = 0;
+    tm.tm_hour = 0;
+    tm.tm_mday = 1;
+    year = (int64_t) tm.tm_year + 1900;
+    switch(d->type) {
+    case Duration_Months:
+        n = (year * 12 + tm.tm_mon) - (((year * 12 + tm.tm_mon) % d->n) + d->n) % d->n;
+        year = n / 12;
+        tm.tm_mon = (int) (n % 12);
+        break;
+    case Duration_Years:     n = d->n;       break;
+    case Duration_Decades:   n = d->n * 10;  break;
+    case Duration_Centuries: n = d->n * 100; break;
+    default: break;
+    }
+    if(d->type != Duration_Months) {
+        tm.tm_mon = 0;
+        year -= ((year % n) + n) % n;
+    }
+    tm.tm_year = year - 1900;
+    b.tv_sec = timegm64(&tm);
     return b;
 }
 
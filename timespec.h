@@ -15,6 +15,7 @@ duration * duration_from_string(char *in);
 int        duration_parse(char *in, duration *d);
 
 timespec64 timespec64_add_duration(timespec64 a, duration *d);
+timespec64 timespec64_floor_duration(timespec64 a, duration *d);
 timespec64 timespec64_now();
 timespec64 timespec64_undef();
 int        timespec64_cmp(timespec64 *a, timespec64 *b);
@@ -0,0 +1,167 @@
+/**
+ * @file
+ * @brief Pack directories of sac files into bundles and unpack them
+ *
+ * Usage:
+ *   sacbundle pack bundle dir     Append the sac files below dir
+ *   sacbundle unpack bundle dir   Write each member to dir/name
+ *   sacbundle list bundle         List the members
+ *
+ * Members are named by their path relative to dir and copied unchanged,
+ * see sac_bundle_open()
+ */
+#define _XOPEN_SOURCE 700 /**< @private nftw() */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <ftw.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "sacio.h"
+
+static sac_bundle *bundle = NULL; /**< @private bundle being packed */
+static int status = 0;            /**< @private exit status */
+
+/**
+ * @brief      Append a file found below the directory being packed
+ * @private
+ */
+static int
+pack_file(const char *path, const struct stat *st, int type, struct FTW *ftw) {
+    int nerr = 0;
+    (void) st;
+    (void) ftw;
+    if(type != FTW_F) {
+        return 0;
+    }
+    if(strncmp(path, "./", 2) == 0) {
+        path += 2;
+    }
+    sac_bundle_append_file(bundle, (char *) path, &nerr);
+    if(nerr) {
+        fprintf(stderr, "%s: not added: %d\n", path, nerr);
+    }
+    return 0;
+}
+
+/**
+ * @brief      Create the parent directories of a file
+ * @private
+ */
+static int
+make_parents(char *path) {
+    char *p = NULL;
+    for(p = strchr(path + 1, '/'); p; p = strchr(p + 1, '/')) {
+        *p = 0;
+        if(mkdir(path, 0777) != 0 && errno != EEXIST) {
+            *p = '/';
+            return -1;
+        }
+        *p = '/';
+    }
+    return 0;
+}
+
+/**
+ * @brief      Copy a member of a bundle to a file, unchanged
+ * @private
+ */
+static int
+unpack_member(int fd, const sac_bundle_member *m, const char *dir) {
+    int out = -1, ret = -1;
+    size_t i = 0;
+    ssize_t k = 0;
+    char buf[65536];
+    char *path = NULL;
+
+    if(m->name[0] == '/' || strcmp(m->name, "..") == 0 || strncmp(m->name, "../", 3) == 0 ||
+       strstr(m->name, "/../") || (strlen(m->name) >= 3 && strcmp(m->name + strlen(m->name) - 3, "/..") == 0)) {
+        fprintf(stderr, "%s: unsafe member name, skipped\n", m->name);
+        return -1;
+    }
+    if(!(path = malloc(strlen(dir) + strlen(m->name) + 2))) {
+        return -1;
+    }
+    sprintf(path, "%s/%s", dir, m->name);
+    if(make_parents(path) != 0 || (out = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666)) < 0) {
+        fprintf(stderr, "%s: error creating file\n", path);
+        goto done;
+    }
+    for(i = 0; i < m->size; i += (size_t) k) {
+        size_t n = (m->size - i < sizeof buf) ? m->size - i : sizeof buf;
+        if((k = pread(fd, buf, n, m->off + (off_t) i)) <= 0 || write(out, buf, (size_t) k) != k) {
+            fprintf(stderr, "%s: error writing file\n", path);
+            goto done;
+        }
+    }
+    ret = 0;
+ done:
+    if(out >= 0) {
+        close(out);
+    }
+    free(path);
+    return ret;
+}
+
+int
+main(int argc, char *argv[]) {
+    int nerr = 0, fd = -1;
+    size_t i = 0;
+    const sac_bundle_member *m = NULL;
+
+    if(argc < 3 || (strcmp(argv[1], "list") != 0 && argc < 4)) {
+        fprintf(stderr, "Usage: %s pack bundle dir\n"
+                        "       %s unpack bundle dir\n"
+                        "       %s list bundle\n", argv[0], argv[0], argv[0]);
+        return 1;
+    }
+    if(strcmp(argv[1], "pack") == 0) {
+        if(!(bundle = sac_bundle_open(argv[2], SAC_BUNDLE_APPEND, &nerr))) {
+            fprintf(stderr, "%s: error opening bundle: %d\n", argv[2], nerr);
+            return 1;
+        }
+        // Members are named relative to the directory
+        if(chdir(argv[3]) != 0 || nftw(".", pack_file, 64, FTW_PHYS) != 0) {
+            fprintf(stderr, "%s: error reading directory\n", argv[3]);
+            status = 1;
+        }
+        sac_bundle_close(bundle, &nerr);
+        if(nerr) {
+            fprintf(stderr, "%s: error writing bundle: %d\n", argv[2], nerr);
+            status = 1;
+        }
+    } else if(strcmp(argv[1], "unpack") == 0 || strcmp(argv[1], "list") == 0) {
+        if(!(bundle = sac_bundle_open(argv[2], 0, &nerr))) {
+            fprintf(stderr, "%s: error opening bundle: %d\n", argv[2], nerr);
+            return 1;
+        }
+        if(argv[1][0] == 'u' && (fd = open(argv[2], O_RDONLY)) < 0) {
+            fprintf(stderr, "%s: error opening bundle\n", argv[2]);
+            status = 1;
+        }
+        if(fd >= 0 && mkdir(argv[3], 0777) != 0 && errno != EEXIST) {
+            fprintf(stderr, "%s: error creating directory\n", argv[3]);
+            status = 1;
+        }
+        for(i = 0; status == 0 && i < sac_bundle_count(bundle); i++) {
+            m = sac_bundle_info(bundle, i);
+            if(fd < 0) {
+                printf("%s %s.%s.%s.%s %lld %zu\n", m->name, m->net, m->sta, m->loc, m->cha,
+                       (long long) m->b.tv_sec, m->size);
+            } else if(unpack_member(fd, m, argv[3]) != 0) {
+                status = 1;
+            }
+        }
+        if(fd >= 0) {
+            close(fd);
+        }
+        sac_bundle_close(bundle, &nerr);
+    } else {
+        fprintf(stderr, "%s: unknown command: %s\n", argv[0], argv[1]);
+        status = 1;
+    }
+    return status;
+}
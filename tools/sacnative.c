@@ -0,0 +1,34 @@
+/**
+ * @file
+ * @brief Convert sac files to the system's byte order, in place
+ *
+ * Usage: sacnative file.sac [file.sac ...]
+ *
+ * Files already in the system's byte order are left untouched,
+ * see sac_file_to_native()
+ */
+#include <stdio.h>
+
+#include "sacio.h"
+
+int
+main(int argc, char *argv[]) {
+    int i = 0;
+    int nerr = 0;
+    int status = 0;
+
+    if(argc < 2) {
+        fprintf(stderr, "Usage: %s file.sac [file.sac ...]\n", argv[0]);
+        return 1;
+    }
+    for(i = 1; i < argc; i++) {
+        if(sac_file_to_native(argv[i], &nerr)) {
+            printf("%s: converted\n", argv[i]);
+        }
+        if(nerr) {
+            fprintf(stderr, "%s: error converting file: %d\n", argv[i], nerr);
+            status = 1;
+        }
+    }
+    return status;
+}